@@ -1475,6 +1475,9 @@ PARSER_RC pluginsd_replay_end(char **words, size_t num_words, void *user)
     st->counter_done++;
     store_metric_collection_completed();
 
+    // the points replicated may fill gaps inside the retention, without changing it
+    __atomic_add_fetch(&st->backfills, 1, __ATOMIC_RELAXED);
+
 #ifdef NETDATA_LOG_REPLICATION_REQUESTS
     st->replay.start_streaming = false;
     st->replay.after = 0;
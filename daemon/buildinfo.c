@@ -26,6 +26,12 @@
 #define FEAT_DBENGINE 0
 #endif
 
+#if defined(ENABLE_DBENGINE) && defined(HAVE_LINUX_IO_URING_H)
+#define FEAT_DBENGINE_IO_URING 1
+#else
+#define FEAT_DBENGINE_IO_URING 0
+#endif
+
 #if defined(HAVE_X509_VERIFY_PARAM_set1_host) && HAVE_X509_VERIFY_PARAM_set1_host == 1
 #define FEAT_TLS_HOST_VERIFY 1
 #else
@@ -95,6 +101,12 @@
 #define FEAT_ZLIB 0
 #endif
 
+#ifdef HAVE_ZSTD
+#define FEAT_ZSTD 1
+#else
+#define FEAT_ZSTD 0
+#endif
+
 #ifdef STORAGE_WITH_MATH
 #define FEAT_LIBM 1
 #else
@@ -269,6 +281,7 @@ void print_build_info(void) {
 
     printf("Features:\n");
     printf("    dbengine:                   %s\n", FEAT_YES_NO(FEAT_DBENGINE));
+    printf("    dbengine io_uring:          %s\n", FEAT_YES_NO(FEAT_DBENGINE_IO_URING));
     printf("    Native HTTPS:               %s\n", FEAT_YES_NO(FEAT_NATIVE_HTTPS));
     printf("    Netdata Cloud:              %s %s\n", FEAT_YES_NO(FEAT_CLOUD), FEAT_CLOUD_MSG);
     printf("    ACLK:                       %s\n", FEAT_YES_NO(FEAT_CLOUD));
@@ -285,6 +298,7 @@ void print_build_info(void) {
     printf("    libm:                    %s\n", FEAT_YES_NO(FEAT_LIBM));
     printf("    tcalloc:                 %s\n", FEAT_YES_NO(FEAT_TCMALLOC));
     printf("    zlib:                    %s\n", FEAT_YES_NO(FEAT_ZLIB));
+    printf("    zstd:                    %s\n", FEAT_YES_NO(FEAT_ZSTD));
 
     printf("Plugins:\n");
     printf("    apps:                    %s\n", FEAT_YES_NO(FEAT_APPS_PLUGIN));
@@ -317,6 +331,7 @@ void print_build_info_json(void) {
     printf("{\n");
     printf("  \"features\": {\n");
     printf("    \"dbengine\": %s,\n",         FEAT_JSON_BOOL(FEAT_DBENGINE));
+    printf("    \"dbengine-io-uring\": %s,\n", FEAT_JSON_BOOL(FEAT_DBENGINE_IO_URING));
     printf("    \"native-https\": %s,\n",     FEAT_JSON_BOOL(FEAT_NATIVE_HTTPS));
     printf("    \"cloud\": %s,\n",            FEAT_JSON_BOOL(FEAT_CLOUD));
 #ifdef DISABLE_CLOUD
@@ -340,7 +355,8 @@ void print_build_info_json(void) {
     printf("    \"libcrypto\": %s,\n",        FEAT_JSON_BOOL(FEAT_CRYPTO));
     printf("    \"libm\": %s,\n",             FEAT_JSON_BOOL(FEAT_LIBM));
     printf("    \"tcmalloc\": %s,\n",         FEAT_JSON_BOOL(FEAT_TCMALLOC));
-    printf("    \"zlib\": %s\n",              FEAT_JSON_BOOL(FEAT_ZLIB));
+    printf("    \"zlib\": %s,\n",             FEAT_JSON_BOOL(FEAT_ZLIB));
+    printf("    \"zstd\": %s\n",              FEAT_JSON_BOOL(FEAT_ZSTD));
     printf("  },\n");
 
     printf("  \"plugins\": {\n");
@@ -379,6 +395,9 @@ void analytics_build_info(BUFFER *b) {
 #ifdef ENABLE_DBENGINE
     add_to_bi(b, "dbengine");
 #endif
+#if (FEAT_DBENGINE_IO_URING!=0)
+    add_to_bi(b, "dbengine io_uring");
+#endif
 #ifdef ENABLE_HTTPS
     add_to_bi(b, "Native HTTPS");
 #endif
@@ -420,6 +439,9 @@ void analytics_build_info(BUFFER *b) {
 #ifdef NETDATA_WITH_ZLIB
     add_to_bi(b, "zlib");
 #endif
+#ifdef HAVE_ZSTD
+    add_to_bi(b, "zstd");
+#endif
 
 #ifdef ENABLE_APPS_PLUGIN
     add_to_bi(b, "apps");
@@ -1236,7 +1236,12 @@ struct dbengine2_cache_pointers {
     RRDDIM *rd_pgc_waste_acquire_spins;
     RRDDIM *rd_pgc_waste_delete_spins;
     RRDDIM *rd_pgc_waste_flush_spins;
+    RRDDIM *rd_pgc_waste_index_readers_fallback;
 
+    RRDSET *st_pgc_admissions;
+    RRDDIM *rd_pgc_admissions_protected;
+    RRDDIM *rd_pgc_admissions_probation;
+    RRDDIM *rd_pgc_admissions_promotions;
 };
 
 static void dbengine2_cache_statistics_charts(struct dbengine2_cache_pointers *ptrs, struct pgc_statistics *pgc_stats, struct pgc_statistics *pgc_stats_old __maybe_unused, const char *name, int priority) {
@@ -1250,7 +1255,7 @@ static void dbengine2_cache_statistics_charts(struct dbengine2_cache_pointers *p
             buffer_sprintf(family, "dbengine %s cache", name);
 
             BUFFER *title = buffer_create(100, NULL);
-            buffer_sprintf(title, "Netdata %s Cache Hit Ratio", name);
+            buffer_sprintf(title, "Netdata %s Cache Hit Ratio (%s eviction)", name, pgc_eviction_policy_name(pgc_stats->eviction_policy));
 
             ptrs->st_cache_hit_ratio = rrdset_create_localhost(
                     "netdata",
@@ -1648,6 +1653,7 @@ static void dbengine2_cache_statistics_charts(struct dbengine2_cache_pointers *p
             ptrs->rd_pgc_waste_delete_spins      = rrddim_add(ptrs->st_pgc_waste, "delete spins", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             ptrs->rd_pgc_waste_evict_spins       = rrddim_add(ptrs->st_pgc_waste, "evict spins", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             ptrs->rd_pgc_waste_flush_spins       = rrddim_add(ptrs->st_pgc_waste, "flush spins", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            ptrs->rd_pgc_waste_index_readers_fallback = rrddim_add(ptrs->st_pgc_waste, "index readers fallback", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
 
             buffer_free(id);
             buffer_free(family);
@@ -1663,6 +1669,7 @@ static void dbengine2_cache_statistics_charts(struct dbengine2_cache_pointers *p
         rrddim_set_by_pointer(ptrs->st_pgc_waste, ptrs->rd_pgc_waste_delete_spins, (collected_number)pgc_stats->delete_spins);
         rrddim_set_by_pointer(ptrs->st_pgc_waste, ptrs->rd_pgc_waste_evict_spins, (collected_number)pgc_stats->evict_spins);
         rrddim_set_by_pointer(ptrs->st_pgc_waste, ptrs->rd_pgc_waste_flush_spins, (collected_number)pgc_stats->flush_spins);
+        rrddim_set_by_pointer(ptrs->st_pgc_waste, ptrs->rd_pgc_waste_index_readers_fallback, (collected_number)pgc_stats->index_readers_fallback);
 
         rrdset_done(ptrs->st_pgc_waste);
     }
@@ -1714,6 +1721,48 @@ static void dbengine2_cache_statistics_charts(struct dbengine2_cache_pointers *p
 
         rrdset_done(ptrs->st_pgc_workers);
     }
+
+    if(pgc_stats->eviction_policy != PGC_EVICTION_LRU) {
+        if (unlikely(!ptrs->st_pgc_admissions)) {
+            BUFFER *id = buffer_create(100, NULL);
+            buffer_sprintf(id, "dbengine_%s_cache_admissions", name);
+
+            BUFFER *family = buffer_create(100, NULL);
+            buffer_sprintf(family, "dbengine %s cache", name);
+
+            BUFFER *title = buffer_create(100, NULL);
+            buffer_sprintf(title, "Netdata %s Cache Admissions (%s)", name, pgc_eviction_policy_name(pgc_stats->eviction_policy));
+
+            ptrs->st_pgc_admissions = rrdset_create_localhost(
+                    "netdata",
+                    buffer_tostring(id),
+                    NULL,
+                    buffer_tostring(family),
+                    NULL,
+                    buffer_tostring(title),
+                    "pages/s",
+                    "netdata",
+                    "stats",
+                    priority,
+                    localhost->rrd_update_every,
+                    RRDSET_TYPE_LINE);
+
+            ptrs->rd_pgc_admissions_protected  = rrddim_add(ptrs->st_pgc_admissions, "protected",  NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            ptrs->rd_pgc_admissions_probation  = rrddim_add(ptrs->st_pgc_admissions, "probation",  NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            ptrs->rd_pgc_admissions_promotions = rrddim_add(ptrs->st_pgc_admissions, "promotions", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+
+            buffer_free(id);
+            buffer_free(family);
+            buffer_free(title);
+            priority++;
+        }
+
+        rrddim_set_by_pointer(ptrs->st_pgc_admissions, ptrs->rd_pgc_admissions_protected, (collected_number)pgc_stats->admissions_protected);
+        rrddim_set_by_pointer(ptrs->st_pgc_admissions, ptrs->rd_pgc_admissions_probation, (collected_number)pgc_stats->admissions_probation);
+        rrddim_set_by_pointer(ptrs->st_pgc_admissions, ptrs->rd_pgc_admissions_promotions, (collected_number)pgc_stats->promotions);
+
+        rrdset_done(ptrs->st_pgc_admissions);
+    }
 }
 
 
@@ -1950,6 +1999,7 @@ static void dbengine2_statistics_charts(void) {
         static RRDDIM *rd_mrg_add = NULL;
         static RRDDIM *rd_mrg_del = NULL;
         static RRDDIM *rd_mrg_search = NULL;
+        static RRDDIM *rd_mrg_search_fallback = NULL;
 
         if (unlikely(!st_mrg_ops)) {
             st_mrg_ops = rrdset_create_localhost(
@@ -1969,12 +2019,14 @@ static void dbengine2_statistics_charts(void) {
             rd_mrg_add = rrddim_add(st_mrg_ops, "add", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             rd_mrg_del = rrddim_add(st_mrg_ops, "delete", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             rd_mrg_search = rrddim_add(st_mrg_ops, "search", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_mrg_search_fallback = rrddim_add(st_mrg_ops, "search lock fallback", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
         }
         priority++;
 
         rrddim_set_by_pointer(st_mrg_ops, rd_mrg_add, (collected_number)mrg_stats.additions);
         rrddim_set_by_pointer(st_mrg_ops, rd_mrg_del, (collected_number)mrg_stats.deletions);
         rrddim_set_by_pointer(st_mrg_ops, rd_mrg_search, (collected_number)mrg_stats.search_hits + (collected_number)mrg_stats.search_misses);
+        rrddim_set_by_pointer(st_mrg_ops, rd_mrg_search_fallback, (collected_number)mrg_stats.search_lockless_fallback);
 
         rrdset_done(st_mrg_ops);
     }
@@ -2357,10 +2409,48 @@ static void dbengine2_statistics_charts(void) {
         rrdset_done(st_query_pages_from_disk);
     }
 
+    {
+        static RRDSET *st_readahead = NULL;
+        static RRDDIM *rd_requests = NULL;
+        static RRDDIM *rd_pages = NULL;
+        static RRDDIM *rd_hits = NULL;
+        static RRDDIM *rd_wasted = NULL;
+
+        if (unlikely(!st_readahead)) {
+            st_readahead = rrdset_create_localhost(
+                    "netdata",
+                    "dbengine_query_readahead",
+                    NULL,
+                    "dbengine query router",
+                    NULL,
+                    "Netdata Query Read-Ahead",
+                    "events/s",
+                    "netdata",
+                    "stats",
+                    priority,
+                    localhost->rrd_update_every,
+                    RRDSET_TYPE_LINE);
+
+            rd_requests = rrddim_add(st_readahead, "requests", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_pages = rrddim_add(st_readahead, "pages to load", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_hits = rrddim_add(st_readahead, "hits", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_wasted = rrddim_add(st_readahead, "wasted", NULL, -1, 1, RRD_ALGORITHM_INCREMENTAL);
+        }
+        priority++;
+
+        rrddim_set_by_pointer(st_readahead, rd_requests, (collected_number)cache_efficiency_stats.readahead_requests);
+        rrddim_set_by_pointer(st_readahead, rd_pages, (collected_number)cache_efficiency_stats.readahead_pages_to_load);
+        rrddim_set_by_pointer(st_readahead, rd_hits, (collected_number)cache_efficiency_stats.readahead_hits);
+        rrddim_set_by_pointer(st_readahead, rd_wasted, (collected_number)cache_efficiency_stats.readahead_wasted);
+
+        rrdset_done(st_readahead);
+    }
+
     {
         static RRDSET *st_events = NULL;
         static RRDDIM *rd_journal_v2_mapped = NULL;
         static RRDDIM *rd_journal_v2_unmapped = NULL;
+        static RRDDIM *rd_journal_v2_filter_skips = NULL;
         static RRDDIM *rd_datafile_creation = NULL;
         static RRDDIM *rd_datafile_deletion = NULL;
         static RRDDIM *rd_datafile_deletion_spin = NULL;
@@ -2384,6 +2474,7 @@ static void dbengine2_statistics_charts(void) {
 
             rd_journal_v2_mapped = rrddim_add(st_events, "journal v2 mapped", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             rd_journal_v2_unmapped = rrddim_add(st_events, "journal v2 unmapped", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_journal_v2_filter_skips = rrddim_add(st_events, "journal v2 filter skips", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             rd_datafile_creation = rrddim_add(st_events, "datafile creation", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             rd_datafile_deletion = rrddim_add(st_events, "datafile deletion", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             rd_datafile_deletion_spin = rrddim_add(st_events, "datafile deletion spin", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
@@ -2394,6 +2485,7 @@ static void dbengine2_statistics_charts(void) {
 
         rrddim_set_by_pointer(st_events, rd_journal_v2_mapped, (collected_number)cache_efficiency_stats.journal_v2_mapped);
         rrddim_set_by_pointer(st_events, rd_journal_v2_unmapped, (collected_number)cache_efficiency_stats.journal_v2_unmapped);
+        rrddim_set_by_pointer(st_events, rd_journal_v2_filter_skips, (collected_number)cache_efficiency_stats.journal_v2_filter_skips);
         rrddim_set_by_pointer(st_events, rd_datafile_creation, (collected_number)cache_efficiency_stats.datafile_creation_started);
         rrddim_set_by_pointer(st_events, rd_datafile_deletion, (collected_number)cache_efficiency_stats.datafile_deletion_started);
         rrddim_set_by_pointer(st_events, rd_datafile_deletion_spin, (collected_number)cache_efficiency_stats.datafile_deletion_spin);
@@ -2634,6 +2726,78 @@ static void dbengine2_statistics_charts(void) {
 
             // ----------------------------------------------------------------
 
+            {
+                static RRDSET *st_write_amplification = NULL;
+                static RRDDIM *rd_datafiles = NULL;
+                static RRDDIM *rd_total = NULL;
+
+                if (unlikely(!st_write_amplification)) {
+                    st_write_amplification = rrdset_create_localhost(
+                            "netdata",
+                            "dbengine_write_amplification",
+                            NULL,
+                            "dbengine io",
+                            NULL,
+                            "Netdata DB engine bytes written per byte of pages flushed",
+                            "percentage",
+                            "netdata",
+                            "stats",
+                            priority,
+                            localhost->rrd_update_every,
+                            RRDSET_TYPE_LINE);
+
+                    rd_datafiles = rrddim_add(st_write_amplification, "datafiles", NULL, 1, 1000, RRD_ALGORITHM_ABSOLUTE);
+                    rd_total = rrddim_add(st_write_amplification, "total", NULL, 1, 1000, RRD_ALGORITHM_ABSOLUTE);
+                }
+                priority++;
+
+                // the bytes of the pages flushed, and the bytes written for them since the last iteration
+                static unsigned long long last_content_size = 0, last_extent_bytes = 0, last_written_bytes = 0;
+                unsigned long long content_size = stats_array[11] - last_content_size;
+                unsigned long long extent_bytes = stats_array[19] - last_extent_bytes;
+                unsigned long long written_bytes = stats_array[15] - last_written_bytes;
+                last_content_size = stats_array[11];
+                last_extent_bytes = stats_array[19];
+                last_written_bytes = stats_array[15];
+
+                rrddim_set_by_pointer(st_write_amplification, rd_datafiles,
+                                      content_size ? (collected_number)(extent_bytes * 100 * 1000 / content_size) : 0);
+                rrddim_set_by_pointer(st_write_amplification, rd_total,
+                                      content_size ? (collected_number)(written_bytes * 100 * 1000 / content_size) : 0);
+                rrdset_done(st_write_amplification);
+            }
+
+            // ----------------------------------------------------------------
+
+            {
+                static RRDSET *st_extents = NULL;
+                static RRDDIM *rd_extents = NULL;
+
+                if (unlikely(!st_extents)) {
+                    st_extents = rrdset_create_localhost(
+                            "netdata",
+                            "dbengine_extents_written",
+                            NULL,
+                            "dbengine io",
+                            NULL,
+                            "Netdata DB engine extents written",
+                            "extents/s",
+                            "netdata",
+                            "stats",
+                            priority,
+                            localhost->rrd_update_every,
+                            RRDSET_TYPE_LINE);
+
+                    rd_extents = rrddim_add(st_extents, "extents", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+                }
+                priority++;
+
+                rrddim_set_by_pointer(st_extents, rd_extents, (collected_number)stats_array[20]);
+                rrdset_done(st_extents);
+            }
+
+            // ----------------------------------------------------------------
+
             {
                 static RRDSET *st_errors = NULL;
                 static RRDDIM *rd_fs_errors = NULL;
@@ -594,6 +594,8 @@ void web_server_config_options(void)
         web_gzip_level = 9;
     }
 #endif /* NETDATA_WITH_ZLIB */
+
+    web_static_files_init();
 }
 
 
@@ -781,6 +783,21 @@ int help(int exitcode) {
             "  -W sqlite-compact        Reclaim metadata database unused space and exit.\n\n"
 #ifdef ENABLE_DBENGINE
             "  -W createdataset=N       Create a DB engine dataset of N seconds and exit.\n\n"
+            "  -W rebuildtier=N         Append to DB engine tier N the points it is missing,\n"
+            "                           aggregating them from tier 0, and exit.\n"
+            "                           Netdata must not be running.\n\n"
+            "  -W dbenginedump=DIR[,UUID[,AFTER,BEFORE]]\n"
+            "                           Print the metrics found in the DB engine\n"
+            "                           directory DIR, or the points of metric UUID\n"
+            "                           as CSV, reading the files without using the\n"
+            "                           page cache of netdata, and exit.\n"
+            "                           Netdata may be running.\n\n"
+            "  -W dbenginecompact=N     Rewrite the datafiles of DB engine tier N,\n"
+            "                           dropping the metrics that are not in the\n"
+            "                           metadata database, merging small extents\n"
+            "                           and compressing them with the configured\n"
+            "                           compression, and exit.\n"
+            "                           Fails when netdata is running.\n\n"
             "  -W stresstest=A,B,C,D,E,F,G\n"
             "                           Run a DB engine stress test for A seconds,\n"
             "                           with B writers and C readers, with a ramp up\n"
@@ -1322,6 +1339,9 @@ void post_conf_load(char **user)
 int buffer_unittest(void);
 int pgc_unittest(void);
 int mrg_unittest(void);
+int gorilla_unittest(void);
+int rle_unittest(void);
+int query_cache_unittest(void);
 int julytest(void);
 int pluginsd_parser_unittest(void);
 void replication_initialize(void);
@@ -1426,6 +1446,9 @@ int main(int argc, char **argv) {
 #ifdef ENABLE_DBENGINE
                         char* createdataset_string = "createdataset=";
                         char* stresstest_string = "stresstest=";
+                        char* rebuildtier_string = "rebuildtier=";
+                        char* dbenginedump_string = "dbenginedump=";
+                        char* dbenginecompact_string = "dbenginecompact=";
 #endif
                         if(strcmp(optarg, "sqlite-check") == 0) {
                             sql_init_database(DB_CHECK_INTEGRITY, 0);
@@ -1475,6 +1498,9 @@ int main(int argc, char **argv) {
                             if(unit_test_storage()) return 1;
 #ifdef ENABLE_DBENGINE
                             if(test_dbengine()) return 1;
+                            if(test_dbengine_aggregation()) return 1;
+                            if(test_dbengine_reader()) return 1;
+                            if(test_dbengine_compact()) return 1;
 #endif
                             if(test_sqlite()) return 1;
                             if(string_unittest(10000)) return 1;
@@ -1533,6 +1559,26 @@ int main(int argc, char **argv) {
                             unittest_running = true;
                             return mrg_unittest();
                         }
+                        else if(strcmp(optarg, "gorillatest") == 0) {
+                            unittest_running = true;
+                            return gorilla_unittest();
+                        }
+                        else if(strcmp(optarg, "rletest") == 0) {
+                            unittest_running = true;
+                            return rle_unittest();
+                        }
+                        else if(strcmp(optarg, "querycachetest") == 0) {
+                            unittest_running = true;
+                            return query_cache_unittest();
+                        }
+                        else if(strcmp(optarg, "staticfilestest") == 0) {
+                            unittest_running = true;
+                            return web_static_files_unittest();
+                        }
+                        else if(strcmp(optarg, "webclienttest") == 0) {
+                            unittest_running = true;
+                            return web_client_unittest();
+                        }
                         else if(strcmp(optarg, "julytest") == 0) {
                             unittest_running = true;
                             return julytest();
@@ -1551,6 +1597,83 @@ int main(int argc, char **argv) {
                             generate_dbengine_dataset(history_seconds);
                             return 0;
                         }
+                        else if(strncmp(optarg, rebuildtier_string, strlen(rebuildtier_string)) == 0) {
+                            optarg += strlen(rebuildtier_string);
+                            size_t tier = (size_t)strtoul(optarg, NULL, 0);
+
+                            if(!config_loaded) {
+                                fprintf(stderr, "warning: no configuration file has been loaded. Use -c CONFIG_FILE, before -W rebuildtier. Using default config.\n");
+                                load_netdata_conf(NULL, 0);
+                            }
+
+                            post_conf_load(&user);
+                            get_netdata_configured_variables();
+                            dbengine_init(netdata_configured_hostname);
+
+                            size_t rebuilt = rrdeng_tier_rebuild(tier);
+
+                            for (size_t t = 0; t < storage_tiers; t++)
+                                rrdeng_prepare_exit(multidb_ctx[t]);
+
+                            while (pgc_hot_and_dirty_entries(main_cache)) {
+                                pgc_flush_all_hot_and_dirty_pages(main_cache, PGC_SECTION_ALL);
+                                sleep_usec(100 * USEC_PER_MS);
+                            }
+
+                            for (size_t t = 0; t < storage_tiers; t++)
+                                rrdeng_exit(multidb_ctx[t]);
+
+                            fprintf(stderr, "%zu metrics rebuilt on tier %zu\n", rebuilt, tier);
+                            return rebuilt ? 0 : 1;
+                        }
+                        else if(strncmp(optarg, dbenginedump_string, strlen(dbenginedump_string)) == 0) {
+                            optarg += strlen(dbenginedump_string);
+
+                            char *path = strsep(&optarg, ",");
+                            char *uuid_str = strsep(&optarg, ",");
+                            char *after_str = strsep(&optarg, ",");
+                            char *before_str = strsep(&optarg, ",");
+                            if(!path || !*path || (after_str && !before_str)) {
+                                fprintf(stderr, "-W dbenginedump needs DIR, or DIR,UUID, or DIR,UUID,AFTER,BEFORE\n");
+                                return 1;
+                            }
+
+                            time_t after_s = after_str ? (time_t)str2ll(after_str, NULL) : 0;
+                            time_t before_s = before_str ? (time_t)str2ll(before_str, NULL) : 0;
+                            return rrdeng_reader_dump(path, uuid_str, after_s, before_s);
+                        }
+                        else if(strncmp(optarg, dbenginecompact_string, strlen(dbenginecompact_string)) == 0) {
+                            optarg += strlen(dbenginecompact_string);
+                            size_t tier = (size_t)strtoul(optarg, NULL, 0);
+
+                            if(!config_loaded) {
+                                fprintf(stderr, "warning: no configuration file has been loaded. Use -c CONFIG_FILE, before -W dbenginecompact. Using default config.\n");
+                                load_netdata_conf(NULL, 0);
+                            }
+
+                            post_conf_load(&user);
+                            get_netdata_configured_variables();
+
+                            if(tier >= RRD_STORAGE_TIERS) {
+                                fprintf(stderr, "-W dbenginecompact needs a tier between 0 and %d\n", RRD_STORAGE_TIERS - 1);
+                                return 1;
+                            }
+                            dbengine_tier_compression_init(netdata_configured_hostname, tier);
+
+                            // without a metadata database all metrics would look dead
+                            char filename[FILENAME_MAX + 1];
+                            snprintfz(filename, FILENAME_MAX, "%s/netdata-meta.db", netdata_configured_cache_dir);
+                            bool drop_dead_metrics = access(filename, R_OK) == 0 && sql_init_database(DB_CHECK_NONE, 0) == 0;
+                            if(!drop_dead_metrics)
+                                fprintf(stderr, "warning: the metadata database '%s' cannot be used, all metrics will be kept.\n", filename);
+
+                            int ret = rrdeng_compact_tier(tier, drop_dead_metrics);
+
+                            if(drop_dead_metrics)
+                                sql_close_database();
+
+                            return ret;
+                        }
                         else if(strncmp(optarg, stresstest_string, strlen(stresstest_string)) == 0) {
                             char *endptr;
                             unsigned test_duration_sec = 0, dset_charts = 0, query_threads = 0, ramp_up_seconds = 0,
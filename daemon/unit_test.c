@@ -393,8 +393,60 @@ static int check_storage_number_exists() {
     return 0;
 }
 
+static int check_storage_number_arrays(void) {
+    const size_t entries = 10000;
+    NETDATA_DOUBLE *values = mallocz(entries * sizeof(NETDATA_DOUBLE));
+    NETDATA_DOUBLE *unpacked = mallocz(entries * sizeof(NETDATA_DOUBLE));
+    storage_number *packed = mallocz(entries * sizeof(storage_number));
+    int errors = 0;
+
+    NETDATA_DOUBLE special[] = { 0.0, -0.0, NAN, INFINITY, -INFINITY, DBL_MIN / 2, DBL_MAX, -DBL_MAX, 1e-10, -1e-10,
+                                 (NETDATA_DOUBLE)0x00ffffff, (NETDATA_DOUBLE)0x01000000, (NETDATA_DOUBLE)0x0019999e, 1.677721549e14 };
+
+    for(size_t i = 0; i < entries ;i++) {
+        if(i < sizeof(special) / sizeof(special[0]))
+            values[i] = special[i];
+        else
+            values[i] = (NETDATA_DOUBLE)(random() - RAND_MAX / 2) / (NETDATA_DOUBLE)(random() % 100000 + 1) * powndd(10, (NETDATA_DOUBLE)(random() % 20));
+    }
+
+    const char *implementations[] = { "scalar", "sse4.1", "avx2", "neon", NULL };
+    for(size_t impl = 0; implementations[impl] ;impl++) {
+        if(!storage_number_array_set_implementation(implementations[impl]))
+            continue;
+
+        // odd sizes test the remainder of the vectors
+        pack_storage_number_array(packed, values, entries - 3, SN_DEFAULT_FLAGS);
+        packed[entries - 3] = packed[entries - 2] = packed[entries - 1] = SN_EMPTY_SLOT;
+        unpack_storage_number_array(unpacked, packed, entries - 1);
+
+        for(size_t i = 0; i < entries - 3 ;i++) {
+            storage_number s = pack_storage_number(values[i], SN_DEFAULT_FLAGS);
+            NETDATA_DOUBLE d = unpack_storage_number(s);
+
+            if(packed[i] != s || memcmp(&unpacked[i], &d, sizeof(d)) != 0) {
+                fprintf(stderr, "STORAGE NUMBER ARRAYS: '%s' packs " NETDATA_DOUBLE_FORMAT " to 0x%08x (" NETDATA_DOUBLE_FORMAT "), "
+                                "expected 0x%08x (" NETDATA_DOUBLE_FORMAT ")\n",
+                        implementations[impl], values[i], packed[i], unpacked[i], s, d);
+                errors++;
+                break;
+            }
+        }
+
+        fprintf(stderr, "STORAGE NUMBER ARRAYS: '%s' %s\n", implementations[impl], errors ? "FAILED" : "OK");
+    }
+
+    storage_number_array_set_implementation("auto");
+
+    freez(values);
+    freez(unpacked);
+    freez(packed);
+    return errors;
+}
+
 int unit_test_storage() {
     if(check_storage_number_exists()) return 0;
+    if(check_storage_number_arrays()) return 1;
 
     NETDATA_DOUBLE storage_number_positive_min = unpack_storage_number(STORAGE_NUMBER_POSITIVE_MIN_RAW);
     NETDATA_DOUBLE storage_number_negative_max = unpack_storage_number(STORAGE_NUMBER_NEGATIVE_MAX_RAW);
@@ -2111,6 +2163,308 @@ static int test_dbengine_check_rrdr(RRDSET *st[CHARTS], RRDDIM *rd[CHARTS][DIMS]
     return errors + value_errors + time_errors;
 }
 
+static bool test_dbengine_query_flush_callback(BUFFER *wb __maybe_unused, void *data __maybe_unused) {
+    // the output is kept in wb, to be compared with the output of the query executed at once
+    return false;
+}
+
+static int test_dbengine_query_output(RRDSET *st, time_t after, time_t before, size_t points,
+                                      DATASOURCE_FORMAT format, RRDR_OPTIONS options, BUFFER *wb, time_t *latest_timestamp)
+{
+    QUERY_TARGET_REQUEST qtr = {
+            .version = 1,
+            .st = st,
+            .after = after,
+            .before = before,
+            .points = points,
+            .format = format,
+            .options = options,
+            .time_group_method = RRDR_GROUPING_AVERAGE,
+            .query_source = QUERY_SOURCE_UNITTEST,
+            .priority = STORAGE_PRIORITY_NORMAL,
+            .flush_callback = test_dbengine_query_flush_callback,
+            .flush_callback_data = NULL,
+    };
+
+    QUERY_TARGET *qt = query_target_create(&qtr);
+    if(!qt)
+        return HTTP_RESP_INTERNAL_SERVER_ERROR;
+
+    ONEWAYALLOC *owa = onewayalloc_create(0);
+    int ret = data_query_execute(owa, wb, qt, latest_timestamp);
+    query_target_release(qt);
+    onewayalloc_destroy(owa);
+
+    return ret;
+}
+
+// Check the output of queries executed in slices is the same as the output of the query executed at once
+static int test_dbengine_check_sliced_queries(RRDSET *st, time_t time_start, time_t time_end)
+{
+    fprintf(stderr, "%s() running...\n", __FUNCTION__ );
+    struct {
+        DATASOURCE_FORMAT format;
+        RRDR_OPTIONS options;
+    } tests[] = {
+            { DATASOURCE_CSV,       0 },
+            { DATASOURCE_CSV,       RRDR_OPTION_REVERSED | RRDR_OPTION_SECONDS },
+            { DATASOURCE_TSV,       RRDR_OPTION_LABEL_QUOTES },
+            { DATASOURCE_SSV,       0 },
+            { DATASOURCE_SSV_COMMA, RRDR_OPTION_REVERSED },
+            { DATASOURCE_JSON,      0 },
+            { DATASOURCE_JSON,      RRDR_OPTION_REVERSED | RRDR_OPTION_OBJECTSROWS | RRDR_OPTION_MILLISECONDS },
+            { DATASOURCE_JS_ARRAY,  RRDR_OPTION_SECONDS },
+    };
+
+    // slices of 130 points, so that the last slice has fewer points than the others
+    size_t points = 1000;
+    time_t after = time_start + 1;
+    time_t before = after + (time_t)points * 2 - 1;
+    if(before > time_end)
+        before = time_end;
+
+    size_t slice_cells = data_query_slice_cells;
+    int errors = 0;
+
+    for(size_t i = 0; i < sizeof(tests) / sizeof(tests[0]) ; i++) {
+        BUFFER *whole = buffer_create(0, NULL);
+        BUFFER *sliced = buffer_create(0, NULL);
+        time_t whole_latest = 0, sliced_latest = 0;
+
+        data_query_slice_cells = 0;
+        int whole_ret = test_dbengine_query_output(st, after, before, points, tests[i].format, tests[i].options, whole, &whole_latest);
+
+        data_query_slice_cells = 130 * rrdset_number_of_dimensions(st);
+        int sliced_ret = test_dbengine_query_output(st, after, before, points, tests[i].format, tests[i].options, sliced, &sliced_latest);
+
+        if(whole_ret != HTTP_RESP_OK || sliced_ret != HTTP_RESP_OK) {
+            fprintf(stderr, "    DB-engine unittest %s: format %s, options 0x%x, the queries returned %d (at once) and %d (sliced) ### E R R O R ###\n",
+                    rrdset_name(st), rrdr_format_to_string(tests[i].format), (unsigned)tests[i].options, whole_ret, sliced_ret);
+            errors++;
+        }
+        else if(buffer_strlen(whole) != buffer_strlen(sliced) || strcmp(buffer_tostring(whole), buffer_tostring(sliced)) != 0) {
+            const char *a = buffer_tostring(whole), *b = buffer_tostring(sliced);
+            size_t pos = 0;
+            while(a[pos] && a[pos] == b[pos]) pos++;
+
+            fprintf(stderr, "    DB-engine unittest %s: format %s, options 0x%x, the sliced output (%zu bytes) differs from the output at once (%zu bytes) at byte %zu ### E R R O R ###\n",
+                    rrdset_name(st), rrdr_format_to_string(tests[i].format), (unsigned)tests[i].options,
+                    buffer_strlen(sliced), buffer_strlen(whole), pos);
+            errors++;
+        }
+        else if(whole_latest != sliced_latest) {
+            fprintf(stderr, "    DB-engine unittest %s: format %s, options 0x%x, the latest timestamp is %lld sliced, %lld at once ### E R R O R ###\n",
+                    rrdset_name(st), rrdr_format_to_string(tests[i].format), (unsigned)tests[i].options,
+                    (long long)sliced_latest, (long long)whole_latest);
+            errors++;
+        }
+
+        buffer_free(whole);
+        buffer_free(sliced);
+    }
+
+    data_query_slice_cells = slice_cells;
+    return errors;
+}
+
+// the parts of an RRDR compared between the serial and the parallel execution of a query
+struct test_dbengine_rrdr_copy {
+    size_t d, rows;
+    struct rrdr_view view;
+    RRDR_DIMENSION_FLAGS *od;
+    time_t *t;
+    NETDATA_DOUBLE *v;
+    RRDR_VALUE_FLAGS *o;
+    NETDATA_DOUBLE *ar;
+    uint32_t *gbc;
+};
+
+static void test_dbengine_rrdr_copy(struct test_dbengine_rrdr_copy *c, RRDR *r) {
+    c->d = r->d;
+    c->rows = rrdr_rows(r);
+    c->view = r->view;
+    c->od = mallocz(c->d * sizeof(*c->od));
+    memcpy(c->od, r->od, c->d * sizeof(*c->od));
+    c->t = mallocz(c->rows * sizeof(*c->t));
+    memcpy(c->t, r->t, c->rows * sizeof(*c->t));
+    c->v = mallocz(c->rows * c->d * sizeof(*c->v));
+    memcpy(c->v, r->v, c->rows * c->d * sizeof(*c->v));
+    c->o = mallocz(c->rows * c->d * sizeof(*c->o));
+    memcpy(c->o, r->o, c->rows * c->d * sizeof(*c->o));
+    c->ar = mallocz(c->rows * c->d * sizeof(*c->ar));
+    memcpy(c->ar, r->ar, c->rows * c->d * sizeof(*c->ar));
+    c->gbc = NULL;
+    if(r->gbc) {
+        c->gbc = mallocz(c->rows * c->d * sizeof(*c->gbc));
+        memcpy(c->gbc, r->gbc, c->rows * c->d * sizeof(*c->gbc));
+    }
+}
+
+static void test_dbengine_rrdr_copy_free(struct test_dbengine_rrdr_copy *c) {
+    freez(c->od);
+    freez(c->t);
+    freez(c->v);
+    freez(c->o);
+    freez(c->ar);
+    freez(c->gbc);
+}
+
+// the metrics are merged in the order the threads complete them, so the sums of group by may differ in their last bits
+static inline bool test_dbengine_same_value(NETDATA_DOUBLE a, NETDATA_DOUBLE b, bool exact) {
+    if(isnan(a) || isnan(b))
+        return isnan(a) && isnan(b);
+
+    if(exact)
+        return a == b;
+
+    return fabsndd(a - b) <= fabsndd(a) * 1e-9;
+}
+
+static int test_dbengine_rrdr_compare(struct test_dbengine_rrdr_copy *c, RRDR *r, const char *name, bool exact) {
+    if(c->d != r->d || c->rows != rrdr_rows(r)) {
+        fprintf(stderr, "    DB-engine unittest %s: the serial query has %zu dimensions x %zu rows, the parallel %zu x %zu ### E R R O R ###\n",
+                name, c->d, c->rows, r->d, rrdr_rows(r));
+        return 1;
+    }
+
+    if(c->view.after != r->view.after || c->view.before != r->view.before || c->view.flags != r->view.flags ||
+       c->view.options != r->view.options || !test_dbengine_same_value(c->view.min, r->view.min, exact) ||
+       !test_dbengine_same_value(c->view.max, r->view.max, exact)) {
+        fprintf(stderr, "    DB-engine unittest %s: the view of the parallel query differs (after %lld/%lld, before %lld/%lld, "
+                        "flags 0x%x/0x%x, options 0x%x/0x%x, min " NETDATA_DOUBLE_FORMAT "/" NETDATA_DOUBLE_FORMAT
+                        ", max " NETDATA_DOUBLE_FORMAT "/" NETDATA_DOUBLE_FORMAT ") ### E R R O R ###\n",
+                name, (long long)c->view.after, (long long)r->view.after, (long long)c->view.before, (long long)r->view.before,
+                (unsigned)c->view.flags, (unsigned)r->view.flags, (unsigned)c->view.options, (unsigned)r->view.options,
+                c->view.min, r->view.min, c->view.max, r->view.max);
+        return 1;
+    }
+
+    int errors = 0;
+    for(size_t d = 0; d < c->d ; d++) {
+        if(c->od[d] != r->od[d]) {
+            if(!errors)
+                fprintf(stderr, "    DB-engine unittest %s: dimension %zu has options 0x%x serially, 0x%x in parallel ### E R R O R ###\n",
+                        name, d, (unsigned)c->od[d], (unsigned)r->od[d]);
+            errors++;
+        }
+    }
+
+    for(size_t i = 0; i < c->rows ; i++) {
+        if(c->t[i] != r->t[i]) {
+            if(!errors)
+                fprintf(stderr, "    DB-engine unittest %s: row %zu has timestamp %lld serially, %lld in parallel ### E R R O R ###\n",
+                        name, i, (long long)c->t[i], (long long)r->t[i]);
+            errors++;
+        }
+
+        for(size_t d = 0; d < c->d ; d++) {
+            size_t idx = i * c->d + d;
+            if(c->o[idx] != r->o[idx] || !test_dbengine_same_value(c->v[idx], r->v[idx], exact) ||
+               !test_dbengine_same_value(c->ar[idx], r->ar[idx], exact) ||
+               (c->gbc && (!r->gbc || c->gbc[idx] != r->gbc[idx]))) {
+                if(!errors)
+                    fprintf(stderr, "    DB-engine unittest %s: row %zu, dimension %zu has value " NETDATA_DOUBLE_FORMAT
+                                    " (flags 0x%x) serially, " NETDATA_DOUBLE_FORMAT " (flags 0x%x) in parallel ### E R R O R ###\n",
+                            name, i, d, c->v[idx], (unsigned)c->o[idx], r->v[idx], (unsigned)r->o[idx]);
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+static RRDR *test_dbengine_wide_query(ONEWAYALLOC *owa, RRDHOST *host, time_t after, time_t before, size_t points,
+                                      RRDR_TIME_GROUPING time_group, RRDR_GROUP_BY group_by,
+                                      RRDR_GROUP_BY_FUNCTION aggregation, RRDR_OPTIONS options)
+{
+    QUERY_TARGET_REQUEST qtr = {
+            .version = 1,
+            .host = host,
+            .contexts = "netdata.dbengine-chart-*",
+            .after = after,
+            .before = before,
+            .points = points,
+            .options = options,
+            .time_group_method = time_group,
+            .group_by = group_by,
+            .group_by_aggregate_function = aggregation,
+            .query_source = QUERY_SOURCE_UNITTEST,
+            .priority = STORAGE_PRIORITY_NORMAL,
+    };
+
+    return rrd2rrdr(owa, query_target_create(&qtr));
+}
+
+// Check wide queries give the same result when executed serially and by parallel threads
+static int test_dbengine_check_parallel_queries(RRDHOST *host, time_t time_start, time_t time_end)
+{
+    fprintf(stderr, "%s() running...\n", __FUNCTION__ );
+    struct {
+        RRDR_TIME_GROUPING time_group;
+        RRDR_GROUP_BY group_by;
+        RRDR_GROUP_BY_FUNCTION aggregation;
+        RRDR_OPTIONS options;
+    } tests[] = {
+            { RRDR_GROUPING_AVERAGE, RRDR_GROUP_BY_NONE,      RRDR_GROUP_BY_FUNCTION_AVERAGE, 0 },
+            { RRDR_GROUPING_MAX,     RRDR_GROUP_BY_NONE,      RRDR_GROUP_BY_FUNCTION_AVERAGE, RRDR_OPTION_ABSOLUTE },
+            { RRDR_GROUPING_AVERAGE, RRDR_GROUP_BY_SELECTED,  RRDR_GROUP_BY_FUNCTION_SUM,     0 },
+            { RRDR_GROUPING_MIN,     RRDR_GROUP_BY_DIMENSION, RRDR_GROUP_BY_FUNCTION_AVERAGE, 0 },
+            { RRDR_GROUPING_SUM,     RRDR_GROUP_BY_DIMENSION, RRDR_GROUP_BY_FUNCTION_MAX,     0 },
+            { RRDR_GROUPING_AVERAGE, RRDR_GROUP_BY_INSTANCE,  RRDR_GROUP_BY_FUNCTION_MIN,     RRDR_OPTION_ABSOLUTE },
+            { RRDR_GROUPING_MEDIAN,  RRDR_GROUP_BY_INSTANCE,  RRDR_GROUP_BY_FUNCTION_SUM,     0 },
+    };
+
+    rrd2rrdr_parallel_init();
+    size_t parallel_threads = rrd2rrdr_parallel_threads;
+    size_t points = 1000;
+    int errors = 0;
+
+    for(size_t i = 0; i < sizeof(tests) / sizeof(tests[0]) ; i++) {
+        char name[200];
+        snprintfz(name, sizeof(name) - 1, "wide query %s, group by %s, aggregation %s, options 0x%x",
+                  time_grouping_tostring(tests[i].time_group),
+                  tests[i].group_by == RRDR_GROUP_BY_NONE ? "none" : tests[i].group_by == RRDR_GROUP_BY_SELECTED ? "selected" :
+                  tests[i].group_by == RRDR_GROUP_BY_DIMENSION ? "dimension" : "instance",
+                  group_by_aggregate_function_to_string(tests[i].aggregation), (unsigned)tests[i].options);
+
+        struct test_dbengine_rrdr_copy serial;
+
+        rrd2rrdr_parallel_threads = 0;
+        ONEWAYALLOC *owa = onewayalloc_create(0);
+        RRDR *r = test_dbengine_wide_query(owa, host, time_start, time_end, points, tests[i].time_group,
+                                           tests[i].group_by, tests[i].aggregation, tests[i].options);
+        if(!r || !rrdr_rows(r)) {
+            fprintf(stderr, "    DB-engine unittest %s: empty RRDR ### E R R O R ###\n", name);
+            if(r) rrdr_free(owa, r);
+            onewayalloc_destroy(owa);
+            errors++;
+            continue;
+        }
+        test_dbengine_rrdr_copy(&serial, r);
+        rrdr_free(owa, r);
+        onewayalloc_destroy(owa);
+
+        rrd2rrdr_parallel_threads = 4;
+        owa = onewayalloc_create(0);
+        r = test_dbengine_wide_query(owa, host, time_start, time_end, points, tests[i].time_group,
+                                     tests[i].group_by, tests[i].aggregation, tests[i].options);
+        if(!r) {
+            fprintf(stderr, "    DB-engine unittest %s: empty parallel RRDR ### E R R O R ###\n", name);
+            errors++;
+        }
+        else {
+            errors += test_dbengine_rrdr_compare(&serial, r, name, tests[i].group_by == RRDR_GROUP_BY_NONE) ? 1 : 0;
+            rrdr_free(owa, r);
+        }
+        onewayalloc_destroy(owa);
+        test_dbengine_rrdr_copy_free(&serial);
+    }
+
+    rrd2rrdr_parallel_threads = parallel_threads;
+    return errors;
+}
+
 int test_dbengine(void)
 {
     fprintf(stderr, "%s() running...\n", __FUNCTION__ );
@@ -2236,6 +2590,9 @@ int test_dbengine(void)
         onewayalloc_destroy(owa);
     }
 
+    errors += test_dbengine_check_sliced_queries(st[0], time_start[REGIONS - 1], time_end[REGIONS - 1]);
+    errors += test_dbengine_check_parallel_queries(host, time_start[0] + 1, time_end[REGIONS - 1]);
+
     rrd_wrlock();
     rrdeng_prepare_exit((struct rrdengine_instance *)host->db[0].instance);
     rrdhost_delete_charts(host);
@@ -2245,6 +2602,905 @@ int test_dbengine(void)
     return errors + value_errors + time_errors;
 }
 
+// ----------------------------------------------------------------------------
+// dbengine instances with files of their own, to test what is stored on disk
+
+#define DBENGINE_FILES_METRICS 4
+#define DBENGINE_FILES_BATCHES 3
+#define DBENGINE_FILES_BATCH_POINTS 7200
+#define DBENGINE_FILES_MAX_POINTS 128
+
+struct test_dbengine_files {
+    char path[FILENAME_MAX + 1];
+    size_t tier;
+    bool gorilla;
+    struct rrdengine_instance *ctx;
+
+    time_t first_time_s;            // the time of the first point written
+    time_t last_time_s;             // the time of the last point written
+};
+
+static void test_dbengine_files_uuid(size_t m, uuid_t *uuid) {
+    char id[20];
+    snprintfz(id, 19, "dim%zu", m);
+    rrdeng_generate_legacy_uuid(id, "unittest.files", uuid);
+}
+
+// the value of metric m at time t, NAN when the metric is not collected at t
+static NETDATA_DOUBLE test_dbengine_files_value(size_t m, time_t t) {
+    switch(m) {
+        case 0:
+            // the same value - one RLE run per page
+            return 42;
+
+        case 1:
+            // a new value every 100 points - RLE pages with many runs
+            return (NETDATA_DOUBLE)((t / 100) % 7);
+
+        case 2:
+            // a new value on every point - these pages are not RLE encoded
+            return (NETDATA_DOUBLE)((t * 7919) % 1000);
+
+        default:
+            // a small gap (filled with empty slots) and a big one (a new page starts after it)
+            if((t % 3600) >= 1000 && (t % 3600) < 1010)
+                return NAN;
+
+            if((t % 3600) >= 2000 && (t % 3600) < 3100)
+                return NAN;
+
+            return (NETDATA_DOUBLE)(t % 500);
+    }
+}
+
+static bool test_dbengine_files_open(struct test_dbengine_files *f) {
+    if(rrdeng_init(&f->ctx, f->path, 0, f->tier)) {
+        fprintf(stderr, "    DB-engine unittest %s: cannot open a dbengine instance at '%s' ### E R R O R ###\n",
+                __FUNCTION__, f->path);
+        return false;
+    }
+
+    if(f->gorilla)
+        f->ctx->config.page_type = PAGE_GORILLA_METRICS;
+
+    return true;
+}
+
+static void test_dbengine_files_close(struct test_dbengine_files *f) {
+    if(!f->ctx)
+        return;
+
+    Word_t section = (Word_t)f->ctx;
+
+    // the next instance may get the same address, so its pages, extents
+    // and metrics must not be found in the caches and the registry
+    pgc_flush_all_hot_and_dirty_pages(main_cache, section);
+    pgc_evict_clean_pages_of_section(main_cache, section);
+    pgc_evict_clean_pages_of_section(extent_cache, section);
+
+    rrdeng_prepare_exit(f->ctx);
+    rrdeng_exit(f->ctx);
+    f->ctx = NULL;
+
+    for(size_t m = 0; m < DBENGINE_FILES_METRICS ;m++) {
+        uuid_t uuid;
+        test_dbengine_files_uuid(m, &uuid);
+        METRIC *metric = mrg_metric_get_and_acquire(main_mrg, &uuid, section);
+        if(metric)
+            mrg_metric_release_and_delete(main_mrg, metric);
+    }
+}
+
+static bool test_dbengine_files_create(struct test_dbengine_files *f, const char *name, size_t tier, bool gorilla) {
+    memset(f, 0, sizeof(*f));
+    snprintfz(f->path, FILENAME_MAX, "/tmp/netdata-unittest-%s-XXXXXX", name);
+    if(!mkdtemp(f->path)) {
+        fprintf(stderr, "    DB-engine unittest %s: cannot create directory '%s' ### E R R O R ###\n",
+                __FUNCTION__, f->path);
+        return false;
+    }
+
+    f->tier = tier;
+    f->gorilla = gorilla;
+    return test_dbengine_files_open(f);
+}
+
+static void test_dbengine_files_remove(struct test_dbengine_files *f) {
+    test_dbengine_files_close(f);
+
+    DIR *dir = opendir(f->path);
+    if(dir) {
+        struct dirent *de;
+        while((de = readdir(dir))) {
+            if(!strcmp(de->d_name, ".") || !strcmp(de->d_name, ".."))
+                continue;
+
+            char filename[FILENAME_MAX + 1];
+            snprintfz(filename, FILENAME_MAX, "%s/%s", f->path, de->d_name);
+            unlink(filename);
+        }
+        closedir(dir);
+    }
+    rmdir(f->path);
+}
+
+static METRIC *test_dbengine_files_metric(struct rrdengine_instance *ctx, size_t m) {
+    uuid_t uuid;
+    test_dbengine_files_uuid(m, &uuid);
+
+    METRIC *metric = mrg_metric_get_and_acquire(main_mrg, &uuid, (Word_t)ctx);
+    if(!metric) {
+        MRG_ENTRY entry = {
+                .section = (Word_t)ctx,
+                .first_time_s = 0,
+                .last_time_s = 0,
+                .latest_update_every_s = 0,
+        };
+        uuid_copy(entry.uuid, uuid);
+        metric = mrg_metric_add_and_acquire(main_mrg, entry, NULL);
+    }
+
+    return metric;
+}
+
+// writes the points in (after_s, before_s] and flushes them to disk
+static void test_dbengine_files_write(struct test_dbengine_files *f, time_t after_s, time_t before_s) {
+    uuid_t group_uuid;
+    uuid_clear(group_uuid);
+    STORAGE_METRICS_GROUP *smg = rrdeng_metrics_group_get((STORAGE_INSTANCE *)f->ctx, &group_uuid);
+
+    for(size_t m = 0; m < DBENGINE_FILES_METRICS ;m++) {
+        METRIC *metric = test_dbengine_files_metric(f->ctx, m);
+        STORAGE_COLLECT_HANDLE *handle = rrdeng_store_metric_init((STORAGE_METRIC_HANDLE *)metric, 1, smg);
+
+        for(time_t t = after_s + 1; t <= before_s ;t++) {
+            NETDATA_DOUBLE v = test_dbengine_files_value(m, t);
+            if(isnan(v))
+                continue;
+
+            // pages that are not full, to have page boundaries everywhere
+            if(t % 1800 == 0)
+                rrdeng_store_metric_flush_current_page(handle);
+
+            rrdeng_store_metric_next(handle, t * USEC_PER_SEC, v, v, v, 1, 0, SN_DEFAULT_FLAGS);
+        }
+
+        rrdeng_store_metric_finalize(handle);
+        mrg_metric_release(main_mrg, metric);
+    }
+
+    rrdeng_metrics_group_release((STORAGE_INSTANCE *)f->ctx, smg);
+    pgc_flush_all_hot_and_dirty_pages(main_cache, (Word_t)f->ctx);
+
+    if(!f->first_time_s)
+        f->first_time_s = after_s + 1;
+
+    f->last_time_s = before_s;
+}
+
+// writes each batch of points to its own datafile and reopens the instance,
+// so that all the datafiles with data are indexed by journal v2 files
+static bool test_dbengine_files_generate(struct test_dbengine_files *f, time_t start_time_s) {
+    for(size_t b = 0; b < DBENGINE_FILES_BATCHES ;b++) {
+        time_t after_s = start_time_s + (time_t)(b * DBENGINE_FILES_BATCH_POINTS);
+        test_dbengine_files_write(f, after_s, after_s + DBENGINE_FILES_BATCH_POINTS);
+
+        if(create_new_datafile_pair(f->ctx)) {
+            fprintf(stderr, "    DB-engine unittest %s: cannot create a new datafile at '%s' ### E R R O R ###\n",
+                    __FUNCTION__, f->path);
+            return false;
+        }
+    }
+
+    test_dbengine_files_close(f);
+    return test_dbengine_files_open(f);
+}
+
+// the start of the test data, aligned to the hour, so that all tier groups are complete
+static time_t test_dbengine_files_start_time(void) {
+    return (now_realtime_sec() / 3600 - 48) * 3600;
+}
+
+// ----------------------------------------------------------------------------
+// aggregation of tier 0 pages
+
+struct test_dbengine_groups {
+    size_t used;
+    size_t size;
+    STORAGE_POINT *points;
+};
+
+static STORAGE_POINT *test_dbengine_groups_get(struct test_dbengine_groups *g, time_t group_s, time_t start_time_s, time_t end_time_s) {
+    if(g->used && g->points[g->used - 1].start_time_s / group_s == start_time_s / group_s) {
+        STORAGE_POINT *p = &g->points[g->used - 1];
+        p->end_time_s = MAX(p->end_time_s, end_time_s);
+        return p;
+    }
+
+    if(g->used == g->size) {
+        g->size = g->size ? g->size * 2 : 1024;
+        g->points = reallocz(g->points, g->size * sizeof(STORAGE_POINT));
+    }
+
+    STORAGE_POINT *p = &g->points[g->used++];
+    storage_point_empty(*p, start_time_s, end_time_s);
+    return p;
+}
+
+// merges the point into its group, the way rrdeng_load_metric_next_aggregated() does
+static void test_dbengine_groups_add(struct test_dbengine_groups *g, time_t group_s, const STORAGE_POINT *sp) {
+    STORAGE_POINT *p = test_dbengine_groups_get(g, group_s, sp->start_time_s, sp->end_time_s);
+
+    if(storage_point_is_gap(*sp))
+        return;
+
+    if(storage_point_is_gap(*p)) {
+        p->sum = sp->sum;
+        p->min = sp->min;
+        p->max = sp->max;
+        p->count = sp->count;
+        p->anomaly_count = sp->anomaly_count;
+        p->flags = sp->flags;
+    }
+    else {
+        p->sum += sp->sum;
+        p->min = MIN(p->min, sp->min);
+        p->max = MAX(p->max, sp->max);
+        p->count += sp->count;
+        p->anomaly_count += sp->anomaly_count;
+        p->flags |= sp->flags;
+    }
+}
+
+static void test_dbengine_groups_by_point(struct test_dbengine_groups *g, METRIC *metric, time_t after_s, time_t before_s, time_t group_s) {
+    struct storage_engine_query_handle handle;
+    rrdeng_load_metric_init((STORAGE_METRIC_HANDLE *)metric, &handle, after_s, before_s, STORAGE_PRIORITY_HIGH);
+
+    while(!rrdeng_load_metric_is_finished(&handle)) {
+        STORAGE_POINT sp = rrdeng_load_metric_next(&handle);
+        test_dbengine_groups_add(g, group_s, &sp);
+    }
+
+    rrdeng_load_metric_finalize(&handle);
+}
+
+static void test_dbengine_groups_aggregated(struct test_dbengine_groups *g, METRIC *metric, time_t after_s, time_t before_s, time_t group_s, size_t max_points) {
+    STORAGE_POINT points[DBENGINE_FILES_MAX_POINTS];
+    struct storage_engine_query_handle handle;
+    rrdeng_load_metric_init((STORAGE_METRIC_HANDLE *)metric, &handle, after_s, before_s, STORAGE_PRIORITY_HIGH);
+
+    size_t used;
+    while(!rrdeng_load_metric_is_finished(&handle) &&
+          (used = rrdeng_load_metric_next_aggregated(&handle, group_s, points, max_points))) {
+        for(size_t i = 0; i < used ;i++)
+            test_dbengine_groups_add(g, group_s, &points[i]);
+    }
+
+    rrdeng_load_metric_finalize(&handle);
+}
+
+static int test_dbengine_groups_compare(const char *name, struct test_dbengine_groups *expected, struct test_dbengine_groups *found) {
+    if(expected->used != found->used) {
+        fprintf(stderr, "    DB-engine unittest %s: expected %zu groups, found %zu ### E R R O R ###\n",
+                name, expected->used, found->used);
+        return 1;
+    }
+
+    for(size_t i = 0; i < expected->used ;i++) {
+        STORAGE_POINT *e = &expected->points[i], *f = &found->points[i];
+
+        bool same = e->start_time_s == f->start_time_s && e->end_time_s == f->end_time_s &&
+                    storage_point_is_gap(*e) == storage_point_is_gap(*f);
+
+        if(same && !storage_point_is_gap(*e))
+            same = e->sum == f->sum && e->min == f->min && e->max == f->max && e->count == f->count &&
+                   e->anomaly_count == f->anomaly_count && e->flags == f->flags;
+
+        if(!same) {
+            fprintf(stderr, "    DB-engine unittest %s: group %zu, expected %ld - %ld, sum " NETDATA_DOUBLE_FORMAT ", count %zu,"
+                            " found %ld - %ld, sum " NETDATA_DOUBLE_FORMAT ", count %zu ### E R R O R ###\n",
+                    name, i, (long)e->start_time_s, (long)e->end_time_s, e->sum, e->count,
+                    (long)f->start_time_s, (long)f->end_time_s, f->sum, f->count);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_dbengine_aggregation_of_pages(struct test_dbengine_files *f) {
+    time_t group_sizes[] = { 1, 7, 60, 1000, 3600 };
+    size_t max_points[] = { DBENGINE_FILES_MAX_POINTS, 3, 1 };
+    int errors = 0;
+
+    for(size_t m = 0; m < DBENGINE_FILES_METRICS ;m++) {
+        METRIC *metric = test_dbengine_files_metric(f->ctx, m);
+
+        for(size_t gs = 0; gs < sizeof(group_sizes) / sizeof(group_sizes[0]) ;gs++) {
+            struct test_dbengine_groups expected = { 0 };
+            test_dbengine_groups_by_point(&expected, metric, f->first_time_s, f->last_time_s, group_sizes[gs]);
+
+            for(size_t mp = 0; mp < sizeof(max_points) / sizeof(max_points[0]) ;mp++) {
+                struct test_dbengine_groups found = { 0 };
+                test_dbengine_groups_aggregated(&found, metric, f->first_time_s, f->last_time_s, group_sizes[gs], max_points[mp]);
+
+                char name[100];
+                snprintfz(name, 99, "%s metric %zu, group %ld, max points %zu",
+                          f->gorilla ? "gorilla" : "raw/rle", m, (long)group_sizes[gs], max_points[mp]);
+                errors += test_dbengine_groups_compare(name, &expected, &found);
+                freez(found.points);
+            }
+
+            freez(expected.points);
+        }
+
+        mrg_metric_release(main_mrg, metric);
+    }
+
+    return errors;
+}
+
+// rebuilds tier 1 from the given tier 0 instance and compares it with the groups of tier 0
+static int test_dbengine_aggregation_rebuild(struct test_dbengine_files *src) {
+    struct test_dbengine_files dst;
+    if(!test_dbengine_files_create(&dst, "tier1", 1, false))
+        return 1;
+
+    int errors = 0;
+    struct rrdengine_instance *tier0_ctx = multidb_ctx[0], *tier1_ctx = multidb_ctx[1];
+    size_t tiers = storage_tiers;
+
+    multidb_ctx[0] = src->ctx;
+    multidb_ctx[1] = dst.ctx;
+    storage_tiers = 2;
+
+    time_t group_s = (time_t)get_tier_grouping(1);
+    size_t rebuilt = rrdeng_tier_rebuild(1);
+
+    multidb_ctx[0] = tier0_ctx;
+    multidb_ctx[1] = tier1_ctx;
+    storage_tiers = tiers;
+
+    if(rebuilt != DBENGINE_FILES_METRICS) {
+        fprintf(stderr, "    DB-engine unittest %s: rebuilt %zu metrics, expected %d ### E R R O R ###\n",
+                __FUNCTION__, rebuilt, DBENGINE_FILES_METRICS);
+        errors++;
+    }
+
+    for(size_t m = 0; m < DBENGINE_FILES_METRICS && !errors ;m++) {
+        METRIC *src_metric = test_dbengine_files_metric(src->ctx, m);
+        METRIC *dst_metric = test_dbengine_files_metric(dst.ctx, m);
+
+        struct test_dbengine_groups expected = { 0 };
+        test_dbengine_groups_by_point(&expected, src_metric, src->first_time_s, src->last_time_s, group_s);
+
+        time_t first_group = expected.points[0].start_time_s / group_s;
+        size_t stored = 0, matched = 0;
+
+        struct storage_engine_query_handle handle;
+        rrdeng_load_metric_init((STORAGE_METRIC_HANDLE *)dst_metric, &handle, src->first_time_s, src->last_time_s, STORAGE_PRIORITY_HIGH);
+        while(!rrdeng_load_metric_is_finished(&handle)) {
+            STORAGE_POINT sp = rrdeng_load_metric_next(&handle);
+            if(storage_point_is_gap(sp))
+                continue;
+
+            stored++;
+
+            // tier points are stored at the end of their group
+            time_t g = sp.end_time_s / group_s - 1 - first_group;
+            if(g < 0 || (size_t)g >= expected.used || storage_point_is_gap(expected.points[g]))
+                continue;
+
+            // tier pages keep the values as floats
+            STORAGE_POINT *e = &expected.points[g];
+            if(sp.sum == (NETDATA_DOUBLE)(float)e->sum && sp.min == (NETDATA_DOUBLE)(float)e->min &&
+               sp.max == (NETDATA_DOUBLE)(float)e->max && sp.count == MIN(e->count, UINT16_MAX) &&
+               sp.anomaly_count == MIN(e->anomaly_count, UINT16_MAX))
+                matched++;
+        }
+        rrdeng_load_metric_finalize(&handle);
+
+        size_t expected_groups = 0;
+        for(size_t i = 0; i < expected.used ;i++)
+            if(!storage_point_is_gap(expected.points[i]))
+                expected_groups++;
+
+        if(stored != expected_groups || matched != expected_groups) {
+            fprintf(stderr, "    DB-engine unittest %s: metric %zu, expected %zu tier 1 points, found %zu, %zu of them correct ### E R R O R ###\n",
+                    __FUNCTION__, m, expected_groups, stored, matched);
+            errors++;
+        }
+
+        freez(expected.points);
+        mrg_metric_release(main_mrg, dst_metric);
+        mrg_metric_release(main_mrg, src_metric);
+    }
+
+    test_dbengine_files_remove(&dst);
+    return errors;
+}
+
+int test_dbengine_aggregation(void) {
+    fprintf(stderr, "%s() running...\n", __FUNCTION__ );
+    int errors = 0;
+    time_t start_time_s = test_dbengine_files_start_time();
+
+    // raw pages are RLE encoded when they are written to disk
+    for(int gorilla = 0; gorilla <= 1 ;gorilla++) {
+        struct test_dbengine_files f;
+        if(!test_dbengine_files_create(&f, gorilla ? "gorilla" : "raw", 0, gorilla) ||
+           !test_dbengine_files_generate(&f, start_time_s)) {
+            test_dbengine_files_remove(&f);
+            return errors + 1;
+        }
+
+        errors += test_dbengine_aggregation_of_pages(&f);
+
+        if(!gorilla)
+            errors += test_dbengine_aggregation_rebuild(&f);
+
+        test_dbengine_files_remove(&f);
+    }
+
+    fprintf(stderr, "%s: %s\n", __FUNCTION__, errors ? "FAILED" : "OK");
+    return errors;
+}
+
+// ----------------------------------------------------------------------------
+// reading the files of a tier with the reader API
+
+static bool test_dbengine_files_metric_id(uuid_t *uuid, size_t *m) {
+    for(size_t i = 0; i < DBENGINE_FILES_METRICS ;i++) {
+        uuid_t u;
+        test_dbengine_files_uuid(i, &u);
+        if(!uuid_compare(u, *uuid)) {
+            *m = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+struct test_dbengine_reader_state {
+    struct test_dbengine_files *f;
+    size_t m;
+    time_t before_s;
+    time_t last_end_time_s;
+    size_t found;
+    size_t types[PAGE_TYPE_MAX + 1];
+    size_t errors;
+};
+
+static bool test_dbengine_reader_metric_cb(uuid_t *uuid, time_t first_time_s, time_t last_time_s, time_t update_every_s, void *data) {
+    struct test_dbengine_reader_state *s = data;
+    size_t m;
+
+    if(!test_dbengine_files_metric_id(uuid, &m) || first_time_s != s->f->first_time_s ||
+       last_time_s != s->f->last_time_s || update_every_s != 1) {
+        fprintf(stderr, "    DB-engine unittest %s: unexpected metric with retention %ld - %ld, every %ld ### E R R O R ###\n",
+                __FUNCTION__, (long)first_time_s, (long)last_time_s, (long)update_every_s);
+        s->errors++;
+    }
+    else
+        s->found++;
+
+    return true;
+}
+
+static bool test_dbengine_reader_points_cb(const STORAGE_POINT *points, size_t count, void *data) {
+    struct test_dbengine_reader_state *s = data;
+
+    for(size_t i = 0; i < count ;i++) {
+        const STORAGE_POINT *sp = &points[i];
+        NETDATA_DOUBLE v = test_dbengine_files_value(s->m, sp->end_time_s);
+
+        bool ok = sp->end_time_s > s->last_end_time_s && sp->end_time_s <= s->before_s &&
+                  sp->start_time_s == sp->end_time_s - 1;
+
+        // small gaps are stored as empty slots
+        if(storage_point_is_gap(*sp))
+            ok = ok && isnan(v);
+        else {
+            ok = ok && sp->sum == v && sp->min == v && sp->max == v && sp->count == 1 && !sp->anomaly_count;
+            s->found++;
+        }
+
+        if(!ok) {
+            if(!s->errors)
+                fprintf(stderr, "    DB-engine unittest %s: metric %zu at %ld, expected " NETDATA_DOUBLE_FORMAT
+                                ", found " NETDATA_DOUBLE_FORMAT " ### E R R O R ###\n",
+                        __FUNCTION__, s->m, (long)sp->end_time_s, v, sp->sum);
+            s->errors++;
+        }
+
+        s->last_end_time_s = sp->end_time_s;
+    }
+
+    return true;
+}
+
+static bool test_dbengine_reader_page_cb(const struct rrdeng_extent_page_descr *descr, const void *page __maybe_unused, void *data) {
+    struct test_dbengine_reader_state *s = data;
+    uuid_t uuid;
+    size_t m;
+
+    uuid_copy(uuid, descr->uuid);
+    time_t start_time_s = (time_t)(descr->start_time_ut / USEC_PER_SEC);
+    time_t end_time_s = (time_t)(descr->end_time_ut / USEC_PER_SEC);
+
+    if(!test_dbengine_files_metric_id(&uuid, &m) || descr->type > PAGE_TYPE_MAX || start_time_s > end_time_s ||
+       start_time_s < s->f->first_time_s || end_time_s > s->f->last_time_s) {
+        fprintf(stderr, "    DB-engine unittest %s: unexpected page of type %u, %ld - %ld ### E R R O R ###\n",
+                __FUNCTION__, (unsigned)descr->type, (long)start_time_s, (long)end_time_s);
+        s->errors++;
+    }
+    else
+        s->types[descr->type]++;
+
+    return true;
+}
+
+static int test_dbengine_reader_check_query(RRDENG_READER *rdr, struct test_dbengine_files *f, size_t m, time_t after_s, time_t before_s) {
+    struct test_dbengine_reader_state s = {
+            .f = f,
+            .m = m,
+            .before_s = before_s,
+            .last_end_time_s = after_s - 1,
+    };
+
+    uuid_t uuid;
+    test_dbengine_files_uuid(m, &uuid);
+    rrdeng_reader_query(rdr, &uuid, after_s, before_s, test_dbengine_reader_points_cb, &s);
+
+    size_t expected = 0;
+    for(time_t t = after_s; t <= before_s ;t++)
+        if(!isnan(test_dbengine_files_value(m, t)))
+            expected++;
+
+    if(s.errors || s.found != expected) {
+        fprintf(stderr, "    DB-engine unittest %s: metric %zu, %ld - %ld, expected %zu points, found %zu, %zu errors ### E R R O R ###\n",
+                __FUNCTION__, m, (long)after_s, (long)before_s, expected, s.found, s.errors);
+        return 1;
+    }
+
+    return 0;
+}
+
+static int test_dbengine_reader_check(struct test_dbengine_files *f) {
+    RRDENG_READER *rdr = rrdeng_reader_open(f->path);
+    if(!rdr) {
+        fprintf(stderr, "    DB-engine unittest %s: cannot open a reader at '%s' ### E R R O R ###\n", __FUNCTION__, f->path);
+        return 1;
+    }
+
+    int errors = 0;
+
+    // the datafile written last has no journal v2 file, so it is not visible
+    size_t files = rrdeng_reader_files(rdr);
+    if(files != DBENGINE_FILES_BATCHES) {
+        fprintf(stderr, "    DB-engine unittest %s: expected %d files, found %zu ### E R R O R ###\n",
+                __FUNCTION__, DBENGINE_FILES_BATCHES, files);
+        errors++;
+    }
+
+    for(size_t i = 0; i < files ;i++) {
+        unsigned tier, fileno;
+        rrdeng_reader_file(rdr, i, &tier, &fileno);
+        if(tier != 0 || fileno != i + 1) {
+            fprintf(stderr, "    DB-engine unittest %s: file %zu is tier %u, fileno %u ### E R R O R ###\n",
+                    __FUNCTION__, i, tier, fileno);
+            errors++;
+        }
+    }
+
+    time_t first_time_s, last_time_s;
+    rrdeng_reader_retention(rdr, &first_time_s, &last_time_s);
+    if(first_time_s != f->first_time_s || last_time_s != f->last_time_s) {
+        fprintf(stderr, "    DB-engine unittest %s: expected retention %ld - %ld, found %ld - %ld ### E R R O R ###\n",
+                __FUNCTION__, (long)f->first_time_s, (long)f->last_time_s, (long)first_time_s, (long)last_time_s);
+        errors++;
+    }
+
+    struct test_dbengine_reader_state metrics = { .f = f };
+    rrdeng_reader_foreach_metric(rdr, test_dbengine_reader_metric_cb, &metrics);
+    if(metrics.errors || metrics.found != DBENGINE_FILES_METRICS) {
+        fprintf(stderr, "    DB-engine unittest %s: expected %d metrics, found %zu ### E R R O R ###\n",
+                __FUNCTION__, DBENGINE_FILES_METRICS, metrics.found);
+        errors++;
+    }
+
+    for(size_t m = 0; m < DBENGINE_FILES_METRICS ;m++) {
+        // all the points, and a part of them crossing the boundary of the first two files
+        errors += test_dbengine_reader_check_query(rdr, f, m, f->first_time_s, f->last_time_s);
+        errors += test_dbengine_reader_check_query(rdr, f, m,
+                                                   f->first_time_s + DBENGINE_FILES_BATCH_POINTS - 1500,
+                                                   f->first_time_s + DBENGINE_FILES_BATCH_POINTS + 1500);
+    }
+
+    struct test_dbengine_reader_state pages = { .f = f };
+    for(size_t i = 0; i < files ;i++)
+        rrdeng_reader_foreach_page(rdr, i, test_dbengine_reader_page_cb, &pages);
+
+    // raw pages with repeated values are RLE encoded on disk
+    bool types_ok = f->gorilla ?
+            (pages.types[PAGE_GORILLA_METRICS] && !pages.types[PAGE_METRICS]) :
+            (pages.types[PAGE_METRICS] && pages.types[PAGE_RLE] && !pages.types[PAGE_GORILLA_METRICS]);
+
+    if(pages.errors || !types_ok) {
+        fprintf(stderr, "    DB-engine unittest %s: found %zu raw, %zu gorilla and %zu RLE pages ### E R R O R ###\n",
+                __FUNCTION__, pages.types[PAGE_METRICS], pages.types[PAGE_GORILLA_METRICS], pages.types[PAGE_RLE]);
+        errors++;
+    }
+
+    rrdeng_reader_close(rdr);
+    return errors;
+}
+
+int test_dbengine_reader(void) {
+    fprintf(stderr, "%s() running...\n", __FUNCTION__ );
+    int errors = 0;
+    time_t start_time_s = test_dbengine_files_start_time();
+
+    for(int gorilla = 0; gorilla <= 1 ;gorilla++) {
+        struct test_dbengine_files f;
+        if(!test_dbengine_files_create(&f, gorilla ? "reader-gorilla" : "reader-raw", 0, gorilla) ||
+           !test_dbengine_files_generate(&f, start_time_s)) {
+            test_dbengine_files_remove(&f);
+            return errors + 1;
+        }
+
+        // the reader works on the files, without the dbengine instance
+        test_dbengine_files_close(&f);
+        errors += test_dbengine_reader_check(&f);
+        test_dbengine_files_remove(&f);
+    }
+
+    fprintf(stderr, "%s: %s\n", __FUNCTION__, errors ? "FAILED" : "OK");
+    return errors;
+}
+
+// ----------------------------------------------------------------------------
+// offline compaction of the files of a tier
+
+// the metrics with odd ids are dropped by the compaction
+static bool test_dbengine_compact_metric_is_alive(uuid_t *uuid, void *data __maybe_unused) {
+    size_t m;
+    return test_dbengine_files_metric_id(uuid, &m) && !(m & 1);
+}
+
+static bool test_dbengine_compact_metric_cb(uuid_t *uuid, time_t first_time_s, time_t last_time_s, time_t update_every_s, void *data) {
+    struct test_dbengine_reader_state *s = data;
+
+    if(!test_dbengine_compact_metric_is_alive(uuid, NULL)) {
+        fprintf(stderr, "    DB-engine unittest %s: a dropped metric is still in the files ### E R R O R ###\n", __FUNCTION__);
+        s->errors++;
+        return true;
+    }
+
+    return test_dbengine_reader_metric_cb(uuid, first_time_s, last_time_s, update_every_s, data);
+}
+
+static bool test_dbengine_compact_page_cb(const struct rrdeng_extent_page_descr *descr, const void *page, void *data) {
+    struct test_dbengine_reader_state *s = data;
+    uuid_t uuid;
+
+    uuid_copy(uuid, descr->uuid);
+    if(!test_dbengine_compact_metric_is_alive(&uuid, NULL)) {
+        fprintf(stderr, "    DB-engine unittest %s: a page of a dropped metric is still in the files ### E R R O R ###\n", __FUNCTION__);
+        s->errors++;
+        return true;
+    }
+
+    return test_dbengine_reader_page_cb(descr, page, data);
+}
+
+// reads back all the files, expecting only the metrics that are alive
+static int test_dbengine_compact_check(struct test_dbengine_files *f) {
+    RRDENG_READER *rdr = rrdeng_reader_open(f->path);
+    if(!rdr) {
+        fprintf(stderr, "    DB-engine unittest %s: cannot open a reader at '%s' ### E R R O R ###\n", __FUNCTION__, f->path);
+        return 1;
+    }
+
+    int errors = 0;
+
+    size_t files = rrdeng_reader_files(rdr);
+    if(files != DBENGINE_FILES_BATCHES) {
+        fprintf(stderr, "    DB-engine unittest %s: expected %d files, found %zu ### E R R O R ###\n",
+                __FUNCTION__, DBENGINE_FILES_BATCHES, files);
+        errors++;
+    }
+
+    size_t alive = 0;
+    for(size_t m = 0; m < DBENGINE_FILES_METRICS ;m++) {
+        uuid_t uuid;
+        test_dbengine_files_uuid(m, &uuid);
+
+        if(test_dbengine_compact_metric_is_alive(&uuid, NULL)) {
+            errors += test_dbengine_reader_check_query(rdr, f, m, f->first_time_s, f->last_time_s);
+            alive++;
+            continue;
+        }
+
+        struct test_dbengine_reader_state s = { .f = f, .m = m, .before_s = f->last_time_s };
+        size_t points = rrdeng_reader_query(rdr, &uuid, f->first_time_s, f->last_time_s, test_dbengine_reader_points_cb, &s);
+        if(points) {
+            fprintf(stderr, "    DB-engine unittest %s: metric %zu has been dropped, but %zu of its points were found ### E R R O R ###\n",
+                    __FUNCTION__, m, points);
+            errors++;
+        }
+    }
+
+    struct test_dbengine_reader_state metrics = { .f = f };
+    rrdeng_reader_foreach_metric(rdr, test_dbengine_compact_metric_cb, &metrics);
+    if(metrics.errors || metrics.found != alive) {
+        fprintf(stderr, "    DB-engine unittest %s: expected %zu metrics, found %zu ### E R R O R ###\n",
+                __FUNCTION__, alive, metrics.found);
+        errors++;
+    }
+
+    struct test_dbengine_reader_state pages = { .f = f };
+    for(size_t i = 0; i < files ;i++)
+        rrdeng_reader_foreach_page(rdr, i, test_dbengine_compact_page_cb, &pages);
+
+    if(pages.errors) {
+        fprintf(stderr, "    DB-engine unittest %s: found %zu invalid pages ### E R R O R ###\n", __FUNCTION__, pages.errors);
+        errors++;
+    }
+
+    rrdeng_reader_close(rdr);
+    return errors;
+}
+
+static void test_dbengine_compact_filename(char *filename, struct test_dbengine_files *f, const char *prefix, const char *name, const char *extension, unsigned fileno) {
+    snprintfz(filename, FILENAME_MAX, "%s/%s%s" RRDENG_FILE_NUMBER_PRINT_TMPL "%s",
+              f->path, prefix, name, (unsigned)f->tier, fileno, extension);
+}
+
+static bool test_dbengine_compact_file_exists(const char *filename) {
+    struct stat st;
+    return stat(filename, &st) == 0;
+}
+
+static bool test_dbengine_compact_file_copy(const char *src, const char *dst) {
+    int in = open(src, O_RDONLY | O_CLOEXEC);
+    int out = open(dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0664);
+    bool ok = (in != -1 && out != -1);
+
+    char buffer[65536];
+    ssize_t bytes;
+    while(ok && (bytes = read(in, buffer, sizeof(buffer))) != 0)
+        ok = (bytes > 0 && write(out, buffer, (size_t)bytes) == bytes);
+
+    if(in != -1) close(in);
+    if(out != -1) close(out);
+
+    if(!ok)
+        fprintf(stderr, "    DB-engine unittest %s: cannot copy '%s' to '%s' ### E R R O R ###\n", __FUNCTION__, src, dst);
+
+    return ok;
+}
+
+static int test_dbengine_compact_recover(struct test_dbengine_files *f, const char *state) {
+    if(rrdeng_compact_recover(f->path) != 0) {
+        fprintf(stderr, "    DB-engine unittest %s: cannot recover a compaction interrupted %s ### E R R O R ###\n",
+                __FUNCTION__, state);
+        return 1;
+    }
+
+    DIR *dir = opendir(f->path);
+    if(!dir)
+        return 1;
+
+    int errors = 0;
+    struct dirent *de;
+    while((de = readdir(dir))) {
+        if(!strncmp(de->d_name, COMPACT_PREFIX, strlen(COMPACT_PREFIX))) {
+            fprintf(stderr, "    DB-engine unittest %s: file '%s' has been left behind, after a compaction interrupted %s ### E R R O R ###\n",
+                    __FUNCTION__, de->d_name, state);
+            errors++;
+        }
+    }
+    closedir(dir);
+
+    return errors;
+}
+
+int test_dbengine_compact(void) {
+    fprintf(stderr, "%s() running...\n", __FUNCTION__ );
+    int errors = 0;
+
+    struct test_dbengine_files f;
+    if(!test_dbengine_files_create(&f, "compact", 0, false) ||
+       !test_dbengine_files_generate(&f, test_dbengine_files_start_time())) {
+        test_dbengine_files_remove(&f);
+        return 1;
+    }
+
+    // the compaction does not run while the files are used
+    test_dbengine_files_close(&f);
+
+    // the files of the first datafile, used to simulate the interrupted compactions
+    char datafile[FILENAME_MAX + 1], journal_v1[FILENAME_MAX + 1], journal_v2[FILENAME_MAX + 1];
+    char new_datafile[FILENAME_MAX + 1], new_journal_v1[FILENAME_MAX + 1], old_journal_v1[FILENAME_MAX + 1];
+    char saved_datafile[FILENAME_MAX + 1], saved_journal_v1[FILENAME_MAX + 1];
+
+    test_dbengine_compact_filename(datafile, &f, "", DATAFILE_PREFIX, DATAFILE_EXTENSION, 1);
+    test_dbengine_compact_filename(journal_v1, &f, "", WALFILE_PREFIX, WALFILE_EXTENSION, 1);
+    test_dbengine_compact_filename(journal_v2, &f, "", WALFILE_PREFIX, WALFILE_EXTENSION_V2, 1);
+    test_dbengine_compact_filename(new_datafile, &f, COMPACT_PREFIX, DATAFILE_PREFIX, DATAFILE_EXTENSION, 1);
+    test_dbengine_compact_filename(new_journal_v1, &f, COMPACT_PREFIX, WALFILE_PREFIX, WALFILE_EXTENSION, 1);
+    test_dbengine_compact_filename(old_journal_v1, &f, COMPACT_OLD_PREFIX, WALFILE_PREFIX, WALFILE_EXTENSION, 1);
+    test_dbengine_compact_filename(saved_datafile, &f, "unittest-", DATAFILE_PREFIX, DATAFILE_EXTENSION, 1);
+    test_dbengine_compact_filename(saved_journal_v1, &f, "unittest-", WALFILE_PREFIX, WALFILE_EXTENSION, 1);
+
+    if(!test_dbengine_compact_file_copy(datafile, saved_datafile) ||
+       !test_dbengine_compact_file_copy(journal_v1, saved_journal_v1)) {
+        test_dbengine_files_remove(&f);
+        return 1;
+    }
+
+    struct rrdeng_compact_stats stats;
+    if(rrdeng_compact(f.path, tier_compression_algorithm[0], tier_compression_level[0],
+                      test_dbengine_compact_metric_is_alive, NULL, &stats) != 0 ||
+       stats.datafiles != DBENGINE_FILES_BATCHES || stats.datafiles_rewritten != DBENGINE_FILES_BATCHES ||
+       !stats.pages_dropped) {
+        fprintf(stderr, "    DB-engine unittest %s: compacted %zu of %zu datafiles, dropping %zu pages ### E R R O R ###\n",
+                __FUNCTION__, stats.datafiles_rewritten, stats.datafiles, stats.pages_dropped);
+        test_dbengine_files_remove(&f);
+        return 1;
+    }
+
+    // the new journal v1 files are indexed again by dbengine
+    if(!test_dbengine_files_open(&f)) {
+        test_dbengine_files_remove(&f);
+        return 1;
+    }
+    test_dbengine_files_close(&f);
+    errors += test_dbengine_compact_check(&f);
+
+    // interrupted before replacing any file - the new files are discarded
+    if(!test_dbengine_compact_file_copy(saved_datafile, new_datafile) ||
+       !test_dbengine_compact_file_copy(saved_journal_v1, new_journal_v1)) {
+        test_dbengine_files_remove(&f);
+        return errors + 1;
+    }
+
+    errors += test_dbengine_compact_recover(&f, "before replacing the files");
+    errors += test_dbengine_compact_check(&f);
+
+    // interrupted after replacing the journal, before replacing the datafile - the compaction is completed
+    if(!test_dbengine_compact_file_copy(datafile, new_datafile) ||
+       !test_dbengine_compact_file_copy(saved_datafile, datafile) ||
+       !test_dbengine_compact_file_copy(saved_journal_v1, old_journal_v1) ||
+       unlink(journal_v2) != 0) {
+        test_dbengine_files_remove(&f);
+        return errors + 1;
+    }
+
+    errors += test_dbengine_compact_recover(&f, "after replacing the journal");
+
+    if(!test_dbengine_compact_file_exists(datafile) || !test_dbengine_compact_file_exists(journal_v1) ||
+       test_dbengine_compact_file_exists(journal_v2)) {
+        fprintf(stderr, "    DB-engine unittest %s: the recovery left datafile %u incomplete ### E R R O R ###\n",
+                __FUNCTION__, 1);
+        errors++;
+    }
+
+    if(!test_dbengine_files_open(&f)) {
+        test_dbengine_files_remove(&f);
+        return errors + 1;
+    }
+    test_dbengine_files_close(&f);
+    errors += test_dbengine_compact_check(&f);
+
+    test_dbengine_files_remove(&f);
+
+    fprintf(stderr, "%s: %s\n", __FUNCTION__, errors ? "FAILED" : "OK");
+    return errors;
+}
+
 struct dbengine_chart_thread {
     uv_thread_t thread;
     RRDHOST *host;
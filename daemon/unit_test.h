@@ -15,6 +15,9 @@ int test_sqlite(void);
 int unit_test_bitmap256(void);
 #ifdef ENABLE_DBENGINE
 int test_dbengine(void);
+int test_dbengine_aggregation(void);
+int test_dbengine_reader(void);
+int test_dbengine_compact(void);
 void generate_dbengine_dataset(unsigned history_seconds);
 void dbengine_stress_test(unsigned TEST_DURATION_SEC, unsigned DSET_CHARTS, unsigned QUERY_THREADS,
                                  unsigned RAMP_UP_SECONDS, unsigned PAGE_CACHE_MB, unsigned DISK_SPACE_MB);
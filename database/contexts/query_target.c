@@ -704,6 +704,9 @@ static bool query_instance_add(QUERY_TARGET_LOCALS *qtl, QUERY_NODE *qn, QUERY_C
         return false;
     }
     else {
+        if(ri->rrdset)
+            qt->versions.backfills += __atomic_load_n(&ri->rrdset->backfills, __ATOMIC_RELAXED);
+
         if(metrics_added) {
             qc->instances.selected++;
             qn->instances.selected++;
@@ -1022,6 +1025,8 @@ QUERY_TARGET *query_target_create(QUERY_TARGET_REQUEST *qtr) {
         }
     }
 
+    qt->versions.backfills = 0;
+
     if(host) {
         // single host query
         qt->versions.contexts_hard_hash = dictionary_version(host->rrdctx.contexts);
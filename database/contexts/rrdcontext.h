@@ -259,6 +259,7 @@ typedef struct query_metric {
 #define MAX_QUERY_TARGET_ID_LENGTH 255
 
 typedef bool (*interrupt_callback_t)(void *data);
+typedef bool (*flush_callback_t)(BUFFER *wb, void *data);
 
 typedef struct query_target_request {
     size_t version;
@@ -308,6 +309,10 @@ typedef struct query_target_request {
 
     interrupt_callback_t interrupt_callback;
     void *interrupt_callback_data;
+
+    // large results are given to it while they are generated (it returns true when it took them)
+    flush_callback_t flush_callback;
+    void *flush_callback_data;
 } QUERY_TARGET_REQUEST;
 
 #define GROUP_BY_MAX_LABEL_KEYS 10
@@ -344,6 +349,12 @@ typedef struct query_target {
         NETDATA_DOUBLE resampling_divisor;
         RRDR_OPTIONS options;
         size_t tier;
+
+        struct {
+            time_t after;                   // the window of the whole query, when it is executed in slices
+            time_t before;                  // (after, before and points above are then the ones of the slice)
+            size_t points;                  // zero when the query is not sliced
+        } whole;
     } window;
 
     struct {
@@ -403,6 +414,7 @@ typedef struct query_target {
     struct {
         uint64_t contexts_hard_hash;
         uint64_t contexts_soft_hash;
+        uint64_t backfills;                 // the sum of the backfills of the instances queried
     } versions;
 
     struct {
@@ -114,8 +114,17 @@ struct pgc {
     struct pgc_index {
         netdata_rwlock_t rwlock;
         Pvoid_t sections_judy;
+        bool writer;                    // a writer is modifying this partition (lockless readers use the rwlock)
+        size_t sketch_additions;        // the sketch increments of the pages of this partition, since the last aging
+        PGC_CACHE_LINE_PADDING(0);
     } *index;
 
+    struct {
+        size_t slots;                   // the number of reader slots (threads beyond this share them)
+        size_t stride;                  // the bytes of each slot, a multiple of the cache line
+        uint8_t *counters;              // for each slot, the lockless readers of each partition
+    } index_readers;
+
     PGC_CACHE_LINE_PADDING(1);
 
     struct {
@@ -127,6 +136,17 @@ struct pgc {
 
     struct pgc_linked_list clean;       // LRU is applied here to free memory from the cache
 
+    struct {
+        PGC_EVICTION_POLICY policy;
+
+        struct {
+            uint8_t *counters;          // PGC_SKETCH_DEPTH rows of (mask + 1) counters
+            size_t mask;
+            size_t aging_period;        // the increments of each partition after which all counters are halved
+            bool aging_pending;         // a partition reached its aging period, the evictor has to halve the counters
+        } sketch;
+    } eviction;
+
     PGC_CACHE_LINE_PADDING(3);
 
     struct pgc_linked_list dirty;       // in the dirty list, pages are ordered the way they were marked dirty
@@ -221,19 +241,87 @@ static inline size_t pgc_indexing_partition(PGC *cache, Word_t metric_id) {
     return last_partition;
 }
 
-static inline void pgc_index_read_lock(PGC *cache, size_t partition) {
+// With PGC_OPTIONS_LOCKLESS_INDEX_READERS, index readers do not touch the
+// shared rwlock of the partition. Each thread increments a counter for the
+// partition in its reader slot and then checks that there is no writer.
+// Writers get the rwlock, raise the writer flag of the partition and wait for
+// its lockless readers to leave, so readers that find a writer fall back to
+// the rwlock.
+// JudyL arrays cannot be read while they are modified, so writers still have
+// to wait for the readers - but readers never wait for each other.
+//
+// There is one slot per CPU (at least 4) and threads get them round-robin,
+// in the order they first read the index. So while there are up to that many
+// reader threads, each one writes only to its own cache line. With more
+// reader threads, the slots are shared and the threads of the same slot
+// contend for its cache line (they still do not wait for each other).
+
+static inline size_t pgc_index_reader_slot(PGC *cache) {
+    static size_t threads = 0;
+    static __thread size_t thread_ordinal = 0;
+
+    if(unlikely(!thread_ordinal))
+        thread_ordinal = __atomic_add_fetch(&threads, 1, __ATOMIC_RELAXED);
+
+    return thread_ordinal % cache->index_readers.slots;
+}
+
+static inline uint32_t *pgc_index_reader_counter(PGC *cache, size_t slot, size_t partition) {
+    return &((uint32_t *)&cache->index_readers.counters[slot * cache->index_readers.stride])[partition];
+}
+
+// returns true when the index is read without the rwlock
+static inline bool pgc_index_read_lock(PGC *cache, size_t partition) {
+    if(likely(cache->index_readers.counters)) {
+        netdata_thread_disable_cancelability();
+
+        uint32_t *counter = pgc_index_reader_counter(cache, pgc_index_reader_slot(cache), partition);
+        __atomic_add_fetch(counter, 1, __ATOMIC_SEQ_CST);
+
+        if(likely(!__atomic_load_n(&cache->index[partition].writer, __ATOMIC_SEQ_CST)))
+            return true;
+
+        // there is a writer, wait for it at the rwlock
+        __atomic_sub_fetch(counter, 1, __ATOMIC_RELEASE);
+        netdata_thread_enable_cancelability();
+        __atomic_add_fetch(&cache->stats.index_readers_fallback, 1, __ATOMIC_RELAXED);
+    }
+
     netdata_rwlock_rdlock(&cache->index[partition].rwlock);
+    return false;
 }
-static inline void pgc_index_read_unlock(PGC *cache, size_t partition) {
-    netdata_rwlock_unlock(&cache->index[partition].rwlock);
+static inline void pgc_index_read_unlock(PGC *cache, size_t partition, bool lockless) {
+    if(likely(lockless)) {
+        __atomic_sub_fetch(pgc_index_reader_counter(cache, pgc_index_reader_slot(cache), partition), 1, __ATOMIC_RELEASE);
+        netdata_thread_enable_cancelability();
+    }
+    else
+        netdata_rwlock_unlock(&cache->index[partition].rwlock);
 }
 //static inline bool pgc_index_write_trylock(PGC *cache, size_t partition) {
 //    return !netdata_rwlock_trywrlock(&cache->index[partition].rwlock);
 //}
 static inline void pgc_index_write_lock(PGC *cache, size_t partition) {
     netdata_rwlock_wrlock(&cache->index[partition].rwlock);
+
+    if(cache->index_readers.counters) {
+        __atomic_store_n(&cache->index[partition].writer, true, __ATOMIC_SEQ_CST);
+
+        for(size_t slot = 0; slot < cache->index_readers.slots ; slot++) {
+            uint32_t *counter = pgc_index_reader_counter(cache, slot, partition);
+            for(size_t spins = 1; __atomic_load_n(counter, __ATOMIC_SEQ_CST) ; spins++) {
+                if(unlikely(spins % 8 == 0)) {
+                    static const struct timespec ns = { .tv_sec = 0, .tv_nsec = 1 };
+                    nanosleep(&ns, NULL);
+                }
+            }
+        }
+    }
 }
 static inline void pgc_index_write_unlock(PGC *cache, size_t partition) {
+    if(cache->index_readers.counters)
+        __atomic_store_n(&cache->index[partition].writer, false, __ATOMIC_RELEASE);
+
     netdata_rwlock_unlock(&cache->index[partition].rwlock);
 }
 
@@ -571,11 +659,140 @@ static void pgc_ll_del(PGC *cache __maybe_unused, struct pgc_linked_list *ll, PG
         pgc_ll_unlock(cache, ll);
 }
 
+// ----------------------------------------------------------------------------
+// eviction policy
+//
+// With PGC_EVICTION_TINYLFU, a count-min sketch of 8-bit counters (saturating
+// at PGC_SKETCH_MAX_COUNTER) estimates
+// how frequently each page (section, metric, start time) is used, including
+// pages that have already been evicted. New clean pages that have been seen
+// before are appended to the clean queue, like LRU does, but pages seen for
+// the first time are prepended, so that they are the first to be evicted.
+// Pages on probation that are accessed again are appended, as usual.
+// This way, a query scanning a lot of data once does not evict the pages
+// that dashboards and alerts use all the time.
+// The counters are halved about every (width / 2) increments, so that old history
+// fades away and the counters of pages seen once stay low even during scans.
+// The increments are counted per index partition, so that queries do not
+// contend on a single atomic, and the halving is done by the background
+// evictor (pgc_evict_pages()), never inline by the threads accessing pages.
+
+#define PGC_SKETCH_DEPTH 4
+#define PGC_SKETCH_MAX_COUNTER 15
+#define PGC_SKETCH_MIN_WIDTH (16 * 1024)
+#define PGC_SKETCH_MAX_WIDTH (16 * 1024 * 1024)
+#define PGC_SKETCH_COUNTERS_PER_PAGE 8
+#define PGC_ADMISSION_MIN_FREQUENCY 2
+
+PGC_EVICTION_POLICY pgc_eviction_policy_id(const char *name) {
+    if(strcmp(name, "tinylfu") == 0)
+        return PGC_EVICTION_TINYLFU;
+
+    return PGC_EVICTION_LRU;
+}
+
+const char *pgc_eviction_policy_name(PGC_EVICTION_POLICY policy) {
+    switch(policy) {
+        case PGC_EVICTION_TINYLFU:
+            return "tinylfu";
+
+        default:
+        case PGC_EVICTION_LRU:
+            return "lru";
+    }
+}
+
+static inline uint64_t pgc_sketch_hash(Word_t section, Word_t metric_id, time_t start_time_s) {
+    uint64_t h = (uint64_t)section * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)metric_id * 0xC2B2AE3D27D4EB4FULL;
+    h ^= (uint64_t)start_time_s * 0x165667B19E3779F9ULL;
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+static void pgc_sketch_age(PGC *cache) {
+    bool expected = true;
+    if(!__atomic_load_n(&cache->eviction.sketch.aging_pending, __ATOMIC_RELAXED) ||
+       !__atomic_compare_exchange_n(&cache->eviction.sketch.aging_pending, &expected, false, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+
+    size_t counters = PGC_SKETCH_DEPTH * (cache->eviction.sketch.mask + 1);
+    uint8_t *c = cache->eviction.sketch.counters;
+
+    // racing increments may be lost, this is fine for an estimation
+    for(size_t i = 0; i < counters ;i++)
+        __atomic_store_n(&c[i], __atomic_load_n(&c[i], __ATOMIC_RELAXED) >> 1, __ATOMIC_RELAXED);
+}
+
+// returns the estimated frequency of the page, including this access
+static inline uint8_t pgc_sketch_increment(PGC *cache, PGC_PAGE *page) {
+    uint64_t hash = pgc_sketch_hash(page->section, page->metric_id, page->start_time_s);
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    size_t width = cache->eviction.sketch.mask + 1;
+    uint8_t *c[PGC_SKETCH_DEPTH];
+    uint8_t frequency = UINT8_MAX;
+
+    for(size_t d = 0; d < PGC_SKETCH_DEPTH ;d++) {
+        c[d] = &cache->eviction.sketch.counters[d * width + ((h1 + d * h2) & cache->eviction.sketch.mask)];
+        uint8_t v = __atomic_load_n(c[d], __ATOMIC_RELAXED);
+
+        if(v < frequency)
+            frequency = v;
+    }
+
+    // conservative update - only the smallest counters are incremented
+    if(frequency < PGC_SKETCH_MAX_COUNTER) {
+        for(size_t d = 0; d < PGC_SKETCH_DEPTH ;d++) {
+            if(__atomic_load_n(c[d], __ATOMIC_RELAXED) == frequency)
+                __atomic_add_fetch(c[d], 1, __ATOMIC_RELAXED);
+        }
+
+        frequency++;
+    }
+
+    size_t partition = pgc_indexing_partition(cache, page->metric_id);
+    if(unlikely(__atomic_add_fetch(&cache->index[partition].sketch_additions, 1, __ATOMIC_RELAXED) == cache->eviction.sketch.aging_period)) {
+        __atomic_sub_fetch(&cache->index[partition].sketch_additions, cache->eviction.sketch.aging_period, __ATOMIC_RELAXED);
+        __atomic_store_n(&cache->eviction.sketch.aging_pending, true, __ATOMIC_RELAXED);
+    }
+
+    return frequency;
+}
+
+// returns true when the new clean page should be appended to the clean queue
+static inline bool page_admission_protected(PGC *cache, PGC_PAGE *page) {
+    if(cache->eviction.policy == PGC_EVICTION_TINYLFU && pgc_sketch_increment(cache, page) < PGC_ADMISSION_MIN_FREQUENCY) {
+        __atomic_add_fetch(&cache->stats.admissions_probation, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    __atomic_add_fetch(&cache->stats.admissions_protected, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static inline bool page_is_on_probation(PGC *cache, PGC_PAGE *page) {
+    return cache->eviction.policy == PGC_EVICTION_TINYLFU && !__atomic_load_n(&page->accesses, __ATOMIC_RELAXED);
+}
+
 static inline void page_has_been_accessed(PGC *cache, PGC_PAGE *page) {
     PGC_PAGE_FLAGS flags = page_flag_check(page, PGC_PAGE_CLEAN | PGC_PAGE_HAS_NO_DATA_IGNORE_ACCESSES);
 
     if (!(flags & PGC_PAGE_HAS_NO_DATA_IGNORE_ACCESSES)) {
-        __atomic_add_fetch(&page->accesses, 1, __ATOMIC_RELAXED);
+        uint16_t accesses = __atomic_fetch_add(&page->accesses, 1, __ATOMIC_RELAXED);
+
+        if(cache->eviction.policy == PGC_EVICTION_TINYLFU) {
+            pgc_sketch_increment(cache, page);
+
+            if(!accesses && (flags & PGC_PAGE_CLEAN))
+                __atomic_add_fetch(&cache->stats.promotions, 1, __ATOMIC_RELAXED);
+        }
 
         if (flags & PGC_PAGE_CLEAN) {
             if(pgc_ll_trylock(cache, &cache->clean)) {
@@ -1084,6 +1301,16 @@ static bool evict_pages_with_filter(PGC *cache, size_t max_skip, size_t max_evic
             else {
                 // we can't delete this page
 
+                if(page_is_on_probation(cache, page)) {
+                    // it is in use, but it should be evicted as soon as it is released,
+                    // so leave it at the beginning of the clean queue
+                    if(unlikely(++total_pages_skipped >= max_skip && !all_of_them)) {
+                        stopped_before_finishing = true;
+                        break;
+                    }
+                    continue;
+                }
+
                 if(!first_page_we_relocated)
                     first_page_we_relocated = page;
 
@@ -1246,7 +1473,7 @@ static PGC_PAGE *page_add(PGC *cache, PGC_ENTRY *entry, bool *added) {
             page = mallocz(sizeof(PGC_PAGE) + cache->config.additional_bytes_per_page);
 #endif
             page->refcount = 1;
-            page->accesses = (entry->hot) ? 0 : 1;
+            page->accesses = 0;
             page->flags = 0;
             page->section = entry->section;
             page->metric_id = entry->metric_id;
@@ -1259,6 +1486,9 @@ static PGC_PAGE *page_add(PGC *cache, PGC_ENTRY *entry, bool *added) {
             page->link.prev = NULL;
             page->link.next = NULL;
 
+            if(!entry->hot && page_admission_protected(cache, page))
+                page->accesses = 1;
+
             if(cache->config.additional_bytes_per_page) {
                 if(entry->custom_data)
                     memcpy(page->custom_data, entry->custom_data, cache->config.additional_bytes_per_page);
@@ -1344,7 +1574,7 @@ static PGC_PAGE *page_find_and_acquire(PGC *cache, Word_t section, Word_t metric
     PGC_PAGE *page = NULL;
     size_t partition = pgc_indexing_partition(cache, metric_id);
 
-    pgc_index_read_lock(cache, partition);
+    bool lockless = pgc_index_read_lock(cache, partition);
 
     Pvoid_t *metrics_judy_pptr = JudyLGet(cache->index[partition].sections_judy, section, PJE0);
     if(unlikely(metrics_judy_pptr == PJERR))
@@ -1467,7 +1697,7 @@ static PGC_PAGE *page_find_and_acquire(PGC *cache, Word_t section, Word_t metric
     }
 
 cleanup:
-    pgc_index_read_unlock(cache, partition);
+    pgc_index_read_unlock(cache, partition, lockless);
 
     if(page) {
         __atomic_add_fetch(stats_hit_ptr, 1, __ATOMIC_RELAXED);
@@ -1781,6 +2011,20 @@ PGC *pgc_create(const char *name,
     for(size_t part = 0; part < cache->config.partitions ; part++)
         netdata_rwlock_init(&cache->index[part].rwlock);
 
+    if(options & PGC_OPTIONS_LOCKLESS_INDEX_READERS) {
+        cache->index_readers.slots = MAX((size_t)get_netdata_cpus(), 4);
+        cache->index_readers.stride = ((cache->config.partitions * sizeof(uint32_t) + 63) / 64) * 64;
+
+        size_t bytes = cache->index_readers.slots * cache->index_readers.stride;
+        void *counters;
+        int ret = posix_memalign(&counters, 64, bytes);
+        if(unlikely(ret))
+            fatal("DBENGINE CACHE: posix_memalign(): %s", strerror(ret));
+
+        memset(counters, 0, bytes);
+        cache->index_readers.counters = counters;
+    }
+
     netdata_spinlock_init(&cache->hot.spinlock);
     netdata_spinlock_init(&cache->dirty.spinlock);
     netdata_spinlock_init(&cache->clean.spinlock);
@@ -1856,6 +2100,11 @@ void pgc_destroy(PGC *cache) {
         for(size_t part = 0; part < cache->config.partitions ; part++)
             netdata_rwlock_destroy(&cache->index[part].rwlock);
 
+        if(cache->index_readers.counters)
+            posix_memfree(cache->index_readers.counters);
+
+        freez(cache->eviction.sketch.counters);
+
 #ifdef PGC_WITH_ARAL
         for(size_t part = 0; part < cache->config.partitions ; part++)
             aral_destroy(cache->aral[part]);
@@ -2004,6 +2253,42 @@ void pgc_reset_hot_max(PGC *cache) {
     evict_pages(cache, 0, 0, true, false);
 }
 
+void pgc_set_eviction_policy(PGC *cache, PGC_EVICTION_POLICY policy) {
+    internal_fatal(cache->stats.added_entries, "DBENGINE CACHE: the eviction policy has to be set before adding pages");
+
+    if(policy == PGC_EVICTION_TINYLFU && !cache->eviction.sketch.counters) {
+        // a few counters for every page that fits in the clean size, assuming 4KiB pages
+        size_t width = PGC_SKETCH_MIN_WIDTH;
+        while(width < PGC_SKETCH_COUNTERS_PER_PAGE * (cache->config.clean_size / 4096) && width < PGC_SKETCH_MAX_WIDTH)
+            width <<= 1;
+
+        cache->eviction.sketch.counters = callocz(PGC_SKETCH_DEPTH * width, sizeof(uint8_t));
+        cache->eviction.sketch.mask = width - 1;
+        cache->eviction.sketch.aging_pending = false;
+
+        // pages are spread evenly across the partitions by their metric id
+        cache->eviction.sketch.aging_period = width / 2 / cache->config.partitions;
+        if(!cache->eviction.sketch.aging_period)
+            cache->eviction.sketch.aging_period = 1;
+
+        for(size_t part = 0; part < cache->config.partitions ; part++)
+            cache->index[part].sketch_additions = 0;
+    }
+
+    cache->eviction.policy = policy;
+    cache->stats.eviction_policy = policy;
+}
+
+void pgc_set_memory_policy(PGC *cache, ARAL_MEMORY_POLICY policy) {
+#ifdef PGC_WITH_ARAL
+    for(size_t part = 0; part < cache->config.partitions ; part++)
+        aral_set_memory_policy(cache->aral[part], policy);
+#else
+    (void)cache;
+    (void)policy;
+#endif
+}
+
 void pgc_set_dynamic_target_cache_size_callback(PGC *cache, dynamic_target_cache_size_callback callback) {
     cache->config.dynamic_target_size_cb = callback;
 
@@ -2023,6 +2308,9 @@ size_t pgc_get_wanted_cache_size(PGC *cache) {
 }
 
 bool pgc_evict_pages(PGC *cache, size_t max_skip, size_t max_evict) {
+    if(cache->eviction.policy == PGC_EVICTION_TINYLFU)
+        pgc_sketch_age(cache);
+
     bool under_pressure = cache_needs_space_aggressively(cache);
     return evict_pages(cache,
                        under_pressure ? 0 : max_skip,
@@ -2261,6 +2549,14 @@ void pgc_open_evict_clean_pages_of_datafile(PGC *cache, struct rrdengine_datafil
     evict_pages_with_filter(cache, 0, 0, true, true, match_page_data, datafile);
 }
 
+static bool match_page_section(PGC_PAGE *page, void *data) {
+    return (page->section == (Word_t)data);
+}
+
+void pgc_evict_clean_pages_of_section(PGC *cache, Word_t section) {
+    evict_pages_with_filter(cache, 0, 0, true, true, match_page_section, (void *)section);
+}
+
 size_t pgc_count_clean_pages_having_data_ptr(PGC *cache, Word_t section, void *ptr) {
     size_t found = 0;
 
@@ -2669,6 +2965,163 @@ void unittest_stress_test(void) {
 }
 #endif
 
+struct pgc_unittest_lockless_readers {
+    PGC *cache;
+    bool stop;
+    size_t metrics;
+    size_t searches;
+    size_t errors;
+};
+
+static void *unittest_lockless_index_readers(void *ptr) {
+    struct pgc_unittest_lockless_readers *t = ptr;
+
+    while(!__atomic_load_n(&t->stop, __ATOMIC_RELAXED)) {
+        for(Word_t metric_id = 1; metric_id <= t->metrics ; metric_id++) {
+            PGC_PAGE *page = pgc_page_get_and_acquire(t->cache, 1, metric_id, 100, PGC_SEARCH_EXACT);
+            if(!page || pgc_page_start_time_s(page) != 100)
+                __atomic_add_fetch(&t->errors, 1, __ATOMIC_RELAXED);
+
+            if(page)
+                pgc_page_release(t->cache, page);
+
+            __atomic_add_fetch(&t->searches, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return ptr;
+}
+
+// readers search pages that exist, while the index is modified by the main thread
+static int pgc_unittest_lockless_index_readers(void) {
+    struct pgc_unittest_lockless_readers t = {
+            .cache = pgc_create("test-lockless",
+                                32 * 1024 * 1024, unittest_free_clean_page_callback,
+                                64, NULL, unittest_save_dirty_page_callback,
+                                10, 10, 1000, 10,
+                                PGC_OPTIONS_DEFAULT | PGC_OPTIONS_LOCKLESS_INDEX_READERS, 4, 0),
+            .stop = false,
+            .metrics = 100,
+            .searches = 0,
+            .errors = 0,
+    };
+
+    for(Word_t metric_id = 1; metric_id <= t.metrics ; metric_id++) {
+        PGC_PAGE *page = pgc_page_add_and_acquire(t.cache, (PGC_ENTRY){
+                .section = 1,
+                .metric_id = metric_id,
+                .start_time_s = 100,
+                .end_time_s = 1000,
+                .size = 64,
+                .data = NULL,
+                .hot = false,
+        }, NULL);
+        pgc_page_release(t.cache, page);
+    }
+
+    netdata_thread_t threads[4];
+    for(size_t i = 0; i < 4 ;i++) {
+        char buffer[100 + 1];
+        snprintfz(buffer, 100, "PGCLOCKLESS_%zu", i);
+        netdata_thread_create(&threads[i], buffer,
+                              NETDATA_THREAD_OPTION_JOINABLE | NETDATA_THREAD_OPTION_DONT_LOG,
+                              unittest_lockless_index_readers, &t);
+    }
+
+    for(Word_t metric_id = t.metrics + 1; metric_id <= t.metrics + 100000 ; metric_id++) {
+        PGC_PAGE *page = pgc_page_add_and_acquire(t.cache, (PGC_ENTRY){
+                .section = 1,
+                .metric_id = metric_id,
+                .start_time_s = 100,
+                .end_time_s = 1000,
+                .size = 64,
+                .data = NULL,
+                .hot = false,
+        }, NULL);
+        pgc_page_release(t.cache, page);
+    }
+
+    __atomic_store_n(&t.stop, true, __ATOMIC_RELAXED);
+    for(size_t i = 0; i < 4 ;i++)
+        netdata_thread_join(threads[i], NULL);
+
+    fprintf(stderr, "PGC: lockless index readers: %zu searches, %zu errors, %zu fallbacks to the rwlock\n",
+            t.searches, t.errors, t.cache->stats.index_readers_fallback);
+
+    pgc_destroy(t.cache);
+    return t.errors ? 1 : 0;
+}
+
+// a working set of pages is used repeatedly, while a query scans a lot of pages once
+static size_t pgc_unittest_eviction_policy_run(PGC_EVICTION_POLICY policy) {
+    const Word_t working_set = 32, scan = 4096;
+
+    PGC *cache = pgc_create("test-eviction",
+                            1 * 1024 * 1024, unittest_free_clean_page_callback,
+                            64, NULL, unittest_save_dirty_page_callback,
+                            10, 10, 1000, 10,
+                            PGC_OPTIONS_DEFAULT, 1, 0);
+    pgc_set_eviction_policy(cache, policy);
+
+    for(size_t round = 0; round < 3 ;round++) {
+        for(Word_t metric_id = 1; metric_id <= working_set ; metric_id++) {
+            PGC_PAGE *page = pgc_page_get_and_acquire(cache, 1, metric_id, 100, PGC_SEARCH_EXACT);
+            if(!page)
+                page = pgc_page_add_and_acquire(cache, (PGC_ENTRY){
+                        .section = 1,
+                        .metric_id = metric_id,
+                        .start_time_s = 100,
+                        .end_time_s = 1000,
+                        .size = 4096,
+                        .data = NULL,
+                        .hot = false,
+                }, NULL);
+            pgc_page_release(cache, page);
+        }
+    }
+
+    for(Word_t metric_id = working_set + 1; metric_id <= working_set + scan ; metric_id++) {
+        PGC_PAGE *page = pgc_page_add_and_acquire(cache, (PGC_ENTRY){
+                .section = 1,
+                .metric_id = metric_id,
+                .start_time_s = 100,
+                .end_time_s = 1000,
+                .size = 4096,
+                .data = NULL,
+                .hot = false,
+        }, NULL);
+        pgc_page_release(cache, page);
+    }
+
+    size_t found = 0;
+    for(Word_t metric_id = 1; metric_id <= working_set ; metric_id++) {
+        PGC_PAGE *page = pgc_page_get_and_acquire(cache, 1, metric_id, 100, PGC_SEARCH_EXACT);
+        if(page) {
+            found++;
+            pgc_page_release(cache, page);
+        }
+    }
+
+    fprintf(stderr, "PGC: eviction policy '%s': %zu of %zu working set pages survived a scan of %zu pages "
+                    "(admissions: %zu protected, %zu probation, %zu promotions)\n",
+            pgc_eviction_policy_name(policy), found, (size_t)working_set, (size_t)scan,
+            cache->stats.admissions_protected, cache->stats.admissions_probation, cache->stats.promotions);
+
+    pgc_destroy(cache);
+    return found;
+}
+
+static int pgc_unittest_eviction_policy(void) {
+    pgc_unittest_eviction_policy_run(PGC_EVICTION_LRU);
+
+    if(pgc_unittest_eviction_policy_run(PGC_EVICTION_TINYLFU) != 32) {
+        fprintf(stderr, "PGC: eviction policy 'tinylfu' evicted pages of the working set\n");
+        return 1;
+    }
+
+    return 0;
+}
+
 int pgc_unittest(void) {
     PGC *cache = pgc_create("test",
                             32 * 1024 * 1024, unittest_free_clean_page_callback,
@@ -2738,6 +3191,12 @@ int pgc_unittest(void) {
 
     pgc_destroy(cache);
 
+    if(pgc_unittest_lockless_index_readers())
+        return 1;
+
+    if(pgc_unittest_eviction_policy())
+        return 1;
+
 #ifdef PGC_STRESS_TEST
     unittest_stress_test();
 #endif
@@ -15,10 +15,17 @@ typedef enum __attribute__ ((__packed__)) {
     PGC_OPTIONS_EVICT_PAGES_INLINE = (1 << 0),
     PGC_OPTIONS_FLUSH_PAGES_INLINE = (1 << 1),
     PGC_OPTIONS_AUTOSCALE          = (1 << 2),
+    PGC_OPTIONS_LOCKLESS_INDEX_READERS = (1 << 3), // searches do not lock the index partitions
 } PGC_OPTIONS;
 
 #define PGC_OPTIONS_DEFAULT (PGC_OPTIONS_EVICT_PAGES_INLINE | PGC_OPTIONS_FLUSH_PAGES_INLINE | PGC_OPTIONS_AUTOSCALE)
 
+// the way clean pages are admitted to the clean queue
+typedef enum __attribute__ ((__packed__)) {
+    PGC_EVICTION_LRU = 0,       // all new clean pages are appended (most recently used)
+    PGC_EVICTION_TINYLFU,       // only new clean pages seen before are appended, the rest are prepended (on probation)
+} PGC_EVICTION_POLICY;
+
 typedef struct pgc_entry {
     Word_t section;             // the section this belongs to
     Word_t metric_id;           // the metric this belongs to
@@ -127,6 +134,7 @@ struct pgc_statistics {
     size_t acquire_spins;
     size_t delete_spins;
     size_t flush_spins;
+    size_t index_readers_fallback;  // lockless index readers that found a writer
 
     PGC_CACHE_LINE_PADDING(10);
 
@@ -148,6 +156,14 @@ struct pgc_statistics {
     size_t events_cache_needs_space_aggressively;
     size_t events_flush_critical;
 
+    PGC_CACHE_LINE_PADDING(11a);
+
+    // eviction policy
+    PGC_EVICTION_POLICY eviction_policy;
+    size_t admissions_protected;    // new clean pages appended to the clean queue
+    size_t admissions_probation;    // new clean pages prepended to the clean queue
+    size_t promotions;              // pages on probation accessed again, appended to the clean queue
+
     PGC_CACHE_LINE_PADDING(12);
 
     struct {
@@ -229,12 +245,19 @@ bool pgc_page_to_clean_evict_or_release(PGC *cache, PGC_PAGE *page);
 typedef void (*migrate_to_v2_callback)(Word_t section, unsigned datafile_fileno, uint8_t type, Pvoid_t JudyL_metrics, Pvoid_t JudyL_extents_pos, size_t count_of_unique_extents, size_t count_of_unique_metrics, size_t count_of_unique_pages, void *data);
 void pgc_open_cache_to_journal_v2(PGC *cache, Word_t section, unsigned datafile_fileno, uint8_t type, migrate_to_v2_callback cb, void *data);
 void pgc_open_evict_clean_pages_of_datafile(PGC *cache, struct rrdengine_datafile *datafile);
+void pgc_evict_clean_pages_of_section(PGC *cache, Word_t section);
 size_t pgc_count_clean_pages_having_data_ptr(PGC *cache, Word_t section, void *ptr);
 size_t pgc_count_hot_pages_having_data_ptr(PGC *cache, Word_t section, void *ptr);
 
 typedef size_t (*dynamic_target_cache_size_callback)(void);
 void pgc_set_dynamic_target_cache_size_callback(PGC *cache, dynamic_target_cache_size_callback callback);
 
+// it has to be set before any page is added to the cache
+void pgc_set_eviction_policy(PGC *cache, PGC_EVICTION_POLICY policy);
+void pgc_set_memory_policy(PGC *cache, ARAL_MEMORY_POLICY policy);
+PGC_EVICTION_POLICY pgc_eviction_policy_id(const char *name);
+const char *pgc_eviction_policy_name(PGC_EVICTION_POLICY policy);
+
 // return true when there is more work to do
 bool pgc_evict_pages(PGC *cache, size_t max_skip, size_t max_evict);
 bool pgc_flush_pages(PGC *cache, size_t max_flushes);
@@ -0,0 +1,631 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "compact.h"
+
+struct rrdeng_compact_state {
+    uint8_t compression_algorithm;
+    int compression_level;
+    unsigned pages_per_extent;
+    rrdeng_compact_metric_cb metric_is_alive;
+    void *data;
+    struct rrdeng_compact_stats *stats;
+
+    // the datafile being written
+    int datafile_fd;
+    int journal_fd;
+    uint64_t datafile_pos;
+    uint64_t journal_pos;
+    uint64_t transaction_id;
+    size_t pages;
+    bool failed;
+
+    // the extent being built
+    struct {
+        uint32_t count;
+        uint32_t payload_length;
+        struct rrdeng_extent_page_descr descr[MAX_PAGES_PER_EXTENT];
+        uint8_t *payload;                       // the pages, uncompressed
+        uint8_t *buffer;                        // the extent, as written to the datafile
+        size_t buffer_size;
+    } extent;
+
+#ifdef HAVE_ZSTD
+    ZSTD_CCtx *zstd;
+#endif
+};
+
+// ----------------------------------------------------------------------------
+// writing
+
+static bool rrdeng_compact_write(int fd, const void *buf, size_t size, uint64_t pos) {
+    const uint8_t *p = buf;
+
+    while(size) {
+        ssize_t ret = pwrite(fd, p, size, (off_t)pos);
+        if(ret < 0) {
+            if(errno == EINTR)
+                continue;
+
+            error("DBENGINE COMPACT: cannot write %zu bytes at position %"PRIu64, size, pos);
+            return false;
+        }
+
+        p += ret;
+        pos += ret;
+        size -= ret;
+    }
+
+    return true;
+}
+
+static bool rrdeng_compact_superblocks_write(struct rrdeng_compact_state *cs) {
+    uint8_t block[RRDENG_BLOCK_SIZE];
+
+    struct rrdeng_df_sb *df_sb = (void *)block;
+    memset(block, 0, sizeof(block));
+    (void) strncpy(df_sb->magic_number, RRDENG_DF_MAGIC, RRDENG_MAGIC_SZ);
+    (void) strncpy(df_sb->version, RRDENG_DF_VER, RRDENG_VER_SZ);
+    df_sb->tier = 1;
+
+    if(!rrdeng_compact_write(cs->datafile_fd, block, sizeof(*df_sb), 0))
+        return false;
+
+    struct rrdeng_jf_sb *jf_sb = (void *)block;
+    memset(block, 0, sizeof(block));
+    (void) strncpy(jf_sb->magic_number, RRDENG_JF_MAGIC, RRDENG_MAGIC_SZ);
+    (void) strncpy(jf_sb->version, RRDENG_JF_VER, RRDENG_VER_SZ);
+
+    if(!rrdeng_compact_write(cs->journal_fd, block, sizeof(*jf_sb), 0))
+        return false;
+
+    cs->datafile_pos = sizeof(*df_sb);
+    cs->journal_pos = sizeof(*jf_sb);
+    return true;
+}
+
+// the same transaction netdata writes to journal v1 files for every extent it flushes
+static bool rrdeng_compact_transaction_write(struct rrdeng_compact_state *cs, uint64_t extent_offset, uint32_t extent_size) {
+    uint8_t block[RRDENG_BLOCK_SIZE];
+    struct rrdeng_jf_transaction_header *jf_header = (void *)block;
+    struct rrdeng_jf_store_data *jf_metric_data = (void *)(block + sizeof(*jf_header));
+    struct rrdeng_jf_transaction_trailer *jf_trailer;
+
+    uint32_t count = cs->extent.count;
+    uint32_t descr_size = sizeof(*jf_metric_data->descr) * count;
+    uint32_t payload_length = sizeof(*jf_metric_data) + descr_size;
+    uint32_t size_bytes = sizeof(*jf_header) + payload_length + sizeof(*jf_trailer);
+
+    memset(block, 0, sizeof(block));
+    jf_header->type = STORE_DATA;
+    jf_header->reserved = 0;
+    jf_header->id = cs->transaction_id++;
+    jf_header->payload_length = payload_length;
+
+    jf_metric_data->extent_offset = extent_offset;
+    jf_metric_data->extent_size = extent_size;
+    jf_metric_data->number_of_pages = count;
+    memcpy(jf_metric_data->descr, cs->extent.descr, descr_size);
+
+    jf_trailer = (void *)(block + sizeof(*jf_header) + payload_length);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, block, sizeof(*jf_header) + payload_length);
+    crc32set(jf_trailer->checksum, crc);
+
+    /* an empty transaction to skip the rest of the block */
+    if(size_bytes < sizeof(block))
+        block[size_bytes] = STORE_PADDING;
+
+    if(!rrdeng_compact_write(cs->journal_fd, block, sizeof(block), cs->journal_pos))
+        return false;
+
+    cs->journal_pos += sizeof(block);
+    return true;
+}
+
+static int rrdeng_compact_payload_compress(struct rrdeng_compact_state *cs, uint8_t *dst, size_t dst_size) {
+    switch(cs->compression_algorithm) {
+        case RRD_LZ4:
+            return LZ4_compress_default((char *)cs->extent.payload, (char *)dst,
+                                        (int)cs->extent.payload_length, (int)dst_size);
+
+#ifdef HAVE_ZSTD
+        case RRD_ZSTD: {
+            size_t zret = ZSTD_compressCCtx(cs->zstd, dst, dst_size, cs->extent.payload, cs->extent.payload_length,
+                                            cs->compression_level ? cs->compression_level : ZSTD_CLEVEL_DEFAULT);
+            return ZSTD_isError(zret) ? -1 : (int)zret;
+        }
+#endif
+
+        default:
+            return -1;
+    }
+}
+
+static bool rrdeng_compact_extent_flush(struct rrdeng_compact_state *cs) {
+    uint32_t count = cs->extent.count;
+    if(!count || cs->failed)
+        goto done;
+
+    struct rrdeng_df_extent_header *header = (void *)cs->extent.buffer;
+    struct rrdeng_df_extent_trailer *trailer;
+    uint32_t payload_offset = sizeof(*header) + count * sizeof(header->descr[0]);
+    size_t available = cs->extent.buffer_size - payload_offset - sizeof(*trailer);
+
+    header->number_of_pages = count;
+    memcpy(header->descr, cs->extent.descr, count * sizeof(header->descr[0]));
+
+    int compressed_size = rrdeng_compact_payload_compress(cs, cs->extent.buffer + payload_offset, available);
+    if(compressed_size > 0 && (uint32_t)compressed_size < cs->extent.payload_length) {
+        header->compression_algorithm = cs->compression_algorithm;
+        header->payload_length = compressed_size;
+    }
+    else {
+        header->compression_algorithm = RRD_NO_COMPRESSION;
+        header->payload_length = cs->extent.payload_length;
+        memcpy(cs->extent.buffer + payload_offset, cs->extent.payload, cs->extent.payload_length);
+    }
+
+    uint32_t size_bytes = payload_offset + header->payload_length + sizeof(*trailer);
+    uint32_t real_io_size = ALIGN_BYTES_CEILING(size_bytes);
+
+    trailer = (void *)(cs->extent.buffer + size_bytes - sizeof(*trailer));
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, cs->extent.buffer, size_bytes - sizeof(*trailer));
+    crc32set(trailer->checksum, crc);
+
+    memset(cs->extent.buffer + size_bytes, 0, real_io_size - size_bytes);
+
+    if(!rrdeng_compact_write(cs->datafile_fd, cs->extent.buffer, real_io_size, cs->datafile_pos) ||
+       !rrdeng_compact_transaction_write(cs, cs->datafile_pos, size_bytes)) {
+        cs->failed = true;
+        goto done;
+    }
+
+    cs->datafile_pos += real_io_size;
+    cs->stats->extents++;
+
+done:
+    cs->extent.count = 0;
+    cs->extent.payload_length = 0;
+    return !cs->failed;
+}
+
+static bool rrdeng_compact_page_cb(const struct rrdeng_extent_page_descr *descr, const void *page, void *data) {
+    struct rrdeng_compact_state *cs = data;
+
+    cs->stats->pages++;
+
+    if(cs->metric_is_alive && !cs->metric_is_alive((uuid_t *)descr->uuid, cs->data)) {
+        cs->stats->pages_dropped++;
+        return true;
+    }
+
+    if(cs->extent.count >= cs->pages_per_extent && !rrdeng_compact_extent_flush(cs))
+        return false;
+
+    struct rrdeng_extent_page_descr *d = &cs->extent.descr[cs->extent.count++];
+    *d = *descr;
+
+    size_t length = pg_cache_rle_enabled ? pg_cache_page_rle_encode(cs->extent.payload + cs->extent.payload_length, d->type, page, d->page_length) : 0;
+    if(length) {
+        d->type = PAGE_RLE;
+        d->page_length = (uint32_t)length;
+    }
+    else
+        memcpy(cs->extent.payload + cs->extent.payload_length, page, d->page_length);
+
+    cs->extent.payload_length += d->page_length;
+    cs->pages++;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// datafiles
+
+static uint64_t rrdeng_compact_file_size(const char *filename, struct stat *st) {
+    struct stat tmp;
+    if(!st) st = &tmp;
+
+    if(stat(filename, st) != 0)
+        return 0;
+
+    return (uint64_t)st->st_size;
+}
+
+static int rrdeng_compact_file_create(const char *filename, struct stat *owner) {
+    int fd = open(filename, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if(fd == -1) {
+        error("DBENGINE COMPACT: cannot create file '%s'", filename);
+        return -1;
+    }
+
+    // the files have to remain accessible to netdata, when compacting as root
+    if(fchown(fd, owner->st_uid, owner->st_gid) != 0)
+        error("DBENGINE COMPACT: cannot change the owner of file '%s'", filename);
+
+    return fd;
+}
+
+struct rrdeng_compact_files {
+    char datafile[FILENAME_MAX + 1];
+    char journal_v1[FILENAME_MAX + 1];
+    char journal_v2[FILENAME_MAX + 1];
+
+    // netdata does not load files with these prefixes, if we are interrupted
+    char new_datafile[FILENAME_MAX + 1];
+    char new_journal_v1[FILENAME_MAX + 1];
+    char old_journal_v1[FILENAME_MAX + 1];  // a link to the journal replaced, until the datafile is replaced too
+};
+
+static void rrdeng_compact_files_init(struct rrdeng_compact_files *f, const char *path, unsigned tier, unsigned fileno) {
+    snprintfz(f->datafile, FILENAME_MAX, "%s/" DATAFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL DATAFILE_EXTENSION, path, tier, fileno);
+    snprintfz(f->journal_v1, FILENAME_MAX, "%s/" WALFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION, path, tier, fileno);
+    snprintfz(f->journal_v2, FILENAME_MAX, "%s/" WALFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION_V2, path, tier, fileno);
+
+    snprintfz(f->new_datafile, FILENAME_MAX, "%s/" COMPACT_PREFIX DATAFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL DATAFILE_EXTENSION, path, tier, fileno);
+    snprintfz(f->new_journal_v1, FILENAME_MAX, "%s/" COMPACT_PREFIX WALFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION, path, tier, fileno);
+    snprintfz(f->old_journal_v1, FILENAME_MAX, "%s/" COMPACT_OLD_PREFIX WALFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION, path, tier, fileno);
+}
+
+static void rrdeng_compact_dir_sync(const char *path) {
+    int dir_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(dir_fd != -1) {
+        (void) fsync(dir_fd);
+        close(dir_fd);
+    }
+}
+
+static bool rrdeng_compact_file_exists(const char *filename) {
+    struct stat st;
+    return lstat(filename, &st) == 0;
+}
+
+// The journal v1 is replaced first and the datafile last, while a link to the old journal
+// is kept, so that a failure in between can be rolled back here, and an interruption
+// can be completed or undone by rrdeng_compact_recover() on the next start.
+// The journal v2 file must already be deleted.
+static bool rrdeng_compact_files_replace(struct rrdeng_compact_files *f, const char *path) {
+    unlink(f->old_journal_v1);
+    if(link(f->journal_v1, f->old_journal_v1) != 0) {
+        error("DBENGINE COMPACT: cannot link journal file '%s' to '%s'", f->journal_v1, f->old_journal_v1);
+        unlink(f->new_datafile);
+        unlink(f->new_journal_v1);
+        return false;
+    }
+    rrdeng_compact_dir_sync(path);
+
+    if(rename(f->new_journal_v1, f->journal_v1) != 0) {
+        error("DBENGINE COMPACT: cannot rename '%s' to '%s'", f->new_journal_v1, f->journal_v1);
+        unlink(f->new_datafile);
+        unlink(f->new_journal_v1);
+        unlink(f->old_journal_v1);
+        return false;
+    }
+    rrdeng_compact_dir_sync(path);
+
+    if(rename(f->new_datafile, f->datafile) != 0) {
+        error("DBENGINE COMPACT: cannot rename '%s' to '%s', restoring journal file '%s'", f->new_datafile, f->datafile, f->journal_v1);
+
+        if(rename(f->old_journal_v1, f->journal_v1) != 0) {
+            // rrdeng_compact_recover() will complete or undo it
+            error("DBENGINE COMPACT: cannot rename '%s' to '%s'", f->old_journal_v1, f->journal_v1);
+            return false;
+        }
+
+        rrdeng_compact_dir_sync(path);
+        unlink(f->new_datafile);
+        return false;
+    }
+    rrdeng_compact_dir_sync(path);
+
+    unlink(f->old_journal_v1);
+    return true;
+}
+
+// completes or undoes the replacement of the files of a datafile, depending on how far it got
+static bool rrdeng_compact_files_recover(struct rrdeng_compact_files *f) {
+    bool new_datafile = rrdeng_compact_file_exists(f->new_datafile);
+    bool new_journal_v1 = rrdeng_compact_file_exists(f->new_journal_v1);
+    bool old_journal_v1 = rrdeng_compact_file_exists(f->old_journal_v1);
+
+    if(old_journal_v1 && !new_journal_v1 && new_datafile) {
+        // the journal has been replaced, but the datafile has not
+        unlink(f->journal_v2);
+
+        if(rename(f->new_datafile, f->datafile) == 0)
+            info("DBENGINE COMPACT: completed the interrupted compaction of datafile '%s'", f->datafile);
+
+        else if(rename(f->old_journal_v1, f->journal_v1) == 0) {
+            error("DBENGINE COMPACT: cannot rename '%s' to '%s', restored journal file '%s'", f->new_datafile, f->datafile, f->journal_v1);
+            unlink(f->new_datafile);
+        }
+
+        else {
+            error("DBENGINE COMPACT: cannot complete or undo the compaction of datafile '%s'", f->datafile);
+            return false;
+        }
+    }
+    else if(new_datafile || new_journal_v1) {
+        // the old files are still in place
+        info("DBENGINE COMPACT: discarding the interrupted compaction of datafile '%s'", f->datafile);
+        unlink(f->new_datafile);
+        unlink(f->new_journal_v1);
+    }
+
+    unlink(f->old_journal_v1);
+    return true;
+}
+
+static bool rrdeng_compact_datafile(struct rrdeng_compact_state *cs, const char *path, RRDENG_READER *rdr, size_t file) {
+    struct rrdeng_compact_files f;
+    unsigned tier, fileno;
+
+    rrdeng_reader_file(rdr, file, &tier, &fileno);
+    rrdeng_compact_files_init(&f, path, tier, fileno);
+
+    struct stat st;
+    uint64_t datafile_size = rrdeng_compact_file_size(f.datafile, &st);
+    if(!datafile_size) {
+        error("DBENGINE COMPACT: cannot find datafile '%s', skipping it", f.datafile);
+        return true;
+    }
+
+    uint64_t bytes_before = datafile_size + rrdeng_compact_file_size(f.journal_v1, NULL) + rrdeng_compact_file_size(f.journal_v2, NULL);
+
+    cs->datafile_fd = rrdeng_compact_file_create(f.new_datafile, &st);
+    cs->journal_fd = rrdeng_compact_file_create(f.new_journal_v1, &st);
+    cs->transaction_id = 1;
+    cs->pages = 0;
+    cs->failed = (cs->datafile_fd == -1 || cs->journal_fd == -1 || !rrdeng_compact_superblocks_write(cs));
+
+    if(!cs->failed) {
+        rrdeng_reader_foreach_page(rdr, file, rrdeng_compact_page_cb, cs);
+        rrdeng_compact_extent_flush(cs);
+    }
+
+    if(!cs->failed && cs->pages && (fsync(cs->datafile_fd) != 0 || fsync(cs->journal_fd) != 0)) {
+        error("DBENGINE COMPACT: cannot sync the new files of datafile %u", fileno);
+        cs->failed = true;
+    }
+
+    if(cs->datafile_fd != -1) close(cs->datafile_fd);
+    if(cs->journal_fd != -1) close(cs->journal_fd);
+    cs->datafile_fd = cs->journal_fd = -1;
+
+    uint64_t bytes_after = cs->datafile_pos + cs->journal_pos;
+
+    if(cs->failed || (cs->pages && cs->datafile_pos >= datafile_size)) {
+        unlink(f.new_datafile);
+        unlink(f.new_journal_v1);
+        return !cs->failed;
+    }
+
+    if(!cs->pages) {
+        // nothing is left in it - the datafile goes first, netdata ignores journals without datafiles
+        unlink(f.new_datafile);
+        unlink(f.new_journal_v1);
+        if(unlink(f.datafile) != 0) {
+            error("DBENGINE COMPACT: cannot delete datafile '%s'", f.datafile);
+            return false;
+        }
+        unlink(f.journal_v2);
+        unlink(f.journal_v1);
+
+        cs->stats->datafiles_deleted++;
+        cs->stats->bytes_before += bytes_before;
+        return true;
+    }
+
+    // the journal v2 file describes the old datafile, netdata will create a new one from the journal v1 file
+    if(unlink(f.journal_v2) != 0 && errno != ENOENT) {
+        error("DBENGINE COMPACT: cannot delete journal file '%s'", f.journal_v2);
+        unlink(f.new_datafile);
+        unlink(f.new_journal_v1);
+        return false;
+    }
+
+    if(!rrdeng_compact_files_replace(&f, path)) {
+        error("DBENGINE COMPACT: cannot replace the files of datafile %u", fileno);
+        return false;
+    }
+
+    cs->stats->datafiles_rewritten++;
+    cs->stats->bytes_before += bytes_before;
+    cs->stats->bytes_after += bytes_after;
+    return true;
+}
+
+int rrdeng_compact_recover(const char *dbfiles_path) {
+    DIR *dir = opendir(dbfiles_path);
+    if(!dir) {
+        error("DBENGINE COMPACT: cannot open directory '%s'", dbfiles_path);
+        return 1;
+    }
+
+    // collect them first, the directory is modified while recovering
+    struct {
+        unsigned tier;
+        unsigned fileno;
+    } *found = NULL;
+    size_t used = 0, size = 0;
+
+    struct dirent *de;
+    while((de = readdir(dir))) {
+        unsigned tier, fileno;
+
+        if(sscanf(de->d_name, COMPACT_PREFIX DATAFILE_PREFIX RRDENG_FILE_NUMBER_SCAN_TMPL DATAFILE_EXTENSION, &tier, &fileno) != 2 &&
+           sscanf(de->d_name, COMPACT_PREFIX WALFILE_PREFIX RRDENG_FILE_NUMBER_SCAN_TMPL WALFILE_EXTENSION, &tier, &fileno) != 2 &&
+           sscanf(de->d_name, COMPACT_OLD_PREFIX WALFILE_PREFIX RRDENG_FILE_NUMBER_SCAN_TMPL WALFILE_EXTENSION, &tier, &fileno) != 2)
+            continue;
+
+        if(used == size) {
+            size = size ? size * 2 : 16;
+            found = reallocz(found, size * sizeof(*found));
+        }
+
+        found[used].tier = tier;
+        found[used].fileno = fileno;
+        used++;
+    }
+    closedir(dir);
+
+    int ret = 0;
+    for(size_t i = 0; i < used ; i++) {
+        struct rrdeng_compact_files f;
+        rrdeng_compact_files_init(&f, dbfiles_path, found[i].tier, found[i].fileno);
+
+        if(!rrdeng_compact_files_recover(&f))
+            ret = 1;
+    }
+
+    if(used)
+        rrdeng_compact_dir_sync(dbfiles_path);
+
+    freez(found);
+    return ret;
+}
+
+int rrdeng_compact(const char *dbfiles_path, uint8_t compression_algorithm, int compression_level,
+                   rrdeng_compact_metric_cb metric_is_alive, void *data, struct rrdeng_compact_stats *stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    int lock_fd;
+    if(!rrdeng_dbfiles_lock(dbfiles_path, &lock_fd)) {
+        error("DBENGINE COMPACT: netdata is using '%s', stop it before compacting it", dbfiles_path);
+        return 1;
+    }
+
+    if(lock_fd == -1 || rrdeng_compact_recover(dbfiles_path) != 0) {
+        rrdeng_dbfiles_unlock(&lock_fd);
+        return 1;
+    }
+
+    RRDENG_READER *rdr = rrdeng_reader_open(dbfiles_path);
+    if(!rdr) {
+        rrdeng_dbfiles_unlock(&lock_fd);
+        return 1;
+    }
+
+    struct rrdeng_compact_state cs = {
+            .compression_algorithm = compression_algorithm,
+            .compression_level = compression_level,
+            .pages_per_extent = MIN(MAX(rrdeng_pages_per_extent, 1), MAX_PAGES_PER_EXTENT),
+            .metric_is_alive = metric_is_alive,
+            .data = data,
+            .stats = stats,
+            .datafile_fd = -1,
+            .journal_fd = -1,
+    };
+
+    size_t max_payload = MAX_PAGES_PER_EXTENT * RRDENG_BLOCK_SIZE;
+    size_t max_compressed = LZ4_compressBound((int)max_payload);
+
+#ifdef HAVE_ZSTD
+    max_compressed = MAX(max_compressed, ZSTD_compressBound(max_payload));
+    cs.zstd = ZSTD_createCCtx();
+    if(!cs.zstd)
+        fatal("DBENGINE COMPACT: cannot create a ZSTD compression context");
+#endif
+
+    cs.extent.payload = mallocz(max_payload);
+    cs.extent.buffer_size = ALIGN_BYTES_CEILING(sizeof(struct rrdeng_df_extent_header) +
+                                                MAX_PAGES_PER_EXTENT * sizeof(struct rrdeng_extent_page_descr) +
+                                                MAX(max_payload, max_compressed) +
+                                                sizeof(struct rrdeng_df_extent_trailer));
+    cs.extent.buffer = mallocz(cs.extent.buffer_size);
+    memset(cs.extent.buffer, 0, cs.extent.buffer_size);
+
+    int ret = 0;
+    for(size_t f = 0; f < rrdeng_reader_files(rdr) ;f++) {
+        stats->datafiles++;
+
+        if(!rrdeng_compact_datafile(&cs, dbfiles_path, rdr, f)) {
+            ret = 1;
+            break;
+        }
+    }
+
+    // make the deletions durable
+    rrdeng_compact_dir_sync(dbfiles_path);
+
+#ifdef HAVE_ZSTD
+    ZSTD_freeCCtx(cs.zstd);
+#endif
+
+    freez(cs.extent.buffer);
+    freez(cs.extent.payload);
+    rrdeng_reader_close(rdr);
+    rrdeng_dbfiles_unlock(&lock_fd);
+    return ret;
+}
+
+// ----------------------------------------------------------------------------
+// compaction of a tier, using the metadata database
+
+struct rrdeng_compact_metrics {
+    Pvoid_t JudyHS;
+    size_t alive;
+    size_t dead;
+};
+
+#define COMPACT_METRIC_ALIVE ((Word_t)1)
+#define COMPACT_METRIC_DEAD  ((Word_t)2)
+
+static bool rrdeng_compact_metric_is_alive(uuid_t *uuid, void *data) {
+    struct rrdeng_compact_metrics *cm = data;
+
+    Pvoid_t *PValue = JudyHSIns(&cm->JudyHS, uuid, sizeof(uuid_t), PJE0);
+    if(!*PValue) {
+        // unknown metrics are kept, when the database cannot tell
+        if(sql_dimension_exists(uuid) == 0) {
+            *(Word_t *)PValue = COMPACT_METRIC_DEAD;
+            cm->dead++;
+        }
+        else {
+            *(Word_t *)PValue = COMPACT_METRIC_ALIVE;
+            cm->alive++;
+        }
+    }
+
+    return *(Word_t *)PValue == COMPACT_METRIC_ALIVE;
+}
+
+int rrdeng_compact_tier(size_t tier, bool drop_dead_metrics) {
+    if(tier >= RRD_STORAGE_TIERS) {
+        error("DBENGINE COMPACT: tier %zu is not supported", tier);
+        return 1;
+    }
+
+    char path[FILENAME_MAX + 1];
+    if(tier == 0)
+        snprintfz(path, FILENAME_MAX, "%s/dbengine", netdata_configured_cache_dir);
+    else
+        snprintfz(path, FILENAME_MAX, "%s/dbengine-tier%zu", netdata_configured_cache_dir, tier);
+
+    struct rrdeng_compact_metrics cm = { 0 };
+    struct rrdeng_compact_stats stats;
+
+    info("DBENGINE COMPACT: compacting '%s' with %s compression%s", path,
+         rrdeng_compression_algorithm_name(tier_compression_algorithm[tier]),
+         drop_dead_metrics ? ", dropping the metrics not in the metadata database" : "");
+
+    int ret = rrdeng_compact(path, tier_compression_algorithm[tier], tier_compression_level[tier],
+                             drop_dead_metrics ? rrdeng_compact_metric_is_alive : NULL, &cm, &stats);
+
+    JudyHSFreeArray(&cm.JudyHS, PJE0);
+
+    if(drop_dead_metrics)
+        sql_dimension_exists_done();
+
+    fprintf(stderr, "%zu datafiles examined, %zu rewritten, %zu deleted\n"
+                    "%zu pages examined, %zu dropped, %zu extents written\n"
+                    "%zu metrics alive, %zu dead\n"
+                    "%"PRIu64" bytes of datafiles and journals became %"PRIu64" bytes (journal v2 files will be recreated by netdata)\n",
+            stats.datafiles, stats.datafiles_rewritten, stats.datafiles_deleted,
+            stats.pages, stats.pages_dropped, stats.extents,
+            cm.alive, cm.dead,
+            stats.bytes_before, stats.bytes_after);
+
+    return ret;
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DBENGINE_COMPACT_H
+#define NETDATA_DBENGINE_COMPACT_H
+
+#include "rrdengine.h"
+
+// ----------------------------------------------------------------------------
+// offline compaction of the datafiles of a dbengine tier
+//
+// Every datafile that has a journal v2 file is rewritten with the pages of the
+// metrics that are still alive, packed into full extents and compressed with
+// the algorithm given. A new journal v1 file is written for it and its journal
+// v2 file is deleted, so that netdata indexes it again on its next start.
+// Datafiles left without pages are deleted. Datafiles that would not shrink
+// are left as they are.
+//
+// Netdata must not be using the directory while it is compacted. Both netdata and
+// the compaction hold an exclusive lock on the directory, so compaction fails
+// while netdata runs.
+//
+// The journal v1 file of a datafile is replaced before the datafile. A compaction
+// that was interrupted in between is completed or undone by rrdeng_compact_recover(),
+// which netdata runs before loading a tier and the compaction runs before starting.
+
+// the new files are written with COMPACT_PREFIX and the journal replaced is kept with
+// COMPACT_OLD_PREFIX, until the datafile is replaced too
+#define COMPACT_PREFIX "compact-"
+#define COMPACT_OLD_PREFIX COMPACT_PREFIX "old-"
+
+typedef bool (*rrdeng_compact_metric_cb)(uuid_t *uuid, void *data);
+
+struct rrdeng_compact_stats {
+    size_t datafiles;
+    size_t datafiles_rewritten;
+    size_t datafiles_deleted;
+    size_t pages;
+    size_t pages_dropped;
+    size_t extents;
+    uint64_t bytes_before;              // the datafiles and journals rewritten or deleted
+    uint64_t bytes_after;
+};
+
+// metric_is_alive can be NULL, to keep the pages of all metrics
+int rrdeng_compact(const char *dbfiles_path, uint8_t compression_algorithm, int compression_level,
+                   rrdeng_compact_metric_cb metric_is_alive, void *data, struct rrdeng_compact_stats *stats);
+
+// completes or undoes the interrupted compactions in a directory, returns 0 on success
+int rrdeng_compact_recover(const char *dbfiles_path);
+
+// compacts a tier of the configured cache directory, with its configured compression
+// when drop_dead_metrics is set, the metrics not in the metadata database are dropped
+int rrdeng_compact_tier(size_t tier, bool drop_dead_metrics);
+
+#endif //NETDATA_DBENGINE_COMPACT_H
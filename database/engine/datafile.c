@@ -376,6 +376,104 @@ static int scan_data_files_cmp(const void *a, const void *b)
     return strcmp(path1, path2);
 }
 
+// ----------------------------------------------------------------------------
+// parallel loading of datafile and journalfile pairs
+
+struct datafile_load_job {
+    struct rrdengine_datafile *datafile;
+    struct rrdengine_journalfile *journalfile;
+    bool failed;
+    bool migrate_to_v2;
+};
+
+struct datafile_load_state {
+    struct rrdengine_instance *ctx;
+    struct datafile_load_job *jobs;
+    size_t count;
+    size_t next;                    // atomic - the next job to be picked
+    usec_t started_ut;
+    usec_t last_logged_ut;          // atomic
+};
+
+static void datafile_load_progress_log(struct datafile_load_state *state, bool force) {
+    struct rrdengine_instance *ctx = state->ctx;
+    usec_t now_ut = now_monotonic_usec();
+    usec_t last_logged_ut = __atomic_load_n(&state->last_logged_ut, __ATOMIC_RELAXED);
+
+    if(!force && (now_ut - last_logged_ut < 5 * USEC_PER_SEC ||
+                  !__atomic_compare_exchange_n(&state->last_logged_ut, &last_logged_ut, now_ut, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)))
+        return;
+
+    info("DBENGINE: tier %d loaded %zu of %zu journal files (%zu v2, %zu v1 replayed) in %0.2f secs",
+         ctx->config.tier,
+         __atomic_load_n(&ctx->loading.progress.journalfiles_loaded, __ATOMIC_RELAXED),
+         state->count,
+         __atomic_load_n(&ctx->loading.progress.journalfiles_v2_loaded, __ATOMIC_RELAXED),
+         __atomic_load_n(&ctx->loading.progress.journalfiles_v1_replayed, __ATOMIC_RELAXED),
+         (double)(now_ut - state->started_ut) / USEC_PER_SEC);
+}
+
+static void *datafile_load_worker(void *ptr) {
+    struct datafile_load_state *state = ptr;
+    struct rrdengine_instance *ctx = state->ctx;
+
+    size_t i;
+    while((i = __atomic_fetch_add(&state->next, 1, __ATOMIC_RELAXED)) < state->count) {
+        struct datafile_load_job *job = &state->jobs[i];
+        struct rrdengine_datafile *datafile = job->datafile;
+
+        bool datafile_loaded = (load_data_file(datafile) == 0);
+        if(!datafile_loaded)
+            job->failed = true;
+
+        job->journalfile = journalfile_alloc_and_init(datafile);
+        if(journalfile_load(ctx, job->journalfile, datafile, &job->migrate_to_v2) != 0) {
+            if(datafile_loaded) /* If datafile is still open close it */
+                close_data_file(datafile);
+
+            job->failed = true;
+        }
+
+        __atomic_add_fetch(&ctx->loading.progress.journalfiles_loaded, 1, __ATOMIC_RELAXED);
+        datafile_load_progress_log(state, false);
+    }
+
+    return NULL;
+}
+
+// Loading (and validating) the journal files of a tier is spread to all the cores that are
+// available to this tier. The list of datafiles is built afterwards, in order.
+static void datafile_load_all(struct rrdengine_instance *ctx, struct datafile_load_state *state) {
+    size_t threads = get_netdata_cpus() / storage_tiers;
+    if(threads > state->count)
+        threads = state->count;
+
+    if(threads < 1)
+        threads = 1;
+
+    info("DBENGINE: loading %zu journal files of tier %d, using %zu threads...", state->count, ctx->config.tier, threads);
+
+    netdata_thread_t *workers = NULL;
+    if(threads > 1) {
+        workers = callocz(threads - 1, sizeof(netdata_thread_t));
+        for(size_t t = 0; t < threads - 1 ;t++)
+            netdata_thread_create(&workers[t], "DBENGINE_LOAD", NETDATA_THREAD_OPTION_JOINABLE | NETDATA_THREAD_OPTION_DONT_LOG,
+                                  datafile_load_worker, state);
+    }
+
+    // this thread works too
+    datafile_load_worker(state);
+
+    if(workers) {
+        for(size_t t = 0; t < threads - 1 ;t++)
+            netdata_thread_join(workers[t], NULL);
+
+        freez(workers);
+    }
+
+    datafile_load_progress_log(state, true);
+}
+
 /* Returns number of datafiles that were loaded or < 0 on error */
 static int scan_data_files(struct rrdengine_instance *ctx)
 {
@@ -417,22 +515,27 @@ static int scan_data_files(struct rrdengine_instance *ctx)
     /* TODO: change this when tiering is implemented */
     ctx->atomic.last_fileno = datafiles[matched_files - 1]->fileno;
 
+    ctx->loading.progress.journalfiles = (size_t)matched_files;
+    ctx->loading.progress.started_ut = now_monotonic_usec();
+
+    struct datafile_load_state state = {
+        .ctx = ctx,
+        .jobs = callocz(matched_files, sizeof(struct datafile_load_job)),
+        .count = (size_t)matched_files,
+        .started_ut = ctx->loading.progress.started_ut,
+        .last_logged_ut = ctx->loading.progress.started_ut,
+    };
+
+    for (i = 0 ; i < matched_files ; ++i)
+        state.jobs[i].datafile = datafiles[i];
+
+    datafile_load_all(ctx, &state);
+
     for (failed_to_load = 0, i = 0 ; i < matched_files ; ++i) {
-        uint8_t must_delete_pair = 0;
+        datafile = state.jobs[i].datafile;
+        journalfile = state.jobs[i].journalfile;
 
-        datafile = datafiles[i];
-        ret = load_data_file(datafile);
-        if (0 != ret) {
-            must_delete_pair = 1;
-        }
-        journalfile = journalfile_alloc_and_init(datafile);
-        ret = journalfile_load(ctx, journalfile, datafile);
-        if (0 != ret) {
-            if (!must_delete_pair) /* If datafile is still open close it */
-                close_data_file(datafile);
-            must_delete_pair = 1;
-        }
-        if (must_delete_pair) {
+        if (state.jobs[i].failed) {
             char path[RRDENG_PATH_MAX];
 
             error("DBENGINE: deleting invalid data and journal file pair.");
@@ -452,9 +555,15 @@ static int scan_data_files(struct rrdengine_instance *ctx)
             continue;
         }
 
+        // the open cache migrates one datafile of a tier at a time
+        if (state.jobs[i].migrate_to_v2)
+            pgc_open_cache_to_journal_v2(open_cache, (Word_t) ctx, (int) datafile->fileno, ctx->config.page_type,
+                                         journalfile_migrate_to_v2_callback, (void *) journalfile);
+
         ctx_current_disk_space_increase(ctx, datafile->pos + journalfile->unsafe.pos);
         datafile_list_insert(ctx, datafile);
     }
+    freez(state.jobs);
     matched_files -= failed_to_load;
     freez(datafiles);
 
@@ -0,0 +1,317 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "gorilla.h"
+
+#define GORILLA_NO_WINDOW 0xFF
+
+static inline void gorilla_bits_write(uint32_t *data, uint32_t position, uint32_t value, uint8_t nbits) {
+    if(nbits < 32)
+        value &= (1U << nbits) - 1;
+
+    uint32_t idx = position >> 5;
+    uint32_t offset = position & 31;
+
+    data[idx] |= value << offset;
+
+    if(offset + nbits > 32)
+        data[idx + 1] |= value >> (32 - offset);
+}
+
+static inline uint32_t gorilla_bits_read(const uint32_t *data, uint32_t position, uint8_t nbits) {
+    uint32_t idx = position >> 5;
+    uint32_t offset = position & 31;
+
+    uint64_t value = data[idx] >> offset;
+
+    if(offset + nbits > 32)
+        value |= (uint64_t)data[idx + 1] << (32 - offset);
+
+    return (uint32_t)(value & ((1ULL << nbits) - 1));
+}
+
+// ----------------------------------------------------------------------------
+// writer
+
+void gorilla_writer_init(GORILLA_WRITER *gw, void *page, size_t page_size) {
+    internal_fatal(page_size < sizeof(GORILLA_PAGE_HEADER) + 2 * sizeof(uint32_t), "GORILLA: page is too small");
+
+    memset(page, 0, page_size);
+
+    gw->page = page;
+    gw->capacity_bits = (uint32_t)(((page_size - sizeof(GORILLA_PAGE_HEADER)) / sizeof(uint32_t)) * 32);
+    gw->prev_value = 0;
+    gw->prev_leading = GORILLA_NO_WINDOW;
+    gw->prev_trailing = GORILLA_NO_WINDOW;
+}
+
+bool gorilla_writer_append(GORILLA_WRITER *gw, uint32_t value) {
+    GORILLA_PAGE_HEADER *page = gw->page;
+    uint32_t position = page->nbits;
+
+    if(unlikely(gw->capacity_bits - position < GORILLA_MAX_BITS_PER_VALUE))
+        return false;
+
+    if(unlikely(!page->entries)) {
+        gorilla_bits_write(page->data, position, value, 32);
+        position += 32;
+    }
+    else {
+        uint32_t xor = value ^ gw->prev_value;
+
+        if(!xor) {
+            // the bit is already zero
+            position++;
+        }
+        else {
+            uint8_t leading = (uint8_t)__builtin_clz(xor);
+            uint8_t trailing = (uint8_t)__builtin_ctz(xor);
+
+            gorilla_bits_write(page->data, position++, 1, 1);
+
+            if(gw->prev_leading != GORILLA_NO_WINDOW && leading >= gw->prev_leading && trailing >= gw->prev_trailing) {
+                // fits in the previous window
+                uint8_t meaningful = 32 - gw->prev_leading - gw->prev_trailing;
+                position++; // the control bit is zero
+                gorilla_bits_write(page->data, position, xor >> gw->prev_trailing, meaningful);
+                position += meaningful;
+            }
+            else {
+                uint8_t meaningful = 32 - leading - trailing;
+                gorilla_bits_write(page->data, position++, 1, 1);
+                gorilla_bits_write(page->data, position, leading, 5);
+                position += 5;
+                gorilla_bits_write(page->data, position, meaningful - 1, 5);
+                position += 5;
+                gorilla_bits_write(page->data, position, xor >> trailing, meaningful);
+                position += meaningful;
+
+                gw->prev_leading = leading;
+                gw->prev_trailing = trailing;
+            }
+        }
+    }
+
+    gw->prev_value = value;
+
+    // readers of hot pages read the entries first, so nbits has to be published before them
+    __atomic_store_n(&page->nbits, position, __ATOMIC_RELEASE);
+    __atomic_store_n(&page->entries, page->entries + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// reader
+
+void gorilla_reader_init(GORILLA_READER *gr, const void *page, size_t page_length) {
+    const GORILLA_PAGE_HEADER *hdr = page;
+
+    gr->page = hdr;
+    gr->index = 0;
+    gr->position = 0;
+    gr->prev_value = 0;
+    gr->prev_leading = GORILLA_NO_WINDOW;
+    gr->prev_trailing = GORILLA_NO_WINDOW;
+
+    if(unlikely(page_length < sizeof(GORILLA_PAGE_HEADER))) {
+        gr->entries = 0;
+        return;
+    }
+
+    gr->entries = __atomic_load_n(&hdr->entries, __ATOMIC_ACQUIRE);
+}
+
+static inline bool gorilla_reader_has_bits(GORILLA_READER *gr, uint32_t nbits) {
+    return gr->position + nbits <= __atomic_load_n(&gr->page->nbits, __ATOMIC_ACQUIRE);
+}
+
+bool gorilla_reader_next(GORILLA_READER *gr, uint32_t *value) {
+    if(unlikely(gr->index >= gr->entries))
+        return false;
+
+    const uint32_t *data = gr->page->data;
+
+    if(unlikely(!gr->index)) {
+        if(unlikely(!gorilla_reader_has_bits(gr, 32)))
+            goto corrupted;
+
+        gr->prev_value = gorilla_bits_read(data, gr->position, 32);
+        gr->position += 32;
+    }
+    else {
+        if(unlikely(!gorilla_reader_has_bits(gr, 1)))
+            goto corrupted;
+
+        if(gorilla_bits_read(data, gr->position++, 1)) {
+            uint8_t meaningful;
+
+            if(unlikely(!gorilla_reader_has_bits(gr, 1)))
+                goto corrupted;
+
+            if(!gorilla_bits_read(data, gr->position++, 1)) {
+                if(unlikely(gr->prev_leading == GORILLA_NO_WINDOW))
+                    goto corrupted;
+
+                meaningful = 32 - gr->prev_leading - gr->prev_trailing;
+            }
+            else {
+                if(unlikely(!gorilla_reader_has_bits(gr, 10)))
+                    goto corrupted;
+
+                uint8_t leading = gorilla_bits_read(data, gr->position, 5);
+                gr->position += 5;
+                meaningful = gorilla_bits_read(data, gr->position, 5) + 1;
+                gr->position += 5;
+
+                if(unlikely(leading + meaningful > 32))
+                    goto corrupted;
+
+                gr->prev_leading = leading;
+                gr->prev_trailing = 32 - leading - meaningful;
+            }
+
+            if(unlikely(!gorilla_reader_has_bits(gr, meaningful)))
+                goto corrupted;
+
+            uint32_t xor = gorilla_bits_read(data, gr->position, meaningful) << gr->prev_trailing;
+            gr->position += meaningful;
+            gr->prev_value ^= xor;
+        }
+    }
+
+    gr->index++;
+    *value = gr->prev_value;
+    return true;
+
+corrupted:
+    // do not try again on this page
+    gr->entries = gr->index;
+    return false;
+}
+
+size_t gorilla_reader_skip(GORILLA_READER *gr, size_t values) {
+    uint32_t value;
+    size_t skipped = 0;
+
+    while(skipped < values && gorilla_reader_next(gr, &value))
+        skipped++;
+
+    return skipped;
+}
+
+// ----------------------------------------------------------------------------
+// whole page conversions
+
+size_t gorilla_page_decode(const void *page, size_t page_length, uint32_t *values, size_t max_values) {
+    GORILLA_READER gr;
+    gorilla_reader_init(&gr, page, page_length);
+
+    size_t entries = 0;
+    while(entries < max_values && gorilla_reader_next(&gr, &values[entries]))
+        entries++;
+
+    return entries;
+}
+
+size_t gorilla_page_encode(void *page, size_t page_size, const uint32_t *values, size_t entries) {
+    GORILLA_WRITER gw;
+    gorilla_writer_init(&gw, page, page_size);
+
+    size_t i;
+    for(i = 0; i < entries ;i++) {
+        if(!gorilla_writer_append(&gw, values[i]))
+            break;
+    }
+
+    return i;
+}
+
+// ----------------------------------------------------------------------------
+// unittest
+
+static int gorilla_unittest_series(const char *name, const uint32_t *values, size_t entries, size_t page_size) {
+    void *page = mallocz(page_size);
+    uint32_t *decoded = mallocz(entries * sizeof(uint32_t));
+    int errors = 0;
+
+    size_t encoded = gorilla_page_encode(page, page_size, values, entries);
+    size_t decoded_entries = gorilla_page_decode(page, gorilla_page_length(page), decoded, entries);
+
+    if(decoded_entries != encoded) {
+        fprintf(stderr, "GORILLA: %s: encoded %zu values, but decoded %zu\n", name, encoded, decoded_entries);
+        errors++;
+    }
+
+    for(size_t i = 0; i < decoded_entries ;i++) {
+        if(decoded[i] != values[i]) {
+            fprintf(stderr, "GORILLA: %s: value %zu is 0x%08x, expected 0x%08x\n", name, i, decoded[i], values[i]);
+            errors++;
+            break;
+        }
+    }
+
+    GORILLA_READER gr;
+    uint32_t v;
+    gorilla_reader_init(&gr, page, gorilla_page_length(page));
+    if(encoded > 2 && (gorilla_reader_skip(&gr, encoded / 2) != encoded / 2 || !gorilla_reader_next(&gr, &v) || v != values[encoded / 2])) {
+        fprintf(stderr, "GORILLA: %s: skipping values does not work\n", name);
+        errors++;
+    }
+
+    fprintf(stderr, "GORILLA: %s: %zu of %zu values in %zu bytes (%0.2f bits per value) - %s\n",
+            name, encoded, entries, (size_t)gorilla_page_length(page),
+            encoded ? (double)((GORILLA_PAGE_HEADER *)page)->nbits / (double)encoded : 0.0,
+            errors ? "FAILED" : "OK");
+
+    freez(decoded);
+    freez(page);
+    return errors;
+}
+
+int gorilla_unittest(void) {
+    const size_t entries = 1024;
+    const size_t page_size = entries * sizeof(uint32_t);
+    uint32_t *values = mallocz(entries * sizeof(uint32_t));
+    int errors = 0;
+
+    for(size_t i = 0; i < entries ;i++)
+        values[i] = pack_storage_number(42.0, SN_DEFAULT_FLAGS);
+    errors += gorilla_unittest_series("constant", values, entries, page_size);
+
+    {
+        // hot pages are sized for the expected bits per value, so a constant series has to fit
+        size_t hot_page_size = gorilla_page_size_for_entries(entries);
+        void *page = mallocz(hot_page_size);
+        size_t encoded = gorilla_page_encode(page, hot_page_size, values, entries);
+        if(encoded != entries) {
+            fprintf(stderr, "GORILLA: hot page of %zu bytes got %zu of %zu constant values - FAILED\n", hot_page_size, encoded, entries);
+            errors++;
+        }
+        freez(page);
+    }
+
+    for(size_t i = 0; i < entries ;i++)
+        values[i] = pack_storage_number((NETDATA_DOUBLE)i, SN_DEFAULT_FLAGS);
+    errors += gorilla_unittest_series("counter", values, entries, page_size);
+
+    for(size_t i = 0; i < entries ;i++)
+        values[i] = pack_storage_number((NETDATA_DOUBLE)(i % 7) * 1.5, SN_DEFAULT_FLAGS);
+    errors += gorilla_unittest_series("periodic", values, entries, page_size);
+
+    for(size_t i = 0; i < entries ;i++)
+        values[i] = (i % 3) ? SN_EMPTY_SLOT : pack_storage_number((NETDATA_DOUBLE)random(), SN_DEFAULT_FLAGS);
+    errors += gorilla_unittest_series("gaps", values, entries, page_size);
+
+    for(size_t i = 0; i < entries ;i++)
+        values[i] = (uint32_t)random() ^ ((uint32_t)random() << 16);
+    errors += gorilla_unittest_series("random", values, entries, page_size);
+
+    values[0] = 0xFFFFFFFF;
+    values[1] = 0;
+    values[2] = 0xFFFFFFFF;
+    values[3] = 0x80000001;
+    errors += gorilla_unittest_series("edges", values, 4, page_size);
+
+    freez(values);
+    return errors;
+}
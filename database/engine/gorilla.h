@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DBENGINE_GORILLA_H
+#define NETDATA_DBENGINE_GORILLA_H
+
+#include "libnetdata/libnetdata.h"
+
+// ----------------------------------------------------------------------------
+// Gorilla (XOR) encoding of tier 0 storage_number pages
+//
+// The page starts with a small header, followed by a bitstream of 32-bit words.
+// The first value is stored verbatim. Each following value is XORed with the
+// previous one and:
+//
+//  - '0'                                 the value is the same as the previous
+//  - '10' + meaningful bits              the XOR fits in the previous leading/trailing zeros window
+//  - '11' + 5 bits leading zeros
+//         + 5 bits (meaningful bits - 1)
+//         + meaningful bits              a new window is started
+//
+// So a value costs from 1 to GORILLA_MAX_BITS_PER_VALUE bits.
+// The header is updated after every append, so that queries can read hot pages.
+
+#define GORILLA_MAX_BITS_PER_VALUE (1 + 1 + 5 + 5 + 32)
+
+// Hot pages are allocated for this many bits per value, so that they hold more points
+// than raw pages of the same size. Pages of values that do not compress that well are
+// flushed when they run out of room, before they reach their number of points.
+#define GORILLA_EXPECTED_BITS_PER_VALUE 16
+
+typedef struct gorilla_page_header {
+    uint32_t entries;               // the number of values in the page
+    uint32_t nbits;                 // the number of bits used in data[]
+    uint32_t data[];
+} GORILLA_PAGE_HEADER;
+
+typedef struct gorilla_writer {
+    GORILLA_PAGE_HEADER *page;
+    uint32_t capacity_bits;
+    uint32_t prev_value;
+    uint8_t prev_leading;
+    uint8_t prev_trailing;
+} GORILLA_WRITER;
+
+typedef struct gorilla_reader {
+    const GORILLA_PAGE_HEADER *page;
+    uint32_t entries;
+    uint32_t index;
+    uint32_t position;              // in bits
+    uint32_t prev_value;
+    uint8_t prev_leading;
+    uint8_t prev_trailing;
+} GORILLA_READER;
+
+#define gorilla_page_length(page) (sizeof(GORILLA_PAGE_HEADER) + ((((GORILLA_PAGE_HEADER *)(page))->nbits + 31) / 32) * sizeof(uint32_t))
+#define gorilla_page_entries(page) __atomic_load_n(&((GORILLA_PAGE_HEADER *)(page))->entries, __ATOMIC_ACQUIRE)
+
+// the size of a page expected to fit this many values (and at least one value of any size)
+#define gorilla_page_size_for_entries(entries) (sizeof(GORILLA_PAGE_HEADER) + \
+        (((size_t)(entries) * GORILLA_EXPECTED_BITS_PER_VALUE + GORILLA_MAX_BITS_PER_VALUE + 31) / 32) * sizeof(uint32_t))
+
+void gorilla_writer_init(GORILLA_WRITER *gw, void *page, size_t page_size);
+bool gorilla_writer_append(GORILLA_WRITER *gw, uint32_t value);
+
+static inline bool gorilla_writer_has_room(GORILLA_WRITER *gw) {
+    return gw->capacity_bits - gw->page->nbits >= GORILLA_MAX_BITS_PER_VALUE;
+}
+
+void gorilla_reader_init(GORILLA_READER *gr, const void *page, size_t page_length);
+bool gorilla_reader_next(GORILLA_READER *gr, uint32_t *value);
+size_t gorilla_reader_skip(GORILLA_READER *gr, size_t values);
+
+size_t gorilla_page_decode(const void *page, size_t page_length, uint32_t *values, size_t max_values);
+size_t gorilla_page_encode(void *page, size_t page_size, const uint32_t *values, size_t entries);
+
+int gorilla_unittest(void);
+
+#endif //NETDATA_DBENGINE_GORILLA_H
@@ -0,0 +1,334 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "iouring.h"
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#endif
+
+RRDENG_IO_BACKEND rrdeng_io_backend = RRDENG_IO_BACKEND_LIBUV;
+
+RRDENG_IO_BACKEND rrdeng_io_backend_id(const char *name) {
+    if(strcmp(name, "io_uring") == 0 || strcmp(name, "io-uring") == 0)
+        return RRDENG_IO_BACKEND_IO_URING;
+
+    if(strcmp(name, "libuv") != 0)
+        error("DBENGINE: unknown io backend '%s', assuming '%s'", name, rrdeng_io_backend_name(RRDENG_IO_BACKEND_LIBUV));
+
+    return RRDENG_IO_BACKEND_LIBUV;
+}
+
+const char *rrdeng_io_backend_name(RRDENG_IO_BACKEND backend) {
+    switch(backend) {
+        case RRDENG_IO_BACKEND_IO_URING:
+            return "io_uring";
+
+        default:
+        case RRDENG_IO_BACKEND_LIBUV:
+            return "libuv";
+    }
+}
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+
+// ----------------------------------------------------------------------------
+// a minimal ring, driven by the raw system calls
+
+struct rrdeng_io_ring {
+    int fd;
+
+    struct {
+        unsigned *head;
+        unsigned *tail;
+        unsigned *mask;
+        unsigned *array;
+        unsigned entries;
+        struct io_uring_sqe *sqes;
+    } sq;
+
+    struct {
+        unsigned *head;
+        unsigned *tail;
+        unsigned *mask;
+        struct io_uring_cqe *cqes;
+    } cq;
+
+    struct {
+        void *sq_ptr;
+        size_t sq_size;
+        void *cq_ptr;
+        size_t cq_size;
+        size_t sqes_size;
+    } mmap;
+
+    struct iovec iov[RRDENG_IO_URING_QUEUE_DEPTH];
+};
+
+static pthread_key_t rrdeng_io_ring_key;
+
+static inline int sys_io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static void rrdeng_io_ring_destroy(struct rrdeng_io_ring *ring) {
+    if(ring->sq.sqes)
+        munmap(ring->sq.sqes, ring->mmap.sqes_size);
+
+    if(ring->mmap.cq_ptr && ring->mmap.cq_ptr != ring->mmap.sq_ptr)
+        munmap(ring->mmap.cq_ptr, ring->mmap.cq_size);
+
+    if(ring->mmap.sq_ptr)
+        munmap(ring->mmap.sq_ptr, ring->mmap.sq_size);
+
+    if(ring->fd != -1)
+        close(ring->fd);
+
+    freez(ring);
+}
+
+static void rrdeng_io_ring_thread_exit(void *ptr) {
+    if(ptr)
+        rrdeng_io_ring_destroy(ptr);
+}
+
+static struct rrdeng_io_ring *rrdeng_io_ring_create(void) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+
+    struct rrdeng_io_ring *ring = callocz(1, sizeof(*ring));
+    ring->fd = sys_io_uring_setup(RRDENG_IO_URING_QUEUE_DEPTH, &p);
+    if(ring->fd < 0)
+        goto failed;
+
+    ring->mmap.sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->mmap.cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+
+    bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if(p.features & IORING_FEAT_SINGLE_MMAP) {
+        single_mmap = true;
+        ring->mmap.sq_size = ring->mmap.cq_size = MAX(ring->mmap.sq_size, ring->mmap.cq_size);
+    }
+#endif
+
+    ring->mmap.sq_ptr = mmap(NULL, ring->mmap.sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if(ring->mmap.sq_ptr == MAP_FAILED) {
+        ring->mmap.sq_ptr = NULL;
+        goto failed;
+    }
+
+    if(single_mmap)
+        ring->mmap.cq_ptr = ring->mmap.sq_ptr;
+    else {
+        ring->mmap.cq_ptr = mmap(NULL, ring->mmap.cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if(ring->mmap.cq_ptr == MAP_FAILED) {
+            ring->mmap.cq_ptr = NULL;
+            goto failed;
+        }
+    }
+
+    ring->mmap.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sq.sqes = mmap(NULL, ring->mmap.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if(ring->sq.sqes == MAP_FAILED) {
+        ring->sq.sqes = NULL;
+        goto failed;
+    }
+
+    uint8_t *sq = ring->mmap.sq_ptr;
+    ring->sq.head    = (unsigned *)(sq + p.sq_off.head);
+    ring->sq.tail    = (unsigned *)(sq + p.sq_off.tail);
+    ring->sq.mask    = (unsigned *)(sq + p.sq_off.ring_mask);
+    ring->sq.array   = (unsigned *)(sq + p.sq_off.array);
+    ring->sq.entries = MIN(p.sq_entries, RRDENG_IO_URING_QUEUE_DEPTH);
+
+    uint8_t *cq = ring->mmap.cq_ptr;
+    ring->cq.head = (unsigned *)(cq + p.cq_off.head);
+    ring->cq.tail = (unsigned *)(cq + p.cq_off.tail);
+    ring->cq.mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    ring->cq.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    return ring;
+
+failed:
+    {
+        int saved_errno = errno;
+        rrdeng_io_ring_destroy(ring);
+        errno = saved_errno;
+    }
+    return NULL;
+}
+
+static struct rrdeng_io_ring *rrdeng_io_ring_get(void) {
+    static __thread bool failed = false;
+
+    if(unlikely(failed))
+        return NULL;
+
+    struct rrdeng_io_ring *ring = pthread_getspecific(rrdeng_io_ring_key);
+    if(unlikely(!ring)) {
+        ring = rrdeng_io_ring_create();
+        if(!ring) {
+            failed = true;
+            error_limit_static_global_var(erl, 1, 0);
+            error_limit(&erl, "DBENGINE: cannot create an io_uring for thread %d, using libuv for its I/O", gettid());
+            return NULL;
+        }
+
+        pthread_setspecific(rrdeng_io_ring_key, ring);
+    }
+
+    return ring;
+}
+
+static inline unsigned rrdeng_io_ring_reap(struct rrdeng_io_ring *ring, RRDENG_IO_REQUEST *requests) {
+    unsigned completed = 0;
+    unsigned head = *ring->cq.head;
+    unsigned tail = __atomic_load_n(ring->cq.tail, __ATOMIC_ACQUIRE);
+    unsigned mask = *ring->cq.mask;
+
+    while(head != tail) {
+        struct io_uring_cqe *cqe = &ring->cq.cqes[head & mask];
+        requests[cqe->user_data].result = cqe->res;
+        completed++;
+        head++;
+    }
+
+    __atomic_store_n(ring->cq.head, head, __ATOMIC_RELEASE);
+    return completed;
+}
+
+static bool rrdeng_io_ring_run(struct rrdeng_io_ring *ring, RRDENG_IO_REQUEST *requests, unsigned count) {
+    unsigned tail = *ring->sq.tail;
+    unsigned mask = *ring->sq.mask;
+
+    for(unsigned i = 0; i < count ;i++) {
+        unsigned index = tail & mask;
+        struct io_uring_sqe *sqe = &ring->sq.sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+
+        ring->iov[i].iov_base = requests[i].buffer;
+        ring->iov[i].iov_len = requests[i].size;
+
+        sqe->opcode = requests[i].write ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe->fd = requests[i].fd;
+        sqe->addr = (uint64_t)(uintptr_t)&ring->iov[i];
+        sqe->len = 1;
+        sqe->off = requests[i].offset;
+        sqe->user_data = i;
+
+        ring->sq.array[index] = index;
+        requests[i].result = -ECANCELED;
+        tail++;
+    }
+
+    // the kernel must see the entries before the new tail
+    __atomic_store_n(ring->sq.tail, tail, __ATOMIC_RELEASE);
+
+    unsigned submitted = 0, completed = 0;
+    while(completed < count) {
+        int ret = sys_io_uring_enter(ring->fd, count - submitted, count - completed, IORING_ENTER_GETEVENTS);
+        if(ret < 0) {
+            if(errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+
+            if(!completed && !submitted) {
+                // nothing has been consumed by the kernel, take the entries back
+                __atomic_store_n(ring->sq.tail, tail - count, __ATOMIC_RELEASE);
+                return false;
+            }
+
+            // some requests are in flight, they have to be waited for
+            error_limit_static_global_var(erl, 1, 0);
+            error_limit(&erl, "DBENGINE: io_uring_enter() failed with %u of %u requests completed", completed, count);
+            sleep_usec(1000);
+        }
+        else
+            submitted += (unsigned)ret;
+
+        if(submitted > count)
+            submitted = count;
+
+        completed += rrdeng_io_ring_reap(ring, requests);
+    }
+
+    return true;
+}
+
+bool rrdeng_io_uring_submit_and_wait(RRDENG_IO_REQUEST *requests, size_t count) {
+    struct rrdeng_io_ring *ring = rrdeng_io_ring_get();
+    if(unlikely(!ring))
+        return false;
+
+    for(size_t done = 0; done < count ;) {
+        unsigned batch = (unsigned)MIN(count - done, ring->sq.entries);
+
+        if(!rrdeng_io_ring_run(ring, &requests[done], batch)) {
+            if(done) {
+                // the first part has been done - fail the rest, instead of mixing backends
+                for(; done < count; done++)
+                    requests[done].result = -EIO;
+
+                return true;
+            }
+
+            return false;
+        }
+
+        done += batch;
+    }
+
+    return true;
+}
+
+RRDENG_IO_BACKEND rrdeng_io_backend_init(RRDENG_IO_BACKEND backend) {
+    static bool key_created = false;
+
+    if(backend == RRDENG_IO_BACKEND_IO_URING) {
+        if(!key_created) {
+            if(pthread_key_create(&rrdeng_io_ring_key, rrdeng_io_ring_thread_exit) != 0) {
+                error("DBENGINE: cannot create the thread key for io_uring, using libuv");
+                backend = RRDENG_IO_BACKEND_LIBUV;
+            }
+            else
+                key_created = true;
+        }
+
+        if(key_created) {
+            // probe the kernel with a ring of our own
+            struct rrdeng_io_ring *ring = rrdeng_io_ring_create();
+            if(ring) {
+                rrdeng_io_ring_destroy(ring);
+                info("DBENGINE: using io_uring for extent I/O");
+            }
+            else {
+                error("DBENGINE: io_uring is not available (%s), using libuv", strerror(errno));
+                backend = RRDENG_IO_BACKEND_LIBUV;
+            }
+        }
+    }
+
+    rrdeng_io_backend = backend;
+    return backend;
+}
+
+#else // !HAVE_LINUX_IO_URING_H
+
+bool rrdeng_io_uring_submit_and_wait(RRDENG_IO_REQUEST *requests __maybe_unused, size_t count __maybe_unused) {
+    return false;
+}
+
+RRDENG_IO_BACKEND rrdeng_io_backend_init(RRDENG_IO_BACKEND backend) {
+    if(backend == RRDENG_IO_BACKEND_IO_URING)
+        error("DBENGINE: this netdata has been compiled without io_uring support, using libuv");
+
+    rrdeng_io_backend = RRDENG_IO_BACKEND_LIBUV;
+    return rrdeng_io_backend;
+}
+
+#endif // HAVE_LINUX_IO_URING_H
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DBENGINE_IOURING_H
+#define NETDATA_DBENGINE_IOURING_H
+
+#include "libnetdata/libnetdata.h"
+
+// ----------------------------------------------------------------------------
+// io_uring backend for dbengine extent I/O
+//
+// Every thread doing extent I/O gets its own small ring, so that submission
+// and completion queues need no locking. A batch of requests is submitted
+// with a single io_uring_enter(), which also waits for all of them to complete.
+// When the kernel does not support io_uring (or it is blocked, e.g. by seccomp)
+// dbengine keeps using libuv.
+
+#define RRDENG_IO_URING_QUEUE_DEPTH 32
+
+typedef enum __attribute__ ((__packed__)) {
+    RRDENG_IO_BACKEND_LIBUV = 0,
+    RRDENG_IO_BACKEND_IO_URING,
+} RRDENG_IO_BACKEND;
+
+extern RRDENG_IO_BACKEND rrdeng_io_backend;
+
+typedef struct rrdeng_io_request {
+    int fd;
+    bool write;
+    void *buffer;
+    unsigned size;
+    uint64_t offset;
+    ssize_t result;                 // the bytes transferred, or -errno
+} RRDENG_IO_REQUEST;
+
+RRDENG_IO_BACKEND rrdeng_io_backend_id(const char *name);
+const char *rrdeng_io_backend_name(RRDENG_IO_BACKEND backend);
+
+// returns the backend that will actually be used
+RRDENG_IO_BACKEND rrdeng_io_backend_init(RRDENG_IO_BACKEND backend);
+
+static inline bool rrdeng_io_uring_enabled(void) {
+    return rrdeng_io_backend == RRDENG_IO_BACKEND_IO_URING;
+}
+
+// false when the calling thread cannot use io_uring - the caller should use libuv for these requests
+bool rrdeng_io_uring_submit_and_wait(RRDENG_IO_REQUEST *requests, size_t count);
+
+#endif //NETDATA_DBENGINE_IOURING_H
@@ -69,7 +69,13 @@ static void after_extent_write_journalfile_v1_io(uv_fs_t* req)
     }
 
     uv_fs_req_cleanup(req);
-    wal_release(wal);
+
+    // the WALs written together with this one
+    while(wal) {
+        WAL *next = wal->group_next;
+        wal_release(wal);
+        wal = next;
+    }
 
     __atomic_sub_fetch(&ctx->atomic.extents_currently_being_flushed, 1, __ATOMIC_RELAXED);
 
@@ -82,32 +88,43 @@ void journalfile_v1_extent_write(struct rrdengine_instance *ctx, struct rrdengin
     int ret;
     struct generic_io_descriptor *io_descr;
     struct rrdengine_journalfile *journalfile = datafile->journalfile;
+    uv_buf_t iov[MAX_EXTENTS_PER_FLUSH];
+    unsigned count = 0;
+    size_t bytes = 0;
+
+    // all the WALs of the extents written together, are written with one request
+    for(WAL *w = wal; w ;w = w->group_next) {
+        internal_fatal(count >= MAX_EXTENTS_PER_FLUSH, "DBENGINE: too many WALs in a journal write");
+
+        if (w->size < w->buf_size) {
+            /* simulate an empty transaction to skip the rest of the block */
+            *(uint8_t *) (w->buf + w->size) = STORE_PADDING;
+        }
+        iov[count++] = uv_buf_init((void *)w->buf, w->buf_size);
+        bytes += w->buf_size;
+    }
 
     io_descr = &wal->io_descr;
     io_descr->ctx = ctx;
-    if (wal->size < wal->buf_size) {
-        /* simulate an empty transaction to skip the rest of the block */
-        *(uint8_t *) (wal->buf + wal->size) = STORE_PADDING;
-    }
     io_descr->buf = wal->buf;
-    io_descr->bytes = wal->buf_size;
+    io_descr->bytes = bytes;
 
     netdata_spinlock_lock(&journalfile->unsafe.spinlock);
     io_descr->pos = journalfile->unsafe.pos;
-    journalfile->unsafe.pos += wal->buf_size;
+    journalfile->unsafe.pos += bytes;
     netdata_spinlock_unlock(&journalfile->unsafe.spinlock);
 
     io_descr->req.data = wal;
     io_descr->data = journalfile;
     io_descr->completion = NULL;
 
-    io_descr->iov = uv_buf_init((void *)io_descr->buf, wal->buf_size);
-    ret = uv_fs_write(loop, &io_descr->req, journalfile->file, &io_descr->iov, 1,
+    io_descr->iov = iov[0];
+    ret = uv_fs_write(loop, &io_descr->req, journalfile->file, iov, count,
                       (int64_t)io_descr->pos, after_extent_write_journalfile_v1_io);
     fatal_assert(-1 != ret);
 
-    ctx_current_disk_space_increase(ctx, wal->buf_size);
-    ctx_io_write_op_bytes(ctx, wal->buf_size);
+    ctx_current_disk_space_increase(ctx, bytes);
+    ctx_io_write_op_bytes(ctx, bytes);
 }
 
 void journalfile_v2_generate_path(struct rrdengine_datafile *datafile, char *str, size_t maxlen)
@@ -751,6 +768,104 @@ static uint64_t journalfile_iterate_transactions(struct rrdengine_instance *ctx,
     return max_id;
 }
 
+// ----------------------------------------------------------------------------
+// metric filter (blocked bloom filter of the metric UUIDs)
+
+static inline uint64_t journalfile_v2_filter_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline uint64_t *journalfile_v2_filter_block(const uint8_t *filter, uint32_t filter_size, const uuid_t *uuid, uint64_t *bits_hash) {
+    uint64_t a, b;
+    memcpy(&a, &((const uint8_t *)uuid)[0], sizeof(a));
+    memcpy(&b, &((const uint8_t *)uuid)[sizeof(a)], sizeof(b));
+
+    // UUIDs are mostly random, but not all their bits are (version, variant)
+    uint64_t h1 = journalfile_v2_filter_mix(a ^ (b * 0x9E3779B97F4A7C15ULL));
+    *bits_hash = journalfile_v2_filter_mix(b ^ h1);
+
+    uint64_t blocks = filter_size / JOURNAL_V2_FILTER_BLOCK_SIZE;
+    uint64_t block = ((h1 >> 32) * blocks) >> 32;
+    return (uint64_t *)(filter + block * JOURNAL_V2_FILTER_BLOCK_SIZE);
+}
+
+static inline uint32_t journalfile_v2_filter_size(size_t number_of_metrics) {
+    if(!number_of_metrics)
+        return 0;
+
+    size_t block_bits = JOURNAL_V2_FILTER_BLOCK_SIZE * 8;
+    size_t blocks = (number_of_metrics * JOURNAL_V2_FILTER_BITS_PER_METRIC + block_bits - 1) / block_bits;
+    return (uint32_t)(blocks * JOURNAL_V2_FILTER_BLOCK_SIZE);
+}
+
+static void journalfile_v2_filter_add(uint8_t *filter, uint32_t filter_size, const uuid_t *uuid) {
+    uint64_t bits_hash;
+    uint64_t *block = journalfile_v2_filter_block(filter, filter_size, uuid, &bits_hash);
+
+    for(size_t i = 0; i < JOURNAL_V2_FILTER_HASHES ;i++) {
+        uint32_t bit = (uint32_t)(bits_hash >> (i * 9)) & 511;
+        block[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+// false when the metric is definitely not in this journal
+bool journalfile_v2_metric_may_exist(struct journal_v2_header *j2_header, uuid_t *uuid) {
+    if(unlikely(!j2_header->filter_size))
+        return true;
+
+    uint64_t bits_hash;
+    const uint64_t *block = journalfile_v2_filter_block((uint8_t *)j2_header + j2_header->filter_offset,
+                                                       j2_header->filter_size, (const uuid_t *)uuid, &bits_hash);
+
+    for(size_t i = 0; i < JOURNAL_V2_FILTER_HASHES ;i++) {
+        uint32_t bit = (uint32_t)(bits_hash >> (i * 9)) & 511;
+        if(!(block[bit >> 6] & (1ULL << (bit & 63))))
+            return false;
+    }
+
+    return true;
+}
+
+static uLong journalfile_v2_filter_crc(struct journal_v2_header *j2_header, void *data_start) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (void *)&j2_header->filter_offset, sizeof(j2_header->filter_offset));
+    crc = crc32(crc, (void *)&j2_header->filter_size, sizeof(j2_header->filter_size));
+    crc = crc32(crc, (uint8_t *)data_start + j2_header->filter_offset, j2_header->filter_size);
+    return crc;
+}
+
+// Checks that the metric filter (if any) is within the file and its checksum is valid
+static int journalfile_check_v2_filter(void *data_start, size_t file_size)
+{
+    struct journal_v2_header *j2_header = (void *) data_start;
+
+    if(!j2_header->filter_offset && !j2_header->filter_size)
+        return 0;
+
+    if(j2_header->filter_size % JOURNAL_V2_FILTER_BLOCK_SIZE ||
+       j2_header->filter_offset % JOURNAL_V2_FILTER_BLOCK_SIZE ||
+       j2_header->filter_offset < RRDENG_BLOCK_SIZE ||
+       (uint64_t)j2_header->filter_offset + j2_header->filter_size + 2 * sizeof(struct journal_v2_block_trailer) > file_size) {
+        error("DBENGINE: metric filter is out of bounds: FAILED");
+        return 1;
+    }
+
+    struct journal_v2_block_trailer *journal_v2_trailer =
+        (struct journal_v2_block_trailer *) ((uint8_t *) data_start + j2_header->filter_offset + j2_header->filter_size);
+
+    if (unlikely(crc32cmp(journal_v2_trailer->checksum, journalfile_v2_filter_crc(j2_header, data_start)))) {
+        error("DBENGINE: metric filter CRC32 check: FAILED");
+        return 1;
+    }
+
+    return 0;
+}
+
 // Checks that the extent list checksum is valid
 static int journalfile_check_v2_extent_list (void *data_start, size_t file_size)
 {
@@ -797,7 +912,7 @@ static int journalfile_check_v2_metric_list(void *data_start, size_t file_size)
 //   2 Force rebuild
 //   3 skip
 
-static int journalfile_v2_validate(void *data_start, size_t journal_v2_file_size, size_t journal_v1_file_size)
+int journalfile_v2_validate(void *data_start, size_t journal_v2_file_size, size_t journal_v1_file_size)
 {
     int rc;
     uLong crc;
@@ -824,7 +939,7 @@ static int journalfile_v2_validate(void *data_start, size_t journal_v2_file_size
     journal_v2_trailer = (struct journal_v2_block_trailer *) ((uint8_t *) data_start + journal_v2_file_size - sizeof(*journal_v2_trailer));
 
     crc = crc32(0L, Z_NULL, 0);
-    crc = crc32(crc, (void *) j2_header, sizeof(*j2_header));
+    crc = crc32(crc, (void *) j2_header, JOURNAL_V2_HEADER_CRC_SZ);
 
     rc = crc32cmp(journal_v2_trailer->checksum, crc);
     if (unlikely(rc)) {
@@ -838,6 +953,9 @@ static int journalfile_v2_validate(void *data_start, size_t journal_v2_file_size
     rc = journalfile_check_v2_metric_list(data_start, journal_v2_file_size);
     if (rc) return 1;
 
+    rc = journalfile_check_v2_filter(data_start, journal_v2_file_size);
+    if (rc) return 1;
+
     if (!db_engine_journal_check)
         return 0;
 
@@ -934,6 +1052,7 @@ void journalfile_v2_populate_retention_to_mrg(struct rrdengine_instance *ctx, st
     }
 
     journalfile_v2_data_release(journalfile);
+    __atomic_add_fetch(&ctx->loading.progress.journalfiles_populated, 1, __ATOMIC_RELAXED);
     usec_t ended_ut = now_monotonic_usec();
 
     info("DBENGINE: journal v2 of tier %d, datafile %u populated, size: %0.2f MiB, metrics: %0.2f k, %0.2f ms"
@@ -977,7 +1096,7 @@ int journalfile_v2_load(struct rrdengine_instance *ctx, struct rrdengine_journal
 
     journal_v2_file_size = (size_t)statbuf.st_size;
 
-    if (journal_v2_file_size < sizeof(struct journal_v2_header)) {
+    if (journal_v2_file_size < JOURNAL_V2_HEADER_CRC_SZ) {
         error_report("Invalid file %s. Not the expected size", path_v2);
         close(fd);
         return 1;
@@ -1221,6 +1340,15 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
     uint32_t pages_offset = total_file_size;
     total_file_size  += (number_of_pages * (sizeof(struct journal_page_list) + sizeof(struct journal_page_header) + sizeof(struct journal_v2_block_trailer)));
 
+    // metric filter, aligned to cache lines, and its trailer
+    uint32_t filter_size = journalfile_v2_filter_size(number_of_metrics);
+    uint32_t filter_offset = 0;
+    if(filter_size) {
+        total_file_size = (total_file_size + JOURNAL_V2_FILTER_BLOCK_SIZE - 1) / JOURNAL_V2_FILTER_BLOCK_SIZE * JOURNAL_V2_FILTER_BLOCK_SIZE;
+        filter_offset = total_file_size;
+        total_file_size  += filter_size + sizeof(struct journal_v2_block_trailer);
+    }
+
     // File trailer
     uint32_t trailer_offset = total_file_size;
     total_file_size  += sizeof(struct journal_v2_block_trailer);
@@ -1231,6 +1359,9 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
 
     memset(data_start, 0, extent_offset);
 
+    if(filter_size)
+        memset(data_start + filter_offset, 0, filter_size);
+
     // Write header
     struct journal_v2_header j2_header;
     memset(&j2_header, 0, sizeof(j2_header));
@@ -1248,6 +1379,8 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
     j2_header.metric_trailer_offset = metric_offset_trailer;
     j2_header.journal_v2_file_size = total_file_size;
     j2_header.journal_v1_file_size = (uint32_t)journalfile_current_size(journalfile);
+    j2_header.filter_offset = filter_offset;
+    j2_header.filter_size = filter_size;
     j2_header.data = data_start;                        // Used during migration
 
     struct journal_v2_block_trailer *journal_v2_trailer;
@@ -1282,6 +1415,9 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
 
         fatal_assert(count < number_of_metrics);
         uuid_list[count++].metric_info = metric_info;
+
+        if(filter_size)
+            journalfile_v2_filter_add(data_start + filter_offset, filter_size, metric_info->uuid);
         min_time_s = MIN(min_time_s, metric_info->first_time_s);
         max_time_s = MAX(max_time_s, metric_info->last_time_s);
     }
@@ -1347,11 +1483,17 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
         crc32set(journal_v2_trailer->checksum, crc);
         internal_error(true, "DBENGINE: CALCULATE CRC FOR UUIDs  %llu", (now_monotonic_usec() - start_loading) / USEC_PER_MS);
 
+        // Calculate CRC for the metric filter
+        if(filter_size) {
+            journal_v2_trailer = (struct journal_v2_block_trailer *)(data_start + filter_offset + filter_size);
+            crc32set(journal_v2_trailer->checksum, journalfile_v2_filter_crc(&j2_header, data_start));
+        }
+
         // Prepare to write checksum for the file
         j2_header.data = NULL;
         journal_v2_trailer = (struct journal_v2_block_trailer *)(data_start + trailer_offset);
         crc = crc32(0L, Z_NULL, 0);
-        crc = crc32(crc, (void *)&j2_header, sizeof(j2_header));
+        crc = crc32(crc, (void *)&j2_header, JOURNAL_V2_HEADER_CRC_SZ);
         crc32set(journal_v2_trailer->checksum, crc);
 
         // Write header to the file
@@ -1393,8 +1535,9 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
         ctx_current_disk_space_increase(ctx, resize_file_to);
 }
 
+// migrate_to_v2 is set when the caller has to index the replayed journal to v2
 int journalfile_load(struct rrdengine_instance *ctx, struct rrdengine_journalfile *journalfile,
-                     struct rrdengine_datafile *datafile)
+                     struct rrdengine_datafile *datafile, bool *migrate_to_v2)
 {
     uv_fs_t req;
     uv_file file;
@@ -1403,10 +1546,15 @@ int journalfile_load(struct rrdengine_instance *ctx, struct rrdengine_journalfil
     char path[RRDENG_PATH_MAX];
     bool loaded_v2 = false;
 
+    *migrate_to_v2 = false;
+
     // Do not try to load jv2 of the latest file
     if (datafile->fileno != ctx_last_fileno_get(ctx))
         loaded_v2 = journalfile_v2_load(ctx, journalfile, datafile) == 0;
 
+    if (loaded_v2)
+        __atomic_add_fetch(&ctx->loading.progress.journalfiles_v2_loaded, 1, __ATOMIC_RELAXED);
+
     journalfile_v1_generate_path(datafile, path, sizeof(path));
 
     fd = open_file_for_io(path, O_RDWR, &file, use_direct_io);
@@ -1447,7 +1595,13 @@ int journalfile_load(struct rrdengine_instance *ctx, struct rrdengine_journalfil
 
     max_id = journalfile_iterate_transactions(ctx, journalfile);
 
-    __atomic_store_n(&ctx->atomic.transaction_id, MAX(__atomic_load_n(&ctx->atomic.transaction_id, __ATOMIC_RELAXED), max_id + 1), __ATOMIC_RELAXED);
+    // journal files are loaded in parallel
+    uint64_t transaction_id = __atomic_load_n(&ctx->atomic.transaction_id, __ATOMIC_RELAXED);
+    while (transaction_id < max_id + 1 &&
+           !__atomic_compare_exchange_n(&ctx->atomic.transaction_id, &transaction_id, max_id + 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+
+    __atomic_add_fetch(&ctx->loading.progress.journalfiles_v1_replayed, 1, __ATOMIC_RELAXED);
 
     info("DBENGINE: journal file '%s' loaded (size:%"PRIu64").", path, file_size);
 
@@ -1457,8 +1611,7 @@ int journalfile_load(struct rrdengine_instance *ctx, struct rrdengine_journalfil
         return 0;
     }
 
-    pgc_open_cache_to_journal_v2(open_cache, (Word_t) ctx, (int) datafile->fileno, ctx->config.page_type,
-                                 journalfile_migrate_to_v2_callback, (void *) datafile->journalfile);
+    *migrate_to_v2 = true;
 
     if (is_last_file)
         ctx->loading.create_new_datafile_pair = true;
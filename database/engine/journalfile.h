@@ -110,7 +110,7 @@ struct journal_extent_list {
     uint8_t  pages;             // number of pages (not all are necesssarily valid)
 };
 
-// 72 bytes
+// 80 bytes
 struct journal_v2_header {
     uint32_t magic;
     usec_t start_time_ut;               // Min start time of journal
@@ -126,9 +126,22 @@ struct journal_v2_header {
     uint32_t journal_v1_file_size;      // This is the original journal file
     uint32_t journal_v2_file_size;      // This is the total file size
     void *data;                         // Used when building the index
+
+    // fields below are not covered by the file CRC (older agents zero them)
+    // they are protected by the CRC of the metric filter
+    uint32_t filter_offset;             // the bloom filter of the metric UUIDs (0 = none)
+    uint32_t filter_size;               // in bytes, multiple of JOURNAL_V2_FILTER_BLOCK_SIZE
 };
 
 #define JOURNAL_V2_HEADER_PADDING_SZ (RRDENG_BLOCK_SIZE - (sizeof(struct journal_v2_header)))
+#define JOURNAL_V2_HEADER_CRC_SZ offsetof(struct journal_v2_header, filter_offset)
+
+// The metric filter is a blocked bloom filter: every UUID sets JOURNAL_V2_FILTER_HASHES bits
+// in a single cache line, so a lookup touches one cache line of the mmapped file.
+// It is written after the page lists, followed by a block trailer.
+#define JOURNAL_V2_FILTER_BLOCK_SIZE 64
+#define JOURNAL_V2_FILTER_BITS_PER_METRIC 10
+#define JOURNAL_V2_FILTER_HASHES 7
 
 struct wal;
 
@@ -141,7 +154,7 @@ int journalfile_unlink(struct rrdengine_journalfile *journalfile);
 int journalfile_destroy_unsafe(struct rrdengine_journalfile *journalfile, struct rrdengine_datafile *datafile);
 int journalfile_create(struct rrdengine_journalfile *journalfile, struct rrdengine_datafile *datafile);
 int journalfile_load(struct rrdengine_instance *ctx, struct rrdengine_journalfile *journalfile,
-                     struct rrdengine_datafile *datafile);
+                     struct rrdengine_datafile *datafile, bool *migrate_to_v2);
 void journalfile_v2_populate_retention_to_mrg(struct rrdengine_instance *ctx, struct rrdengine_journalfile *journalfile);
 
 void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno __maybe_unused, uint8_t type __maybe_unused,
@@ -156,4 +169,9 @@ struct journal_v2_header *journalfile_v2_data_acquire(struct rrdengine_journalfi
 void journalfile_v2_data_release(struct rrdengine_journalfile *journalfile);
 void journalfile_v2_data_unmount_cleanup(time_t now_s);
 
+bool journalfile_v2_metric_may_exist(struct journal_v2_header *j2_header, uuid_t *uuid);
+
+// 0 = valid, 1 = invalid, 2 = needs rebuild, 3 = skip - journal_v1_file_size can be zero, to skip its check
+int journalfile_v2_validate(void *data_start, size_t journal_v2_file_size, size_t journal_v1_file_size);
+
 #endif /* NETDATA_JOURNALFILE_H */
\ No newline at end of file
@@ -16,8 +16,10 @@ struct metric {
     time_t latest_time_s_hot;       // latest time of the currently collected page
     uint32_t latest_update_every_s; //
     pid_t writer;
+    uint16_t page_points;           // the points the pages of this metric should be sized for, 0 = all the page
     METRIC_FLAGS flags;
     REFCOUNT refcount;
+    uint32_t version;               // odd while the retention is being changed (for lockless readers)
     SPINLOCK spinlock;              // protects all variable members
 
     // THIS IS allocated with malloc()
@@ -26,17 +28,29 @@ struct metric {
 
 static struct aral_statistics mrg_aral_statistics;
 
+#define MRG_CACHE_LINE_PADDING(x) uint8_t padding##x[128]
+
 struct mrg {
-    ARAL *aral[MRG_PARTITIONS];
+    size_t partitions;
 
-    struct pgc_index {
+    struct mrg_partition {
+        ARAL *aral;
         netdata_rwlock_t rwlock;
         Pvoid_t uuid_judy;          // each UUID has a JudyL of sections (tiers)
-    } index[MRG_PARTITIONS];
+        bool writer;                // a writer is modifying this partition (lockless readers use the rwlock)
+        size_t entries;
+        MRG_CACHE_LINE_PADDING(0);
+    } *index;
 
-    struct mrg_statistics stats;
+    struct {
+        size_t slots;               // the number of reader slots
+        size_t stride;              // the bytes of each slot, a multiple of the cache line
+        uint8_t *counters;          // for each slot, the lockless readers of each partition
+    } index_readers;
 
-    size_t entries_per_partition[MRG_PARTITIONS];
+    MRG_CACHE_LINE_PADDING(1);
+
+    struct mrg_statistics stats;
 };
 
 static inline void MRG_STATS_DUPLICATE_ADD(MRG *mrg) {
@@ -48,7 +62,7 @@ static inline void MRG_STATS_ADDED_METRIC(MRG *mrg, size_t partition) {
     __atomic_add_fetch(&mrg->stats.additions, 1, __ATOMIC_RELAXED);
     __atomic_add_fetch(&mrg->stats.size, sizeof(METRIC), __ATOMIC_RELAXED);
 
-    __atomic_add_fetch(&mrg->entries_per_partition[partition], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&mrg->index[partition].entries, 1, __ATOMIC_RELAXED);
 }
 
 static inline void MRG_STATS_DELETED_METRIC(MRG *mrg, size_t partition) {
@@ -56,7 +70,7 @@ static inline void MRG_STATS_DELETED_METRIC(MRG *mrg, size_t partition) {
     __atomic_sub_fetch(&mrg->stats.size, sizeof(METRIC), __ATOMIC_RELAXED);
     __atomic_add_fetch(&mrg->stats.deletions, 1, __ATOMIC_RELAXED);
 
-    __atomic_sub_fetch(&mrg->entries_per_partition[partition], 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&mrg->index[partition].entries, 1, __ATOMIC_RELAXED);
 }
 
 static inline void MRG_STATS_SEARCH_HIT(MRG *mrg) {
@@ -71,16 +85,69 @@ static inline void MRG_STATS_DELETE_MISS(MRG *mrg) {
     __atomic_add_fetch(&mrg->stats.delete_misses, 1, __ATOMIC_RELAXED);
 }
 
-static inline void mrg_index_read_lock(MRG *mrg, size_t partition) {
+// Index readers do not touch the shared rwlock of the partition, in the same
+// way the page cache does it: each thread increments its own counter for the
+// partition and then checks that there is no writer. Writers get the rwlock,
+// raise the writer flag of the partition and wait for its lockless readers to
+// leave, so readers that find a writer fall back to the rwlock.
+
+static inline size_t mrg_index_reader_slot(MRG *mrg) {
+    static size_t threads = 0;
+    static __thread size_t thread_ordinal = 0;
+
+    if(unlikely(!thread_ordinal))
+        thread_ordinal = __atomic_add_fetch(&threads, 1, __ATOMIC_RELAXED);
+
+    return thread_ordinal % mrg->index_readers.slots;
+}
+
+static inline uint32_t *mrg_index_reader_counter(MRG *mrg, size_t slot, size_t partition) {
+    return &((uint32_t *)&mrg->index_readers.counters[slot * mrg->index_readers.stride])[partition];
+}
+
+// returns true when the index is read without the rwlock
+static inline bool mrg_index_read_lock(MRG *mrg, size_t partition) {
+    netdata_thread_disable_cancelability();
+
+    uint32_t *counter = mrg_index_reader_counter(mrg, mrg_index_reader_slot(mrg), partition);
+    __atomic_add_fetch(counter, 1, __ATOMIC_SEQ_CST);
+
+    if(likely(!__atomic_load_n(&mrg->index[partition].writer, __ATOMIC_SEQ_CST)))
+        return true;
+
+    // there is a writer, wait for it at the rwlock
+    __atomic_sub_fetch(counter, 1, __ATOMIC_RELEASE);
+    netdata_thread_enable_cancelability();
+    __atomic_add_fetch(&mrg->stats.search_lockless_fallback, 1, __ATOMIC_RELAXED);
+
     netdata_rwlock_rdlock(&mrg->index[partition].rwlock);
+    return false;
 }
-static inline void mrg_index_read_unlock(MRG *mrg, size_t partition) {
-    netdata_rwlock_unlock(&mrg->index[partition].rwlock);
+static inline void mrg_index_read_unlock(MRG *mrg, size_t partition, bool lockless) {
+    if(likely(lockless)) {
+        __atomic_sub_fetch(mrg_index_reader_counter(mrg, mrg_index_reader_slot(mrg), partition), 1, __ATOMIC_RELEASE);
+        netdata_thread_enable_cancelability();
+    }
+    else
+        netdata_rwlock_unlock(&mrg->index[partition].rwlock);
 }
 static inline void mrg_index_write_lock(MRG *mrg, size_t partition) {
     netdata_rwlock_wrlock(&mrg->index[partition].rwlock);
+
+    __atomic_store_n(&mrg->index[partition].writer, true, __ATOMIC_SEQ_CST);
+
+    for(size_t slot = 0; slot < mrg->index_readers.slots ; slot++) {
+        uint32_t *counter = mrg_index_reader_counter(mrg, slot, partition);
+        for(size_t spins = 1; __atomic_load_n(counter, __ATOMIC_SEQ_CST) ; spins++) {
+            if(unlikely(spins % 8 == 0)) {
+                static const struct timespec ns = { .tv_sec = 0, .tv_nsec = 1 };
+                nanosleep(&ns, NULL);
+            }
+        }
+    }
 }
 static inline void mrg_index_write_unlock(MRG *mrg, size_t partition) {
+    __atomic_store_n(&mrg->index[partition].writer, false, __ATOMIC_RELEASE);
     netdata_rwlock_unlock(&mrg->index[partition].rwlock);
 }
 
@@ -99,9 +166,38 @@ static inline void mrg_stats_size_judyhs_removed_uuid(MRG *mrg) {
     __atomic_sub_fetch(&mrg->stats.size, JUDYHS_INDEX_SIZE_ESTIMATE(sizeof(uuid_t)), __ATOMIC_RELAXED);
 }
 
-static inline size_t uuid_partition(MRG *mrg __maybe_unused, uuid_t *uuid) {
-    uint8_t *u = (uint8_t *)uuid;
-    return u[UUID_SZ - 1] % MRG_PARTITIONS;
+static inline size_t uuid_partition(MRG *mrg, uuid_t *uuid) {
+    // the last bytes of the UUID are random, for all UUID versions we use
+    uint64_t u;
+    memcpy(&u, &((uint8_t *)uuid)[UUID_SZ - sizeof(u)], sizeof(u));
+    return u % mrg->partitions;
+}
+
+// ----------------------------------------------------------------------------
+// optimistic retention readers
+//
+// Writers change the retention of a metric while holding its spinlock, and they
+// make its version odd while doing so. Readers copy the retention without the
+// spinlock and retry when the version was odd or changed while copying.
+
+#define METRIC_RETENTION_READ_ATTEMPTS 3
+
+static inline void metric_retention_write_begin(METRIC *metric) {
+    __atomic_store_n(&metric->version, metric->version + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void metric_retention_write_end(METRIC *metric) {
+    __atomic_store_n(&metric->version, metric->version + 1, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t metric_retention_read_begin(METRIC *metric) {
+    return __atomic_load_n(&metric->version, __ATOMIC_ACQUIRE);
+}
+
+static inline bool metric_retention_read_retry(METRIC *metric, uint32_t version) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return (version & 1) || __atomic_load_n(&metric->version, __ATOMIC_RELAXED) != version;
 }
 
 static inline bool metric_has_retention_unsafe(MRG *mrg __maybe_unused, METRIC *metric) {
@@ -171,7 +267,7 @@ static inline bool metric_release_and_can_be_deleted(MRG *mrg __maybe_unused, ME
 static METRIC *metric_add_and_acquire(MRG *mrg, MRG_ENTRY *entry, bool *ret) {
     size_t partition = uuid_partition(mrg, &entry->uuid);
 
-    METRIC *allocation = aral_mallocz(mrg->aral[partition]);
+    METRIC *allocation = aral_mallocz(mrg->index[partition].aral);
 
     mrg_index_write_lock(mrg, partition);
 
@@ -201,7 +297,7 @@ static METRIC *metric_add_and_acquire(MRG *mrg, MRG_ENTRY *entry, bool *ret) {
         if(ret)
             *ret = false;
 
-        aral_freez(mrg->aral[partition], allocation);
+        aral_freez(mrg->index[partition].aral, allocation);
 
         MRG_STATS_DUPLICATE_ADD(mrg);
         return metric;
@@ -215,7 +311,9 @@ static METRIC *metric_add_and_acquire(MRG *mrg, MRG_ENTRY *entry, bool *ret) {
     metric->latest_time_s_hot = 0;
     metric->latest_update_every_s = entry->latest_update_every_s;
     metric->writer = 0;
+    metric->page_points = 0;
     metric->refcount = 0;
+    metric->version = 0;
     metric->flags = 0;
     netdata_spinlock_init(&metric->spinlock);
     metric_acquire(mrg, metric, true); // no spinlock use required here
@@ -234,27 +332,29 @@ static METRIC *metric_add_and_acquire(MRG *mrg, MRG_ENTRY *entry, bool *ret) {
 static METRIC *metric_get_and_acquire(MRG *mrg, uuid_t *uuid, Word_t section) {
     size_t partition = uuid_partition(mrg, uuid);
 
-    mrg_index_read_lock(mrg, partition);
+    bool lockless = mrg_index_read_lock(mrg, partition);
 
     Pvoid_t *sections_judy_pptr = JudyHSGet(mrg->index[partition].uuid_judy, uuid, sizeof(uuid_t));
     if(unlikely(!sections_judy_pptr)) {
-        mrg_index_read_unlock(mrg, partition);
+        mrg_index_read_unlock(mrg, partition, lockless);
         MRG_STATS_SEARCH_MISS(mrg);
         return NULL;
     }
 
     Pvoid_t *PValue = JudyLGet(*sections_judy_pptr, section, PJE0);
     if(unlikely(!PValue)) {
-        mrg_index_read_unlock(mrg, partition);
+        mrg_index_read_unlock(mrg, partition, lockless);
         MRG_STATS_SEARCH_MISS(mrg);
         return NULL;
     }
 
     METRIC *metric = *PValue;
 
+    // deleters get the write lock before checking the refcount,
+    // so the metric cannot be freed while we acquire it
     metric_acquire(mrg, metric, false);
 
-    mrg_index_read_unlock(mrg, partition);
+    mrg_index_read_unlock(mrg, partition, lockless);
 
     MRG_STATS_SEARCH_HIT(mrg);
     return metric;
@@ -300,7 +400,7 @@ static bool acquired_metric_del(MRG *mrg, METRIC *metric) {
 
     mrg_index_write_unlock(mrg, partition);
 
-    aral_freez(mrg->aral[partition], metric);
+    aral_freez(mrg->index[partition].aral, metric);
 
     MRG_STATS_DELETED_METRIC(mrg, partition);
 
@@ -310,16 +410,24 @@ static bool acquired_metric_del(MRG *mrg, METRIC *metric) {
 // ----------------------------------------------------------------------------
 // public API
 
-MRG *mrg_create(void) {
+MRG *mrg_create(ssize_t partitions) {
+    if(partitions < 1)
+        partitions = get_netdata_cpus();
+
+    if(partitions < MRG_PARTITIONS_MIN)
+        partitions = MRG_PARTITIONS_MIN;
+
     MRG *mrg = callocz(1, sizeof(MRG));
+    mrg->partitions = (size_t)partitions;
+    mrg->index = callocz(mrg->partitions, sizeof(struct mrg_partition));
 
-    for(size_t i = 0; i < MRG_PARTITIONS ; i++) {
+    for(size_t i = 0; i < mrg->partitions ; i++) {
         netdata_rwlock_init(&mrg->index[i].rwlock);
 
         char buf[ARAL_MAX_NAME + 1];
         snprintfz(buf, ARAL_MAX_NAME, "mrg[%zu]", i);
 
-        mrg->aral[i] = aral_create(buf,
+        mrg->index[i].aral = aral_create(buf,
                                    sizeof(METRIC),
                                    0,
                                    16384,
@@ -328,11 +436,27 @@ MRG *mrg_create(void) {
                                    false);
     }
 
-    mrg->stats.size = sizeof(MRG);
+    mrg->index_readers.slots = MAX((size_t)get_netdata_cpus(), 4);
+    mrg->index_readers.stride = ((mrg->partitions * sizeof(uint32_t) + 63) / 64) * 64;
+
+    size_t bytes = mrg->index_readers.slots * mrg->index_readers.stride;
+    void *counters;
+    int ret = posix_memalign(&counters, 64, bytes);
+    if(unlikely(ret))
+        fatal("DBENGINE METRIC: posix_memalign(): %s", strerror(ret));
+
+    memset(counters, 0, bytes);
+    mrg->index_readers.counters = counters;
+
+    mrg->stats.size = sizeof(MRG) + mrg->partitions * sizeof(struct mrg_partition) + bytes;
 
     return mrg;
 }
 
+size_t mrg_partitions(MRG *mrg) {
+    return mrg->partitions;
+}
+
 size_t mrg_aral_structures(void) {
     return aral_structures_from_stats(&mrg_aral_statistics);
 }
@@ -341,14 +465,27 @@ size_t mrg_aral_overhead(void) {
     return aral_overhead_from_stats(&mrg_aral_statistics);
 }
 
-void mrg_destroy(MRG *mrg __maybe_unused) {
-    // no destruction possible
-    // we can't traverse the metrics list
+void mrg_destroy(MRG *mrg) {
+    // we can't traverse the metrics list (JudyHS cannot be iterated)
 
     // to delete entries, the caller needs to keep pointers to them
-    // and delete them one by one
+    // and delete them one by one, before calling this.
+    // Metrics still indexed are freed with their aral, but the JudyL
+    // of sections of their UUIDs cannot be reached and are leaked.
+
+    internal_error(__atomic_load_n(&mrg->stats.entries, __ATOMIC_RELAXED) != 0,
+                   "DBENGINE METRIC: destroying the metrics registry while it still has %zu entries",
+                   __atomic_load_n(&mrg->stats.entries, __ATOMIC_RELAXED));
+
+    for(size_t i = 0; i < mrg->partitions ; i++) {
+        JudyHSFreeArray(&mrg->index[i].uuid_judy, PJE0);
+        aral_destroy(mrg->index[i].aral);
+        netdata_rwlock_destroy(&mrg->index[i].rwlock);
+    }
 
-    ;
+    free(mrg->index_readers.counters);
+    freez(mrg->index);
+    freez(mrg);
 }
 
 METRIC *mrg_metric_add_and_acquire(MRG *mrg, MRG_ENTRY entry, bool *ret) {
@@ -394,7 +531,9 @@ bool mrg_metric_set_first_time_s(MRG *mrg __maybe_unused, METRIC *metric, time_t
         return false;
 
     netdata_spinlock_lock(&metric->spinlock);
+    metric_retention_write_begin(metric);
     metric->first_time_s = first_time_s;
+    metric_retention_write_end(metric);
     metric_has_retention_unsafe(mrg, metric);
     netdata_spinlock_unlock(&metric->spinlock);
 
@@ -422,6 +561,7 @@ void mrg_metric_expand_retention(MRG *mrg __maybe_unused, METRIC *metric, time_t
         return;
 
     netdata_spinlock_lock(&metric->spinlock);
+    metric_retention_write_begin(metric);
 
     if(unlikely(first_time_s && (!metric->first_time_s || first_time_s < metric->first_time_s)))
         metric->first_time_s = first_time_s;
@@ -435,6 +575,7 @@ void mrg_metric_expand_retention(MRG *mrg __maybe_unused, METRIC *metric, time_t
     else if(unlikely(!metric->latest_update_every_s && update_every_s))
         metric->latest_update_every_s = (uint32_t) update_every_s;
 
+    metric_retention_write_end(metric);
     metric_has_retention_unsafe(mrg, metric);
     netdata_spinlock_unlock(&metric->spinlock);
 }
@@ -446,7 +587,9 @@ bool mrg_metric_set_first_time_s_if_bigger(MRG *mrg __maybe_unused, METRIC *metr
 
     netdata_spinlock_lock(&metric->spinlock);
     if(first_time_s > metric->first_time_s) {
+        metric_retention_write_begin(metric);
         metric->first_time_s = first_time_s;
+        metric_retention_write_end(metric);
         ret = true;
     }
     metric_has_retention_unsafe(mrg, metric);
@@ -455,37 +598,65 @@ bool mrg_metric_set_first_time_s_if_bigger(MRG *mrg __maybe_unused, METRIC *metr
     return ret;
 }
 
-time_t mrg_metric_get_first_time_s(MRG *mrg __maybe_unused, METRIC *metric) {
-    time_t first_time_s;
-
-    netdata_spinlock_lock(&metric->spinlock);
-
+// a metric without a first time gets its latest time as its first time (under its spinlock)
+static inline void metric_first_time_s_fix_unsafe(METRIC *metric) {
     if(unlikely(!metric->first_time_s)) {
-        if(metric->latest_time_s_clean)
+        if(metric->latest_time_s_clean) {
+            metric_retention_write_begin(metric);
             metric->first_time_s = metric->latest_time_s_clean;
+            metric_retention_write_end(metric);
+        }
 
-        else if(metric->latest_time_s_hot)
+        else if(metric->latest_time_s_hot) {
+            metric_retention_write_begin(metric);
             metric->first_time_s = metric->latest_time_s_hot;
+            metric_retention_write_end(metric);
+        }
     }
+}
 
-    first_time_s = metric->first_time_s;
+time_t mrg_metric_get_first_time_s(MRG *mrg __maybe_unused, METRIC *metric) {
+    time_t first_time_s;
+
+    // the first time only needs fixing once, so it can be read without the spinlock
+    first_time_s = __atomic_load_n(&metric->first_time_s, __ATOMIC_RELAXED);
+    if(likely(first_time_s))
+        return first_time_s;
 
+    netdata_spinlock_lock(&metric->spinlock);
+    metric_first_time_s_fix_unsafe(metric);
+    first_time_s = metric->first_time_s;
     netdata_spinlock_unlock(&metric->spinlock);
 
     return first_time_s;
 }
 
 void mrg_metric_get_retention(MRG *mrg __maybe_unused, METRIC *metric, time_t *first_time_s, time_t *last_time_s, time_t *update_every_s) {
-    netdata_spinlock_lock(&metric->spinlock);
+    for(size_t attempt = 0; attempt < METRIC_RETENTION_READ_ATTEMPTS ;attempt++) {
+        uint32_t version = metric_retention_read_begin(metric);
 
-    if(unlikely(!metric->first_time_s)) {
-        if(metric->latest_time_s_clean)
-            metric->first_time_s = metric->latest_time_s_clean;
+        time_t first = __atomic_load_n(&metric->first_time_s, __ATOMIC_RELAXED);
+        time_t clean = __atomic_load_n(&metric->latest_time_s_clean, __ATOMIC_RELAXED);
+        time_t hot = __atomic_load_n(&metric->latest_time_s_hot, __ATOMIC_RELAXED);
+        uint32_t update_every = __atomic_load_n(&metric->latest_update_every_s, __ATOMIC_RELAXED);
 
-        else if(metric->latest_time_s_hot)
-            metric->first_time_s = metric->latest_time_s_hot;
+        if(metric_retention_read_retry(metric, version))
+            continue;
+
+        if(unlikely(!first && (clean || hot)))
+            // it has to be fixed
+            break;
+
+        *first_time_s = first;
+        *last_time_s = MAX(clean, hot);
+        *update_every_s = update_every;
+        return;
     }
 
+    netdata_spinlock_lock(&metric->spinlock);
+
+    metric_first_time_s_fix_unsafe(metric);
+
     *first_time_s = metric->first_time_s;
     *last_time_s = MAX(metric->latest_time_s_clean, metric->latest_time_s_hot);
     *update_every_s = metric->latest_update_every_s;
@@ -507,11 +678,13 @@ bool mrg_metric_set_clean_latest_time_s(MRG *mrg __maybe_unused, METRIC *metric,
 //    internal_fatal(metric->latest_time_s_clean > latest_time_s,
 //                   "DBENGINE METRIC: metric new clean latest time is older than the previous one");
 
+    metric_retention_write_begin(metric);
     metric->latest_time_s_clean = latest_time_s;
 
     if(unlikely(!metric->first_time_s))
         metric->first_time_s = latest_time_s;
 
+    metric_retention_write_end(metric);
     metric_has_retention_unsafe(mrg, metric);
     netdata_spinlock_unlock(&metric->spinlock);
     return true;
@@ -558,8 +731,10 @@ bool mrg_metric_zero_disk_retention(MRG *mrg __maybe_unused, METRIC *metric) {
             internal_error(!countdown, "METRIC: giving up on updating the retention of metric without disk retention");
 
             do_again = false;
+            metric_retention_write_begin(metric);
             metric->first_time_s = min_first_time_s;
             metric->latest_time_s_clean = max_end_time_s;
+            metric_retention_write_end(metric);
 
             ret = metric_has_retention_unsafe(mrg, metric);
         }
@@ -579,11 +754,13 @@ bool mrg_metric_set_hot_latest_time_s(MRG *mrg __maybe_unused, METRIC *metric, t
         return false;
 
     netdata_spinlock_lock(&metric->spinlock);
+    metric_retention_write_begin(metric);
     metric->latest_time_s_hot = latest_time_s;
 
     if(unlikely(!metric->first_time_s))
         metric->first_time_s = latest_time_s;
 
+    metric_retention_write_end(metric);
     metric_has_retention_unsafe(mrg, metric);
     netdata_spinlock_unlock(&metric->spinlock);
     return true;
@@ -591,6 +768,16 @@ bool mrg_metric_set_hot_latest_time_s(MRG *mrg __maybe_unused, METRIC *metric, t
 
 time_t mrg_metric_get_latest_time_s(MRG *mrg __maybe_unused, METRIC *metric) {
     time_t max;
+
+    for(size_t attempt = 0; attempt < METRIC_RETENTION_READ_ATTEMPTS ;attempt++) {
+        uint32_t version = metric_retention_read_begin(metric);
+        time_t clean = __atomic_load_n(&metric->latest_time_s_clean, __ATOMIC_RELAXED);
+        time_t hot = __atomic_load_n(&metric->latest_time_s_hot, __ATOMIC_RELAXED);
+
+        if(!metric_retention_read_retry(metric, version))
+            return MAX(clean, hot);
+    }
+
     netdata_spinlock_lock(&metric->spinlock);
     max = MAX(metric->latest_time_s_clean, metric->latest_time_s_hot);
     netdata_spinlock_unlock(&metric->spinlock);
@@ -604,7 +791,7 @@ bool mrg_metric_set_update_every(MRG *mrg __maybe_unused, METRIC *metric, time_t
         return false;
 
     netdata_spinlock_lock(&metric->spinlock);
-    metric->latest_update_every_s = (uint32_t) update_every_s;
+    __atomic_store_n(&metric->latest_update_every_s, (uint32_t) update_every_s, __ATOMIC_RELAXED);
     netdata_spinlock_unlock(&metric->spinlock);
 
     return true;
@@ -618,20 +805,25 @@ bool mrg_metric_set_update_every_s_if_zero(MRG *mrg __maybe_unused, METRIC *metr
 
     netdata_spinlock_lock(&metric->spinlock);
     if(!metric->latest_update_every_s)
-        metric->latest_update_every_s = (uint32_t) update_every_s;
+        __atomic_store_n(&metric->latest_update_every_s, (uint32_t) update_every_s, __ATOMIC_RELAXED);
     netdata_spinlock_unlock(&metric->spinlock);
 
     return true;
 }
 
 time_t mrg_metric_get_update_every_s(MRG *mrg __maybe_unused, METRIC *metric) {
-    time_t update_every_s;
+    return (time_t)__atomic_load_n(&metric->latest_update_every_s, __ATOMIC_RELAXED);
+}
 
-    netdata_spinlock_lock(&metric->spinlock);
-    update_every_s = metric->latest_update_every_s;
-    netdata_spinlock_unlock(&metric->spinlock);
+void mrg_metric_set_page_points(MRG *mrg __maybe_unused, METRIC *metric, size_t points) {
+    if(points > UINT16_MAX)
+        points = 0;
 
-    return update_every_s;
+    __atomic_store_n(&metric->page_points, (uint16_t) points, __ATOMIC_RELAXED);
+}
+
+size_t mrg_metric_get_page_points(MRG *mrg __maybe_unused, METRIC *metric) {
+    return (size_t)__atomic_load_n(&metric->page_points, __ATOMIC_RELAXED);
 }
 
 bool mrg_metric_set_writer(MRG *mrg, METRIC *metric) {
@@ -735,6 +927,12 @@ static void mrg_stress(MRG *mrg, size_t entries, size_t sections) {
                 fatal("DBENGINE METRIC: wrong latest time returned");
             if(mrg_metric_get_update_every_s(mrg, array[i][section]) != (time_t)((i + 1) * 4))
                 fatal("DBENGINE METRIC: wrong latest time returned");
+
+            if(mrg_metric_get_page_points(mrg, array[i][section]) != 0)
+                fatal("DBENGINE METRIC: new metric has page points");
+            mrg_metric_set_page_points(mrg, array[i][section], i + 5);
+            if(mrg_metric_get_page_points(mrg, array[i][section]) != i + 5)
+                fatal("DBENGINE METRIC: wrong page points returned");
         }
     }
 
@@ -774,8 +972,125 @@ static void *mrg_stress_test_thread3(void *ptr) {
 }
 #endif
 
+struct mrg_unittest_lockless_readers {
+    MRG *mrg;
+    bool stop;
+    size_t metrics;
+    uuid_t *uuids;
+    size_t searches;
+    size_t errors;
+};
+
+static void *mrg_unittest_lockless_readers_thread(void *ptr) {
+    struct mrg_unittest_lockless_readers *t = ptr;
+
+    while(!__atomic_load_n(&t->stop, __ATOMIC_RELAXED)) {
+        for(size_t i = 0; i < t->metrics ; i++) {
+            METRIC *metric = mrg_metric_get_and_acquire(t->mrg, &t->uuids[i], 0);
+            if(!metric) {
+                __atomic_add_fetch(&t->errors, 1, __ATOMIC_RELAXED);
+                continue;
+            }
+
+            // the main thread keeps the retention of these metrics consistent
+            time_t first_time_s, last_time_s, update_every_s;
+            mrg_metric_get_retention(t->mrg, metric, &first_time_s, &last_time_s, &update_every_s);
+            if(first_time_s <= 0 || last_time_s != first_time_s + update_every_s)
+                __atomic_add_fetch(&t->errors, 1, __ATOMIC_RELAXED);
+
+            mrg_metric_release(t->mrg, metric);
+            __atomic_add_fetch(&t->searches, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return ptr;
+}
+
+// readers search metrics that exist and read their retention, while the main
+// thread adds and deletes other metrics and changes the retention of the searched ones
+static int mrg_unittest_lockless_readers(void) {
+    struct mrg_unittest_lockless_readers t = {
+            .mrg = mrg_create(0),
+            .stop = false,
+            .metrics = 100,
+            .searches = 0,
+            .errors = 0,
+    };
+
+    t.uuids = callocz(t.metrics, sizeof(uuid_t));
+    METRIC **metrics = callocz(t.metrics, sizeof(METRIC *));
+    for(size_t i = 0; i < t.metrics ; i++) {
+        uuid_generate_random(t.uuids[i]);
+        MRG_ENTRY entry = {
+                .section = 0,
+                .first_time_s = 10,
+                .last_time_s = 11,
+                .latest_update_every_s = 1,
+        };
+        uuid_copy(entry.uuid, t.uuids[i]);
+        metrics[i] = mrg_metric_add_and_acquire(t.mrg, entry, NULL);
+    }
+
+    netdata_thread_t threads[4];
+    for(size_t i = 0; i < 4 ;i++) {
+        char buffer[100 + 1];
+        snprintfz(buffer, 100, "MRGLOCKLESS_%zu", i);
+        netdata_thread_create(&threads[i], buffer,
+                              NETDATA_THREAD_OPTION_JOINABLE | NETDATA_THREAD_OPTION_DONT_LOG,
+                              mrg_unittest_lockless_readers_thread, &t);
+    }
+
+    for(size_t round = 0; round < 100 ; round++) {
+        METRIC *others[1000];
+        for(size_t i = 0; i < 1000 ; i++) {
+            MRG_ENTRY entry = {
+                    .section = 0,
+                    .first_time_s = 1,
+                    .last_time_s = 2,
+                    .latest_update_every_s = 1,
+            };
+            uuid_generate_random(entry.uuid);
+            others[i] = mrg_metric_add_and_acquire(t.mrg, entry, NULL);
+        }
+
+        for(size_t i = 0; i < t.metrics ; i++) {
+            time_t update_every_s = (time_t)(round + 1);
+            mrg_metric_expand_retention(t.mrg, metrics[i], 0, 10 + update_every_s, update_every_s);
+        }
+
+        for(size_t i = 0; i < 1000 ; i++) {
+            mrg_metric_set_first_time_s(t.mrg, others[i], 0);
+            mrg_metric_set_clean_latest_time_s(t.mrg, others[i], 0);
+            if(!mrg_metric_release_and_delete(t.mrg, others[i]))
+                t.errors++;
+        }
+    }
+
+    __atomic_store_n(&t.stop, true, __ATOMIC_RELAXED);
+    for(size_t i = 0; i < 4 ;i++)
+        netdata_thread_join(threads[i], NULL);
+
+    info("DBENGINE METRIC: lockless readers did %zu searches, with %zu fallbacks to the lock, while the index was modified - %zu errors",
+         t.searches, t.mrg->stats.search_lockless_fallback, t.errors);
+
+    for(size_t i = 0; i < t.metrics ; i++) {
+        mrg_metric_set_first_time_s(t.mrg, metrics[i], 0);
+        mrg_metric_set_clean_latest_time_s(t.mrg, metrics[i], 0);
+        if(!mrg_metric_release_and_delete(t.mrg, metrics[i]))
+            t.errors++;
+    }
+
+    if(t.mrg->stats.entries != 0)
+        t.errors++;
+
+    mrg_destroy(t.mrg);
+    freez(metrics);
+    freez(t.uuids);
+    return t.errors ? 1 : 0;
+}
+
 int mrg_unittest(void) {
-    MRG *mrg = mrg_create();
+    MRG *mrg = mrg_create(0);
     METRIC *m1_t0, *m2_t0, *m3_t0, *m4_t0;
     METRIC *m1_t1, *m2_t1, *m3_t1, *m4_t1;
     bool ret;
@@ -897,6 +1212,9 @@ int mrg_unittest(void) {
 
     mrg_destroy(mrg);
 
+    if(mrg_unittest_lockless_readers())
+        fatal("DBENGINE METRIC: lockless readers failed");
+
     info("DBENGINE METRIC: all tests passed!");
 
     return 0;
@@ -3,7 +3,7 @@
 
 #include "../rrd.h"
 
-#define MRG_PARTITIONS 10
+#define MRG_PARTITIONS_MIN 10      // the MRG gets as many partitions as the CPUs, but not less than this
 
 typedef struct metric METRIC;
 typedef struct mrg MRG;
@@ -34,12 +34,14 @@ struct mrg_statistics {
 
     size_t search_hits;
     size_t search_misses;
+    size_t search_lockless_fallback;    // lockless searches that found a writer and used the lock
 
     size_t writers;
     size_t writers_conflicts;
 };
 
-MRG *mrg_create(void);
+MRG *mrg_create(ssize_t partitions);
+size_t mrg_partitions(MRG *mrg);
 void mrg_destroy(MRG *mrg);
 
 METRIC *mrg_metric_dup(MRG *mrg, METRIC *metric);
@@ -69,6 +71,10 @@ void mrg_metric_expand_retention(MRG *mrg, METRIC *metric, time_t first_time_s,
 void mrg_metric_get_retention(MRG *mrg, METRIC *metric, time_t *first_time_s, time_t *last_time_s, time_t *update_every_s);
 bool mrg_metric_zero_disk_retention(MRG *mrg __maybe_unused, METRIC *metric);
 
+// the number of points the collector learned the pages of the metric should have (0 = unknown)
+void mrg_metric_set_page_points(MRG *mrg, METRIC *metric, size_t points);
+size_t mrg_metric_get_page_points(MRG *mrg, METRIC *metric);
+
 bool mrg_metric_set_writer(MRG *mrg, METRIC *metric);
 bool mrg_metric_clear_writer(MRG *mrg, METRIC *metric);
 
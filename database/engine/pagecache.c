@@ -6,6 +6,7 @@
 MRG *main_mrg = NULL;
 PGC *main_cache = NULL;
 PGC *open_cache = NULL;
+uint8_t main_cache_eviction_policy = PGC_EVICTION_TINYLFU;
 PGC *extent_cache = NULL;
 struct rrdeng_cache_efficiency_stats rrdeng_cache_efficiency_stats = {};
 
@@ -21,6 +22,122 @@ static void main_cache_flush_dirty_page_init_callback(PGC *cache __maybe_unused,
     __atomic_add_fetch(&ctx->atomic.extents_currently_being_flushed, 1, __ATOMIC_RELAXED);
 }
 
+// ----------------------------------------------------------------------------
+// the order dirty pages are written to extents
+//
+// The dirty pages arrive in the order they were completed, so the pages of the
+// same chart (which are completed together) are next to each other, but the
+// pages of the same metric are spread across the flush. We keep the order of
+// the first page of each metric and bring its other pages next to it, in time
+// order, so that a query for the metric needs fewer extents.
+
+struct flush_page_order {
+    Word_t metric_id;
+    time_t start_time_s;
+    size_t index;
+    size_t first_index;                 // the index of the first page of the metric in the flush
+};
+
+static int flush_page_order_by_metric(const void *a, const void *b) {
+    const struct flush_page_order *p1 = a, *p2 = b;
+
+    if(p1->metric_id != p2->metric_id)
+        return (p1->metric_id < p2->metric_id) ? -1 : 1;
+
+    if(p1->index != p2->index)
+        return (p1->index < p2->index) ? -1 : 1;
+
+    return 0;
+}
+
+static int flush_page_order_by_locality(const void *a, const void *b) {
+    const struct flush_page_order *p1 = a, *p2 = b;
+
+    if(p1->first_index != p2->first_index)
+        return (p1->first_index < p2->first_index) ? -1 : 1;
+
+    if(p1->start_time_s != p2->start_time_s)
+        return (p1->start_time_s < p2->start_time_s) ? -1 : 1;
+
+    if(p1->index != p2->index)
+        return (p1->index < p2->index) ? -1 : 1;
+
+    return 0;
+}
+
+static void flush_pages_order(PGC_ENTRY *entries_array, struct flush_page_order *order, size_t entries) {
+    for(size_t i = 0; i < entries ;i++) {
+        order[i] = (struct flush_page_order) {
+                .metric_id = entries_array[i].metric_id,
+                .start_time_s = entries_array[i].start_time_s,
+                .index = i,
+        };
+    }
+
+    qsort(order, entries, sizeof(*order), flush_page_order_by_metric);
+
+    for(size_t i = 0; i < entries ;i++)
+        order[i].first_index = (i && order[i - 1].metric_id == order[i].metric_id) ? order[i - 1].first_index : order[i].index;
+
+    qsort(order, entries, sizeof(*order), flush_page_order_by_locality);
+}
+
+// ----------------------------------------------------------------------------
+// run-length encoding of the pages written to disk
+//
+// Pages of metrics that do not change (zero error counters, static gauges),
+// or change rarely, are written as PAGE_RLE pages, when this makes them at
+// least 2 times smaller. The dirty page in the cache is not touched (queries
+// may be reading it), the encoded copy is freed with the page descriptor.
+
+bool pg_cache_rle_enabled = true;
+
+size_t pg_cache_page_rle_encode(void *encoded, uint8_t type, const void *page, size_t page_length) {
+    storage_number decoded[RRDENG_BLOCK_SIZE * 8 / GORILLA_EXPECTED_BITS_PER_VALUE];
+    const void *points = page;
+    size_t entries;
+
+    switch(type) {
+        case PAGE_METRICS:
+        case PAGE_TIER:
+            entries = page_length / page_type_size[type];
+            break;
+
+        case PAGE_GORILLA_METRICS:
+            entries = gorilla_page_decode(page, page_length, decoded, sizeof(decoded) / sizeof(decoded[0]));
+
+            // pages with more points than we can decode here are not encoded
+            if(entries != gorilla_page_entries(page))
+                return 0;
+
+            points = decoded;
+            type = PAGE_METRICS;
+            break;
+
+        default:
+            return 0;
+    }
+
+    if(entries < 2)
+        return 0;
+
+    return rle_page_encode(encoded, MIN(page_length / 2, RRDENG_BLOCK_SIZE), type, points, page_type_size[type], entries);
+}
+
+static void flush_page_rle_encode(struct page_descr_with_data *descr) {
+    uint8_t encoded[RRDENG_BLOCK_SIZE];
+
+    size_t length = pg_cache_page_rle_encode(encoded, descr->type, descr->page, descr->page_length);
+    if(!length)
+        return;
+
+    descr->page = mallocz(length);
+    memcpy(descr->page, encoded, length);
+    descr->page_length = length;
+    descr->page_encoded = true;
+    descr->type = PAGE_RLE;
+}
+
 static void main_cache_flush_dirty_page_callback(PGC *cache __maybe_unused, PGC_ENTRY *entries_array __maybe_unused, PGC_PAGE **pages_array __maybe_unused, size_t entries __maybe_unused)
 {
     if(!entries)
@@ -28,11 +145,13 @@ static void main_cache_flush_dirty_page_callback(PGC *cache __maybe_unused, PGC_
 
      struct rrdengine_instance *ctx = (struct rrdengine_instance *) entries_array[0].section;
 
-    size_t bytes_per_point =  CTX_POINT_SIZE_BYTES(ctx);
-
     struct page_descr_with_data *base = NULL;
 
-    for (size_t Index = 0 ; Index < entries; Index++) {
+    struct flush_page_order order[entries];
+    flush_pages_order(entries_array, order, entries);
+
+    for (size_t i = 0 ; i < entries; i++) {
+        size_t Index = order[i].index;
         time_t start_time_s = entries_array[Index].start_time_s;
         time_t end_time_s = entries_array[Index].end_time_s;
         struct page_descr_with_data *descr = page_descriptor_get();
@@ -42,9 +161,10 @@ static void main_cache_flush_dirty_page_callback(PGC *cache __maybe_unused, PGC_
         descr->start_time_ut = start_time_s * USEC_PER_SEC;
         descr->end_time_ut = end_time_s * USEC_PER_SEC;
         descr->update_every_s = entries_array[Index].update_every_s;
-        descr->type = ctx->config.page_type;
+        descr->type = *entries_array[Index].custom_data;
 
-        descr->page_length = (end_time_s - (start_time_s - descr->update_every_s)) / descr->update_every_s * bytes_per_point;
+        descr->page_length = page_length_by_data(descr->type, entries_array[Index].data,
+                                                 page_entries_by_time(start_time_s, end_time_s, descr->update_every_s));
 
         if(descr->page_length > entries_array[Index].size) {
             descr->page_length = entries_array[Index].size;
@@ -54,6 +174,10 @@ static void main_cache_flush_dirty_page_callback(PGC *cache __maybe_unused, PGC_
         }
 
         descr->page = pgc_page_data(pages_array[Index]);
+
+        if(pg_cache_rle_enabled)
+            flush_page_rle_encode(descr);
+
         DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(base, descr, link.prev, link.next);
 
         internal_fatal(descr->page_length > RRDENG_BLOCK_SIZE, "DBENGINE: faulty page length calculation");
@@ -533,6 +657,13 @@ static size_t get_page_list_from_journal_v2(struct rrdengine_instance *ctx, METR
 
         // the datafile possibly contains useful data for this query
 
+        if (!journalfile_v2_metric_may_exist(j2_header, uuid)) {
+            // our UUID is not in this datafile - no need to search its metric list
+            __atomic_add_fetch(&rrdeng_cache_efficiency_stats.journal_v2_filter_skips, 1, __ATOMIC_RELAXED);
+            journalfile_v2_data_release(datafile->journalfile);
+            continue;
+        }
+
         size_t journal_metric_count = (size_t)j2_header->metric_count;
         struct journal_metric_list *uuid_list = (struct journal_metric_list *)((uint8_t *) j2_header + j2_header->metric_offset);
         struct journal_metric_list *uuid_entry = bsearch(uuid,uuid_list,journal_metric_count,sizeof(*uuid_list), journal_metric_uuid_compare);
@@ -782,6 +913,9 @@ void rrdeng_prep_query(PDC *pdc) {
                                                  &pages_to_load,
                                                  &pdc->optimal_end_time_s);
 
+    if(pdc->readahead)
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.readahead_pages_to_load, pages_to_load, __ATOMIC_RELAXED);
+
     if (pages_to_load && pdc->page_list_JudyL) {
         pdc_acquire(pdc); // we get 1 for the 1st worker in the chain: do_read_page_list_work()
         usec_t start_ut = now_monotonic_usec();
@@ -799,6 +933,142 @@ void rrdeng_prep_query(PDC *pdc) {
     pdc_release_and_destroy_if_unreferenced(pdc, true, true);
 }
 
+static PDC *pg_cache_pdc_create(struct rrdengine_instance *ctx, METRIC *metric, time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority) {
+    __atomic_add_fetch(&ctx->atomic.inflight_queries, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&rrdeng_cache_efficiency_stats.currently_running_queries, 1, __ATOMIC_RELAXED);
+
+    PDC *pdc = pdc_get();
+    pdc->metric = mrg_metric_dup(main_mrg, metric);
+    pdc->start_time_s = start_time_s;
+    pdc->end_time_s = end_time_s;
+    pdc->priority = priority;
+    pdc->optimal_end_time_s = end_time_s;
+    pdc->ctx = ctx;
+    pdc->refcount = 1;
+    netdata_spinlock_init(&pdc->refcount_spinlock);
+    completion_init(&pdc->prep_completion);
+    completion_init(&pdc->page_completion);
+
+    return pdc;
+}
+
+// ----------------------------------------------------------------------------
+// read-ahead
+//
+// Dashboards query the same metrics again and again, moving the time window
+// each time (e.g. while playing back or panning through history).
+// We remember the last window queried for each metric and when the window
+// moves the same way a few times, we load into the main cache the pages the
+// next queries are going to need, at the lowest priority.
+// Windows at the edges of the retention (like the live edge) are not read-ahead,
+// since there is nothing to load there.
+
+#define PG_CACHE_READAHEAD_SLOTS 4096
+#define PG_CACHE_READAHEAD_MIN_SEQUENTIAL 2     // the window has to move that many times the same way
+#define PG_CACHE_READAHEAD_STEPS 4              // read-ahead that many window movements
+
+bool pg_cache_readahead_enabled = true;
+
+static struct pg_cache_readahead_slot {
+    SPINLOCK spinlock;
+    struct rrdengine_instance *ctx;
+    Word_t metric_id;
+    time_t after_s;
+    time_t before_s;
+    time_t step_s;                      // how much the window moved the last time
+    size_t sequential;                  // how many times the window moved the same way
+    time_t readahead_after_s;           // the range loaded, that has not been queried yet
+    time_t readahead_before_s;
+} pg_cache_readahead_slots[PG_CACHE_READAHEAD_SLOTS];
+
+static inline void pg_cache_readahead_slot_forget(struct pg_cache_readahead_slot *slot) {
+    if(slot->readahead_before_s)
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.readahead_wasted, 1, __ATOMIC_RELAXED);
+
+    slot->readahead_after_s = 0;
+    slot->readahead_before_s = 0;
+}
+
+static void pg_cache_readahead(struct rrdengine_instance *ctx, METRIC *metric, time_t after_s, time_t before_s) {
+    Word_t metric_id = mrg_metric_id(main_mrg, metric);
+    struct pg_cache_readahead_slot *slot = &pg_cache_readahead_slots[indexing_partition(metric_id ^ (Word_t)ctx, PG_CACHE_READAHEAD_SLOTS)];
+
+    time_t first_time_s, last_time_s, update_every_s;
+    mrg_metric_get_retention(main_mrg, metric, &first_time_s, &last_time_s, &update_every_s);
+
+    time_t readahead_after_s = 0, readahead_before_s = 0;
+
+    netdata_spinlock_lock(&slot->spinlock);
+
+    if(slot->ctx != ctx || slot->metric_id != metric_id) {
+        // another metric is using this slot
+        pg_cache_readahead_slot_forget(slot);
+        slot->ctx = ctx;
+        slot->metric_id = metric_id;
+        slot->after_s = after_s;
+        slot->before_s = before_s;
+        slot->step_s = 0;
+        slot->sequential = 0;
+        netdata_spinlock_unlock(&slot->spinlock);
+        return;
+    }
+
+    if(slot->readahead_before_s && after_s < slot->readahead_before_s && before_s > slot->readahead_after_s) {
+        // this query uses the pages we loaded
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.readahead_hits, 1, __ATOMIC_RELAXED);
+        slot->readahead_after_s = 0;
+        slot->readahead_before_s = 0;
+    }
+
+    time_t duration_s = before_s - after_s;
+    time_t previous_duration_s = slot->before_s - slot->after_s;
+    time_t step_s = after_s - slot->after_s;
+    time_t tolerance_s = MAX(update_every_s, duration_s / 10);
+
+    if(step_s && labs(duration_s - previous_duration_s) <= tolerance_s && (!slot->step_s || (step_s > 0) == (slot->step_s > 0)))
+        slot->sequential++;
+    else {
+        slot->sequential = 0;
+        pg_cache_readahead_slot_forget(slot);
+    }
+
+    slot->after_s = after_s;
+    slot->before_s = before_s;
+    slot->step_s = step_s;
+
+    if(slot->sequential >= PG_CACHE_READAHEAD_MIN_SEQUENTIAL && !slot->readahead_before_s) {
+        time_t distance_s = labs(step_s) * PG_CACHE_READAHEAD_STEPS;
+
+        if(step_s > 0) {
+            readahead_after_s = before_s;
+            readahead_before_s = MIN(before_s + distance_s, last_time_s);
+        }
+        else {
+            readahead_after_s = MAX(after_s - distance_s, first_time_s);
+            readahead_before_s = after_s;
+        }
+
+        if(readahead_before_s > readahead_after_s) {
+            slot->readahead_after_s = readahead_after_s;
+            slot->readahead_before_s = readahead_before_s;
+        }
+        else
+            readahead_before_s = 0;
+    }
+
+    netdata_spinlock_unlock(&slot->spinlock);
+
+    if(!readahead_before_s || !ctx_is_available_for_queries(ctx))
+        return;
+
+    // the prep thread has the only reference, the pages are released to the cache when the workers finish
+    PDC *pdc = pg_cache_pdc_create(ctx, metric, readahead_after_s, readahead_before_s, STORAGE_PRIORITY_BEST_EFFORT);
+    pdc->readahead = true;
+    rrdeng_enq_cmd(ctx, RRDENG_OPCODE_QUERY, pdc, NULL, STORAGE_PRIORITY_BEST_EFFORT, NULL, NULL);
+
+    __atomic_add_fetch(&rrdeng_cache_efficiency_stats.readahead_requests, 1, __ATOMIC_RELAXED);
+}
+
 /**
  * Searches for pages in a time range and triggers disk I/O if necessary and possible.
  * @param ctx DB context
@@ -811,19 +1081,7 @@ void pg_cache_preload(struct rrdeng_query_handle *handle) {
     if (unlikely(!handle || !handle->metric))
         return;
 
-    __atomic_add_fetch(&handle->ctx->atomic.inflight_queries, 1, __ATOMIC_RELAXED);
-    __atomic_add_fetch(&rrdeng_cache_efficiency_stats.currently_running_queries, 1, __ATOMIC_RELAXED);
-    handle->pdc = pdc_get();
-    handle->pdc->metric = mrg_metric_dup(main_mrg, handle->metric);
-    handle->pdc->start_time_s = handle->start_time_s;
-    handle->pdc->end_time_s = handle->end_time_s;
-    handle->pdc->priority = handle->priority;
-    handle->pdc->optimal_end_time_s = handle->end_time_s;
-    handle->pdc->ctx = handle->ctx;
-    handle->pdc->refcount = 1;
-    netdata_spinlock_init(&handle->pdc->refcount_spinlock);
-    completion_init(&handle->pdc->prep_completion);
-    completion_init(&handle->pdc->page_completion);
+    handle->pdc = pg_cache_pdc_create(handle->ctx, handle->metric, handle->start_time_s, handle->end_time_s, handle->priority);
 
     if(ctx_is_available_for_queries(handle->ctx)) {
         handle->pdc->refcount++; // we get 1 for the query thread and 1 for the prep thread
@@ -832,6 +1090,9 @@ void pg_cache_preload(struct rrdeng_query_handle *handle) {
             rrdeng_prep_query(handle->pdc);
         else
             rrdeng_enq_cmd(handle->ctx, RRDENG_OPCODE_QUERY, handle->pdc, NULL, handle->priority, NULL, NULL);
+
+        if(pg_cache_readahead_enabled)
+            pg_cache_readahead(handle->ctx, handle->metric, handle->start_time_s, handle->end_time_s);
     }
     else {
         completion_mark_complete(&handle->pdc->prep_completion);
@@ -910,6 +1171,7 @@ struct pgc_page *pg_cache_lookup_next(
         time_t page_end_time_s = pgc_page_end_time_s(page);
         time_t page_update_every_s = pgc_page_update_every_s(page);
         size_t page_length = pgc_page_data_size(main_cache, page);
+        size_t entries_by_size = page_entries_by_data(main_cache_page_type(page), pgc_page_data(page), page_length);
 
         if(unlikely(page_start_time_s == INVALID_TIME || page_end_time_s == INVALID_TIME)) {
             __atomic_add_fetch(&rrdeng_cache_efficiency_stats.pages_zero_time_skipped, 1, __ATOMIC_RELAXED);
@@ -918,7 +1180,7 @@ struct pgc_page *pg_cache_lookup_next(
             pd->page = page = NULL;
             continue;
         }
-        else if(page_length > RRDENG_BLOCK_SIZE) {
+        else if(page_length > RRDENG_BLOCK_SIZE || !entries_by_size) {
             __atomic_add_fetch(&rrdeng_cache_efficiency_stats.pages_invalid_size_skipped, 1, __ATOMIC_RELAXED);
             pgc_page_to_clean_evict_or_release(main_cache, page);
             pdc_page_status_set(pd, PDC_PAGE_INVALID | PDC_PAGE_RELEASED);
@@ -932,7 +1194,6 @@ struct pgc_page *pg_cache_lookup_next(
                 pd->update_every_s = (uint32_t) page_update_every_s;
             }
 
-            size_t entries_by_size = page_entries_by_size(page_length, CTX_POINT_SIZE_BYTES(ctx));
             size_t entries_by_time = page_entries_by_time(page_start_time_s, page_end_time_s, page_update_every_s);
             if(unlikely(entries_by_size < entries_by_time)) {
                 time_t fixed_page_end_time_s = (time_t)(page_start_time_s + (entries_by_size - 1) * page_update_every_s);
@@ -1062,7 +1323,7 @@ size_t dynamic_extent_cache_size(void) {
 
 void pgc_and_mrg_initialize(void)
 {
-    main_mrg = mrg_create();
+    main_mrg = mrg_create(0);
 
     size_t target_cache_size = (size_t)default_rrdeng_page_cache_mb * 1024ULL * 1024ULL;
     size_t main_cache_size = (target_cache_size / 100) * 95;
@@ -1078,17 +1339,21 @@ void pgc_and_mrg_initialize(void)
             "main_cache",
             main_cache_size,
             main_cache_free_clean_page_callback,
-            (size_t) rrdeng_pages_per_extent,
+            (size_t) rrdeng_pages_per_extent * rrdeng_extents_per_flush,
             main_cache_flush_dirty_page_init_callback,
             main_cache_flush_dirty_page_callback,
             10,
             10240,                                      // if there are that many threads, evict so many at once!
             1000,                           //
             5,                                          // don't delay too much other threads
-            PGC_OPTIONS_AUTOSCALE,                               // AUTOSCALE = 2x max hot pages
+            PGC_OPTIONS_AUTOSCALE | PGC_OPTIONS_LOCKLESS_INDEX_READERS, // AUTOSCALE = 2x max hot pages
             0,                                                 // 0 = as many as the system cpus
-            0
+            sizeof(uint8_t)                                    // the page type
     );
+    pgc_set_eviction_policy(main_cache, (PGC_EVICTION_POLICY)main_cache_eviction_policy);
+
+    if(dbengine_page_memory_policy != ARAL_MEMORY_DEFAULT)
+        pgc_set_memory_policy(main_cache, dbengine_page_memory_policy);
 
     open_cache = pgc_create(
             "open_cache",
@@ -1118,7 +1383,7 @@ void pgc_and_mrg_initialize(void)
             10,                                         // it will lose up to that extents at once!
             100,                            //
             2,                                          // don't delay too much other threads
-            PGC_OPTIONS_AUTOSCALE | PGC_OPTIONS_EVICT_PAGES_INLINE | PGC_OPTIONS_FLUSH_PAGES_INLINE,
+            PGC_OPTIONS_AUTOSCALE | PGC_OPTIONS_EVICT_PAGES_INLINE | PGC_OPTIONS_FLUSH_PAGES_INLINE | PGC_OPTIONS_LOCKLESS_INDEX_READERS,
             0,                                                 // 0 = as many as the system cpus
             0
     );
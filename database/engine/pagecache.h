@@ -9,10 +9,20 @@ extern struct mrg *main_mrg;
 extern struct pgc *main_cache;
 extern struct pgc *open_cache;
 extern struct pgc *extent_cache;
+extern uint8_t main_cache_eviction_policy; // PGC_EVICTION_POLICY
+extern bool pg_cache_readahead_enabled;
+extern bool pg_cache_rle_enabled;
+
+// encodes a page as PAGE_RLE into encoded (of RRDENG_BLOCK_SIZE bytes), if this makes it at least 2 times smaller
+// returns the length of the encoded page, or zero
+size_t pg_cache_page_rle_encode(void *encoded, uint8_t type, const void *page, size_t page_length);
 
 /* Forward declarations */
 struct rrdengine_instance;
 
+// main cache pages carry their page type (PAGE_METRICS, PAGE_TIER, etc.) as custom data
+#define main_cache_page_type(page) (*(uint8_t *)pgc_page_custom_data(main_cache, page))
+
 #define INVALID_TIME (0)
 #define MAX_PAGE_CACHE_FETCH_RETRIES (3)
 #define PAGE_CACHE_FETCH_WAIT_TIMEOUT (3)
@@ -28,6 +38,7 @@ struct page_descr_with_data {
     uint32_t update_every_s;
     uint32_t page_length;
     uint8_t *page;
+    bool page_encoded;                  // page is a copy of the cache page, to be freed with the descriptor
 
     struct {
         struct page_descr_with_data *prev;
@@ -18,6 +18,10 @@ struct extent_page_details_list {
         struct extent_page_details_list *prev;
         struct extent_page_details_list *next;
     } query;
+
+    struct {
+        struct extent_page_details_list *next;
+    } batch;
 };
 
 typedef struct datafile_extent_offset_list {
@@ -668,7 +672,18 @@ VALIDATED_PAGE_DESCRIPTOR validate_page(
 
     // always calculate entries by size
     vd.point_size = page_type_size[vd.type];
-    vd.entries = page_entries_by_size(vd.page_length, vd.point_size);
+    if(likely(vd.type != PAGE_GORILLA_METRICS && vd.type != PAGE_RLE))
+        vd.entries = vd.point_size ? page_entries_by_size(vd.page_length, vd.point_size) : 0;
+
+    else {
+        // gorilla and rle pages have variable length points,
+        // so we trust the caller or the time-range
+        time_t ue = update_every_s ? update_every_s : overwrite_zero_update_every_s;
+        if(entries)
+            vd.entries = entries;
+        else if(vd.end_time_s >= vd.start_time_s)
+            vd.entries = page_entries_by_time(vd.start_time_s, vd.end_time_s, ue);
+    }
 
     // allow to be called without entries (when loading pages from disk)
     if(!entries)
@@ -688,6 +703,8 @@ VALIDATED_PAGE_DESCRIPTOR validate_page(
     bool updated = false;
 
     if( have_read_error                                         ||
+        vd.type > PAGE_TYPE_MAX                                 ||
+        vd.entries == 0                                         ||
         vd.page_length == 0                                     ||
         vd.page_length > RRDENG_BLOCK_SIZE                      ||
         vd.start_time_s > vd.end_time_s                         ||
@@ -883,6 +900,51 @@ static void epdl_extent_loading_error_log(struct rrdengine_instance *ctx, EPDL *
                 msg);
 }
 
+#ifdef HAVE_ZSTD
+// the decompression context of each thread is freed by this key, when the thread exits
+static pthread_key_t dbengine_zstd_dctx_key;
+static pthread_once_t dbengine_zstd_dctx_key_once = PTHREAD_ONCE_INIT;
+
+static void dbengine_zstd_dctx_free(void *dctx) {
+    ZSTD_freeDCtx(dctx);
+}
+
+static void dbengine_zstd_dctx_key_create(void) {
+    if(pthread_key_create(&dbengine_zstd_dctx_key, dbengine_zstd_dctx_free) != 0)
+        fatal("DBENGINE: cannot create the thread key of the ZSTD decompression contexts");
+}
+
+static ZSTD_DCtx *dbengine_zstd_dctx(void) {
+    static __thread ZSTD_DCtx *dctx = NULL;
+
+    if(unlikely(!dctx)) {
+        pthread_once(&dbengine_zstd_dctx_key_once, dbengine_zstd_dctx_key_create);
+
+        dctx = ZSTD_createDCtx();
+        if(!dctx)
+            fatal("DBENGINE: cannot create a ZSTD decompression context");
+
+        pthread_setspecific(dbengine_zstd_dctx_key, dctx);
+    }
+
+    return dctx;
+}
+#endif
+
+static inline bool pdc_compression_algorithm_supported(uint8_t algorithm) {
+    switch(algorithm) {
+        case RRD_NO_COMPRESSION:
+        case RRD_LZ4:
+#ifdef HAVE_ZSTD
+        case RRD_ZSTD:
+#endif
+            return true;
+
+        default:
+            return false;
+    }
+}
+
 static bool epdl_populate_pages_from_extent_data(
         struct rrdengine_instance *ctx,
         void *data,
@@ -927,7 +989,7 @@ static bool epdl_populate_pages_from_extent_data(
     if( !can_use_data ||
         count < 1 ||
         count > MAX_PAGES_PER_EXTENT ||
-        (header->compression_algorithm != RRD_NO_COMPRESSION && header->compression_algorithm != RRD_LZ4) ||
+        !pdc_compression_algorithm_supported(header->compression_algorithm) ||
         (payload_length != trailer_offset - payload_offset) ||
         (data_length != payload_offset + payload_length + sizeof(*trailer))
             ) {
@@ -967,11 +1029,25 @@ static bool epdl_populate_pages_from_extent_data(
             eb = extent_buffer_get(uncompressed_payload_length);
             uncompressed_buf = eb->data;
 
+#ifdef HAVE_ZSTD
+            if(header->compression_algorithm == RRD_ZSTD) {
+                size_t zret = ZSTD_decompressDCtx(dbengine_zstd_dctx(), uncompressed_buf, uncompressed_payload_length,
+                                                  data + payload_offset, payload_length);
+                ret = ZSTD_isError(zret) ? -1 : (int)zret;
+            }
+            else
+#endif
             ret = LZ4_decompress_safe(data + payload_offset, uncompressed_buf,
                                       (int) payload_length, (int) uncompressed_payload_length);
 
-            __atomic_add_fetch(&ctx->stats.before_decompress_bytes, payload_length, __ATOMIC_RELAXED);
-            __atomic_add_fetch(&ctx->stats.after_decompress_bytes, ret, __ATOMIC_RELAXED);
+            if(unlikely(ret != (int)uncompressed_payload_length)) {
+                have_read_error = true;
+                epdl_extent_loading_error_log(ctx, epdl, NULL, "DECOMPRESSION FAILED");
+            }
+            else {
+                __atomic_add_fetch(&ctx->stats.before_decompress_bytes, payload_length, __ATOMIC_RELAXED);
+                __atomic_add_fetch(&ctx->stats.after_decompress_bytes, ret, __ATOMIC_RELAXED);
+            }
         }
     }
 
@@ -1062,7 +1138,8 @@ static bool epdl_populate_pages_from_extent_data(
                 .end_time_s = vd.end_time_s,
                 .update_every_s = (uint32_t) vd.update_every_s,
                 .size = (size_t) ((page_data == DBENGINE_EMPTY_PAGE) ? 0 : vd.page_length),
-                .data = page_data
+                .data = page_data,
+                .custom_data = &vd.type,
         };
 
         bool added = true;
@@ -1121,18 +1198,24 @@ static bool epdl_populate_pages_from_extent_data(
     return true;
 }
 
+static inline void *datafile_extent_read_buffer(unsigned size_bytes) {
+    void *buffer;
+    int ret = posix_memalign(&buffer, RRDFILE_ALIGNMENT, ALIGN_BYTES_CEILING(size_bytes));
+    if (unlikely(ret))
+        fatal("DBENGINE: posix_memalign(): %s", strerror(ret));
+
+    return buffer;
+}
+
 static inline void *datafile_extent_read(struct rrdengine_instance *ctx, uv_file file, unsigned pos, unsigned size_bytes)
 {
-    void *buffer;
     uv_fs_t request;
 
     unsigned real_io_size = ALIGN_BYTES_CEILING(size_bytes);
-    int ret = posix_memalign(&buffer, RRDFILE_ALIGNMENT, real_io_size);
-    if (unlikely(ret))
-        fatal("DBENGINE: posix_memalign(): %s", strerror(ret));
+    void *buffer = datafile_extent_read_buffer(size_bytes);
 
     uv_buf_t iov = uv_buf_init(buffer, real_io_size);
-    ret = uv_fs_read(NULL, &request, file, &iov, 1, pos, NULL);
+    int ret = uv_fs_read(NULL, &request, file, &iov, 1, pos, NULL);
     if (unlikely(-1 == ret)) {
         ctx_io_error(ctx);
         posix_memfree(buffer);
@@ -1150,10 +1233,73 @@ static inline void datafile_extent_read_free(void *buffer) {
     posix_memfree(buffer);
 }
 
-void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *epdl, bool worker) {
-    size_t *statistics_counter = NULL;
-    PDC_PAGE_STATUS not_loaded_pages_tag = 0, loaded_pages_tag = 0;
+// read the extents of many EPDLs with a single io_uring submission
+// returns false when io_uring cannot be used, so that the caller will use libuv
+static bool datafile_extents_read_io_uring(struct rrdengine_instance *ctx, EPDL **epdls, void **extents, size_t count) {
+    RRDENG_IO_REQUEST requests[EPDL_READ_BATCH_MAX];
+
+    internal_fatal(count > EPDL_READ_BATCH_MAX, "DBENGINE: too many extents to read in a batch");
+
+    for(size_t i = 0; i < count ;i++) {
+        requests[i] = (RRDENG_IO_REQUEST) {
+                .fd = epdls[i]->file,
+                .write = false,
+                .buffer = datafile_extent_read_buffer(epdls[i]->extent_size),
+                .size = ALIGN_BYTES_CEILING(epdls[i]->extent_size),
+                .offset = epdls[i]->extent_offset,
+                .result = 0,
+        };
+    }
 
+    if(!rrdeng_io_uring_submit_and_wait(requests, count)) {
+        for(size_t i = 0; i < count ;i++)
+            datafile_extent_read_free(requests[i].buffer);
+
+        return false;
+    }
+
+    for(size_t i = 0; i < count ;i++) {
+        if(unlikely(requests[i].result < (ssize_t)epdls[i]->extent_size)) {
+            ctx_io_error(ctx);
+            datafile_extent_read_free(requests[i].buffer);
+            extents[i] = NULL;
+        }
+        else {
+            ctx_io_read_op_bytes(ctx, requests[i].size);
+            extents[i] = requests[i].buffer;
+        }
+    }
+
+    return true;
+}
+
+static PGC_PAGE *epdl_extent_cache_add(struct rrdengine_instance *ctx, EPDL *epdl, void *extent_data) {
+    void *copied_extent_compressed_data = dbengine_extent_alloc(epdl->extent_size);
+    memcpy(copied_extent_compressed_data, extent_data, epdl->extent_size);
+    datafile_extent_read_free(extent_data);
+
+    bool added = false;
+    PGC_PAGE *extent_cache_page = pgc_page_add_and_acquire(extent_cache, (PGC_ENTRY) {
+            .hot = false,
+            .section = (Word_t) ctx,
+            .metric_id = (Word_t) epdl->datafile->fileno,
+            .start_time_s = (time_t) epdl->extent_offset,
+            .size = epdl->extent_size,
+            .end_time_s = 0,
+            .update_every_s = 0,
+            .data = copied_extent_compressed_data,
+    }, &added);
+
+    if (!added) {
+        dbengine_extent_free(copied_extent_compressed_data, epdl->extent_size);
+        internal_fatal(epdl->extent_size != pgc_page_data_size(extent_cache, extent_cache_page),
+                       "DBENGINE: cache size does not match the expected size");
+    }
+
+    return extent_cache_page;
+}
+
+static bool epdl_should_stop(EPDL *epdl) {
     bool should_stop = __atomic_load_n(&epdl->pdc->workers_should_stop, __ATOMIC_RELAXED);
     for(EPDL *ep = epdl->query.next; ep ;ep = ep->query.next) {
         internal_fatal(ep->datafile != epdl->datafile, "DBENGINE: datafiles do not match");
@@ -1167,72 +1313,33 @@ void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *e
         }
     }
 
+    return should_stop;
+}
+
+static void epdl_populate_pages_and_release(struct rrdengine_instance *ctx, EPDL *epdl, PGC_PAGE *extent_cache_page, bool extent_found_in_cache, bool should_stop, bool worker) {
+    size_t *statistics_counter = NULL;
+    PDC_PAGE_STATUS not_loaded_pages_tag = 0, loaded_pages_tag = 0;
+
     if(unlikely(should_stop)) {
         statistics_counter = &rrdeng_cache_efficiency_stats.pages_load_fail_cancelled;
         not_loaded_pages_tag = PDC_PAGE_CANCELLED;
         goto cleanup;
     }
 
-    if(worker)
-        worker_is_busy(UV_EVENT_DBENGINE_EXTENT_CACHE_LOOKUP);
-
-    bool extent_found_in_cache = false;
-
-    void *extent_compressed_data = NULL;
-    PGC_PAGE *extent_cache_page = pgc_page_get_and_acquire(
-            extent_cache, (Word_t)ctx,
-            (Word_t)epdl->datafile->fileno, (time_t)epdl->extent_offset,
-            PGC_SEARCH_EXACT);
-
-    if(extent_cache_page) {
-        extent_compressed_data = pgc_page_data(extent_cache_page);
-        internal_fatal(epdl->extent_size != pgc_page_data_size(extent_cache, extent_cache_page),
-                       "DBENGINE: cache size does not match the expected size");
-
+    if(extent_found_in_cache) {
         loaded_pages_tag |= PDC_PAGE_EXTENT_FROM_CACHE;
         not_loaded_pages_tag |= PDC_PAGE_EXTENT_FROM_CACHE;
-        extent_found_in_cache = true;
     }
-    else {
-        if(worker)
-            worker_is_busy(UV_EVENT_DBENGINE_EXTENT_MMAP);
-
-        void *extent_data = datafile_extent_read(ctx, epdl->file, epdl->extent_offset, epdl->extent_size);
-        if(extent_data != NULL) {
-
-            void *copied_extent_compressed_data = dbengine_extent_alloc(epdl->extent_size);
-            memcpy(copied_extent_compressed_data, extent_data, epdl->extent_size);
-            datafile_extent_read_free(extent_data);
-
-            if(worker)
-                worker_is_busy(UV_EVENT_DBENGINE_EXTENT_CACHE_LOOKUP);
-
-            bool added = false;
-            extent_cache_page = pgc_page_add_and_acquire(extent_cache, (PGC_ENTRY) {
-                    .hot = false,
-                    .section = (Word_t) ctx,
-                    .metric_id = (Word_t) epdl->datafile->fileno,
-                    .start_time_s = (time_t) epdl->extent_offset,
-                    .size = epdl->extent_size,
-                    .end_time_s = 0,
-                    .update_every_s = 0,
-                    .data = copied_extent_compressed_data,
-            }, &added);
-
-            if (!added) {
-                dbengine_extent_free(copied_extent_compressed_data, epdl->extent_size);
-                internal_fatal(epdl->extent_size != pgc_page_data_size(extent_cache, extent_cache_page),
-                               "DBENGINE: cache size does not match the expected size");
-            }
-
-            extent_compressed_data = pgc_page_data(extent_cache_page);
-
-            loaded_pages_tag |= PDC_PAGE_EXTENT_FROM_DISK;
-            not_loaded_pages_tag |= PDC_PAGE_EXTENT_FROM_DISK;
-        }
+    else if(extent_cache_page) {
+        loaded_pages_tag |= PDC_PAGE_EXTENT_FROM_DISK;
+        not_loaded_pages_tag |= PDC_PAGE_EXTENT_FROM_DISK;
     }
 
-    if(extent_compressed_data) {
+    if(extent_cache_page) {
+        void *extent_compressed_data = pgc_page_data(extent_cache_page);
+        internal_fatal(epdl->extent_size != pgc_page_data_size(extent_cache, extent_cache_page),
+                       "DBENGINE: cache size does not match the expected size");
+
         // Need to decompress and then process the pagelist
         bool extent_used = epdl_populate_pages_from_extent_data(
                 ctx, extent_compressed_data, epdl->extent_size,
@@ -1248,15 +1355,14 @@ void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *e
             not_loaded_pages_tag |= PDC_PAGE_FAILED_INVALID_EXTENT;
             statistics_counter = &rrdeng_cache_efficiency_stats.pages_load_fail_invalid_extent;
         }
+
+        pgc_page_release(extent_cache, extent_cache_page);
     }
     else {
         not_loaded_pages_tag |= PDC_PAGE_FAILED_TO_MAP_EXTENT;
         statistics_counter = &rrdeng_cache_efficiency_stats.pages_load_fail_cant_mmap_extent;
     }
 
-    if(extent_cache_page)
-        pgc_page_release(extent_cache, extent_cache_page);
-
 cleanup:
     // remove it from the datafile extent_queries
     // this can be called multiple times safely
@@ -1277,6 +1383,82 @@ void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *e
         // Free the Judy that holds the requested pagelist and the extents
         epdl_destroy(ep);
     }
+}
+
+void epdl_batch_append(EPDL *head, EPDL *epdl) {
+    EPDL *last = head;
+    while(last->batch.next)
+        last = last->batch.next;
+
+    last->batch.next = epdl;
+    epdl->batch.next = NULL;
+}
+
+// epdl may be the head of a batch of EPDLs (linked via batch.next),
+// in which case all the extents not found in the extent cache are read together
+void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *epdl, bool worker) {
+    EPDL *epdls[EPDL_READ_BATCH_MAX];
+    PGC_PAGE *extent_cache_pages[EPDL_READ_BATCH_MAX];
+    bool should_stop[EPDL_READ_BATCH_MAX];
+    size_t count = 0;
+
+    for(EPDL *ep = epdl, *next = NULL; ep ;ep = next) {
+        next = ep->batch.next;
+        ep->batch.next = NULL;
+
+        internal_fatal(count >= EPDL_READ_BATCH_MAX, "DBENGINE: EPDL batch is too big");
+        epdls[count++] = ep;
+    }
+
+    if(worker)
+        worker_is_busy(UV_EVENT_DBENGINE_EXTENT_CACHE_LOOKUP);
+
+    EPDL *to_read[EPDL_READ_BATCH_MAX];
+    size_t to_read_index[EPDL_READ_BATCH_MAX];
+    size_t to_read_count = 0;
+
+    for(size_t i = 0; i < count ;i++) {
+        extent_cache_pages[i] = NULL;
+        should_stop[i] = epdl_should_stop(epdls[i]);
+        if(unlikely(should_stop[i]))
+            continue;
+
+        extent_cache_pages[i] = pgc_page_get_and_acquire(
+                extent_cache, (Word_t)ctx,
+                (Word_t)epdls[i]->datafile->fileno, (time_t)epdls[i]->extent_offset,
+                PGC_SEARCH_EXACT);
+
+        if(!extent_cache_pages[i]) {
+            to_read_index[to_read_count] = i;
+            to_read[to_read_count++] = epdls[i];
+        }
+    }
+
+    bool extent_found_in_cache[EPDL_READ_BATCH_MAX];
+    for(size_t i = 0; i < count ;i++)
+        extent_found_in_cache[i] = extent_cache_pages[i] != NULL;
+
+    if(to_read_count) {
+        if(worker)
+            worker_is_busy(UV_EVENT_DBENGINE_EXTENT_MMAP);
+
+        void *extents[EPDL_READ_BATCH_MAX];
+        if(!rrdeng_io_uring_enabled() || !datafile_extents_read_io_uring(ctx, to_read, extents, to_read_count)) {
+            for(size_t i = 0; i < to_read_count ;i++)
+                extents[i] = datafile_extent_read(ctx, to_read[i]->file, to_read[i]->extent_offset, to_read[i]->extent_size);
+        }
+
+        if(worker)
+            worker_is_busy(UV_EVENT_DBENGINE_EXTENT_CACHE_LOOKUP);
+
+        for(size_t i = 0; i < to_read_count ;i++) {
+            if(extents[i])
+                extent_cache_pages[to_read_index[i]] = epdl_extent_cache_add(ctx, to_read[i], extents[i]);
+        }
+    }
+
+    for(size_t i = 0; i < count ;i++)
+        epdl_populate_pages_and_release(ctx, epdls[i], extent_cache_pages[i], extent_found_in_cache[i], should_stop[i], worker);
 
     if(worker)
         worker_is_idle();
@@ -34,6 +34,10 @@ typedef void (*execute_extent_page_details_list_t)(struct rrdengine_instance *ct
 void pdc_to_epdl_router(struct rrdengine_instance *ctx, struct page_details_control *pdc, execute_extent_page_details_list_t exec_first_extent_list, execute_extent_page_details_list_t exec_rest_extent_list);
 void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *epdl, bool worker);
 
+// the max number of EPDLs whose extents are read from disk together
+#define EPDL_READ_BATCH_MAX 16
+void epdl_batch_append(EPDL *head, EPDL *epdl);
+
 size_t pdc_cache_size(void);
 size_t pd_cache_size(void);
 size_t epdl_cache_size(void);
@@ -0,0 +1,687 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "reader.h"
+
+#define RRDENG_READER_POINTS 1024
+
+struct rrdeng_reader_mapping {
+    int fd;
+    void *data;
+    size_t size;
+};
+
+struct rrdeng_reader_file {
+    unsigned tier;
+    unsigned fileno;
+    time_t first_time_s;
+    time_t last_time_s;
+    struct rrdeng_reader_mapping journal;
+    struct rrdeng_reader_mapping datafile;
+};
+
+struct rrdeng_reader {
+    char *path;
+
+    size_t count;
+    struct rrdeng_reader_file *files;
+
+    struct {
+        // the last extent used, uncompressed
+        struct rrdeng_reader_file *file;
+        uint64_t offset;
+        struct rrdeng_df_extent_header *header;
+        uint8_t *payload;
+        size_t payload_length;
+        uint8_t *buffer;                        // for decompression
+    } extent;
+
+    uint8_t page[RRDENG_BLOCK_SIZE] __attribute__((aligned(sizeof(uint64_t))));
+    STORAGE_POINT points[RRDENG_READER_POINTS];
+
+#ifdef HAVE_ZSTD
+    ZSTD_DCtx *zstd;
+#endif
+};
+
+// ----------------------------------------------------------------------------
+// files
+
+static bool rrdeng_reader_map(const char *filename, struct rrdeng_reader_mapping *m) {
+    m->fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if(m->fd == -1) {
+        error("DBENGINE READER: cannot open file '%s'", filename);
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(m->fd, &st) != 0 || st.st_size <= 0) {
+        error("DBENGINE READER: cannot get the size of file '%s'", filename);
+        close(m->fd);
+        m->fd = -1;
+        return false;
+    }
+
+    m->size = (size_t)st.st_size;
+    m->data = mmap(NULL, m->size, PROT_READ, MAP_SHARED, m->fd, 0);
+    if(m->data == MAP_FAILED) {
+        error("DBENGINE READER: cannot mmap file '%s'", filename);
+        m->data = NULL;
+        close(m->fd);
+        m->fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+static void rrdeng_reader_unmap(struct rrdeng_reader_mapping *m) {
+    if(m->data)
+        munmap(m->data, m->size);
+
+    if(m->fd != -1)
+        close(m->fd);
+
+    m->data = NULL;
+    m->fd = -1;
+}
+
+static bool rrdeng_reader_file_open(RRDENG_READER *rdr, struct rrdeng_reader_file *f) {
+    char filename[FILENAME_MAX + 1];
+
+    f->journal.fd = f->datafile.fd = -1;
+
+    snprintfz(filename, FILENAME_MAX, "%s/" WALFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION_V2,
+              rdr->path, f->tier, f->fileno);
+
+    if(!rrdeng_reader_map(filename, &f->journal))
+        return false;
+
+    if(f->journal.size < sizeof(struct journal_v2_header) ||
+       journalfile_v2_validate(f->journal.data, f->journal.size, 0) != 0) {
+        error("DBENGINE READER: journal file '%s' is not valid, ignoring it", filename);
+        goto failed;
+    }
+
+    struct journal_v2_header *j2_header = f->journal.data;
+    f->first_time_s = (time_t)(j2_header->start_time_ut / USEC_PER_SEC);
+    f->last_time_s = (time_t)(j2_header->end_time_ut / USEC_PER_SEC);
+
+    snprintfz(filename, FILENAME_MAX, "%s/" DATAFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL DATAFILE_EXTENSION,
+              rdr->path, f->tier, f->fileno);
+
+    if(!rrdeng_reader_map(filename, &f->datafile))
+        goto failed;
+
+    struct rrdeng_df_sb *sb = f->datafile.data;
+    if(f->datafile.size < sizeof(*sb) ||
+       strncmp(sb->magic_number, RRDENG_DF_MAGIC, RRDENG_MAGIC_SZ) != 0 ||
+       strncmp(sb->version, RRDENG_DF_VER, RRDENG_VER_SZ) != 0) {
+        error("DBENGINE READER: datafile '%s' has an invalid superblock, ignoring it", filename);
+        goto failed;
+    }
+
+    return true;
+
+failed:
+    rrdeng_reader_unmap(&f->datafile);
+    rrdeng_reader_unmap(&f->journal);
+    return false;
+}
+
+static int rrdeng_reader_file_compare(const void *a, const void *b) {
+    const struct rrdeng_reader_file *f1 = a, *f2 = b;
+
+    if(f1->tier != f2->tier)
+        return (f1->tier < f2->tier) ? -1 : 1;
+
+    if(f1->fileno != f2->fileno)
+        return (f1->fileno < f2->fileno) ? -1 : 1;
+
+    return 0;
+}
+
+RRDENG_READER *rrdeng_reader_open(const char *dbfiles_path) {
+    DIR *dir = opendir(dbfiles_path);
+    if(!dir) {
+        error("DBENGINE READER: cannot open directory '%s'", dbfiles_path);
+        return NULL;
+    }
+
+    RRDENG_READER *rdr = callocz(1, sizeof(RRDENG_READER));
+    rdr->path = strdupz(dbfiles_path);
+
+    size_t size = 0;
+    size_t ext_len = strlen(WALFILE_EXTENSION_V2);
+    struct dirent *de;
+    while((de = readdir(dir))) {
+        unsigned tier, fileno;
+        size_t len = strlen(de->d_name);
+
+        if(len <= ext_len || strcmp(&de->d_name[len - ext_len], WALFILE_EXTENSION_V2) != 0)
+            continue;
+
+        if(sscanf(de->d_name, WALFILE_PREFIX RRDENG_FILE_NUMBER_SCAN_TMPL WALFILE_EXTENSION_V2, &tier, &fileno) != 2)
+            continue;
+
+        if(rdr->count == size) {
+            size = size ? size * 2 : 64;
+            rdr->files = reallocz(rdr->files, size * sizeof(*rdr->files));
+        }
+
+        struct rrdeng_reader_file *f = &rdr->files[rdr->count];
+        memset(f, 0, sizeof(*f));
+        f->tier = tier;
+        f->fileno = fileno;
+
+        if(rrdeng_reader_file_open(rdr, f))
+            rdr->count++;
+    }
+    closedir(dir);
+
+    if(!rdr->count) {
+        error("DBENGINE READER: no usable journal v2 files found in '%s'", dbfiles_path);
+        rrdeng_reader_close(rdr);
+        return NULL;
+    }
+
+    qsort(rdr->files, rdr->count, sizeof(*rdr->files), rrdeng_reader_file_compare);
+
+    rdr->extent.buffer = mallocz(MAX_PAGES_PER_EXTENT * RRDENG_BLOCK_SIZE);
+
+#ifdef HAVE_ZSTD
+    rdr->zstd = ZSTD_createDCtx();
+    if(!rdr->zstd)
+        fatal("DBENGINE READER: cannot create a ZSTD decompression context");
+#endif
+
+    info("DBENGINE READER: opened %zu datafiles in '%s'", rdr->count, dbfiles_path);
+    return rdr;
+}
+
+void rrdeng_reader_close(RRDENG_READER *rdr) {
+    if(!rdr) return;
+
+    for(size_t i = 0; i < rdr->count ;i++) {
+        rrdeng_reader_unmap(&rdr->files[i].datafile);
+        rrdeng_reader_unmap(&rdr->files[i].journal);
+    }
+
+#ifdef HAVE_ZSTD
+    if(rdr->zstd)
+        ZSTD_freeDCtx(rdr->zstd);
+#endif
+
+    freez(rdr->extent.buffer);
+    freez(rdr->files);
+    freez(rdr->path);
+    freez(rdr);
+}
+
+size_t rrdeng_reader_files(RRDENG_READER *rdr) {
+    return rdr->count;
+}
+
+void rrdeng_reader_file(RRDENG_READER *rdr, size_t file, unsigned *tier, unsigned *fileno) {
+    *tier = rdr->files[file].tier;
+    *fileno = rdr->files[file].fileno;
+}
+
+void rrdeng_reader_retention(RRDENG_READER *rdr, time_t *first_time_s, time_t *last_time_s) {
+    time_t first = 0, last = 0;
+
+    for(size_t i = 0; i < rdr->count ;i++) {
+        if(!first || rdr->files[i].first_time_s < first)
+            first = rdr->files[i].first_time_s;
+
+        if(rdr->files[i].last_time_s > last)
+            last = rdr->files[i].last_time_s;
+    }
+
+    *first_time_s = first;
+    *last_time_s = last;
+}
+
+// ----------------------------------------------------------------------------
+// metrics
+
+struct rrdeng_reader_metric {
+    uuid_t uuid;
+    time_t first_time_s;
+    time_t last_time_s;
+    time_t update_every_s;
+};
+
+static int rrdeng_reader_metric_compare(const void *a, const void *b) {
+    const struct rrdeng_reader_metric *m1 = a, *m2 = b;
+    int rc = uuid_compare(m1->uuid, m2->uuid);
+    if(rc) return rc;
+
+    // for the same metric, the latest last
+    if(m1->last_time_s != m2->last_time_s)
+        return (m1->last_time_s < m2->last_time_s) ? -1 : 1;
+
+    return 0;
+}
+
+size_t rrdeng_reader_foreach_metric(RRDENG_READER *rdr, rrdeng_reader_metric_cb cb, void *data) {
+    size_t entries = 0;
+    for(size_t i = 0; i < rdr->count ;i++)
+        entries += ((struct journal_v2_header *)rdr->files[i].journal.data)->metric_count;
+
+    if(!entries)
+        return 0;
+
+    struct rrdeng_reader_metric *array = mallocz(entries * sizeof(*array));
+    size_t used = 0;
+
+    for(size_t i = 0; i < rdr->count ;i++) {
+        struct journal_v2_header *j2_header = rdr->files[i].journal.data;
+        time_t journal_start_time_s = (time_t)(j2_header->start_time_ut / USEC_PER_SEC);
+        struct journal_metric_list *metric = (void *)((uint8_t *)j2_header + j2_header->metric_offset);
+
+        for(uint32_t m = 0; m < j2_header->metric_count ;m++) {
+            struct journal_page_header *page_list_header = (void *)((uint8_t *)j2_header + metric[m].page_offset);
+            struct journal_page_list *page_list = (void *)((uint8_t *)page_list_header + sizeof(*page_list_header));
+
+            struct rrdeng_reader_metric *rm = &array[used++];
+            uuid_copy(rm->uuid, metric[m].uuid);
+            rm->first_time_s = journal_start_time_s + metric[m].delta_start_s;
+            rm->last_time_s = journal_start_time_s + metric[m].delta_end_s;
+            rm->update_every_s = page_list_header->entries ? page_list[page_list_header->entries - 1].update_every_s : 0;
+        }
+    }
+
+    qsort(array, used, sizeof(*array), rrdeng_reader_metric_compare);
+
+    size_t metrics = 0;
+    for(size_t i = 0; i < used ;) {
+        struct rrdeng_reader_metric rm = array[i];
+
+        // merge the retention of the same metric in all files
+        size_t j;
+        for(j = i + 1; j < used && uuid_compare(array[j].uuid, rm.uuid) == 0 ;j++) {
+            if(array[j].first_time_s < rm.first_time_s)
+                rm.first_time_s = array[j].first_time_s;
+
+            rm.last_time_s = array[j].last_time_s;
+
+            if(array[j].update_every_s)
+                rm.update_every_s = array[j].update_every_s;
+        }
+        i = j;
+
+        metrics++;
+        if(!cb(&rm.uuid, rm.first_time_s, rm.last_time_s, rm.update_every_s, data))
+            break;
+    }
+
+    freez(array);
+    return metrics;
+}
+
+// ----------------------------------------------------------------------------
+// extents
+
+static bool rrdeng_reader_extent_load(RRDENG_READER *rdr, struct rrdeng_reader_file *f, struct journal_extent_list *ext) {
+    if(rdr->extent.file == f && rdr->extent.offset == ext->datafile_offset)
+        return rdr->extent.header != NULL;
+
+    rdr->extent.file = f;
+    rdr->extent.offset = ext->datafile_offset;
+    rdr->extent.header = NULL;
+
+    size_t data_length = ext->datafile_size;
+    if(ext->datafile_offset + data_length > f->datafile.size)
+        return false;
+
+    uint8_t *data = (uint8_t *)f->datafile.data + ext->datafile_offset;
+    struct rrdeng_df_extent_header *header = (void *)data;
+    struct rrdeng_df_extent_trailer *trailer;
+
+    if(data_length < sizeof(*header) + sizeof(header->descr[0]) + sizeof(*trailer))
+        return false;
+
+    uint32_t count = header->number_of_pages;
+    uint32_t payload_length = header->payload_length;
+    uint32_t payload_offset = sizeof(*header) + sizeof(header->descr[0]) * count;
+    uint32_t trailer_offset = data_length - sizeof(*trailer);
+    trailer = (void *)(data + trailer_offset);
+
+    if(count < 1 || count > MAX_PAGES_PER_EXTENT ||
+       payload_length != trailer_offset - payload_offset ||
+       data_length != payload_offset + payload_length + sizeof(*trailer))
+        return false;
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, data, data_length - sizeof(*trailer));
+    if(crc32cmp(trailer->checksum, crc))
+        return false;
+
+    if(header->compression_algorithm == RRD_NO_COMPRESSION) {
+        rdr->extent.payload = data + payload_offset;
+        rdr->extent.payload_length = payload_length;
+    }
+    else {
+        size_t uncompressed_payload_length = 0;
+        for(uint32_t i = 0; i < count ;i++) {
+            if(header->descr[i].page_length > RRDENG_BLOCK_SIZE)
+                return false;
+
+            uncompressed_payload_length += header->descr[i].page_length;
+        }
+
+        int ret;
+        switch(header->compression_algorithm) {
+            case RRD_LZ4:
+                ret = LZ4_decompress_safe((char *)data + payload_offset, (char *)rdr->extent.buffer,
+                                          (int)payload_length, (int)uncompressed_payload_length);
+                break;
+
+#ifdef HAVE_ZSTD
+            case RRD_ZSTD: {
+                size_t zret = ZSTD_decompressDCtx(rdr->zstd, rdr->extent.buffer, uncompressed_payload_length,
+                                                  data + payload_offset, payload_length);
+                ret = ZSTD_isError(zret) ? -1 : (int)zret;
+            }
+            break;
+#endif
+
+            default:
+                return false;
+        }
+
+        if(ret != (int)uncompressed_payload_length)
+            return false;
+
+        rdr->extent.payload = rdr->extent.buffer;
+        rdr->extent.payload_length = uncompressed_payload_length;
+    }
+
+    rdr->extent.header = header;
+    return true;
+}
+
+// copies the page to rdr->page, and returns its validated descriptor
+static VALIDATED_PAGE_DESCRIPTOR rrdeng_reader_page_load(RRDENG_READER *rdr, uuid_t *uuid, time_t start_time_s, time_t update_every_s) {
+    struct rrdeng_df_extent_header *header = rdr->extent.header;
+    VALIDATED_PAGE_DESCRIPTOR vd = { .is_valid = false };
+
+    uint32_t page_offset = 0;
+    for(uint32_t i = 0; i < header->number_of_pages ; page_offset += header->descr[i].page_length, i++) {
+        struct rrdeng_extent_page_descr *descr = &header->descr[i];
+
+        if((time_t)(descr->start_time_ut / USEC_PER_SEC) != start_time_s || uuid_compare(descr->uuid, *uuid) != 0)
+            continue;
+
+        vd = validate_extent_page_descr(descr, 0, update_every_s, false);
+        if(!vd.is_valid || page_offset + vd.page_length > rdr->extent.payload_length)
+            vd.is_valid = false;
+        else
+            memcpy(rdr->page, rdr->extent.payload + page_offset, vd.page_length);
+
+        break;
+    }
+
+    return vd;
+}
+
+size_t rrdeng_reader_foreach_page(RRDENG_READER *rdr, size_t file, rrdeng_reader_page_cb cb, void *data) {
+    struct rrdeng_reader_file *f = &rdr->files[file];
+    struct journal_v2_header *j2_header = f->journal.data;
+    struct journal_extent_list *extent_list = (void *)((uint8_t *)j2_header + j2_header->extent_offset);
+
+    // the extent list is sorted by datafile offset
+    size_t pages = 0;
+    for(uint32_t e = 0; e < j2_header->extent_count ;e++) {
+        if(!rrdeng_reader_extent_load(rdr, f, &extent_list[e])) {
+            error_limit_static_global_var(erl, 1, 0);
+            error_limit(&erl, "DBENGINE READER: datafile %u has a corrupted extent, skipping its pages", f->fileno);
+            continue;
+        }
+
+        struct rrdeng_df_extent_header *header = rdr->extent.header;
+        uint32_t page_offset = 0;
+        for(uint32_t i = 0; i < header->number_of_pages ; page_offset += header->descr[i].page_length, i++) {
+            struct rrdeng_extent_page_descr *descr = &header->descr[i];
+
+            if(descr->type > PAGE_TYPE_MAX || !descr->page_length || descr->page_length > RRDENG_BLOCK_SIZE ||
+               page_offset + descr->page_length > rdr->extent.payload_length)
+                continue;
+
+            memcpy(rdr->page, rdr->extent.payload + page_offset, descr->page_length);
+
+            pages++;
+            if(!cb(descr, rdr->page, data))
+                return pages;
+        }
+    }
+
+    return pages;
+}
+
+// ----------------------------------------------------------------------------
+// queries
+
+struct rrdeng_reader_query_state {
+    time_t after_s;
+    time_t before_s;
+    time_t last_end_time_s;                     // points are sent in time order, once
+    size_t used;
+    size_t points;
+    rrdeng_reader_points_cb cb;
+    void *data;
+    bool stop;
+};
+
+static inline void rrdeng_reader_points_flush(RRDENG_READER *rdr, struct rrdeng_reader_query_state *qs) {
+    if(qs->used && !qs->stop) {
+        qs->points += qs->used;
+        if(!qs->cb(rdr->points, qs->used, qs->data))
+            qs->stop = true;
+    }
+
+    qs->used = 0;
+}
+
+static inline void rrdeng_reader_point_add(RRDENG_READER *rdr, struct rrdeng_reader_query_state *qs, STORAGE_POINT sp) {
+    if(sp.end_time_s < qs->after_s || sp.end_time_s > qs->before_s || sp.end_time_s <= qs->last_end_time_s)
+        return;
+
+    qs->last_end_time_s = sp.end_time_s;
+    rdr->points[qs->used++] = sp;
+
+    if(qs->used == RRDENG_READER_POINTS)
+        rrdeng_reader_points_flush(rdr, qs);
+}
+
+static inline STORAGE_POINT rrdeng_reader_storage_number_point(storage_number n, time_t end_time_s, time_t update_every_s) {
+    NETDATA_DOUBLE value = unpack_storage_number(n);
+
+    return (STORAGE_POINT) {
+            .start_time_s = end_time_s - update_every_s,
+            .end_time_s = end_time_s,
+            .min = value,
+            .max = value,
+            .sum = value,
+            .count = 1,
+            .anomaly_count = is_storage_number_anomalous(n) ? 1 : 0,
+            .flags = n & SN_USER_FLAGS,
+    };
+}
+
+static inline STORAGE_POINT rrdeng_reader_tier_point(const storage_number_tier1_t *t, time_t end_time_s, time_t update_every_s) {
+    return (STORAGE_POINT) {
+            .start_time_s = end_time_s - update_every_s,
+            .end_time_s = end_time_s,
+            .min = t->min_value,
+            .max = t->max_value,
+            .sum = t->sum_value,
+            .count = t->count,
+            .anomaly_count = t->anomaly_count,
+            .flags = t->anomaly_count ? SN_FLAG_NONE : SN_FLAG_NOT_ANOMALOUS,
+    };
+}
+
+static void rrdeng_reader_page_points(RRDENG_READER *rdr, struct rrdeng_reader_query_state *qs, VALIDATED_PAGE_DESCRIPTOR *vd) {
+    time_t now_s = vd->start_time_s;
+    time_t dt_s = vd->update_every_s;
+
+    switch(vd->type) {
+        case PAGE_METRICS: {
+            storage_number *array = (storage_number *)rdr->page;
+            for(size_t i = 0; i < vd->entries && !qs->stop ;i++, now_s += dt_s)
+                rrdeng_reader_point_add(rdr, qs, rrdeng_reader_storage_number_point(array[i], now_s, dt_s));
+        }
+        break;
+
+        case PAGE_GORILLA_METRICS: {
+            GORILLA_READER gr;
+            storage_number n;
+            gorilla_reader_init(&gr, rdr->page, vd->page_length);
+            for(size_t i = 0; i < vd->entries && !qs->stop && gorilla_reader_next(&gr, &n) ;i++, now_s += dt_s)
+                rrdeng_reader_point_add(rdr, qs, rrdeng_reader_storage_number_point(n, now_s, dt_s));
+        }
+        break;
+
+        case PAGE_TIER: {
+            storage_number_tier1_t *array = (storage_number_tier1_t *)rdr->page;
+            for(size_t i = 0; i < vd->entries && !qs->stop ;i++, now_s += dt_s)
+                rrdeng_reader_point_add(rdr, qs, rrdeng_reader_tier_point(&array[i], now_s, dt_s));
+        }
+        break;
+
+        case PAGE_RLE: {
+            RLE_READER rr;
+            rle_reader_init(&rr, rdr->page, vd->page_length);
+            if(!rr.entries || rr.page->point_size != page_type_size[rle_page_type(rr.page)])
+                break;
+
+            for(size_t i = 0; i < vd->entries && !qs->stop ;i++, now_s += dt_s) {
+                const void *point = rle_reader_point(&rr, i, NULL);
+                if(!point)
+                    break;
+
+                if(rle_page_type(rr.page) == PAGE_METRICS)
+                    rrdeng_reader_point_add(rdr, qs, rrdeng_reader_storage_number_point(*(const storage_number *)point, now_s, dt_s));
+                else if(rle_page_type(rr.page) == PAGE_TIER)
+                    rrdeng_reader_point_add(rdr, qs, rrdeng_reader_tier_point(point, now_s, dt_s));
+                else
+                    break;
+            }
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+static int rrdeng_reader_journal_metric_compare(const void *key, const void *metric) {
+    return uuid_compare(*(uuid_t *)key, ((struct journal_metric_list *)metric)->uuid);
+}
+
+size_t rrdeng_reader_query(RRDENG_READER *rdr, uuid_t *uuid, time_t after_s, time_t before_s, rrdeng_reader_points_cb cb, void *data) {
+    struct rrdeng_reader_query_state qs = {
+            .after_s = after_s,
+            .before_s = before_s,
+            .cb = cb,
+            .data = data,
+    };
+
+    for(size_t f = 0; f < rdr->count && !qs.stop ;f++) {
+        struct rrdeng_reader_file *file = &rdr->files[f];
+
+        if(file->last_time_s < after_s || file->first_time_s > before_s)
+            continue;
+
+        struct journal_v2_header *j2_header = file->journal.data;
+        if(!journalfile_v2_metric_may_exist(j2_header, uuid))
+            continue;
+
+        struct journal_metric_list *uuid_list = (void *)((uint8_t *)j2_header + j2_header->metric_offset);
+        struct journal_metric_list *uuid_entry = bsearch(uuid, uuid_list, j2_header->metric_count, sizeof(*uuid_list), rrdeng_reader_journal_metric_compare);
+        if(!uuid_entry)
+            continue;
+
+        time_t journal_start_time_s = (time_t)(j2_header->start_time_ut / USEC_PER_SEC);
+        struct journal_page_header *page_list_header = (void *)((uint8_t *)j2_header + uuid_entry->page_offset);
+        struct journal_page_list *page_list = (void *)((uint8_t *)page_list_header + sizeof(*page_list_header));
+        struct journal_extent_list *extent_list = (void *)((uint8_t *)j2_header + j2_header->extent_offset);
+
+        for(uint32_t p = 0; p < page_list_header->entries && !qs.stop ;p++) {
+            struct journal_page_list *page = &page_list[p];
+            time_t page_first_time_s = journal_start_time_s + page->delta_start_s;
+            time_t page_last_time_s = journal_start_time_s + page->delta_end_s;
+
+            if(page_last_time_s < after_s || page_last_time_s <= qs.last_end_time_s)
+                continue;
+
+            if(page_first_time_s > before_s)
+                break;
+
+            if(page->extent_index >= j2_header->extent_count ||
+               !rrdeng_reader_extent_load(rdr, file, &extent_list[page->extent_index])) {
+                error_limit_static_global_var(erl, 1, 0);
+                error_limit(&erl, "DBENGINE READER: datafile %u has a corrupted extent, skipping its pages", file->fileno);
+                continue;
+            }
+
+            VALIDATED_PAGE_DESCRIPTOR vd = rrdeng_reader_page_load(rdr, uuid, page_first_time_s, page->update_every_s);
+            if(vd.is_valid)
+                rrdeng_reader_page_points(rdr, &qs, &vd);
+        }
+    }
+
+    rrdeng_reader_points_flush(rdr, &qs);
+    return qs.points;
+}
+
+// ----------------------------------------------------------------------------
+// dump to CSV
+
+static bool rrdeng_reader_dump_metric_cb(uuid_t *uuid, time_t first_time_s, time_t last_time_s, time_t update_every_s, void *data __maybe_unused) {
+    char uuid_str[UUID_STR_LEN];
+    uuid_unparse_lower(*uuid, uuid_str);
+    fprintf(stdout, "%s,%ld,%ld,%ld\n", uuid_str, (long)first_time_s, (long)last_time_s, (long)update_every_s);
+    return true;
+}
+
+static bool rrdeng_reader_dump_points_cb(const STORAGE_POINT *points, size_t count, void *data __maybe_unused) {
+    for(size_t i = 0; i < count ;i++) {
+        const STORAGE_POINT *sp = &points[i];
+        fprintf(stdout, "%ld,%ld," NETDATA_DOUBLE_FORMAT "," NETDATA_DOUBLE_FORMAT "," NETDATA_DOUBLE_FORMAT ",%zu,%zu\n",
+                (long)sp->start_time_s, (long)sp->end_time_s, sp->min, sp->max, sp->sum, sp->count, sp->anomaly_count);
+    }
+
+    return true;
+}
+
+int rrdeng_reader_dump(const char *dbfiles_path, const char *uuid_str, time_t after_s, time_t before_s) {
+    uuid_t uuid;
+    if(uuid_str && uuid_parse(uuid_str, uuid) != 0) {
+        fprintf(stderr, "'%s' is not a valid UUID\n", uuid_str);
+        return 1;
+    }
+
+    RRDENG_READER *rdr = rrdeng_reader_open(dbfiles_path);
+    if(!rdr)
+        return 1;
+
+    size_t found;
+    if(!uuid_str) {
+        fprintf(stdout, "uuid,first_time_s,last_time_s,update_every_s\n");
+        found = rrdeng_reader_foreach_metric(rdr, rrdeng_reader_dump_metric_cb, NULL);
+        fprintf(stderr, "%zu metrics found in %zu datafiles\n", found, rrdeng_reader_files(rdr));
+    }
+    else {
+        if(!after_s && !before_s)
+            rrdeng_reader_retention(rdr, &after_s, &before_s);
+
+        fprintf(stdout, "start_time_s,end_time_s,min,max,sum,count,anomaly_count\n");
+        found = rrdeng_reader_query(rdr, &uuid, after_s, before_s, rrdeng_reader_dump_points_cb, NULL);
+        fprintf(stderr, "%zu points found\n", found);
+    }
+
+    rrdeng_reader_close(rdr);
+    return found ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DBENGINE_READER_H
+#define NETDATA_DBENGINE_READER_H
+
+#include "rrdengine.h"
+#include "rrddiskprotocol.h"
+
+// ----------------------------------------------------------------------------
+// read-only access to the files of a dbengine tier, from any process
+//
+// The journal v2 files and their datafiles are mmapped read-only, so the
+// data are read through the kernel page cache, which is shared with the
+// netdata daemon (or other readers), without using the daemon's page cache
+// or its query threads. Nothing is written to the database directory.
+//
+// Only the datafiles that have a journal v2 file are visible: the data of
+// the datafile netdata is currently writing are not. Files rotated by netdata
+// while a reader has them mapped stay readable until the reader is closed.
+//
+// A reader is not thread safe: use one reader per thread.
+
+typedef struct rrdeng_reader RRDENG_READER;
+
+// returns NULL when the directory has no journal v2 files
+RRDENG_READER *rrdeng_reader_open(const char *dbfiles_path);
+void rrdeng_reader_close(RRDENG_READER *rdr);
+
+size_t rrdeng_reader_files(RRDENG_READER *rdr);
+void rrdeng_reader_file(RRDENG_READER *rdr, size_t file, unsigned *tier, unsigned *fileno);
+void rrdeng_reader_retention(RRDENG_READER *rdr, time_t *first_time_s, time_t *last_time_s);
+
+// called once per metric, with its retention in the files of the reader
+// return false to stop the iteration
+typedef bool (*rrdeng_reader_metric_cb)(uuid_t *uuid, time_t first_time_s, time_t last_time_s, time_t update_every_s, void *data);
+size_t rrdeng_reader_foreach_metric(RRDENG_READER *rdr, rrdeng_reader_metric_cb cb, void *data);
+
+// called for every run of consecutive points of the metric, in time order
+// return false to stop the query
+typedef bool (*rrdeng_reader_points_cb)(const STORAGE_POINT *points, size_t count, void *data);
+size_t rrdeng_reader_query(RRDENG_READER *rdr, uuid_t *uuid, time_t after_s, time_t before_s, rrdeng_reader_points_cb cb, void *data);
+
+// called for every page of a datafile of the reader, in the order they are stored in it
+// the page is valid only during the call - return false to stop the iteration
+typedef bool (*rrdeng_reader_page_cb)(const struct rrdeng_extent_page_descr *descr, const void *page, void *data);
+size_t rrdeng_reader_foreach_page(RRDENG_READER *rdr, size_t file, rrdeng_reader_page_cb cb, void *data);
+
+// prints to stdout the metrics of the directory, or the points of one of them, as CSV
+// zero after_s and before_s select all the retention of the metric
+int rrdeng_reader_dump(const char *dbfiles_path, const char *uuid_str, time_t after_s, time_t before_s);
+
+#endif //NETDATA_DBENGINE_READER_H
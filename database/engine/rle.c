@@ -0,0 +1,222 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "rle.h"
+
+static inline const uint8_t *rle_page_points(const RLE_PAGE_HEADER *page) {
+    return (const uint8_t *)&page->ends[page->runs];
+}
+
+// ----------------------------------------------------------------------------
+// encoding
+
+size_t rle_page_encode(void *page, size_t page_size, uint8_t type, const void *points, size_t point_size, size_t entries) {
+    if(unlikely(!entries || !point_size || point_size > UINT8_MAX || entries > UINT32_MAX))
+        return 0;
+
+    const uint8_t *src = points;
+
+    // count the runs first, to find where the points start
+    size_t runs = 1;
+    for(size_t i = 1; i < entries ;i++) {
+        if(memcmp(&src[i * point_size], &src[(i - 1) * point_size], point_size) != 0)
+            runs++;
+    }
+
+    if(runs > UINT16_MAX || rle_page_length_for(runs, point_size) > page_size)
+        return 0;
+
+    RLE_PAGE_HEADER *hdr = page;
+    hdr->entries = (uint32_t)entries;
+    hdr->runs = (uint16_t)runs;
+    hdr->type = type;
+    hdr->point_size = (uint8_t)point_size;
+
+    uint8_t *dst = (uint8_t *)&hdr->ends[runs];
+    size_t run = 0;
+    memcpy(dst, src, point_size);
+
+    for(size_t i = 1; i < entries ;i++) {
+        if(memcmp(&src[i * point_size], &src[(i - 1) * point_size], point_size) != 0) {
+            hdr->ends[run++] = (uint32_t)i;
+            memcpy(&dst[run * point_size], &src[i * point_size], point_size);
+        }
+    }
+    hdr->ends[run] = (uint32_t)entries;
+
+    return rle_page_length(page);
+}
+
+// ----------------------------------------------------------------------------
+// reading
+
+bool rle_page_check(const void *page, size_t page_length) {
+    const RLE_PAGE_HEADER *hdr = page;
+
+    if(unlikely(!page || page_length < sizeof(RLE_PAGE_HEADER) ||
+                !hdr->runs || !hdr->point_size || !hdr->entries ||
+                rle_page_length(page) > page_length))
+        return false;
+
+    uint32_t previous = 0;
+    for(size_t run = 0; run < hdr->runs ;run++) {
+        if(unlikely(hdr->ends[run] <= previous))
+            return false;
+
+        previous = hdr->ends[run];
+    }
+
+    return previous == hdr->entries;
+}
+
+void rle_reader_init(RLE_READER *rr, const void *page, size_t page_length) {
+    rr->page = page;
+    rr->run = 0;
+
+    if(likely(rle_page_check(page, page_length))) {
+        rr->points = rle_page_points(page);
+        rr->entries = rr->page->entries;
+    }
+    else {
+        rr->points = NULL;
+        rr->entries = 0;
+    }
+}
+
+const void *rle_reader_point(RLE_READER *rr, size_t position, size_t *run_end) {
+    if(unlikely(position >= rr->entries))
+        return NULL;
+
+    const RLE_PAGE_HEADER *hdr = rr->page;
+    uint32_t run = rr->run;
+
+    // queries move forward, so the next point is usually in the same or the next run
+    if(unlikely(position >= hdr->ends[run] || (run && position < hdr->ends[run - 1]))) {
+        if(run + 1 < hdr->runs && position >= hdr->ends[run] && position < hdr->ends[run + 1])
+            run++;
+
+        else {
+            uint32_t low = 0, high = hdr->runs - 1;
+            while(low < high) {
+                uint32_t mid = low + (high - low) / 2;
+                if(hdr->ends[mid] <= position)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+            run = low;
+        }
+
+        rr->run = run;
+    }
+
+    if(run_end)
+        *run_end = hdr->ends[run];
+
+    return &rr->points[(size_t)run * hdr->point_size];
+}
+
+size_t rle_page_decode(const void *page, size_t page_length, void *points, size_t max_points) {
+    RLE_READER rr;
+    rle_reader_init(&rr, page, page_length);
+
+    uint8_t *dst = points;
+    size_t point_size = rr.entries ? rr.page->point_size : 0;
+    size_t decoded = 0;
+
+    while(decoded < max_points) {
+        size_t run_end;
+        const void *point = rle_reader_point(&rr, decoded, &run_end);
+        if(!point)
+            break;
+
+        for(; decoded < run_end && decoded < max_points ;decoded++)
+            memcpy(&dst[decoded * point_size], point, point_size);
+    }
+
+    return decoded;
+}
+
+// ----------------------------------------------------------------------------
+// unittest
+
+static int rle_unittest_series(const char *name, const uint32_t *values, size_t entries, size_t expected_runs) {
+    size_t page_size = rle_page_length_for(entries, sizeof(uint32_t));
+    void *page = mallocz(page_size);
+    uint32_t *decoded = mallocz(entries * sizeof(uint32_t));
+    int errors = 0;
+
+    size_t length = rle_page_encode(page, page_size, 0, values, sizeof(uint32_t), entries);
+    if(!length || ((RLE_PAGE_HEADER *)page)->runs != expected_runs) {
+        fprintf(stderr, "RLE: %s: expected %zu runs, got %u\n", name, expected_runs,
+                length ? ((RLE_PAGE_HEADER *)page)->runs : 0);
+        errors++;
+    }
+
+    size_t decoded_entries = length ? rle_page_decode(page, length, decoded, entries) : 0;
+    if(decoded_entries != entries) {
+        fprintf(stderr, "RLE: %s: encoded %zu values, but decoded %zu\n", name, entries, decoded_entries);
+        errors++;
+    }
+
+    for(size_t i = 0; i < decoded_entries ;i++) {
+        if(decoded[i] != values[i]) {
+            fprintf(stderr, "RLE: %s: value %zu is 0x%08x, expected 0x%08x\n", name, i, decoded[i], values[i]);
+            errors++;
+            break;
+        }
+    }
+
+    // random access, backwards
+    RLE_READER rr;
+    rle_reader_init(&rr, page, length);
+    for(size_t i = decoded_entries; i > 0 ;i--) {
+        size_t run_end = 0;
+        const uint32_t *v = rle_reader_point(&rr, i - 1, &run_end);
+        if(!v || *v != values[i - 1] || run_end < i || (run_end < entries && values[run_end] == values[i - 1])) {
+            fprintf(stderr, "RLE: %s: random access to value %zu does not work\n", name, i - 1);
+            errors++;
+            break;
+        }
+    }
+
+    if(length && rle_page_check(page, length - 1)) {
+        fprintf(stderr, "RLE: %s: truncated page passes the checks\n", name);
+        errors++;
+    }
+
+    fprintf(stderr, "RLE: %s: %zu values in %zu bytes - %s\n", name, entries, length, errors ? "FAILED" : "OK");
+
+    freez(decoded);
+    freez(page);
+    return errors;
+}
+
+int rle_unittest(void) {
+    const size_t entries = 1024;
+    uint32_t *values = mallocz(entries * sizeof(uint32_t));
+    int errors = 0;
+
+    for(size_t i = 0; i < entries ;i++)
+        values[i] = pack_storage_number(0.0, SN_DEFAULT_FLAGS);
+    errors += rle_unittest_series("constant", values, entries, 1);
+
+    for(size_t i = 0; i < entries ;i++)
+        values[i] = pack_storage_number((NETDATA_DOUBLE)(i / 100), SN_DEFAULT_FLAGS);
+    errors += rle_unittest_series("steps", values, entries, (entries + 99) / 100);
+
+    for(size_t i = 0; i < entries ;i++)
+        values[i] = (uint32_t)i;
+    errors += rle_unittest_series("counter", values, entries, entries);
+
+    errors += rle_unittest_series("single", values, 1, 1);
+
+    // a page that does not fit is not encoded
+    uint8_t small[rle_page_length_for(1, sizeof(uint32_t))];
+    if(rle_page_encode(small, sizeof(small), 0, values, sizeof(uint32_t), 2) != 0) {
+        fprintf(stderr, "RLE: encoded a page that does not fit\n");
+        errors++;
+    }
+
+    freez(values);
+    return errors;
+}
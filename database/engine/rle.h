@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DBENGINE_RLE_H
+#define NETDATA_DBENGINE_RLE_H
+
+#include "libnetdata/libnetdata.h"
+
+// ----------------------------------------------------------------------------
+// Run-length encoding of pages with constant (or piecewise constant) points
+//
+// The page starts with a small header, followed by the index after the last
+// point of each run (so that any point can be found with a binary search) and
+// then by one point per run. The points are stored as they are in the original
+// page type (given in the header), so they are used as they are, without decoding.
+//
+// Pages are encoded once, when they are written to disk, so the encoding does
+// not support appending.
+
+typedef struct rle_page_header {
+    uint32_t entries;               // the number of points in the page
+    uint16_t runs;                  // the number of runs
+    uint8_t type;                   // the page type of the points
+    uint8_t point_size;             // the size of each point, in bytes
+    uint32_t ends[];                // for each run, the index after its last point
+                                    // followed by the points of the runs
+} RLE_PAGE_HEADER;
+
+typedef struct rle_reader {
+    const RLE_PAGE_HEADER *page;
+    const uint8_t *points;
+    uint32_t entries;               // 0 when the page is corrupted
+    uint32_t run;                   // the run of the last point returned
+} RLE_READER;
+
+#define rle_page_length_for(runs, point_size) (sizeof(RLE_PAGE_HEADER) + (size_t)(runs) * (sizeof(uint32_t) + (size_t)(point_size)))
+#define rle_page_length(page) rle_page_length_for(((RLE_PAGE_HEADER *)(page))->runs, ((RLE_PAGE_HEADER *)(page))->point_size)
+#define rle_page_entries(page) (((RLE_PAGE_HEADER *)(page))->entries)
+#define rle_page_type(page) (((RLE_PAGE_HEADER *)(page))->type)
+
+// returns the length of the encoded page, or zero when it does not fit in page_size
+size_t rle_page_encode(void *page, size_t page_size, uint8_t type, const void *points, size_t point_size, size_t entries);
+
+// returns the number of points decoded
+size_t rle_page_decode(const void *page, size_t page_length, void *points, size_t max_points);
+
+// returns false when the page is corrupted
+bool rle_page_check(const void *page, size_t page_length);
+
+void rle_reader_init(RLE_READER *rr, const void *page, size_t page_length);
+
+// returns the point at position (or NULL if there is no such point)
+// and the position after the last point of its run
+const void *rle_reader_point(RLE_READER *rr, size_t position, size_t *run_end);
+
+int rle_unittest(void);
+
+#endif //NETDATA_DBENGINE_RLE_H
@@ -19,6 +19,7 @@
 
 #define RRD_NO_COMPRESSION (0)
 #define RRD_LZ4 (1)
+#define RRD_ZSTD (2)
 
 #define RRDENG_DF_SB_PADDING_SZ (RRDENG_BLOCK_SIZE - (RRDENG_MAGIC_SZ + RRDENG_VER_SZ + sizeof(uint8_t)))
 /*
@@ -34,9 +35,11 @@ struct rrdeng_df_sb {
 /*
  * Page types
  */
-#define PAGE_METRICS    (0)
-#define PAGE_TIER       (1)
-#define PAGE_TYPE_MAX   1   // Maximum page type (inclusive)
+#define PAGE_METRICS            (0)
+#define PAGE_TIER               (1)
+#define PAGE_GORILLA_METRICS    (2) // tier 0 storage_number values, XOR encoded (see gorilla.h)
+#define PAGE_RLE                (3) // PAGE_METRICS or PAGE_TIER points, run-length encoded (see rle.h)
+#define PAGE_TYPE_MAX           3   // Maximum page type (inclusive)
 
 /*
  * Data file page descriptor
@@ -11,6 +11,7 @@ rrdeng_stats_t global_pg_cache_over_half_dirty_events = 0;
 rrdeng_stats_t global_flushing_pressure_page_deletions = 0;
 
 unsigned rrdeng_pages_per_extent = MAX_PAGES_PER_EXTENT;
+unsigned rrdeng_extents_per_flush = 4;
 
 #if WORKER_UTILIZATION_MAX_JOB_TYPES < (RRDENG_OPCODE_MAX + 2)
 #error Please increase WORKER_UTILIZATION_MAX_JOB_TYPES to at least (RRDENG_MAX_OPCODE + 2)
@@ -218,6 +219,9 @@ struct page_descr_with_data *page_descriptor_get(void) {
 }
 
 static inline void page_descriptor_release(struct page_descr_with_data *descr) {
+    if(descr->page_encoded)
+        freez(descr->page);
+
     aral_freez(rrdeng_main.descriptors.ar, descr);
 }
 
@@ -465,6 +469,36 @@ static inline bool rrdeng_cmd_has_waiting_opcodes_in_lower_priorities(STORAGE_PR
     return false;
 }
 
+// with io_uring, a worker reads the extents of many EPDLs with a single system call,
+// so we move the extent reads of the same instance and priority to the EPDL we just dequeued
+static inline void rrdeng_deq_extent_read_batch(struct rrdengine_instance *ctx, STORAGE_PRIORITY priority, EPDL *epdl) {
+    size_t batched = 1;
+
+    netdata_spinlock_lock(&rrdeng_main.cmd_queue.unsafe.spinlock);
+
+    struct rrdeng_cmd *cmd = rrdeng_main.cmd_queue.unsafe.waiting_items_by_priority[priority], *next;
+    for(; cmd && batched < EPDL_READ_BATCH_MAX ; cmd = next) {
+        next = cmd->queue.next;
+
+        if(cmd->opcode != RRDENG_OPCODE_EXTENT_READ || cmd->ctx != ctx)
+            continue;
+
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(rrdeng_main.cmd_queue.unsafe.waiting_items_by_priority[priority], cmd, queue.prev, queue.next);
+        rrdeng_main.cmd_queue.unsafe.waiting--;
+
+        if(cmd->dequeue_cb) {
+            cmd->dequeue_cb(cmd);
+            cmd->dequeue_cb = NULL;
+        }
+
+        epdl_batch_append(epdl, cmd->data);
+        aral_freez(rrdeng_main.cmd_queue.ar, cmd);
+        batched++;
+    }
+
+    netdata_spinlock_unlock(&rrdeng_main.cmd_queue.unsafe.spinlock);
+}
+
 static inline struct rrdeng_cmd rrdeng_deq_cmd(void) {
     struct rrdeng_cmd *cmd = NULL;
 
@@ -522,6 +556,9 @@ static inline struct rrdeng_cmd rrdeng_deq_cmd(void) {
 
 // ----------------------------------------------------------------------------
 
+// how the memory of pages (data and main cache entries) is allocated
+ARAL_MEMORY_POLICY dbengine_page_memory_policy = ARAL_MEMORY_DEFAULT;
+
 struct {
     ARAL *aral[RRD_STORAGE_TIERS];
 } dbengine_page_alloc_globals = {};
@@ -548,6 +585,9 @@ static void dbengine_page_alloc_init(void) {
                 512 * tier_page_size[tier],
                 pgc_aral_statistics(),
                 NULL, NULL, false, false);
+
+        if(dbengine_page_memory_policy != ARAL_MEMORY_DEFAULT)
+            aral_set_memory_policy(dbengine_page_alloc_globals.aral[tier], dbengine_page_memory_policy);
     }
 }
 
@@ -653,10 +693,20 @@ static void *extent_flushed_to_open_tp_worker(struct rrdengine_instance *ctx __m
         page_descriptor_release(descr);
     }
 
+    struct extent_write_group *group = xt_io_descr->group;
+
     uv_fs_req_cleanup(uv_fs_request);
     posix_memfree(xt_io_descr->buf);
     extent_io_descriptor_release(xt_io_descr);
 
+    if(group && __atomic_sub_fetch(&group->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+        // all the extents written together are now in the open cache
+        if(group->completion)
+            completion_mark_complete(group->completion);
+
+        freez(group);
+    }
+
     netdata_spinlock_lock(&datafile->writers.spinlock);
     datafile->writers.flushed_to_open_running--;
     netdata_spinlock_unlock(&datafile->writers.spinlock);
@@ -681,20 +731,28 @@ static void after_extent_write_datafile_io(uv_fs_t *uv_fs_request) {
         error("DBENGINE: %s: uv_fs_write(): %s", __func__, uv_strerror((int)uv_fs_request->result));
     }
 
+    // the transactions of all the extents written with this request
     journalfile_v1_extent_write(ctx, xt_io_descr->datafile, xt_io_descr->wal, &rrdeng_main.loop);
 
-    netdata_spinlock_lock(&datafile->writers.spinlock);
-    datafile->writers.running--;
-    datafile->writers.flushed_to_open_running++;
-    netdata_spinlock_unlock(&datafile->writers.spinlock);
+    while(xt_io_descr) {
+        // the open cache worker may free it
+        struct extent_io_descriptor *next = xt_io_descr->group_next;
+
+        netdata_spinlock_lock(&datafile->writers.spinlock);
+        datafile->writers.running--;
+        datafile->writers.flushed_to_open_running++;
+        netdata_spinlock_unlock(&datafile->writers.spinlock);
+
+        rrdeng_enq_cmd(xt_io_descr->ctx,
+                       RRDENG_OPCODE_FLUSHED_TO_OPEN,
+                       &xt_io_descr->uv_fs_request,
+                       xt_io_descr->completion,
+                       STORAGE_PRIORITY_INTERNAL_DBENGINE,
+                       NULL,
+                       NULL);
 
-    rrdeng_enq_cmd(xt_io_descr->ctx,
-                   RRDENG_OPCODE_FLUSHED_TO_OPEN,
-                   uv_fs_request,
-                   xt_io_descr->completion,
-                   STORAGE_PRIORITY_INTERNAL_DBENGINE,
-                   NULL,
-                   NULL);
+        xt_io_descr = next;
+    }
 
     worker_is_idle();
 }
@@ -763,7 +821,39 @@ static struct rrdengine_datafile *get_datafile_to_write_extent(struct rrdengine_
 /*
  * Take a page list in a judy array and write them
  */
-static struct extent_io_descriptor *datafile_extent_build(struct rrdengine_instance *ctx, struct page_descr_with_data *base, struct completion *completion) {
+#ifdef HAVE_ZSTD
+// the compression context of each thread is freed by this key, when the thread exits
+static pthread_key_t dbengine_zstd_cctx_key;
+static pthread_once_t dbengine_zstd_cctx_key_once = PTHREAD_ONCE_INIT;
+
+static void dbengine_zstd_cctx_free(void *cctx) {
+    ZSTD_freeCCtx(cctx);
+}
+
+static void dbengine_zstd_cctx_key_create(void) {
+    if(pthread_key_create(&dbengine_zstd_cctx_key, dbengine_zstd_cctx_free) != 0)
+        fatal("DBENGINE: cannot create the thread key of the ZSTD compression contexts");
+}
+
+static ZSTD_CCtx *dbengine_zstd_cctx(void) {
+    static __thread ZSTD_CCtx *cctx = NULL;
+
+    if(unlikely(!cctx)) {
+        pthread_once(&dbengine_zstd_cctx_key_once, dbengine_zstd_cctx_key_create);
+
+        cctx = ZSTD_createCCtx();
+        if(!cctx)
+            fatal("DBENGINE: cannot create a ZSTD compression context");
+
+        pthread_setspecific(dbengine_zstd_cctx_key, cctx);
+    }
+
+    return cctx;
+}
+#endif
+
+// builds an extent with the first pages of the list, and advances the list to the pages left
+static struct extent_io_descriptor *datafile_extent_build(struct rrdengine_instance *ctx, struct page_descr_with_data **base_ptr) {
     int ret;
     int compressed_size, max_compressed_size = 0;
     unsigned i, count, size_bytes, pos, real_io_size;
@@ -774,13 +864,12 @@ static struct extent_io_descriptor *datafile_extent_build(struct rrdengine_insta
     void *compressed_buf = NULL;
     Word_t Index;
     uint8_t compression_algorithm = ctx->config.global_compress_alg;
-    struct rrdengine_datafile *datafile;
     /* persistent structures */
     struct rrdeng_df_extent_header *header;
     struct rrdeng_df_extent_trailer *trailer;
     uLong crc;
 
-    for(descr = base, Index = 0, count = 0, uncompressed_payload_length = 0;
+    for(descr = *base_ptr, Index = 0, count = 0, uncompressed_payload_length = 0;
         descr && count != rrdeng_pages_per_extent;
         descr = descr->link.next, Index++) {
 
@@ -788,14 +877,10 @@ static struct extent_io_descriptor *datafile_extent_build(struct rrdengine_insta
         eligible_pages[count++] = descr;
 
     }
+    *base_ptr = descr;
 
-    if (!count) {
-        if (completion)
-            completion_mark_complete(completion);
-
-        __atomic_sub_fetch(&ctx->atomic.extents_currently_being_flushed, 1, __ATOMIC_RELAXED);
+    if (!count)
         return NULL;
-    }
 
     xt_io_descr = extent_io_descriptor_get();
     xt_io_descr->ctx = ctx;
@@ -805,7 +890,17 @@ static struct extent_io_descriptor *datafile_extent_build(struct rrdengine_insta
             size_bytes = payload_offset + uncompressed_payload_length + sizeof(*trailer);
             break;
 
+#ifdef HAVE_ZSTD
+        case RRD_ZSTD:
+            max_compressed_size = (int)ZSTD_compressBound(uncompressed_payload_length);
+            eb = extent_buffer_get(max_compressed_size);
+            compressed_buf = eb->data;
+            size_bytes = payload_offset + MAX(uncompressed_payload_length, (unsigned)max_compressed_size) + sizeof(*trailer);
+            break;
+#endif
+
         default: /* Compress */
+            compression_algorithm = RRD_LZ4;
             fatal_assert(uncompressed_payload_length < LZ4_MAX_INPUT_SIZE);
             max_compressed_size = LZ4_compressBound(uncompressed_payload_length);
             eb = extent_buffer_get(max_compressed_size);
@@ -859,22 +954,52 @@ static struct extent_io_descriptor *datafile_extent_build(struct rrdengine_insta
         size_bytes = payload_offset + compressed_size + sizeof(*trailer);
         header->payload_length = compressed_size;
     }
+#ifdef HAVE_ZSTD
+    else if(compression_algorithm == RRD_ZSTD) {
+        size_t zret = ZSTD_compressCCtx(
+                dbengine_zstd_cctx(),
+                compressed_buf,
+                max_compressed_size,
+                xt_io_descr->buf + payload_offset,
+                uncompressed_payload_length,
+                ctx->config.compression_level ? ctx->config.compression_level : ZSTD_CLEVEL_DEFAULT);
+
+        if(unlikely(ZSTD_isError(zret))) {
+            error_limit_static_global_var(erl, 1, 0);
+            error_limit(&erl, "DBENGINE: ZSTD compression failed (%s), storing the extent uncompressed", ZSTD_getErrorName(zret));
+
+            header->compression_algorithm = RRD_NO_COMPRESSION;
+            header->payload_length = uncompressed_payload_length;
+            size_bytes = payload_offset + uncompressed_payload_length + sizeof(*trailer);
+        }
+        else {
+            compressed_size = (int)zret;
+
+            __atomic_add_fetch(&ctx->stats.before_compress_bytes, uncompressed_payload_length, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&ctx->stats.after_compress_bytes, compressed_size, __ATOMIC_RELAXED);
+
+            (void) memcpy(xt_io_descr->buf + payload_offset, compressed_buf, compressed_size);
+            size_bytes = payload_offset + compressed_size + sizeof(*trailer);
+            header->payload_length = compressed_size;
+        }
+
+        extent_buffer_release(eb);
+    }
+#endif
     else { // RRD_NO_COMPRESSION
         header->payload_length = uncompressed_payload_length;
     }
 
-    real_io_size = ALIGN_BYTES_CEILING(size_bytes);
+    if(header->compression_algorithm == RRD_NO_COMPRESSION) {
+        // so that the write amplification accounts all the pages
+        __atomic_add_fetch(&ctx->stats.before_compress_bytes, uncompressed_payload_length, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&ctx->stats.after_compress_bytes, uncompressed_payload_length, __ATOMIC_RELAXED);
+    }
 
-    datafile = get_datafile_to_write_extent(ctx);
-    netdata_spinlock_lock(&datafile->writers.spinlock);
-    xt_io_descr->datafile = datafile;
-    xt_io_descr->pos = datafile->pos;
-    datafile->pos += real_io_size;
-    netdata_spinlock_unlock(&datafile->writers.spinlock);
+    real_io_size = ALIGN_BYTES_CEILING(size_bytes);
 
     xt_io_descr->bytes = size_bytes;
     xt_io_descr->uv_fs_request.data = xt_io_descr;
-    xt_io_descr->completion = completion;
 
     trailer = xt_io_descr->buf + size_bytes - sizeof(*trailer);
     crc = crc32(0L, Z_NULL, 0);
@@ -882,19 +1007,109 @@ static struct extent_io_descriptor *datafile_extent_build(struct rrdengine_insta
     crc32set(trailer->checksum, crc);
 
     xt_io_descr->iov = uv_buf_init((void *)xt_io_descr->buf, real_io_size);
-    journalfile_extent_build(ctx, xt_io_descr);
+
+    return xt_io_descr;
+}
+
+/*
+ * Builds the extents of all the pages of the list, and places them one after
+ * the other in the datafile, so that they are written with one request (and
+ * their journal transactions with another). Returns the first extent, which
+ * does the I/O for all of them.
+ */
+static struct extent_io_descriptor *datafile_extents_build(struct rrdengine_instance *ctx, struct page_descr_with_data *base, struct completion *completion) {
+    struct extent_io_descriptor *xt_array[MAX_EXTENTS_PER_FLUSH];
+    size_t real_io_size[MAX_EXTENTS_PER_FLUSH];
+    struct extent_write_group *group = NULL;
+    struct rrdengine_datafile *datafile;
+    size_t count = 0, total_bytes = 0, i;
+
+    while(base) {
+        fatal_assert(count < MAX_EXTENTS_PER_FLUSH);
+
+        struct extent_io_descriptor *xt_io_descr = datafile_extent_build(ctx, &base);
+        if(!xt_io_descr)
+            break;
+
+        real_io_size[count] = xt_io_descr->iov.len;
+        xt_array[count++] = xt_io_descr;
+        total_bytes += xt_io_descr->iov.len;
+    }
+
+    if (!count) {
+        if (completion)
+            completion_mark_complete(completion);
+
+        __atomic_sub_fetch(&ctx->atomic.extents_currently_being_flushed, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    if(count > 1) {
+        // copy them to one buffer, the first extent owns it
+        uint8_t *buf;
+        int ret = posix_memalign((void *)&buf, RRDFILE_ALIGNMENT, total_bytes);
+        if (unlikely(ret))
+            fatal("DBENGINE: posix_memalign:%s", strerror(ret));
+
+        size_t offset = 0;
+        for(i = 0; i < count ;i++) {
+            memcpy(buf + offset, xt_array[i]->buf, real_io_size[i]);
+            posix_memfree(xt_array[i]->buf);
+            xt_array[i]->buf = buf + offset;
+            offset += real_io_size[i];
+        }
+        xt_array[0]->iov = uv_buf_init((void *)buf, total_bytes);
+
+        // the flush is complete when all of them are in the open cache
+        group = callocz(1, sizeof(*group));
+        group->completion = completion;
+        group->pending = count;
+    }
+
+    datafile = get_datafile_to_write_extent(ctx);
+    netdata_spinlock_lock(&datafile->writers.spinlock);
+    // we are already a writer for one of them
+    datafile->writers.running += count - 1;
+    uint64_t pos = datafile->pos;
+    datafile->pos += total_bytes;
+    netdata_spinlock_unlock(&datafile->writers.spinlock);
+
+    for(i = 0; i < count ;i++) {
+        struct extent_io_descriptor *xt_io_descr = xt_array[i];
+
+        xt_io_descr->datafile = datafile;
+        xt_io_descr->pos = pos;
+        xt_io_descr->completion = group ? NULL : completion;
+        xt_io_descr->group = group;
+        xt_io_descr->group_next = (i + 1 < count) ? xt_array[i + 1] : NULL;
+        pos += real_io_size[i];
+
+        journalfile_extent_build(ctx, xt_io_descr);
+        if(i)
+            xt_array[i - 1]->wal->group_next = xt_io_descr->wal;
+    }
+
+    // only the first extent has a buffer to free
+    for(i = 1; i < count ;i++)
+        xt_array[i]->buf = NULL;
 
     ctx_last_flush_fileno_set(ctx, datafile->fileno);
-    ctx_current_disk_space_increase(ctx, real_io_size);
-    ctx_io_write_op_bytes(ctx, real_io_size);
+    ctx_current_disk_space_increase(ctx, total_bytes);
+    ctx_io_write_op_bytes(ctx, total_bytes);
+    __atomic_add_fetch(&ctx->stats.io_write_extent_bytes, total_bytes, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&ctx->stats.io_write_extents, count, __ATOMIC_RELAXED);
 
-    return xt_io_descr;
+    return xt_array[0];
 }
 
 static void after_extent_write(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t* uv_work_req __maybe_unused, int status __maybe_unused) {
     struct extent_io_descriptor *xt_io_descr = data;
 
-    if(xt_io_descr) {
+    if(xt_io_descr && xt_io_descr->written) {
+        // the worker has already written it with io_uring
+        after_extent_write_datafile_io(&xt_io_descr->uv_fs_request);
+    }
+    else if(xt_io_descr) {
         int ret = uv_fs_write(&rrdeng_main.loop,
                               &xt_io_descr->uv_fs_request,
                               xt_io_descr->datafile->file,
@@ -910,7 +1125,26 @@ static void after_extent_write(struct rrdengine_instance *ctx __maybe_unused, vo
 static void *extent_write_tp_worker(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t *uv_work_req __maybe_unused) {
     worker_is_busy(UV_EVENT_DBENGINE_EXTENT_WRITE);
     struct page_descr_with_data *base = data;
-    struct extent_io_descriptor *xt_io_descr = datafile_extent_build(ctx, base, completion);
+    struct extent_io_descriptor *xt_io_descr = datafile_extents_build(ctx, base, completion);
+
+    if(xt_io_descr && rrdeng_io_uring_enabled()) {
+        RRDENG_IO_REQUEST request = {
+                .fd = xt_io_descr->datafile->file,
+                .write = true,
+                .buffer = xt_io_descr->iov.base,
+                .size = (unsigned)xt_io_descr->iov.len,
+                .offset = xt_io_descr->pos,
+        };
+
+        if(rrdeng_io_uring_submit_and_wait(&request, 1)) {
+            if(request.result >= 0 && request.result < (ssize_t)request.size)
+                request.result = -EIO;
+
+            xt_io_descr->uv_fs_request.result = request.result;
+            xt_io_descr->written = true;
+        }
+    }
+
     return xt_io_descr;
 }
 
@@ -966,6 +1200,7 @@ void find_uuid_first_time(
     unsigned journalfile_count = 0;
     size_t binary_match = 0;
     size_t not_matching_bsearches = 0;
+    size_t not_matching_filters = 0;
 
     while (datafile) {
         struct journal_v2_header *j2_header = journalfile_v2_data_acquire(datafile->journalfile, NULL, 0, 0);
@@ -987,6 +1222,12 @@ void find_uuid_first_time(
             if (uuid_original_entry->df_matched > 3 || uuid_original_entry->pages_found > 5)
                 continue;
 
+            if (!journalfile_v2_metric_may_exist(j2_header, uuid_original_entry->uuid)) {
+                // Not in this journal, according to its metric filter
+                not_matching_filters++;
+                continue;
+            }
+
             struct journal_metric_list *live_entry = bsearch(uuid_original_entry->uuid,uuid_list,journal_metric_count,sizeof(*uuid_list), journal_metric_compare);
             if (!live_entry) {
                 // Not found in this journal
@@ -1066,7 +1307,7 @@ void find_uuid_first_time(
     }
     internal_error(true,
          "DBENGINE: analyzed the retention of %zu rotated metrics of tier %d, "
-         "did %zu jv2 matching binary searches (%zu not matching, %zu overflown) in %u journal files, "
+         "did %zu jv2 matching binary searches (%zu not matching, %zu overflown, %zu avoided by the metric filters) in %u journal files, "
          "%zu metrics with entries in open cache, "
          "metrics first time found per datafile index ([not in jv2]:%zu, [1]:%zu, [2]:%zu, [3]:%zu, [4]:%zu, [5]:%zu, [6]:%zu, [7]:%zu, [8]:%zu, [bigger]: %zu), "
          "open cache found first time %zu, "
@@ -1077,6 +1318,7 @@ void find_uuid_first_time(
          binary_match,
          not_matching_bsearches,
          not_needed_bsearches,
+         not_matching_filters,
          journalfile_count,
          open_cache_count,
          df_index[0], df_index[1], df_index[2], df_index[3], df_index[4], df_index[5], df_index[6], df_index[7], df_index[8], df_index[9],
@@ -1392,6 +1634,42 @@ void finalize_rrd_files(struct rrdengine_instance *ctx)
     return finalize_data_files(ctx);
 }
 
+// Netdata holds an exclusive lock on the directory of each tier while it uses it, and so do
+// the offline tools that modify its files (compaction), so that they never run concurrently.
+// Returns false only when another process holds the lock. When the lock cannot be taken for
+// any other reason, the error is logged, *fd is set to -1 and true is returned.
+bool rrdeng_dbfiles_lock(const char *dbfiles_path, int *fd) {
+    *fd = open(dbfiles_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(*fd == -1) {
+        error("DBENGINE: cannot open directory '%s' to lock it", dbfiles_path);
+        return true;
+    }
+
+    if(flock(*fd, LOCK_EX | LOCK_NB) != 0) {
+        bool busy = (errno == EWOULDBLOCK);
+
+        if(busy)
+            error("DBENGINE: directory '%s' is locked by another process (is netdata running?)", dbfiles_path);
+        else
+            error("DBENGINE: cannot lock directory '%s'", dbfiles_path);
+
+        close(*fd);
+        *fd = -1;
+        return !busy;
+    }
+
+    return true;
+}
+
+void rrdeng_dbfiles_unlock(int *fd) {
+    if(*fd == -1)
+        return;
+
+    flock(*fd, LOCK_UN);
+    close(*fd);
+    *fd = -1;
+}
+
 void async_cb(uv_async_t *handle)
 {
     uv_stop(handle->loop);
@@ -1417,12 +1695,39 @@ void pdc_route_asynchronously(struct rrdengine_instance *ctx, struct page_detail
     pdc_to_epdl_router(ctx, pdc, epdl_populate_pages_asynchronously, epdl_populate_pages_asynchronously);
 }
 
+// the EPDLs of a synchronous query, waiting to be read together with io_uring
+static __thread struct {
+    EPDL *first;
+    size_t count;
+} epdl_sync_batch = { NULL, 0 };
+
+static void epdl_sync_batch_flush(struct rrdengine_instance *ctx) {
+    if(epdl_sync_batch.first) {
+        EPDL *epdl = epdl_sync_batch.first;
+        epdl_sync_batch.first = NULL;
+        epdl_sync_batch.count = 0;
+        epdl_find_extent_and_populate_pages(ctx, epdl, false);
+    }
+}
+
 void epdl_populate_pages_synchronously(struct rrdengine_instance *ctx, EPDL *epdl, enum storage_priority priority __maybe_unused) {
-    epdl_find_extent_and_populate_pages(ctx, epdl, false);
+    if(!rrdeng_io_uring_enabled()) {
+        epdl_find_extent_and_populate_pages(ctx, epdl, false);
+        return;
+    }
+
+    if(!epdl_sync_batch.first)
+        epdl_sync_batch.first = epdl;
+    else
+        epdl_batch_append(epdl_sync_batch.first, epdl);
+
+    if(++epdl_sync_batch.count >= EPDL_READ_BATCH_MAX)
+        epdl_sync_batch_flush(ctx);
 }
 
 void pdc_route_synchronously(struct rrdengine_instance *ctx, struct page_details_control *pdc) {
     pdc_to_epdl_router(ctx, pdc, epdl_populate_pages_synchronously, epdl_populate_pages_synchronously);
+    epdl_sync_batch_flush(ctx);
 }
 
 #define MAX_RETRIES_TO_START_INDEX (100)
@@ -1684,6 +1989,8 @@ void dbengine_event_loop(void* arg) {
                 case RRDENG_OPCODE_EXTENT_READ: {
                     struct rrdengine_instance *ctx = cmd.ctx;
                     EPDL *epdl = cmd.data;
+                    if(rrdeng_io_uring_enabled())
+                        rrdeng_deq_extent_read_batch(ctx, cmd.priority, epdl);
                     work_dispatch(ctx, epdl, NULL, opcode, extent_read_tp_worker, after_extent_read);
                     break;
                 }
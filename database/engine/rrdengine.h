@@ -7,7 +7,11 @@
 #define _GNU_SOURCE
 #endif
 #include <fcntl.h>
+#include <sys/file.h>
 #include <lz4.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #include <Judy.h>
 #include <openssl/sha.h>
 #include <openssl/evp.h>
@@ -15,6 +19,9 @@
 #include "../rrd.h"
 #include "rrddiskprotocol.h"
 #include "rrdenginelib.h"
+#include "gorilla.h"
+#include "rle.h"
+#include "iouring.h"
 #include "datafile.h"
 #include "journalfile.h"
 #include "rrdengineapi.h"
@@ -24,12 +31,14 @@
 #include "pdc.h"
 
 extern unsigned rrdeng_pages_per_extent;
+extern unsigned rrdeng_extents_per_flush;
 
 /* Forward declarations */
 struct rrdengine_instance;
 struct rrdeng_cmd;
 
 #define MAX_PAGES_PER_EXTENT (64) /* TODO: can go higher only when journal supports bigger than 4KiB transactions */
+#define MAX_EXTENTS_PER_FLUSH (8) /* extents written to the datafile with one write */
 
 #define RRDENG_FILE_NUMBER_SCAN_TMPL "%1u-%10u"
 #define RRDENG_FILE_NUMBER_PRINT_TMPL "%1.1u-%10.10u"
@@ -45,6 +54,7 @@ typedef struct page_details_control {
     unsigned completed_jobs;        // the number of jobs completed last time the query thread checked
     bool workers_should_stop;       // true when the query thread left and the workers should stop
     bool prep_done;
+    bool readahead;                 // true when there is no query thread, the pages are just loaded into the cache
 
     SPINLOCK refcount_spinlock;     // spinlock to protect refcount
     int32_t refcount;               // the number of workers currently working on this request + 1 for the query thread
@@ -194,6 +204,7 @@ struct rrdeng_collect_handle {
     usec_t page_start_time_ut;
     usec_t page_end_time_ut;
     usec_t update_every_ut;
+    GORILLA_WRITER gorilla;                   // the encoder state, for PAGE_GORILLA_METRICS pages
 };
 
 struct rrdeng_query_handle {
@@ -215,6 +226,10 @@ struct rrdeng_query_handle {
     unsigned position;
     unsigned entries;
 
+    uint8_t page_type;
+    GORILLA_READER gorilla;                   // the decoder state, for PAGE_GORILLA_METRICS pages
+    RLE_READER rle;                           // the current run, for PAGE_RLE pages
+
 #ifdef NETDATA_INTERNAL_CHECKS
     usec_t started_time_s;
     pid_t query_pid;
@@ -276,7 +291,17 @@ struct extent_io_descriptor {
     unsigned descr_count;
     struct page_descr_with_data *descr_array[MAX_PAGES_PER_EXTENT];
     struct rrdengine_datafile *datafile;
+    bool written;                      /* written by the worker with io_uring */
     struct extent_io_descriptor *next; /* multiple requests to be served by the same cached extent */
+
+    /* extents written to the datafile with one write, the first one does the I/O */
+    struct extent_write_group *group;
+    struct extent_io_descriptor *group_next;
+};
+
+struct extent_write_group {
+    struct completion *completion;
+    size_t pending;                    /* extents not added to the open cache yet */
 };
 
 struct generic_io_descriptor {
@@ -296,6 +321,7 @@ typedef struct wal {
     size_t size;
     size_t buf_size;
     struct generic_io_descriptor io_descr;
+    struct wal *group_next;            /* written to the journal with this one */
 
     struct {
         struct wal *prev;
@@ -318,6 +344,8 @@ struct rrdengine_statistics {
 
     rrdeng_stats_t io_write_bytes;
     rrdeng_stats_t io_write_requests;
+    rrdeng_stats_t io_write_extent_bytes;
+    rrdeng_stats_t io_write_extents;
     rrdeng_stats_t io_read_bytes;
     rrdeng_stats_t io_read_requests;
 
@@ -349,8 +377,10 @@ struct rrdengine_instance {
 
         uint64_t max_disk_space;                    // the max disk space this ctx is allowed to use
         uint8_t global_compress_alg;                // the wanted compression algorithm
+        int compression_level;                      // the compression level, for algorithms that support it
 
         char dbfiles_path[FILENAME_MAX + 1];
+        int dbfiles_lock_fd;                        // the exclusive lock on dbfiles_path, or -1
     } config;
 
     struct {
@@ -386,6 +416,15 @@ struct rrdengine_instance {
             struct completion *array;
         } populate_mrg;
 
+        struct {
+            size_t journalfiles;                    // the journal files found at startup
+            size_t journalfiles_loaded;             // atomic
+            size_t journalfiles_v2_loaded;          // atomic
+            size_t journalfiles_v1_replayed;        // atomic
+            size_t journalfiles_populated;          // atomic, the journal files populated to MRG
+            usec_t started_ut;
+        } progress;
+
         bool create_new_datafile_pair;
     } loading;
 
@@ -432,6 +471,7 @@ static inline void ctx_last_flush_fileno_set(struct rrdengine_instance *ctx, uns
 
 #define ctx_is_available_for_queries(ctx) (__atomic_load_n(&(ctx)->quiesce.enabled, __ATOMIC_RELAXED) == false && __atomic_load_n(&(ctx)->quiesce.exit_mode, __ATOMIC_RELAXED) == false)
 
+extern ARAL_MEMORY_POLICY dbengine_page_memory_policy;
 void *dbengine_page_alloc(size_t size);
 void dbengine_page_free(void *page, size_t size);
 
@@ -441,6 +481,8 @@ void dbengine_extent_free(void *extent, size_t size);
 bool rrdeng_ctx_exceeded_disk_quota(struct rrdengine_instance *ctx);
 int init_rrd_files(struct rrdengine_instance *ctx);
 void finalize_rrd_files(struct rrdengine_instance *ctx);
+bool rrdeng_dbfiles_lock(const char *dbfiles_path, int *fd);
+void rrdeng_dbfiles_unlock(int *fd);
 bool rrdeng_dbengine_spawn(struct rrdengine_instance *ctx);
 void dbengine_event_loop(void *arg);
 
@@ -486,6 +528,28 @@ typedef struct validated_page_descriptor {
 #define page_entries_by_size(page_length_in_bytes, point_size_in_bytes) \
         ((page_length_in_bytes) / (point_size_in_bytes))
 
+extern size_t page_type_size[];
+
+static inline size_t page_entries_by_data(uint8_t type, void *data, size_t page_length) {
+    if(unlikely(type == PAGE_GORILLA_METRICS))
+        return (page_length >= sizeof(GORILLA_PAGE_HEADER)) ? gorilla_page_entries(data) : 0;
+
+    if(unlikely(type == PAGE_RLE))
+        return rle_page_check(data, page_length) ? rle_page_entries(data) : 0;
+
+    return page_type_size[type] ? page_entries_by_size(page_length, page_type_size[type]) : 0;
+}
+
+static inline size_t page_length_by_data(uint8_t type, void *data, size_t entries) {
+    if(unlikely(type == PAGE_GORILLA_METRICS))
+        return gorilla_page_length(data);
+
+    if(unlikely(type == PAGE_RLE))
+        return rle_page_length(data);
+
+    return entries * page_type_size[type];
+}
+
 VALIDATED_PAGE_DESCRIPTOR validate_page(uuid_t *uuid,
                                         time_t start_time_s,
                                         time_t end_time_s,
@@ -514,5 +578,6 @@ static inline time_t max_acceptable_collected_time(void) {
 }
 
 void datafile_delete(struct rrdengine_instance *ctx, struct rrdengine_datafile *datafile, bool update_retention, bool worker);
+struct rrdengine_datafile *datafile_release_and_acquire_next_for_retention(struct rrdengine_instance *ctx, struct rrdengine_datafile *datafile);
 
 #endif /* NETDATA_RRDENGINE_H */
@@ -15,6 +15,8 @@ struct rrdengine_instance multidb_ctx_storage_tier4;
 #endif
 struct rrdengine_instance *multidb_ctx[RRD_STORAGE_TIERS];
 uint8_t tier_page_type[RRD_STORAGE_TIERS] = {PAGE_METRICS, PAGE_TIER, PAGE_TIER, PAGE_TIER, PAGE_TIER};
+uint8_t tier_compression_algorithm[RRD_STORAGE_TIERS] = {RRD_LZ4, RRD_LZ4, RRD_LZ4, RRD_LZ4, RRD_LZ4};
+int tier_compression_level[RRD_STORAGE_TIERS] = {0, 0, 0, 0, 0}; // 0 = the default of each algorithm
 
 #if defined(ENV32BIT)
 size_t tier_page_size[RRD_STORAGE_TIERS] = {2048, 1024, 192, 192, 192};
@@ -22,10 +24,13 @@ size_t tier_page_size[RRD_STORAGE_TIERS] = {2048, 1024, 192, 192, 192};
 size_t tier_page_size[RRD_STORAGE_TIERS] = {4096, 2048, 384, 384, 384};
 #endif
 
-#if PAGE_TYPE_MAX != 1
-#error PAGE_TYPE_MAX is not 1 - you need to add allocations here
+#if PAGE_TYPE_MAX != 3
+#error PAGE_TYPE_MAX is not 3 - you need to add allocations here
 #endif
-size_t page_type_size[256] = {sizeof(storage_number), sizeof(storage_number_tier1_t)};
+// gorilla pages have variable length points - their size here is the uncompressed one
+// (their hot pages are sized by gorilla_page_size_for_entries())
+// rle pages are never collected - their points have the size of the type in their header
+size_t page_type_size[256] = {sizeof(storage_number), sizeof(storage_number_tier1_t), sizeof(storage_number), 0};
 
 __attribute__((constructor)) void initialize_multidb_ctx(void) {
     multidb_ctx[0] = &multidb_ctx_storage_tier0;
@@ -199,13 +204,11 @@ static inline bool check_completed_page_consistency(struct rrdeng_collect_handle
     if (unlikely(!handle->page || !handle->page_entries_max || !handle->page_position || !handle->page_end_time_ut))
         return false;
 
-    struct rrdengine_instance *ctx = mrg_metric_ctx(handle->metric);
-
     uuid_t *uuid = mrg_metric_uuid(main_mrg, handle->metric);
     time_t start_time_s = pgc_page_start_time_s(handle->page);
     time_t end_time_s = pgc_page_end_time_s(handle->page);
     time_t update_every_s = pgc_page_update_every_s(handle->page);
-    size_t page_length = handle->page_position * CTX_POINT_SIZE_BYTES(ctx);
+    size_t page_length = page_length_by_data(handle->type, handle->data, handle->page_position);
     size_t entries = handle->page_position;
     time_t overwrite_zero_update_every_s = (time_t)(handle->update_every_ut / USEC_PER_SEC);
 
@@ -218,7 +221,7 @@ static inline bool check_completed_page_consistency(struct rrdeng_collect_handle
             end_time_s,
             update_every_s,
             page_length,
-            ctx->config.page_type,
+            handle->type,
             entries,
             0, // do not check for future timestamps - we inherit the timestamps of the children
             overwrite_zero_update_every_s,
@@ -261,6 +264,7 @@ STORAGE_COLLECT_HANDLE *rrdeng_store_metric_init(STORAGE_METRIC_HANDLE *db_metri
     handle->page_entries_max = 0;
     handle->update_every_ut = (usec_t)update_every * USEC_PER_SEC;
     handle->options = is_1st_metric_writer ? RRDENG_1ST_METRIC_WRITER : 0;
+    handle->type = ctx->config.page_type;
 
     __atomic_add_fetch(&ctx->atomic.collectors_running, 1, __ATOMIC_RELAXED);
     if(!is_1st_metric_writer)
@@ -306,10 +310,21 @@ static bool page_has_only_empty_metrics(struct rrdeng_collect_handle *handle) {
         }
         break;
 
+        case PAGE_GORILLA_METRICS: {
+            GORILLA_READER gr;
+            storage_number n;
+            gorilla_reader_init(&gr, handle->data, handle->data_size);
+            while(gorilla_reader_next(&gr, &n)) {
+                if(does_storage_number_exist(n))
+                    return false;
+            }
+        }
+        break;
+
         default: {
             static bool logged = false;
             if(!logged) {
-                error("DBENGINE: cannot check page for nulls on unknown page type id %d", (mrg_metric_ctx(handle->metric))->config.page_type);
+                error("DBENGINE: cannot check page for nulls on unknown page type id %d", handle->type);
                 logged = true;
             }
             return false;
@@ -319,12 +334,61 @@ static bool page_has_only_empty_metrics(struct rrdeng_collect_handle *handle) {
     return true;
 }
 
+// ----------------------------------------------------------------------------
+// adaptive page sizing
+//
+// Pages are allocated for all the points the page size of the tier can hold,
+// but the pages of metrics collected irregularly (gaps, unaligned or repeated
+// collections, etc.) are flushed long before they are full, so most of their
+// hot page memory is never used. The collector learns per metric (in MRG) how
+// many points its pages end up having and allocates smaller pages for them.
+// Pages that are filled double the learned size, until it reaches the page
+// size of the tier again.
+
+bool rrdeng_adaptive_page_sizing = true;
+
+static inline size_t rrdeng_page_max_points(struct rrdengine_instance *ctx) {
+    // gorilla pages of the same size hold more points - they are flushed earlier if they run out of room
+    if(ctx->config.page_type == PAGE_GORILLA_METRICS)
+        return tier_page_size[ctx->config.tier] * 8 / GORILLA_EXPECTED_BITS_PER_VALUE;
+
+    return tier_page_size[ctx->config.tier] / CTX_POINT_SIZE_BYTES(ctx);
+}
+
+static void rrdeng_page_points_learn(struct rrdeng_collect_handle *handle) {
+    if(!rrdeng_adaptive_page_sizing || !handle->page_position)
+        return;
+
+    // these say nothing about the way the metric is collected
+    if(handle->page_flags & (RRDENG_PAGE_COLLECT_FINALIZE | RRDENG_PAGE_UPDATE_EVERY_CHANGE))
+        return;
+
+    struct rrdengine_instance *ctx = mrg_metric_ctx(handle->metric);
+    size_t max_points = rrdeng_page_max_points(ctx);
+    size_t points = mrg_metric_get_page_points(main_mrg, handle->metric);
+    if(!points)
+        points = max_points;
+
+    if(handle->page_flags & RRDENG_PAGE_FULL)
+        points *= 2;
+    else
+        points = (points * 3 + handle->page_position) / 4;
+
+    // zero means all the page of the tier
+    if(points + points / 4 >= max_points)
+        points = 0;
+
+    mrg_metric_set_page_points(main_mrg, handle->metric, points);
+}
+
 void rrdeng_store_metric_flush_current_page(STORAGE_COLLECT_HANDLE *collection_handle) {
     struct rrdeng_collect_handle *handle = (struct rrdeng_collect_handle *)collection_handle;
 
     if (unlikely(!handle->page))
         return;
 
+    rrdeng_page_points_learn(handle);
+
     if(!handle->page_position || page_has_only_empty_metrics(handle))
         pgc_page_to_clean_evict_or_release(main_cache, handle->page);
 
@@ -370,7 +434,8 @@ static void rrdeng_store_metric_create_new_page(struct rrdeng_collect_handle *ha
             .size = data_size,
             .data = data,
             .update_every_s = (uint32_t) update_every_s,
-            .hot = true
+            .hot = true,
+            .custom_data = &handle->type,
     };
 
     size_t conflicts = 0;
@@ -407,7 +472,9 @@ static void rrdeng_store_metric_create_new_page(struct rrdeng_collect_handle *ha
         page = pgc_page_add_and_acquire(main_cache, page_entry, &added);
     }
 
-    handle->page_entries_max = data_size / CTX_POINT_SIZE_BYTES(ctx);
+    // the entries of gorilla pages are set when they are allocated
+    if(handle->type != PAGE_GORILLA_METRICS)
+        handle->page_entries_max = data_size / CTX_POINT_SIZE_BYTES(ctx);
     handle->page_start_time_ut = point_in_time_ut;
     handle->page_end_time_ut = point_in_time_ut;
     handle->page_position = 1; // zero is already in our data
@@ -441,8 +508,7 @@ static size_t aligned_allocation_entries(size_t max_slots, size_t target_slot, t
 static void *rrdeng_alloc_new_metric_data(struct rrdeng_collect_handle *handle, size_t *data_size, usec_t point_in_time_ut) {
     struct rrdengine_instance *ctx = mrg_metric_ctx(handle->metric);
 
-    size_t max_size = tier_page_size[ctx->config.tier];
-    size_t max_slots = max_size / CTX_POINT_SIZE_BYTES(ctx);
+    size_t max_slots = rrdeng_page_max_points(ctx);
 
     size_t slots = aligned_allocation_entries(
             max_slots,
@@ -450,13 +516,30 @@ static void *rrdeng_alloc_new_metric_data(struct rrdeng_collect_handle *handle,
             (time_t) (point_in_time_ut / USEC_PER_SEC)
     );
 
-    if(slots < max_slots / 3)
+    size_t learned_points = rrdeng_adaptive_page_sizing ? mrg_metric_get_page_points(main_mrg, handle->metric) : 0;
+    if(learned_points) {
+        // room for 25% more points than the metric usually has, in multiples of 64 bytes
+        size_t learned_slots = learned_points + learned_points / 4;
+        size_t slots_per_64_bytes = MAX(64 / CTX_POINT_SIZE_BYTES(ctx), 1);
+        learned_slots = (learned_slots + slots_per_64_bytes - 1) / slots_per_64_bytes * slots_per_64_bytes;
+
+        if(learned_slots < slots)
+            slots = learned_slots;
+    }
+    else if(slots < max_slots / 3)
         slots = max_slots / 3;
 
+    if(slots > max_slots)
+        slots = max_slots;
+
     if(slots < 3)
         slots = 3;
 
-    size_t size = slots * CTX_POINT_SIZE_BYTES(ctx);
+    size_t size;
+    if(handle->type == PAGE_GORILLA_METRICS)
+        size = MIN(gorilla_page_size_for_entries(slots), tier_page_size[ctx->config.tier]);
+    else
+        size = slots * CTX_POINT_SIZE_BYTES(ctx);
 
     // internal_error(true, "PAGE ALLOC %zu bytes (%zu max)", size, max_size);
 
@@ -466,6 +549,12 @@ static void *rrdeng_alloc_new_metric_data(struct rrdeng_collect_handle *handle,
     *data_size = size;
     void *d = dbengine_page_alloc(size);
 
+    if(handle->type == PAGE_GORILLA_METRICS) {
+        // they are flushed at this many points, or earlier if they run out of room
+        handle->page_entries_max = slots;
+        gorilla_writer_init(&handle->gorilla, d, size);
+    }
+
     timing_step(TIMING_STEP_DBENGINE_PAGE_ALLOC);
 
     return d;
@@ -492,6 +581,10 @@ static void rrdeng_store_metric_append_point(STORAGE_COLLECT_HANDLE *collection_
         storage_number *tier0_metric_data = handle->data;
         tier0_metric_data[handle->page_position] = pack_storage_number(n, flags);
     }
+    else if(likely(ctx->config.page_type == PAGE_GORILLA_METRICS)) {
+        if(unlikely(!gorilla_writer_append(&handle->gorilla, pack_storage_number(n, flags))))
+            internal_fatal(true, "DBENGINE: gorilla page has no room for more points");
+    }
     else if(likely(ctx->config.page_type == PAGE_TIER)) {
         storage_number_tier1_t *tier12_metric_data = handle->data;
         storage_number_tier1_t number_tier1;
@@ -516,7 +609,8 @@ static void rrdeng_store_metric_append_point(STORAGE_COLLECT_HANDLE *collection_
         pgc_page_hot_set_end_time_s(main_cache, handle->page, (time_t) (point_in_time_ut / USEC_PER_SEC));
         handle->page_end_time_ut = point_in_time_ut;
 
-        if(unlikely(++handle->page_position >= handle->page_entries_max)) {
+        if(unlikely(++handle->page_position >= handle->page_entries_max ||
+                    (handle->type == PAGE_GORILLA_METRICS && !gorilla_writer_has_room(&handle->gorilla)))) {
             internal_fatal(handle->page_position > handle->page_entries_max, "DBENGINE: exceeded page max number of points");
             handle->page_flags |= RRDENG_PAGE_FULL;
             rrdeng_store_metric_flush_current_page(collection_handle);
@@ -849,7 +943,51 @@ static bool rrdeng_load_page_next(struct storage_engine_query_handle *rrddim_han
     handle->entries = entries;
     handle->position = position;
     handle->metric_data = pgc_page_data((PGC_PAGE *)handle->page);
+    handle->page_type = main_cache_page_type(handle->page);
     handle->dt_s = page_update_every_s;
+
+    if(handle->page_type == PAGE_GORILLA_METRICS) {
+        // gorilla pages can only be decoded sequentially
+        gorilla_reader_init(&handle->gorilla, handle->metric_data, pgc_page_data_size(main_cache, handle->page));
+        gorilla_reader_skip(&handle->gorilla, position);
+    }
+    else if(handle->page_type == PAGE_RLE) {
+        rle_reader_init(&handle->rle, handle->metric_data, pgc_page_data_size(main_cache, handle->page));
+
+        // we only know how to use the points of these page types
+        if(handle->rle.entries &&
+           ((rle_page_type(handle->rle.page) != PAGE_METRICS && rle_page_type(handle->rle.page) != PAGE_TIER) ||
+            handle->rle.page->point_size != page_type_size[rle_page_type(handle->rle.page)]))
+            handle->rle.entries = 0;
+    }
+
+    return true;
+}
+
+// Sets the values of the point at the position of the query, from an rle page,
+// and returns the position after the last point with the same values.
+static inline bool rrdeng_rle_point(struct rrdeng_query_handle *handle, STORAGE_POINT *sp, size_t *run_end) {
+    const void *point = rle_reader_point(&handle->rle, handle->position, run_end);
+    if(unlikely(!point))
+        return false;
+
+    if(rle_page_type(handle->rle.page) == PAGE_METRICS) {
+        storage_number n = *(const storage_number *)point;
+        sp->min = sp->max = sp->sum = unpack_storage_number(n);
+        sp->flags = n & SN_USER_FLAGS;
+        sp->count = 1;
+        sp->anomaly_count = is_storage_number_anomalous(n) ? 1 : 0;
+    }
+    else {
+        const storage_number_tier1_t *tier1_value = point;
+        sp->flags = tier1_value->anomaly_count ? SN_FLAG_NONE : SN_FLAG_NOT_ANOMALOUS;
+        sp->count = tier1_value->count;
+        sp->anomaly_count = tier1_value->anomaly_count;
+        sp->min = tier1_value->min_value;
+        sp->max = tier1_value->max_value;
+        sp->sum = tier1_value->sum_value;
+    }
+
     return true;
 }
 
@@ -878,7 +1016,7 @@ STORAGE_POINT rrdeng_load_metric_next(struct storage_engine_query_handle *rrddim
     sp.start_time_s = handle->now_s - handle->dt_s;
     sp.end_time_s = handle->now_s;
 
-    switch(handle->ctx->config.page_type) {
+    switch(handle->page_type) {
         case PAGE_METRICS: {
             storage_number n = handle->metric_data[handle->position];
             sp.min = sp.max = sp.sum = unpack_storage_number(n);
@@ -888,6 +1026,23 @@ STORAGE_POINT rrdeng_load_metric_next(struct storage_engine_query_handle *rrddim
         }
         break;
 
+        case PAGE_GORILLA_METRICS: {
+            storage_number n;
+
+            if(unlikely(handle->gorilla.index < handle->position))
+                gorilla_reader_skip(&handle->gorilla, handle->position - handle->gorilla.index);
+
+            if(likely(handle->gorilla.index == handle->position && gorilla_reader_next(&handle->gorilla, &n))) {
+                sp.min = sp.max = sp.sum = unpack_storage_number(n);
+                sp.flags = n & SN_USER_FLAGS;
+                sp.count = 1;
+                sp.anomaly_count = is_storage_number_anomalous(n) ? 1 : 0;
+            }
+            else
+                storage_point_empty(sp, sp.start_time_s, sp.end_time_s);
+        }
+        break;
+
         case PAGE_TIER: {
             storage_number_tier1_t tier1_value = ((storage_number_tier1_t *)handle->metric_data)[handle->position];
             sp.flags = tier1_value.anomaly_count ? SN_FLAG_NONE : SN_FLAG_NOT_ANOMALOUS;
@@ -899,11 +1054,16 @@ STORAGE_POINT rrdeng_load_metric_next(struct storage_engine_query_handle *rrddim
         }
         break;
 
+        case PAGE_RLE:
+            if(unlikely(!rrdeng_rle_point(handle, &sp, NULL)))
+                storage_point_empty(sp, sp.start_time_s, sp.end_time_s);
+            break;
+
         // we don't know this page type
         default: {
             static bool logged = false;
             if(!logged) {
-                error("DBENGINE: unknown page type %d found. Cannot decode it. Ignoring its metrics.", handle->ctx->config.page_type);
+                error("DBENGINE: unknown page type %d found. Cannot decode it. Ignoring its metrics.", handle->page_type);
                 logged = true;
             }
             storage_point_empty(sp, sp.start_time_s, sp.end_time_s);
@@ -921,6 +1081,285 @@ STORAGE_POINT rrdeng_load_metric_next(struct storage_engine_query_handle *rrddim
     return sp;
 }
 
+#define RRDENG_LOAD_METRIC_BATCH_MAX 128
+
+static inline void rrdeng_storage_numbers_to_points(STORAGE_POINT *sp, const storage_number *values, size_t entries, time_t now_s, time_t dt_s) {
+    NETDATA_DOUBLE unpacked[RRDENG_LOAD_METRIC_BATCH_MAX];
+    unpack_storage_number_array(unpacked, values, entries);
+
+    for(size_t i = 0; i < entries ;i++) {
+        sp[i].start_time_s = now_s - dt_s;
+        sp[i].end_time_s = now_s;
+        sp[i].min = sp[i].max = sp[i].sum = unpacked[i];
+        sp[i].flags = values[i] & SN_USER_FLAGS;
+        sp[i].count = 1;
+        sp[i].anomaly_count = is_storage_number_anomalous(values[i]) ? 1 : 0;
+        now_s += dt_s;
+    }
+}
+
+// Fills up to max_points, the same way rrdeng_load_metric_next() would.
+// The points of the current page are decoded in bulk, everything else
+// (switching pages, running out of data) goes through rrdeng_load_metric_next().
+size_t rrdeng_load_metric_next_batch(struct storage_engine_query_handle *rrddim_handle, STORAGE_POINT *points, size_t max_points) {
+    struct rrdeng_query_handle *handle = (struct rrdeng_query_handle *)rrddim_handle->handle;
+    size_t filled = 0;
+
+    while(filled < max_points && handle->now_s <= rrddim_handle->end_time_s) {
+        if(unlikely(!handle->page || handle->position >= handle->entries || handle->dt_s <= 0)) {
+            points[filled++] = rrdeng_load_metric_next(rrddim_handle);
+            continue;
+        }
+
+        size_t run = handle->entries - handle->position;
+        run = MIN(run, max_points - filled);
+        run = MIN(run, RRDENG_LOAD_METRIC_BATCH_MAX);
+        run = MIN(run, (size_t)((rrddim_handle->end_time_s - handle->now_s) / handle->dt_s + 1));
+
+        STORAGE_POINT *sp = &points[filled];
+
+        switch(handle->page_type) {
+            case PAGE_METRICS:
+                rrdeng_storage_numbers_to_points(sp, &handle->metric_data[handle->position], run, handle->now_s, handle->dt_s);
+                break;
+
+            case PAGE_GORILLA_METRICS: {
+                storage_number values[RRDENG_LOAD_METRIC_BATCH_MAX];
+                size_t decoded = 0;
+
+                if(likely(handle->gorilla.index == handle->position)) {
+                    while(decoded < run && gorilla_reader_next(&handle->gorilla, &values[decoded]))
+                        decoded++;
+                }
+
+                if(unlikely(!decoded)) {
+                    // let the single point path deal with it
+                    points[filled++] = rrdeng_load_metric_next(rrddim_handle);
+                    continue;
+                }
+
+                run = decoded;
+                rrdeng_storage_numbers_to_points(sp, values, run, handle->now_s, handle->dt_s);
+            }
+            break;
+
+            case PAGE_TIER: {
+                const storage_number_tier1_t *tier1_values = &((storage_number_tier1_t *)handle->metric_data)[handle->position];
+                time_t now_s = handle->now_s;
+
+                for(size_t i = 0; i < run ;i++) {
+                    sp[i].start_time_s = now_s - handle->dt_s;
+                    sp[i].end_time_s = now_s;
+                    sp[i].flags = tier1_values[i].anomaly_count ? SN_FLAG_NONE : SN_FLAG_NOT_ANOMALOUS;
+                    sp[i].count = tier1_values[i].count;
+                    sp[i].anomaly_count = tier1_values[i].anomaly_count;
+                    sp[i].min = tier1_values[i].min_value;
+                    sp[i].max = tier1_values[i].max_value;
+                    sp[i].sum = tier1_values[i].sum_value;
+                    now_s += handle->dt_s;
+                }
+            }
+            break;
+
+            case PAGE_RLE: {
+                STORAGE_POINT value;
+                size_t run_end;
+
+                if(unlikely(!rrdeng_rle_point(handle, &value, &run_end))) {
+                    // let the single point path deal with it
+                    points[filled++] = rrdeng_load_metric_next(rrddim_handle);
+                    continue;
+                }
+
+                // all the points up to the end of the run have the same values
+                run = MIN(run, run_end - handle->position);
+                time_t now_s = handle->now_s;
+
+                for(size_t i = 0; i < run ;i++) {
+                    sp[i] = value;
+                    sp[i].start_time_s = now_s - handle->dt_s;
+                    sp[i].end_time_s = now_s;
+                    now_s += handle->dt_s;
+                }
+            }
+            break;
+
+            default:
+                points[filled++] = rrdeng_load_metric_next(rrddim_handle);
+                continue;
+        }
+
+        internal_fatal(sp[0].end_time_s < rrddim_handle->start_time_s, "DBENGINE: this point is too old for this query");
+
+        handle->now_s += (time_t)run * handle->dt_s;
+        handle->position += run;
+        filled += run;
+    }
+
+    return filled;
+}
+
+// ----------------------------------------------------------------------------
+// aggregating the points of pages into the granularity of higher tiers
+
+static inline STORAGE_POINT *rrdeng_aggregation_group(STORAGE_POINT *points, size_t *filled, time_t *group, time_t group_s, time_t start_time_s, time_t end_time_s) {
+    time_t g = start_time_s / group_s;
+
+    if(unlikely(!*filled || g != *group)) {
+        STORAGE_POINT *p = &points[(*filled)++];
+        storage_point_empty(*p, start_time_s, end_time_s);
+        *group = g;
+        return p;
+    }
+
+    STORAGE_POINT *p = &points[*filled - 1];
+    if(likely(end_time_s > p->end_time_s))
+        p->end_time_s = end_time_s;
+
+    return p;
+}
+
+static inline void rrdeng_aggregation_merge(STORAGE_POINT *p, NETDATA_DOUBLE sum, NETDATA_DOUBLE min, NETDATA_DOUBLE max, uint32_t count, uint32_t anomaly_count, SN_FLAGS flags) {
+    if(unlikely(!netdata_double_isnumber(sum)))
+        return;
+
+    if(unlikely(storage_point_is_gap(*p))) {
+        p->sum = sum;
+        p->min = min;
+        p->max = max;
+        p->count = count;
+        p->anomaly_count = anomaly_count;
+        p->flags = flags;
+    }
+    else {
+        p->sum += sum;
+        p->min = MIN(p->min, min);
+        p->max = MAX(p->max, max);
+        p->count += count;
+        p->anomaly_count += anomaly_count;
+        p->flags |= flags;
+    }
+}
+
+// Aggregates the points of the query into groups of group_s seconds, without
+// creating a STORAGE_POINT per database point: the values of each page are
+// decoded in bulk and merged directly into the point of their group.
+// A group may continue in the next call, so the caller has to merge the
+// points of the same group (store_aggregated_metric_at_tier() does).
+size_t rrdeng_load_metric_next_aggregated(struct storage_engine_query_handle *rrddim_handle, time_t group_s, STORAGE_POINT *points, size_t max_points) {
+    struct rrdeng_query_handle *handle = (struct rrdeng_query_handle *)rrddim_handle->handle;
+
+    if(unlikely(group_s <= 0))
+        return rrdeng_load_metric_next_batch(rrddim_handle, points, max_points);
+
+    NETDATA_DOUBLE values[RRDENG_LOAD_METRIC_BATCH_MAX];
+    storage_number decoded[RRDENG_LOAD_METRIC_BATCH_MAX];
+    size_t filled = 0;
+    time_t group = 0;
+
+    while(handle->now_s <= rrddim_handle->end_time_s) {
+        bool single_point = (!handle->page || handle->position >= handle->entries || handle->dt_s <= 0 ||
+                             (handle->page_type == PAGE_GORILLA_METRICS && handle->gorilla.index != handle->position) ||
+                             (handle->page_type == PAGE_RLE && !rle_reader_point(&handle->rle, handle->position, NULL)) ||
+                             (handle->page_type != PAGE_METRICS && handle->page_type != PAGE_GORILLA_METRICS &&
+                              handle->page_type != PAGE_TIER && handle->page_type != PAGE_RLE));
+
+        if(unlikely(single_point)) {
+            // page switches and points outside the database - we don't know
+            // the time of the next point, so there has to be room for a new group
+            if(filled == max_points)
+                break;
+
+            STORAGE_POINT sp = rrdeng_load_metric_next(rrddim_handle);
+            STORAGE_POINT *p = rrdeng_aggregation_group(points, &filled, &group, group_s, sp.start_time_s, sp.end_time_s);
+            rrdeng_aggregation_merge(p, sp.sum, sp.min, sp.max, sp.count, sp.anomaly_count, sp.flags);
+            continue;
+        }
+
+        time_t dt_s = handle->dt_s;
+        time_t start_time_s = handle->now_s - dt_s;
+
+        // the points of this run must not need more groups than we have room for
+        time_t last_group = (filled ? group : start_time_s / group_s - 1) + (time_t)(max_points - filled);
+        time_t limit_s = (last_group + 1) * group_s;
+        if(limit_s <= start_time_s)
+            break;
+
+        size_t run = handle->entries - handle->position;
+        run = MIN(run, RRDENG_LOAD_METRIC_BATCH_MAX);
+        run = MIN(run, (size_t)((rrddim_handle->end_time_s - handle->now_s) / dt_s + 1));
+        run = MIN(run, (size_t)((limit_s - start_time_s + dt_s - 1) / dt_s));
+
+        if(handle->page_type == PAGE_RLE) {
+            STORAGE_POINT value;
+            size_t run_end;
+            rrdeng_rle_point(handle, &value, &run_end);
+            run = MIN(run, run_end - handle->position);
+
+            // the points of the run are merged into their groups all at once
+            for(size_t i = 0; i < run ;) {
+                time_t next_group_s = (start_time_s / group_s + 1) * group_s;
+                size_t n = MIN(run - i, (size_t)((next_group_s - start_time_s + dt_s - 1) / dt_s));
+
+                STORAGE_POINT *p = rrdeng_aggregation_group(points, &filled, &group, group_s, start_time_s, start_time_s + (time_t)n * dt_s);
+                rrdeng_aggregation_merge(p, value.sum * (NETDATA_DOUBLE)n, value.min, value.max,
+                                         value.count * (uint32_t)n, value.anomaly_count * (uint32_t)n, value.flags);
+
+                start_time_s += (time_t)n * dt_s;
+                i += n;
+            }
+        }
+        else if(handle->page_type == PAGE_TIER) {
+            const storage_number_tier1_t *tier1_values = &((storage_number_tier1_t *)handle->metric_data)[handle->position];
+
+            for(size_t i = 0; i < run ;i++, start_time_s += dt_s) {
+                STORAGE_POINT *p = rrdeng_aggregation_group(points, &filled, &group, group_s, start_time_s, start_time_s + dt_s);
+                rrdeng_aggregation_merge(p, tier1_values[i].sum_value, tier1_values[i].min_value, tier1_values[i].max_value,
+                                         tier1_values[i].count, tier1_values[i].anomaly_count,
+                                         tier1_values[i].anomaly_count ? SN_FLAG_NONE : SN_FLAG_NOT_ANOMALOUS);
+            }
+        }
+        else {
+            const storage_number *raw;
+
+            if(handle->page_type == PAGE_METRICS)
+                raw = &handle->metric_data[handle->position];
+            else {
+                size_t got = 0;
+                while(got < run && gorilla_reader_next(&handle->gorilla, &decoded[got]))
+                    got++;
+
+                if(unlikely(!got)) {
+                    // corrupted - the single point path will give empty points for the rest of the page
+                    if(filled == max_points)
+                        break;
+
+                    STORAGE_POINT sp = rrdeng_load_metric_next(rrddim_handle);
+                    STORAGE_POINT *p = rrdeng_aggregation_group(points, &filled, &group, group_s, sp.start_time_s, sp.end_time_s);
+                    rrdeng_aggregation_merge(p, sp.sum, sp.min, sp.max, sp.count, sp.anomaly_count, sp.flags);
+                    continue;
+                }
+
+                run = got;
+                raw = decoded;
+            }
+
+            unpack_storage_number_array(values, raw, run);
+
+            for(size_t i = 0; i < run ;i++, start_time_s += dt_s) {
+                STORAGE_POINT *p = rrdeng_aggregation_group(points, &filled, &group, group_s, start_time_s, start_time_s + dt_s);
+                rrdeng_aggregation_merge(p, values[i], values[i], values[i], 1,
+                                         is_storage_number_anomalous(raw[i]) ? 1 : 0, raw[i] & SN_USER_FLAGS);
+            }
+        }
+
+        handle->now_s += (time_t)run * dt_s;
+        handle->position += run;
+    }
+
+    return filled;
+}
+
 int rrdeng_load_metric_is_finished(struct storage_engine_query_handle *rrddim_handle) {
     struct rrdeng_query_handle *handle = (struct rrdeng_query_handle *)rrddim_handle->handle;
     return (handle->now_s > rrddim_handle->end_time_s);
@@ -1027,8 +1466,8 @@ void rrdeng_get_37_statistics(struct rrdengine_instance *ctx, unsigned long long
     array[16] = (uint64_t)__atomic_load_n(&ctx->stats.io_write_requests, __ATOMIC_RELAXED); // used
     array[17] = (uint64_t)__atomic_load_n(&ctx->stats.io_read_bytes, __ATOMIC_RELAXED);
     array[18] = (uint64_t)__atomic_load_n(&ctx->stats.io_read_requests, __ATOMIC_RELAXED); // used
-    array[19] = 0; // (uint64_t)__atomic_load_n(&ctx->stats.io_write_extent_bytes, __ATOMIC_RELAXED);
-    array[20] = 0; // (uint64_t)__atomic_load_n(&ctx->stats.io_write_extents, __ATOMIC_RELAXED);
+    array[19] = (uint64_t)__atomic_load_n(&ctx->stats.io_write_extent_bytes, __ATOMIC_RELAXED); // used
+    array[20] = (uint64_t)__atomic_load_n(&ctx->stats.io_write_extents, __ATOMIC_RELAXED); // used
     array[21] = 0; // (uint64_t)__atomic_load_n(&ctx->stats.io_read_extent_bytes, __ATOMIC_RELAXED);
     array[22] = 0; // (uint64_t)__atomic_load_n(&ctx->stats.io_read_extents, __ATOMIC_RELAXED);
     array[23] = (uint64_t)__atomic_load_n(&ctx->stats.datafile_creations, __ATOMIC_RELAXED);
@@ -1067,8 +1506,8 @@ static void rrdeng_populate_mrg(struct rrdengine_instance *ctx) {
     if(cpus > (size_t)libuv_worker_threads)
         cpus = (size_t)libuv_worker_threads;
 
-    if(cpus > MRG_PARTITIONS)
-        cpus = MRG_PARTITIONS;
+    if(cpus > mrg_partitions(main_mrg))
+        cpus = mrg_partitions(main_mrg);
 
     info("DBENGINE: populating retention to MRG from %zu journal files of tier %d, using %zu threads...", datafiles, ctx->config.tier, cpus);
 
@@ -1102,7 +1541,23 @@ static void rrdeng_populate_mrg(struct rrdengine_instance *ctx) {
 }
 
 void rrdeng_readiness_wait(struct rrdengine_instance *ctx) {
+    usec_t last_logged_ut = now_monotonic_usec();
+
     for (size_t i = 0; i < ctx->loading.populate_mrg.size; i++) {
+        while(!completion_is_done(&ctx->loading.populate_mrg.array[i])) {
+            sleep_usec(50 * USEC_PER_MS);
+
+            usec_t now_ut = now_monotonic_usec();
+            if(now_ut - last_logged_ut >= 5 * USEC_PER_SEC) {
+                last_logged_ut = now_ut;
+                info("DBENGINE: tier %d populated retention to MRG from %zu of %zu journal files in %0.2f secs",
+                     ctx->config.tier,
+                     __atomic_load_n(&ctx->loading.progress.journalfiles_populated, __ATOMIC_RELAXED),
+                     ctx->loading.progress.journalfiles,
+                     (double)(now_ut - ctx->loading.progress.started_ut) / USEC_PER_SEC);
+            }
+        }
+
         completion_wait_for(&ctx->loading.populate_mrg.array[i]);
         completion_destroy(&ctx->loading.populate_mrg.array[i]);
     }
@@ -1111,7 +1566,40 @@ void rrdeng_readiness_wait(struct rrdengine_instance *ctx) {
     ctx->loading.populate_mrg.array = NULL;
     ctx->loading.populate_mrg.size = 0;
 
-    info("DBENGINE: tier %d is ready for data collection and queries", ctx->config.tier);
+    info("DBENGINE: tier %d is ready for data collection and queries, after %0.2f secs",
+         ctx->config.tier,
+         ctx->loading.progress.started_ut ? (double)(now_monotonic_usec() - ctx->loading.progress.started_ut) / USEC_PER_SEC : 0.0);
+}
+
+uint8_t rrdeng_compression_algorithm_id(const char *name) {
+    if(!strcmp(name, "none"))
+        return RRD_NO_COMPRESSION;
+
+    if(!strcmp(name, "lz4"))
+        return RRD_LZ4;
+
+#ifdef HAVE_ZSTD
+    if(!strcmp(name, "zstd"))
+        return RRD_ZSTD;
+#endif
+
+    return UINT8_MAX;
+}
+
+const char *rrdeng_compression_algorithm_name(uint8_t algorithm) {
+    switch(algorithm) {
+        case RRD_NO_COMPRESSION:
+            return "none";
+
+        case RRD_LZ4:
+            return "lz4";
+
+        case RRD_ZSTD:
+            return "zstd";
+
+        default:
+            return "unknown";
+    }
 }
 
 bool rrdeng_is_legacy(STORAGE_INSTANCE *db_instance) {
@@ -1157,7 +1645,8 @@ int rrdeng_init(struct rrdengine_instance **ctxp, const char *dbfiles_path,
 
     ctx->config.tier = (int)tier;
     ctx->config.page_type = tier_page_type[tier];
-    ctx->config.global_compress_alg = RRD_LZ4;
+    ctx->config.global_compress_alg = tier_compression_algorithm[tier];
+    ctx->config.compression_level = tier_compression_level[tier];
     if (disk_space_mb < RRDENG_MIN_DISK_SPACE_MB)
         disk_space_mb = RRDENG_MIN_DISK_SPACE_MB;
     ctx->config.max_disk_space = disk_space_mb * 1048576LLU;
@@ -1167,12 +1656,18 @@ int rrdeng_init(struct rrdengine_instance **ctxp, const char *dbfiles_path,
     ctx->atomic.transaction_id = 1;
     ctx->quiesce.enabled = false;
 
-    if (rrdeng_dbengine_spawn(ctx) && !init_rrd_files(ctx)) {
+    // the lock keeps offline compaction away while we use the files,
+    // and the recovery completes or undoes a compaction that was interrupted
+    if (rrdeng_dbfiles_lock(ctx->config.dbfiles_path, &ctx->config.dbfiles_lock_fd) &&
+        rrdeng_compact_recover(ctx->config.dbfiles_path) == 0 &&
+        rrdeng_dbengine_spawn(ctx) && !init_rrd_files(ctx)) {
         // success - we run this ctx too
         rrdeng_populate_mrg(ctx);
         return 0;
     }
 
+    rrdeng_dbfiles_unlock(&ctx->config.dbfiles_lock_fd);
+
     if (ctx->config.legacy) {
         freez(ctx);
         if (ctxp)
@@ -1220,6 +1715,7 @@ int rrdeng_exit(struct rrdengine_instance *ctx) {
     completion_destroy(&completion);
 
     finalize_rrd_files(ctx);
+    rrdeng_dbfiles_unlock(&ctx->config.dbfiles_lock_fd);
 
     if(ctx->config.legacy)
         freez(ctx);
@@ -1270,11 +1766,15 @@ static void populate_v2_statistics(struct rrdengine_datafile *datafile, RRDENG_S
 
             time_t update_every_s;
 
-            size_t points = descr->page_length / CTX_POINT_SIZE_BYTES(datafile->ctx);
-
             time_t start_time_s = journal_start_time_s + descr->delta_start_s;
             time_t end_time_s = journal_start_time_s + descr->delta_end_s;
 
+            size_t points;
+            if(descr->type == PAGE_GORILLA_METRICS || descr->type == PAGE_RLE)
+                points = page_entries_by_time(start_time_s, end_time_s, descr->update_every_s);
+            else
+                points = page_type_size[descr->type] ? descr->page_length / page_type_size[descr->type] : 0;
+
             if(likely(points > 1))
                 update_every_s = (time_t) ((end_time_s - start_time_s) / (points - 1));
             else {
@@ -1369,3 +1869,173 @@ struct rrdeng_cache_efficiency_stats rrdeng_get_cache_efficiency_stats(void) {
     // FIXME - make cache efficiency stats atomic
     return rrdeng_cache_efficiency_stats;
 }
+
+// ----------------------------------------------------------------------------
+// rebuilding a tier from tier 0
+
+static size_t rrdeng_tier_rebuild_metrics_list(struct rrdengine_instance *ctx, uuid_t **uuids) {
+    Pvoid_t JudyHS = NULL;
+    size_t count = 0, size = 0;
+    *uuids = NULL;
+
+    uv_rwlock_rdlock(&ctx->datafiles.rwlock);
+    struct rrdengine_datafile *datafile = ctx->datafiles.first;
+    while(datafile && !datafile_acquire(datafile, DATAFILE_ACQUIRE_RETENTION))
+        datafile = datafile->next;
+    uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
+
+    while(datafile) {
+        struct journal_v2_header *j2_header = journalfile_v2_data_acquire(datafile->journalfile, NULL, 0, 0);
+        if(!j2_header) {
+            datafile = datafile_release_and_acquire_next_for_retention(ctx, datafile);
+            continue;
+        }
+
+        struct journal_metric_list *uuid_list = (struct journal_metric_list *)((uint8_t *) j2_header + j2_header->metric_offset);
+        for(size_t i = 0; i < j2_header->metric_count ;i++) {
+            Pvoid_t *PValue = JudyHSIns(&JudyHS, &uuid_list[i].uuid, sizeof(uuid_t), PJE0);
+            if(*PValue)
+                continue;
+
+            *PValue = (void *)1;
+
+            if(count == size) {
+                size = size ? size * 2 : 1024;
+                *uuids = reallocz(*uuids, size * sizeof(uuid_t));
+            }
+            uuid_copy((*uuids)[count++], uuid_list[i].uuid);
+        }
+
+        journalfile_v2_data_release(datafile->journalfile);
+        datafile = datafile_release_and_acquire_next_for_retention(ctx, datafile);
+    }
+
+    JudyHSFreeArray(&JudyHS, PJE0);
+    return count;
+}
+
+static inline void rrdeng_tier_rebuild_store(STORAGE_COLLECT_HANDLE *collection_handle, STORAGE_POINT *sp, time_t point_end_time_s) {
+    if(storage_point_is_gap(*sp))
+        rrdeng_store_metric_next(collection_handle, point_end_time_s * USEC_PER_SEC, NAN, NAN, NAN, 0, 0, SN_FLAG_NONE);
+    else
+        rrdeng_store_metric_next(collection_handle, point_end_time_s * USEC_PER_SEC, sp->sum, sp->min, sp->max,
+                                 (uint16_t)MIN(sp->count, UINT16_MAX), (uint16_t)MIN(sp->anomaly_count, UINT16_MAX), sp->flags);
+}
+
+// Appends to the given tier the points it is missing, aggregating them from tier 0.
+// The tier 0 pages are aggregated directly (rrdeng_load_metric_next_aggregated()),
+// so this is much cheaper than querying them point by point.
+// Only metrics found in indexed (v2) journal files are rebuilt.
+// It is meant to run without collectors (netdata -W rebuildtier=N).
+size_t rrdeng_tier_rebuild(size_t tier) {
+    if(tier == 0 || tier >= storage_tiers || !multidb_ctx[0] || !multidb_ctx[tier]) {
+        error("DBENGINE: cannot rebuild tier %zu, it should be between 1 and %zu", tier, storage_tiers - 1);
+        return 0;
+    }
+
+    struct rrdengine_instance *src_ctx = multidb_ctx[0];
+    struct rrdengine_instance *dst_ctx = multidb_ctx[tier];
+    time_t grouping = (time_t)get_tier_grouping(tier);
+
+    uuid_t *uuids;
+    size_t metrics = rrdeng_tier_rebuild_metrics_list(src_ctx, &uuids);
+    info("DBENGINE: rebuilding tier %zu from tier 0, for %zu metrics", tier, metrics);
+
+    uuid_t group_uuid;
+    uuid_clear(group_uuid);
+    STORAGE_METRICS_GROUP *smg = rrdeng_metrics_group_get((STORAGE_INSTANCE *)dst_ctx, &group_uuid);
+
+    usec_t started_ut = now_monotonic_usec();
+    size_t rebuilt = 0, points_read = 0, points_stored = 0, skipped = 0;
+    STORAGE_POINT points[RRDENG_LOAD_METRIC_BATCH_MAX];
+
+    for(size_t m = 0; m < metrics ;m++) {
+        METRIC *src = mrg_metric_get_and_acquire(main_mrg, &uuids[m], (Word_t)src_ctx);
+        if(!src) {
+            skipped++;
+            continue;
+        }
+
+        time_t src_first_time_s, src_last_time_s, update_every_s;
+        mrg_metric_get_retention(main_mrg, src, &src_first_time_s, &src_last_time_s, &update_every_s);
+        if(!update_every_s || !src_first_time_s || src_last_time_s <= src_first_time_s) {
+            mrg_metric_release(main_mrg, src);
+            skipped++;
+            continue;
+        }
+
+        METRIC *dst = mrg_metric_get_and_acquire(main_mrg, &uuids[m], (Word_t)dst_ctx);
+        if(!dst)
+            dst = rrdeng_metric_create((STORAGE_INSTANCE *)dst_ctx, &uuids[m]);
+
+        time_t group_s = update_every_s * grouping;
+        time_t dst_latest_time_s = mrg_metric_get_latest_time_s(main_mrg, dst);
+        time_t after_s = MAX(dst_latest_time_s, src_first_time_s);
+
+        if(after_s >= src_last_time_s) {
+            mrg_metric_release(main_mrg, dst);
+            mrg_metric_release(main_mrg, src);
+            continue;
+        }
+
+        struct storage_engine_query_handle handle;
+        rrdeng_load_metric_init((STORAGE_METRIC_HANDLE *)src, &handle, after_s, src_last_time_s, STORAGE_PRIORITY_HIGH);
+        STORAGE_COLLECT_HANDLE *collection_handle = rrdeng_store_metric_init((STORAGE_METRIC_HANDLE *)dst, (uint32_t)group_s, smg);
+
+        STORAGE_POINT vp = { 0 };
+        time_t vp_group = 0;
+        bool have_vp = false;
+        size_t used;
+
+        while(!rrdeng_load_metric_is_finished(&handle) &&
+              (used = rrdeng_load_metric_next_aggregated(&handle, group_s, points, RRDENG_LOAD_METRIC_BATCH_MAX))) {
+
+            for(size_t i = 0; i < used ;i++) {
+                points_read += (size_t)((points[i].end_time_s - points[i].start_time_s) / update_every_s);
+                time_t g = points[i].start_time_s / group_s;
+
+                if(have_vp && g == vp_group) {
+                    // the same group, continued from the previous call
+                    vp.end_time_s = MAX(vp.end_time_s, points[i].end_time_s);
+                    rrdeng_aggregation_merge(&vp, points[i].sum, points[i].min, points[i].max,
+                                             points[i].count, points[i].anomaly_count, points[i].flags);
+                    continue;
+                }
+
+                if(have_vp && (vp_group + 1) * group_s > dst_latest_time_s) {
+                    rrdeng_tier_rebuild_store(collection_handle, &vp, (vp_group + 1) * group_s);
+                    points_stored++;
+                }
+
+                vp = points[i];
+                vp_group = g;
+                have_vp = true;
+            }
+        }
+
+        // the last group is stored only when it is complete,
+        // the collectors (or the next rebuild) will do the rest
+        if(have_vp && (vp_group + 1) * group_s > dst_latest_time_s && (vp_group + 1) * group_s <= src_last_time_s) {
+            rrdeng_tier_rebuild_store(collection_handle, &vp, (vp_group + 1) * group_s);
+            points_stored++;
+        }
+
+        rrdeng_store_metric_finalize(collection_handle);
+        rrdeng_load_metric_finalize(&handle);
+        mrg_metric_release(main_mrg, dst);
+        mrg_metric_release(main_mrg, src);
+        rebuilt++;
+
+        if(rebuilt % 10000 == 0)
+            info("DBENGINE: rebuilding tier %zu, %zu of %zu metrics done", tier, m + 1, metrics);
+    }
+
+    rrdeng_metrics_group_release((STORAGE_INSTANCE *)dst_ctx, smg);
+    freez(uuids);
+
+    usec_t ended_ut = now_monotonic_usec();
+    info("DBENGINE: rebuilt tier %zu from tier 0: %zu metrics (%zu skipped), %zu points read, %zu points stored, in %llu ms",
+         tier, rebuilt, skipped, points_read, points_stored, (ended_ut - started_ut) / USEC_PER_MS);
+
+    return rebuilt;
+}
@@ -19,6 +19,13 @@ extern int default_multidb_disk_quota_mb;
 extern struct rrdengine_instance *multidb_ctx[RRD_STORAGE_TIERS];
 extern size_t page_type_size[];
 extern size_t tier_page_size[];
+extern bool rrdeng_adaptive_page_sizing;
+extern uint8_t tier_page_type[];
+extern uint8_t tier_compression_algorithm[];
+extern int tier_compression_level[];
+
+uint8_t rrdeng_compression_algorithm_id(const char *name);
+const char *rrdeng_compression_algorithm_name(uint8_t algorithm);
 
 #define CTX_POINT_SIZE_BYTES(ctx) page_type_size[(ctx)->config.page_type]
 
@@ -43,6 +50,8 @@ int rrdeng_store_metric_finalize(STORAGE_COLLECT_HANDLE *collection_handle);
 void rrdeng_load_metric_init(STORAGE_METRIC_HANDLE *db_metric_handle, struct storage_engine_query_handle *rrddim_handle,
                                     time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority);
 STORAGE_POINT rrdeng_load_metric_next(struct storage_engine_query_handle *rrddim_handle);
+size_t rrdeng_load_metric_next_batch(struct storage_engine_query_handle *rrddim_handle, STORAGE_POINT *points, size_t max_points);
+size_t rrdeng_load_metric_next_aggregated(struct storage_engine_query_handle *rrddim_handle, time_t group_s, STORAGE_POINT *points, size_t max_points);
 
 
 int rrdeng_load_metric_is_finished(struct storage_engine_query_handle *rrddim_handle);
@@ -162,6 +171,12 @@ struct rrdeng_cache_efficiency_stats {
     size_t pages_load_fail_invalid_extent;
     size_t pages_load_fail_cancelled;
 
+    // read-ahead of sliding window queries
+    size_t readahead_requests;
+    size_t readahead_pages_to_load;                     // the pages the read-ahead requests had to load from disk
+    size_t readahead_hits;                              // read-ahead ranges queried afterwards
+    size_t readahead_wasted;                            // read-ahead ranges never queried
+
     // timings for query preparation
     size_t prep_time_to_route;
     size_t prep_time_in_main_cache_lookup;
@@ -188,6 +203,7 @@ struct rrdeng_cache_efficiency_stats {
     // database events
     size_t journal_v2_mapped;
     size_t journal_v2_unmapped;
+    size_t journal_v2_filter_skips;
     size_t datafile_creation_started;
     size_t datafile_deletion_started;
     size_t datafile_deletion_spin;
@@ -220,5 +236,6 @@ struct rrdeng_cache_efficiency_stats rrdeng_get_cache_efficiency_stats(void);
 RRDENG_SIZE_STATS rrdeng_size_statistics(struct rrdengine_instance *ctx);
 size_t rrdeng_collectors_running(struct rrdengine_instance *ctx);
 bool rrdeng_is_legacy(STORAGE_INSTANCE *db_instance);
+size_t rrdeng_tier_rebuild(size_t tier);
 
 #endif /* NETDATA_RRDENGINEAPI_H */
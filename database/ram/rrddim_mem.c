@@ -401,6 +401,57 @@ STORAGE_POINT rrddim_query_next_metric(struct storage_engine_query_handle *handl
     return sp;
 }
 
+#define RRDDIM_QUERY_BATCH_MAX 128
+
+size_t rrddim_query_next_metrics(struct storage_engine_query_handle *handle, STORAGE_POINT *points, size_t max_points) {
+    struct mem_query_handle* h = (struct mem_query_handle*)handle->handle;
+    struct mem_metric_handle *mh = (struct mem_metric_handle *)h->db_metric_handle;
+    RRDDIM *rd = mh->rd;
+
+    NETDATA_DOUBLE values[RRDDIM_QUERY_BATCH_MAX];
+    size_t entries = mh->entries;
+    size_t filled = 0;
+
+    while(filled < max_points && h->next_timestamp <= handle->end_time_s) {
+        time_t this_timestamp = h->next_timestamp;
+
+        if(unlikely(this_timestamp < h->slot_timestamp || this_timestamp > h->last_timestamp || h->slot >= entries)) {
+            // empty points are returned one by one
+            points[filled++] = rrddim_query_next_metric(handle);
+            continue;
+        }
+
+        // the consecutive slots we can read, up to the end of the round robin buffer
+        size_t run = entries - h->slot;
+        run = MIN(run, max_points - filled);
+        run = MIN(run, RRDDIM_QUERY_BATCH_MAX);
+        run = MIN(run, (size_t)((MIN(h->last_timestamp, handle->end_time_s) - this_timestamp) / h->dt + 1));
+
+        const storage_number *db = &rd->db[h->slot];
+        unpack_storage_number_array(values, db, run);
+
+        STORAGE_POINT *sp = &points[filled];
+        for(size_t i = 0; i < run ;i++) {
+            sp[i].start_time_s = this_timestamp - h->dt;
+            sp[i].end_time_s = this_timestamp;
+            sp[i].min = sp[i].max = sp[i].sum = values[i];
+            sp[i].count = 1;
+            sp[i].anomaly_count = is_storage_number_anomalous(db[i]) ? 1 : 0;
+            sp[i].flags = (db[i] & SN_USER_FLAGS);
+            this_timestamp += h->dt;
+        }
+
+        h->slot += run;
+        if(unlikely(h->slot >= entries)) h->slot = 0;
+
+        h->next_timestamp += (time_t)run * h->dt;
+        h->slot_timestamp += (time_t)run * h->dt;
+        filled += run;
+    }
+
+    return filled;
+}
+
 int rrddim_query_is_finished(struct storage_engine_query_handle *handle) {
     struct mem_query_handle *h = (struct mem_query_handle*)handle->handle;
     return (h->next_timestamp > handle->end_time_s);
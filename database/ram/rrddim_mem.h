@@ -43,6 +43,7 @@ int rrddim_collect_finalize(STORAGE_COLLECT_HANDLE *collection_handle);
 
 void rrddim_query_init(STORAGE_METRIC_HANDLE *db_metric_handle, struct storage_engine_query_handle *handle, time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority);
 STORAGE_POINT rrddim_query_next_metric(struct storage_engine_query_handle *handle);
+size_t rrddim_query_next_metrics(struct storage_engine_query_handle *handle, STORAGE_POINT *points, size_t max_points);
 int rrddim_query_is_finished(struct storage_engine_query_handle *handle);
 void rrddim_query_finalize(struct storage_engine_query_handle *handle);
 time_t rrddim_query_latest_time_s(STORAGE_METRIC_HANDLE *db_metric_handle);
@@ -484,6 +484,16 @@ struct storage_engine_query_ops {
     // run this to load each metric number from the database
     STORAGE_POINT (*next_metric)(struct storage_engine_query_handle *handle);
 
+    // run this to load up to max_points metric numbers from the database at once
+    // returns the number of points filled in, 0 when the query is finished
+    // it is the same as calling is_finished() and next_metric() repeatedly
+    size_t (*next_metrics)(struct storage_engine_query_handle *handle, STORAGE_POINT *points, size_t max_points);
+
+    // optional - run this to load the metric numbers aggregated into points of group_s seconds,
+    // aligned the way higher tiers aggregate them (each point belongs to the group its start time falls into)
+    // returns the number of points filled in, 0 when the query is finished
+    size_t (*next_metrics_aggregated)(struct storage_engine_query_handle *handle, time_t group_s, STORAGE_POINT *points, size_t max_points);
+
     // run this to test if the series of next_metric() database queries is finished
     int (*is_finished)(struct storage_engine_query_handle *handle);
 
@@ -653,6 +663,7 @@ struct rrdset {
 
     size_t counter;                                 // the number of times we added values to this database
     size_t counter_done;                            // the number of times rrdset_done() has been called
+    size_t backfills;                               // the number of times replication stored past points (atomic)
 
     time_t last_accessed_time_s;                    // the last time this RRDSET has been accessed
 
@@ -1167,6 +1178,10 @@ void rrddim_index_destroy(RRDSET *st);
 extern time_t rrdhost_free_orphan_time_s;
 
 int rrd_init(char *hostname, struct rrdhost_system_info *system_info, bool unittest);
+void dbengine_init(char *hostname);
+#ifdef ENABLE_DBENGINE
+void dbengine_tier_compression_init(const char *hostname, size_t tier);
+#endif
 
 RRDHOST *rrdhost_find_by_hostname(const char *hostname);
 RRDHOST *rrdhost_find_by_guid(const char *guid);
@@ -1389,6 +1404,8 @@ void store_metric_collection_completed(void);
 
 #ifdef ENABLE_DBENGINE
 #include "database/engine/rrdengineapi.h"
+#include "database/engine/reader.h"
+#include "database/engine/compact.h"
 #endif
 #include "sqlite/sqlite_functions.h"
 #include "sqlite/sqlite_context.h"
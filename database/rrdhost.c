@@ -779,12 +779,46 @@ void *dbengine_tier_init(void *ptr) {
     dbi->ret = rrdeng_init(NULL, dbi->path, dbi->disk_space_mb, dbi->tier);
     return ptr;
 }
+
+void dbengine_tier_compression_init(const char *hostname, size_t tier) {
+    char dbengineconfig[200 + 1];
+
+    if(tier == 0)
+        snprintfz(dbengineconfig, 200, "dbengine compression");
+    else
+        snprintfz(dbengineconfig, 200, "dbengine tier %zu compression", tier);
+
+    const char *compression = config_get(CONFIG_SECTION_DB, dbengineconfig, rrdeng_compression_algorithm_name(tier_compression_algorithm[tier]));
+    uint8_t algorithm = rrdeng_compression_algorithm_id(compression);
+    if(algorithm == UINT8_MAX) {
+        error("DBENGINE on '%s': compression algorithm '%s' is not supported by this build, assuming 'lz4'", hostname, compression);
+        config_set(CONFIG_SECTION_DB, dbengineconfig, "lz4");
+        algorithm = RRD_LZ4;
+    }
+    tier_compression_algorithm[tier] = algorithm;
+
+    if(algorithm == RRD_ZSTD) {
+        if(tier == 0)
+            snprintfz(dbengineconfig, 200, "dbengine compression level");
+        else
+            snprintfz(dbengineconfig, 200, "dbengine tier %zu compression level", tier);
+
+        tier_compression_level[tier] = (int)config_get_number(CONFIG_SECTION_DB, dbengineconfig, 3);
+    }
+}
 #endif
 
 void dbengine_init(char *hostname) {
 #ifdef ENABLE_DBENGINE
     use_direct_io = config_get_boolean(CONFIG_SECTION_DB, "dbengine use direct io", use_direct_io);
 
+#ifdef HAVE_LINUX_IO_URING_H
+    const char *io_backend = config_get(CONFIG_SECTION_DB, "dbengine io backend", rrdeng_io_backend_name(RRDENG_IO_BACKEND_IO_URING));
+#else
+    const char *io_backend = config_get(CONFIG_SECTION_DB, "dbengine io backend", rrdeng_io_backend_name(RRDENG_IO_BACKEND_LIBUV));
+#endif
+    rrdeng_io_backend_init(rrdeng_io_backend_id(io_backend));
+
     unsigned read_num = (unsigned)config_get_number(CONFIG_SECTION_DB, "dbengine pages per extent", MAX_PAGES_PER_EXTENT);
     if (read_num > 0 && read_num <= MAX_PAGES_PER_EXTENT)
         rrdeng_pages_per_extent = read_num;
@@ -793,6 +827,44 @@ void dbengine_init(char *hostname) {
         config_set_number(CONFIG_SECTION_DB, "dbengine pages per extent", rrdeng_pages_per_extent);
     }
 
+    read_num = (unsigned)config_get_number(CONFIG_SECTION_DB, "dbengine extents per flush", rrdeng_extents_per_flush);
+    if (read_num > 0 && read_num <= MAX_EXTENTS_PER_FLUSH)
+        rrdeng_extents_per_flush = read_num;
+    else {
+        error("Invalid dbengine extents per flush %u given. Using %u.", read_num, rrdeng_extents_per_flush);
+        config_set_number(CONFIG_SECTION_DB, "dbengine extents per flush", rrdeng_extents_per_flush);
+    }
+
+    const char *ep = config_get(CONFIG_SECTION_DB, "dbengine page cache eviction policy", pgc_eviction_policy_name(main_cache_eviction_policy));
+    if(strcmp(ep, "lru") == 0 || strcmp(ep, "tinylfu") == 0)
+        main_cache_eviction_policy = pgc_eviction_policy_id(ep);
+    else {
+        error("DBENGINE: unknown page cache eviction policy '%s', assuming '%s'", ep, pgc_eviction_policy_name(main_cache_eviction_policy));
+        config_set(CONFIG_SECTION_DB, "dbengine page cache eviction policy", pgc_eviction_policy_name(main_cache_eviction_policy));
+    }
+
+    if(config_get_boolean(CONFIG_SECTION_DB, "dbengine page cache huge pages", CONFIG_BOOLEAN_NO))
+        dbengine_page_memory_policy |= ARAL_MEMORY_HUGE_PAGES;
+
+    int numa_interleave = config_get_boolean_ondemand(CONFIG_SECTION_DB, "dbengine page cache numa interleave", CONFIG_BOOLEAN_AUTO);
+    if(numa_interleave == CONFIG_BOOLEAN_YES || (numa_interleave == CONFIG_BOOLEAN_AUTO && aral_numa_nodes() > 1))
+        dbengine_page_memory_policy |= ARAL_MEMORY_NUMA_INTERLEAVE;
+
+    pg_cache_readahead_enabled = config_get_boolean(CONFIG_SECTION_DB, "dbengine query read ahead", pg_cache_readahead_enabled);
+    pg_cache_rle_enabled = config_get_boolean(CONFIG_SECTION_DB, "dbengine run length encoding", pg_cache_rle_enabled);
+    rrdeng_adaptive_page_sizing = config_get_boolean(CONFIG_SECTION_DB, "dbengine adaptive page size", rrdeng_adaptive_page_sizing);
+
+    const char *pt = config_get(CONFIG_SECTION_DB, "dbengine page type", tier_page_type[0] == PAGE_GORILLA_METRICS ? "gorilla" : "raw");
+    if(strcmp(pt, "gorilla") == 0)
+        tier_page_type[0] = PAGE_GORILLA_METRICS;
+    else if(strcmp(pt, "raw") == 0)
+        tier_page_type[0] = PAGE_METRICS;
+    else {
+        error("DBENGINE: unknown page type '%s', assuming 'raw'", pt);
+        config_set(CONFIG_SECTION_DB, "dbengine page type", "raw");
+        tier_page_type[0] = PAGE_METRICS;
+    }
+
     storage_tiers = config_get_number(CONFIG_SECTION_DB, "storage tiers", storage_tiers);
     if(storage_tiers < 1) {
         error("At least 1 storage tier is required. Assuming 1.");
@@ -857,6 +929,8 @@ void dbengine_init(char *hostname) {
             }
         }
 
+        dbengine_tier_compression_init(hostname, tier);
+
         storage_tiers_grouping_iterations[tier] = grouping_iterations;
         storage_tiers_backfill[tier] = backfill;
 
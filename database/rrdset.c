@@ -1111,67 +1111,93 @@ static inline time_t tier_next_point_time_s(RRDDIM *rd, struct rrddim_tier *t, t
     return now_s + loop - ((now_s + loop) % loop);
 }
 
-void store_metric_at_tier(RRDDIM *rd, size_t tier, struct rrddim_tier *t, STORAGE_POINT sp, usec_t now_ut __maybe_unused) {
-    if (unlikely(!t->next_point_end_time_s))
-        t->next_point_end_time_s = tier_next_point_time_s(rd, t, sp.end_time_s);
-
-    if(unlikely(sp.start_time_s >= t->next_point_end_time_s)) {
-        // flush the virtual point, it is done
-
-        if (likely(!storage_point_is_unset(t->virtual_point))) {
-
-            t->collect_ops->store_metric(
-                t->db_collection_handle,
-                t->next_point_end_time_s * USEC_PER_SEC,
-                t->virtual_point.sum,
-                t->virtual_point.min,
-                t->virtual_point.max,
-                t->virtual_point.count,
-                t->virtual_point.anomaly_count,
-                t->virtual_point.flags);
-        }
-        else {
-            t->collect_ops->store_metric(
-                t->db_collection_handle,
-                t->next_point_end_time_s * USEC_PER_SEC,
-                NAN,
-                NAN,
-                NAN,
-                0,
-                0, SN_FLAG_NONE);
-        }
-
-        rrdset_done_statistics_points_stored_per_tier[tier]++;
-        t->virtual_point.count = 0; // make the point unset
-        t->next_point_end_time_s = tier_next_point_time_s(rd, t, sp.end_time_s);
+static inline void store_metric_at_tier_flush_virtual_point(size_t tier, struct rrddim_tier *t) {
+    if (likely(!storage_point_is_unset(t->virtual_point))) {
+
+        t->collect_ops->store_metric(
+            t->db_collection_handle,
+            t->next_point_end_time_s * USEC_PER_SEC,
+            t->virtual_point.sum,
+            t->virtual_point.min,
+            t->virtual_point.max,
+            t->virtual_point.count,
+            t->virtual_point.anomaly_count,
+            t->virtual_point.flags);
     }
+    else {
+        t->collect_ops->store_metric(
+            t->db_collection_handle,
+            t->next_point_end_time_s * USEC_PER_SEC,
+            NAN,
+            NAN,
+            NAN,
+            0,
+            0, SN_FLAG_NONE);
+    }
+
+    rrdset_done_statistics_points_stored_per_tier[tier]++;
+    t->virtual_point.count = 0; // make the point unset
+}
 
+static inline void store_metric_at_tier_merge_virtual_point(struct rrddim_tier *t, STORAGE_POINT *sp) {
     // merge the dates into our virtual point
-    if (unlikely(sp.start_time_s < t->virtual_point.start_time_s))
-        t->virtual_point.start_time_s = sp.start_time_s;
+    if (unlikely(sp->start_time_s < t->virtual_point.start_time_s))
+        t->virtual_point.start_time_s = sp->start_time_s;
 
-    if (likely(sp.end_time_s > t->virtual_point.end_time_s))
-        t->virtual_point.end_time_s = sp.end_time_s;
+    if (likely(sp->end_time_s > t->virtual_point.end_time_s))
+        t->virtual_point.end_time_s = sp->end_time_s;
 
     // merge the values into our virtual point
-    if (likely(!storage_point_is_gap(sp))) {
+    if (likely(!storage_point_is_gap(*sp))) {
         // we aggregate only non NULLs into higher tiers
 
         if (likely(!storage_point_is_unset(t->virtual_point))) {
             // merge the collected point to our virtual one
-            t->virtual_point.sum += sp.sum;
-            t->virtual_point.min = MIN(t->virtual_point.min, sp.min);
-            t->virtual_point.max = MAX(t->virtual_point.max, sp.max);
-            t->virtual_point.count += sp.count;
-            t->virtual_point.anomaly_count += sp.anomaly_count;
-            t->virtual_point.flags |= sp.flags;
+            t->virtual_point.sum += sp->sum;
+            t->virtual_point.min = MIN(t->virtual_point.min, sp->min);
+            t->virtual_point.max = MAX(t->virtual_point.max, sp->max);
+            t->virtual_point.count += sp->count;
+            t->virtual_point.anomaly_count += sp->anomaly_count;
+            t->virtual_point.flags |= sp->flags;
         }
         else {
             // reset our virtual point to this one
-            t->virtual_point = sp;
+            t->virtual_point = *sp;
         }
     }
 }
+
+void store_metric_at_tier(RRDDIM *rd, size_t tier, struct rrddim_tier *t, STORAGE_POINT sp, usec_t now_ut __maybe_unused) {
+    if (unlikely(!t->next_point_end_time_s))
+        t->next_point_end_time_s = tier_next_point_time_s(rd, t, sp.end_time_s);
+
+    if(unlikely(sp.start_time_s >= t->next_point_end_time_s)) {
+        // flush the virtual point, it is done
+        store_metric_at_tier_flush_virtual_point(tier, t);
+        t->next_point_end_time_s = tier_next_point_time_s(rd, t, sp.end_time_s);
+    }
+
+    store_metric_at_tier_merge_virtual_point(t, &sp);
+}
+
+// The same as store_metric_at_tier(), for points the storage engine has already
+// aggregated into the granularity of this tier (next_metrics_aggregated() query ops).
+// Each of these points belongs to the tier point its start time falls into.
+void store_aggregated_metric_at_tier(RRDDIM *rd, size_t tier, struct rrddim_tier *t, STORAGE_POINT sp) {
+    time_t point_end_time_s = tier_next_point_time_s(rd, t, sp.start_time_s);
+
+    if (unlikely(!t->next_point_end_time_s))
+        t->next_point_end_time_s = point_end_time_s;
+
+    if(unlikely(sp.start_time_s >= t->next_point_end_time_s)) {
+        // flush the virtual point, it is done
+        store_metric_at_tier_flush_virtual_point(tier, t);
+        t->next_point_end_time_s = point_end_time_s;
+    }
+
+    store_metric_at_tier_merge_virtual_point(t, &sp);
+}
+
 #ifdef NETDATA_LOG_COLLECTION_ERRORS
 void rrddim_store_metric_with_trace(RRDDIM *rd, usec_t point_end_time_ut, NETDATA_DOUBLE n, SN_FLAGS flags, const char *function) {
 #else // !NETDATA_LOG_COLLECTION_ERRORS
@@ -19,6 +19,7 @@
 #define STORE_HOST_OR_CHART_LABEL_VALUE "(u2h('%s'), %d,'%s','%s', unixepoch())"
 
 #define DELETE_DIMENSION_UUID   "DELETE FROM dimension WHERE dim_id = @uuid;"
+#define SELECT_DIMENSION_UUID   "SELECT 1 FROM dimension WHERE dim_id = @uuid;"
 
 #define SQL_STORE_HOST_INFO "INSERT OR REPLACE INTO host " \
         "(host_id, hostname, registry_hostname, update_every, os, timezone," \
@@ -278,6 +279,56 @@ static void delete_dimension_uuid(uuid_t *dimension_uuid)
         error_report("Failed to reset statement when deleting dimension UUID, rc = %d", rc);
 }
 
+// the statement is finalized by sql_dimension_exists_done(), not at thread exit,
+// since its users (the offline compaction) run on the main thread
+static __thread sqlite3_stmt *dimension_exists_res = NULL;
+
+// returns 1 when the dimension is in the database, 0 when it is not, -1 on errors
+int sql_dimension_exists(uuid_t *dimension_uuid)
+{
+    int rc, exists = -1;
+
+    if (unlikely(!dimension_exists_res)) {
+        rc = sqlite3_prepare_v2(db_meta, SELECT_DIMENSION_UUID, -1, &dimension_exists_res, 0);
+        if (rc != SQLITE_OK) {
+            error_report("Failed to prepare statement to check a dimension uuid");
+            return -1;
+        }
+    }
+
+    rc = sqlite3_bind_blob(dimension_exists_res, 1, dimension_uuid,  sizeof(*dimension_uuid), SQLITE_STATIC);
+    if (unlikely(rc != SQLITE_OK))
+        goto skip_execution;
+
+    rc = sqlite3_step_monitored(dimension_exists_res);
+    if (rc == SQLITE_ROW)
+        exists = 1;
+    else if (rc == SQLITE_DONE)
+        exists = 0;
+    else
+        error_report("Failed to check dimension uuid, rc = %d", rc);
+
+skip_execution:
+    rc = sqlite3_reset(dimension_exists_res);
+    if (unlikely(rc != SQLITE_OK))
+        error_report("Failed to reset statement when checking dimension UUID, rc = %d", rc);
+
+    return exists;
+}
+
+// finalizes the statement of sql_dimension_exists() of this thread
+void sql_dimension_exists_done(void)
+{
+    if (!dimension_exists_res)
+        return;
+
+    int rc = sqlite3_finalize(dimension_exists_res);
+    if (unlikely(rc != SQLITE_OK))
+        error_report("Failed to finalize statement to check a dimension uuid, rc = %d", rc);
+
+    dimension_exists_res = NULL;
+}
+
 //
 // Store host and host system info information in the database
 static int store_host_metadata(RRDHOST *host)
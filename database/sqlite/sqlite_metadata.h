@@ -16,6 +16,8 @@ void metaqueue_store_claim_id(uuid_t *host_uuid, uuid_t *claim_uuid);
 void metaqueue_host_update_info(RRDHOST *host);
 void migrate_localhost(uuid_t *host_uuid);
 void metadata_queue_load_host_context(RRDHOST *host);
+int sql_dimension_exists(uuid_t *dimension_uuid);
+void sql_dimension_exists_done(void);
 
 // UNIT TEST
 int metadata_unittest(void);
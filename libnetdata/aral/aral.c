@@ -19,6 +19,13 @@
 // ideal to have the same overhead as libc is 4k
 #define ARAL_MAX_PAGE_SIZE_MALLOC (65*1024)
 
+// the size of huge pages (x86_64 and aarch64 with 4k pages)
+#define ARAL_HUGE_PAGE_SIZE (2*1024*1024)
+
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
 typedef struct aral_free {
     size_t size;
     struct aral_free *next;
@@ -28,6 +35,7 @@ typedef struct aral_page {
     size_t size;                    // the allocation size of the page
     const char *filename;
     uint8_t *data;
+    bool anonymous_mmap;            // data has been allocated with mmap() for the memory policy
 
     uint32_t free_elements_to_move_first;
     uint32_t max_elements;          // the number of elements that can fit on this page
@@ -74,6 +82,8 @@ struct aral {
             const char *filename;
             char **cache_dir;
         } mmap;
+
+        ARAL_MEMORY_POLICY memory_policy;
     } config;
 
     struct {
@@ -271,6 +281,129 @@ size_t aral_next_allocation_size___adders_lock_needed(ARAL *ar) {
     return size;
 }
 
+// ----------------------------------------------------------------------------
+// memory policy
+
+size_t aral_numa_nodes(void) {
+    static size_t nodes = 0;
+
+    if(unlikely(!nodes)) {
+        size_t found = 0;
+        DIR *dir = opendir("/sys/devices/system/node");
+        if(dir) {
+            struct dirent *de;
+            while((de = readdir(dir))) {
+                if(strncmp(de->d_name, "node", 4) == 0 && isdigit((uint8_t)de->d_name[4]))
+                    found++;
+            }
+            closedir(dir);
+        }
+
+        nodes = found ? found : 1;
+    }
+
+    return nodes;
+}
+
+void aral_set_memory_policy(ARAL *ar, ARAL_MEMORY_POLICY policy) {
+    if(ar->config.mmap.enabled)
+        return;
+
+    if((policy & ARAL_MEMORY_NUMA_INTERLEAVE) && aral_numa_nodes() < 2)
+        policy &= ~ARAL_MEMORY_NUMA_INTERLEAVE;
+
+    aral_lock(ar);
+
+    if(ar->aral_lock.pages) {
+        aral_unlock(ar);
+        error("ARAL: '%s' memory policy cannot be changed after memory has been allocated", ar->config.name);
+        return;
+    }
+
+    ar->config.memory_policy = policy;
+
+    if(policy != ARAL_MEMORY_DEFAULT) {
+        // pages are mmap()ed, so make them big enough to be worth it
+        // and a multiple of the huge page size, so that no part of them is wasted
+        uint64_t max_alloc_size = MAX(ar->config.max_allocation_size, ARAL_HUGE_PAGE_SIZE);
+        max_alloc_size = ((max_alloc_size + ARAL_HUGE_PAGE_SIZE - 1) / ARAL_HUGE_PAGE_SIZE) * ARAL_HUGE_PAGE_SIZE;
+        ar->config.max_allocation_size = max_alloc_size - (max_alloc_size % ar->config.element_size);
+        ar->config.max_page_elements = ar->config.max_allocation_size / ar->config.element_size;
+
+        aral_adders_lock(ar);
+        ar->adders.allocation_size = ar->config.max_allocation_size;
+        aral_adders_unlock(ar);
+    }
+
+    aral_unlock(ar);
+
+    info("ARAL: '%s' pages of %zu bytes, using%s%s",
+         ar->config.name, ar->config.max_allocation_size,
+         (policy & ARAL_MEMORY_HUGE_PAGES) ? " huge pages" : "",
+         (policy & ARAL_MEMORY_NUMA_INTERLEAVE) ? " interleaved across NUMA nodes" : "");
+}
+
+static void *aral_mmap_anonymous(ARAL *ar, size_t size) {
+    // the mapping is a multiple of the huge page size (set by aral_set_memory_policy())
+    size_t mapped_size = ((size + ARAL_HUGE_PAGE_SIZE - 1) / ARAL_HUGE_PAGE_SIZE) * ARAL_HUGE_PAGE_SIZE;
+    void *ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if(ar->config.memory_policy & ARAL_MEMORY_HUGE_PAGES) {
+        // pre-allocated huge pages (hugetlbfs), if the system has any available
+        static bool hugetlb_available = true;
+        if(__atomic_load_n(&hugetlb_available, __ATOMIC_RELAXED)) {
+            ptr = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if(ptr == MAP_FAILED)
+                __atomic_store_n(&hugetlb_available, false, __ATOMIC_RELAXED);
+        }
+    }
+#endif
+
+    if(ptr == MAP_FAILED) {
+        // map one huge page more, to align the region to the huge page size
+        size_t unaligned_size = mapped_size + ARAL_HUGE_PAGE_SIZE;
+        uint8_t *unaligned = mmap(NULL, unaligned_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(unaligned == MAP_FAILED)
+            return NULL;
+
+        uint8_t *aligned = (uint8_t *)(((uintptr_t)unaligned + ARAL_HUGE_PAGE_SIZE - 1) & ~((uintptr_t)ARAL_HUGE_PAGE_SIZE - 1));
+        if(aligned > unaligned)
+            munmap(unaligned, aligned - unaligned);
+        if(unaligned + unaligned_size > aligned + mapped_size)
+            munmap(aligned + mapped_size, unaligned + unaligned_size - (aligned + mapped_size));
+
+        ptr = aligned;
+
+#ifdef MADV_HUGEPAGE
+        if(ar->config.memory_policy & ARAL_MEMORY_HUGE_PAGES)
+            (void)madvise(ptr, mapped_size, MADV_HUGEPAGE);
+#endif
+    }
+
+#if defined(__linux__) && defined(SYS_mbind)
+    if(ar->config.memory_policy & ARAL_MEMORY_NUMA_INTERLEAVE) {
+        // this has to be done before the memory is touched
+        unsigned long nodemask[4] = { 0 };
+        size_t nodes = MIN(aral_numa_nodes(), sizeof(nodemask) * 8);
+        for(size_t n = 0; n < nodes ;n++)
+            nodemask[n / (sizeof(unsigned long) * 8)] |= 1UL << (n % (sizeof(unsigned long) * 8));
+
+        if(syscall(SYS_mbind, ptr, mapped_size, MPOL_INTERLEAVE, nodemask, sizeof(nodemask) * 8, 0) != 0) {
+            error_limit_static_global_var(erl, 1, 0);
+            error_limit(&erl, "ARAL: '%s' cannot interleave memory across %zu NUMA nodes", ar->config.name, nodes);
+        }
+    }
+#endif
+
+    return ptr;
+}
+
+static void aral_munmap_anonymous(void *ptr, size_t size) {
+    size_t mapped_size = ((size + ARAL_HUGE_PAGE_SIZE - 1) / ARAL_HUGE_PAGE_SIZE) * ARAL_HUGE_PAGE_SIZE;
+    munmap(ptr, mapped_size);
+}
+
 static ARAL_PAGE *aral_create_page___no_lock_needed(ARAL *ar, size_t size TRACE_ALLOCATIONS_FUNCTION_DEFINITION_PARAMS) {
     ARAL_PAGE *page = callocz(1, sizeof(ARAL_PAGE));
     netdata_spinlock_init(&page->free.spinlock);
@@ -297,11 +430,18 @@ static ARAL_PAGE *aral_create_page___no_lock_needed(ARAL *ar, size_t size TRACE_
         __atomic_add_fetch(&ar->stats->mmap.allocated_bytes, page->size, __ATOMIC_RELAXED);
     }
     else {
+        if(unlikely(ar->config.memory_policy != ARAL_MEMORY_DEFAULT)) {
+            page->data = aral_mmap_anonymous(ar, page->size);
+            page->anonymous_mmap = (page->data != NULL);
+        }
+
+        if(likely(!page->data)) {
 #ifdef NETDATA_TRACE_ALLOCATIONS
-        page->data = mallocz_int(page->size TRACE_ALLOCATIONS_FUNCTION_CALL_PARAMS);
+            page->data = mallocz_int(page->size TRACE_ALLOCATIONS_FUNCTION_CALL_PARAMS);
 #else
-        page->data = mallocz(page->size);
+            page->data = mallocz(page->size);
 #endif
+        }
         __atomic_add_fetch(&ar->stats->malloc.allocations, 1, __ATOMIC_RELAXED);
         __atomic_add_fetch(&ar->stats->malloc.allocated_bytes, page->size, __ATOMIC_RELAXED);
     }
@@ -332,11 +472,15 @@ void aral_del_page___no_lock_needed(ARAL *ar, ARAL_PAGE *page TRACE_ALLOCATIONS_
         __atomic_sub_fetch(&ar->stats->mmap.allocated_bytes, page->size, __ATOMIC_RELAXED);
     }
     else {
+        if(unlikely(page->anonymous_mmap))
+            aral_munmap_anonymous(page->data, page->size);
+        else {
 #ifdef NETDATA_TRACE_ALLOCATIONS
-        freez_int(page->data TRACE_ALLOCATIONS_FUNCTION_CALL_PARAMS);
+            freez_int(page->data TRACE_ALLOCATIONS_FUNCTION_CALL_PARAMS);
 #else
-        freez(page->data);
+            freez(page->data);
 #endif
+        }
         __atomic_sub_fetch(&ar->stats->malloc.allocations, 1, __ATOMIC_RELAXED);
         __atomic_sub_fetch(&ar->stats->malloc.allocated_bytes, page->size, __ATOMIC_RELAXED);
     }
@@ -1083,7 +1227,20 @@ int aral_unittest(size_t elements) {
 
     aral_destroy(auc.ar);
 
+    struct aral_unittest_config auc_huge = {
+            .single_threaded = true,
+            .threads = 1,
+            .ar = aral_create("aral-test-huge", 20, 0, 8192, NULL, NULL, NULL, false, false),
+            .elements = elements,
+            .errors = 0,
+    };
+    aral_set_memory_policy(auc_huge.ar, ARAL_MEMORY_HUGE_PAGES | ARAL_MEMORY_NUMA_INTERLEAVE);
+
+    aral_test_thread(&auc_huge);
+
+    aral_destroy(auc_huge.ar);
+
     int errors = aral_stress_test(2, elements, 5);
 
-    return auc.errors + errors;
+    return auc.errors + auc_huge.errors + errors;
 }
@@ -29,6 +29,17 @@ struct aral_statistics {
 
 ARAL *aral_create(const char *name, size_t element_size, size_t initial_page_elements, size_t max_page_size,
                   struct aral_statistics *stats, const char *filename, char **cache_dir, bool mmap, bool lockless);
+
+// How the memory of ARAL pages is allocated (when mmap is not enabled).
+// It has to be set before the first allocation.
+typedef enum __attribute__ ((__packed__)) {
+    ARAL_MEMORY_DEFAULT         = 0,
+    ARAL_MEMORY_HUGE_PAGES      = (1 << 0), // back the pages with 2MB huge pages (hugetlbfs or transparent huge pages)
+    ARAL_MEMORY_NUMA_INTERLEAVE = (1 << 1), // spread the pages across all NUMA nodes
+} ARAL_MEMORY_POLICY;
+
+void aral_set_memory_policy(ARAL *ar, ARAL_MEMORY_POLICY policy);
+size_t aral_numa_nodes(void);
 size_t aral_element_size(ARAL *ar);
 size_t aral_overhead(ARAL *ar);
 size_t aral_structures(ARAL *ar);
@@ -1290,9 +1290,105 @@ int accept_socket(int fd, int flags, char *client_ip, size_t ipsize, char *clien
 // poll() based listener
 // this should be the fastest possible listener for up to 100 sockets
 // above 100, an epoll() interface is needed on Linux
+//
+// On Linux, the sockets are added to an epoll() set, so that each wakeup costs
+// only the sockets that are ready. epoll() is level triggered, like poll(), since
+// the callbacks expect to be called again for whatever they have not read yet
+// (and the listener accepts one connection per wakeup). The events the callbacks
+// ask for are kept in the pollfd array, as with poll(), and are synced to the
+// epoll() set after every callback. The listening sockets are added to the set of
+// every thread with EPOLLEXCLUSIVE, so that a new connection wakes up only one
+// of the threads listening on them.
 
 #define POLL_FDS_INCREASE_STEP 10
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define POLL_EVENTS_EPOLL 1
+
+#ifndef EPOLLEXCLUSIVE
+#define EPOLLEXCLUSIVE 0
+#endif
+
+// on Linux, the EPOLL* event bits are the same with the POLL* ones
+#define poll_to_epoll_events(events) ((uint32_t)(unsigned short)(events) & (EPOLLIN | EPOLLPRI | EPOLLOUT))
+#define epoll_to_poll_events(events) ((short int)((events) & (EPOLLIN | EPOLLPRI | EPOLLOUT | EPOLLERR | EPOLLHUP)))
+
+static void poll_fd_sync_events(POLLJOB *p, POLLINFO *pi) {
+    if(p->epoll_fd == -1 || pi->fd == -1 || (pi->flags & POLLINFO_FLAG_NOT_POLLABLE))
+        return;
+
+    short int events = p->fds[pi->slot].events;
+    if(pi->epoll_registered && events == pi->epoll_events)
+        return;
+
+    struct epoll_event ev = {
+            .events = poll_to_epoll_events(events),
+            .data.u64 = pi->slot,
+    };
+
+    if(pi->flags & POLLINFO_FLAG_SERVER_SOCKET) {
+        // EPOLLEXCLUSIVE cannot be modified, so the listening sockets are removed and added back
+        if(pi->epoll_registered) {
+            if(epoll_ctl(p->epoll_fd, EPOLL_CTL_DEL, pi->fd, NULL) == -1)
+                error("POLLFD: cannot remove listening socket %d from epoll()", pi->fd);
+
+            pi->epoll_registered = false;
+        }
+
+        if(events) {
+            ev.events |= EPOLLEXCLUSIVE;
+            if(epoll_ctl(p->epoll_fd, EPOLL_CTL_ADD, pi->fd, &ev) == -1)
+                error("POLLFD: cannot add listening socket %d to epoll()", pi->fd);
+            else
+                pi->epoll_registered = true;
+        }
+    }
+    else if(pi->epoll_registered) {
+        if(epoll_ctl(p->epoll_fd, EPOLL_CTL_MOD, pi->fd, &ev) == -1)
+            error("POLLFD: cannot modify the events of socket %d in epoll()", pi->fd);
+    }
+    else {
+        if(epoll_ctl(p->epoll_fd, EPOLL_CTL_ADD, pi->fd, &ev) == 0)
+            pi->epoll_registered = true;
+
+        else if(errno == EPERM) {
+            // regular files cannot be polled, but they are always ready
+            pi->flags |= POLLINFO_FLAG_NOT_POLLABLE;
+            p->not_pollable++;
+        }
+        else
+            error("POLLFD: cannot add socket %d to epoll()", pi->fd);
+    }
+
+    pi->epoll_events = events;
+}
+
+static void poll_fd_unregister(POLLJOB *p, POLLINFO *pi) {
+    if(pi->flags & POLLINFO_FLAG_NOT_POLLABLE)
+        p->not_pollable--;
+
+    else if(pi->epoll_registered && epoll_ctl(p->epoll_fd, EPOLL_CTL_DEL, pi->fd, NULL) == -1)
+        error("POLLFD: cannot remove socket %d from epoll()", pi->fd);
+
+    pi->epoll_registered = false;
+    pi->epoll_events = 0;
+}
+
+#else // !__linux__
+
+#define poll_fd_sync_events(p, pi) do { (void)(p); (void)(pi); } while(0)
+#define poll_fd_unregister(p, pi) do { (void)(p); (void)(pi); } while(0)
+
+#endif // __linux__
+
+void poll_fd_add_events(POLLINFO *pi, short int events) {
+    POLLJOB *p = pi->p;
+
+    p->fds[pi->slot].events |= events;
+    poll_fd_sync_events(p, pi);
+}
+
 inline POLLINFO *poll_add_fd(POLLJOB *p
                              , int fd
                              , int socktype
@@ -1324,6 +1420,11 @@ inline POLLINFO *poll_add_fd(POLLJOB *p
         p->fds = reallocz(p->fds, sizeof(struct pollfd) * new_slots);
         p->inf = reallocz(p->inf, sizeof(POLLINFO) * new_slots);
 
+#ifdef POLL_EVENTS_EPOLL
+        if(p->epoll_fd != -1)
+            p->epoll_ready = reallocz(p->epoll_ready, sizeof(struct epoll_event) * new_slots);
+#endif
+
         // reset all the newly added slots
         ssize_t i;
         for(i = new_slots - 1; i >= (ssize_t)p->slots ; i--) {
@@ -1337,6 +1438,8 @@ inline POLLINFO *poll_add_fd(POLLJOB *p
             p->inf[i].flags = 0;
             p->inf[i].socktype = -1;
             p->inf[i].port_acl = -1;
+            p->inf[i].epoll_events = 0;
+            p->inf[i].epoll_registered = false;
 
             p->inf[i].client_ip = NULL;
             p->inf[i].client_port = NULL;
@@ -1398,6 +1501,8 @@ inline POLLINFO *poll_add_fd(POLLJOB *p
     if(pi->flags & POLLINFO_FLAG_SERVER_SOCKET) {
         p->min = pi->slot;
     }
+
+    poll_fd_sync_events(p, pi);
     netdata_thread_enable_cancelability();
 
     debug(D_POLLFD, "POLLFD: ADD: completed, slots = %zu, used = %zu, min = %zu, max = %zu, next free = %zd", p->slots, p->used, p->min, p->max, p->first_free?(ssize_t)p->first_free->slot:(ssize_t)-1);
@@ -1415,6 +1520,8 @@ inline void poll_close_fd(POLLINFO *pi) {
 
     netdata_thread_disable_cancelability();
 
+    poll_fd_unregister(p, pi);
+
     if(pi->flags & POLLINFO_FLAG_CLIENT_SOCKET) {
         pi->del_callback(pi);
 
@@ -1525,6 +1632,73 @@ static void poll_events_cleanup(void *data) {
 
     freez(p->fds);
     freez(p->inf);
+
+#ifdef POLL_EVENTS_EPOLL
+    if(p->epoll_fd != -1)
+        close(p->epoll_fd);
+
+    freez(p->epoll_ready);
+#endif
+}
+
+// waits for events on the sockets of the POLLJOB
+// returns the slots with events in ready[], their number, or -1 on error
+static int poll_events_wait(POLLJOB *p, int timeout_ms, size_t *ready) {
+    size_t i;
+    int retval;
+
+#ifdef POLL_EVENTS_EPOLL
+    if(likely(p->epoll_fd != -1)) {
+        // the files are always ready for reading, so we should not wait when they are waiting to be read
+        if(unlikely(p->not_pollable)) {
+            for(i = 0; i <= p->max ; i++) {
+                if((p->inf[i].flags & POLLINFO_FLAG_NOT_POLLABLE) && p->fds[i].events) {
+                    timeout_ms = 0;
+                    break;
+                }
+            }
+        }
+
+        debug(D_POLLFD, "POLLFD: LISTENER: Waiting on %zu sockets with epoll() for %zu ms...", p->used, (size_t)timeout_ms);
+        retval = epoll_wait(p->epoll_fd, p->epoll_ready, (int)p->slots, timeout_ms);
+        if(unlikely(retval == -1))
+            return (errno == EINTR) ? 0 : -1;
+
+        int ready_max = 0;
+        for(int e = 0; e < retval ; e++) {
+            i = (size_t)p->epoll_ready[e].data.u64;
+            if(unlikely(i > p->max || p->fds[i].fd == -1))
+                continue;
+
+            p->fds[i].revents = epoll_to_poll_events(p->epoll_ready[e].events);
+            ready[ready_max++] = i;
+        }
+
+        if(unlikely(p->not_pollable)) {
+            for(i = 0; i <= p->max ; i++) {
+                if((p->inf[i].flags & POLLINFO_FLAG_NOT_POLLABLE) && p->fds[i].events) {
+                    p->fds[i].revents = (short int)(p->fds[i].events & (POLLIN | POLLOUT));
+                    ready[ready_max++] = i;
+                }
+            }
+        }
+
+        return ready_max;
+    }
+#endif
+
+    debug(D_POLLFD, "POLLFD: LISTENER: Waiting on %zu sockets for %zu ms...", p->max + 1, (size_t)timeout_ms);
+    retval = poll(p->fds, p->max + 1, timeout_ms);
+    if(unlikely(retval <= 0))
+        return retval;
+
+    int ready_max = 0;
+    for(i = 0; i <= p->max ; i++) {
+        if(p->fds[i].revents)
+            ready[ready_max++] = i;
+    }
+
+    return ready_max;
 }
 
 static int poll_process_error(POLLINFO *pi, struct pollfd *pf, short int revents) {
@@ -1559,6 +1733,8 @@ static inline int poll_process_send(POLLJOB *p, POLLINFO *pi, struct pollfd *pf,
 
     if (unlikely(pi->snd_callback(pi, &pf->events) == -1))
         poll_close_fd(&p->inf[slot]);
+    else
+        poll_fd_sync_events(p, &p->inf[slot]);
 
     // IMPORTANT:
     // pf and pi may be invalid below this point, they may have been reallocated.
@@ -1580,6 +1756,8 @@ static inline int poll_process_tcp_read(POLLJOB *p, POLLINFO *pi, struct pollfd
 
     if (pi->rcv_callback(pi, &pf->events) == -1)
         poll_close_fd(&p->inf[slot]);
+    else
+        poll_fd_sync_events(p, &p->inf[slot]);
 
     // IMPORTANT:
     // pf and pi may be invalid below this point, they may have been reallocated.
@@ -1587,7 +1765,7 @@ static inline int poll_process_tcp_read(POLLJOB *p, POLLINFO *pi, struct pollfd
     return 1;
 }
 
-static inline int poll_process_udp_read(POLLINFO *pi, struct pollfd *pf, time_t now __maybe_unused) {
+static inline int poll_process_udp_read(POLLJOB *p, POLLINFO *pi, struct pollfd *pf, time_t now __maybe_unused) {
     pi->last_received_t = now;
     pi->recv_count++;
 
@@ -1598,9 +1776,13 @@ static inline int poll_process_udp_read(POLLINFO *pi, struct pollfd *pf, time_t
     // performance, especially for statsd.
 
     pf->events = 0;
+
+    size_t slot = pi->slot;
     if(pi->rcv_callback(pi, &pf->events) == -1)
         return 0;
 
+    poll_fd_sync_events(p, &p->inf[slot]);
+
     // IMPORTANT:
     // pf and pi may be invalid below this point, they may have been reallocated.
 
@@ -1699,6 +1881,9 @@ void poll_events(LISTEN_SOCKETS *sockets
             .fds = NULL,
             .inf = NULL,
             .first_free = NULL,
+            .epoll_fd = -1,
+            .epoll_ready = NULL,
+            .not_pollable = 0,
 
             .complete_request_timeout = tcp_request_timeout_seconds,
             .idle_timeout = tcp_idle_timeout_seconds,
@@ -1717,6 +1902,12 @@ void poll_events(LISTEN_SOCKETS *sockets
             .tmr_callback = tmr_callback?tmr_callback:poll_default_tmr_callback
     };
 
+#ifdef POLL_EVENTS_EPOLL
+    p.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(p.epoll_fd == -1)
+        error("POLLFD: LISTENER: cannot create an epoll() instance, falling back to poll()");
+#endif
+
     size_t i;
     for(i = 0; i < sockets->opened ;i++) {
 
@@ -1781,16 +1972,17 @@ void poll_events(LISTEN_SOCKETS *sockets
             for (i = 0; i <= p.max; i++) {
                 if(p.inf[i].flags & POLLINFO_FLAG_SERVER_SOCKET && p.inf[i].socktype == SOCK_STREAM) {
                     p.fds[i].events = (short int) ((listen_sockets_active) ? POLLIN : 0);
+                    poll_fd_sync_events(&p, &p.inf[i]);
                 }
             }
         }
 
-        debug(D_POLLFD, "POLLFD: LISTENER: Waiting on %zu sockets for %zu ms...", p.max + 1, (size_t)timeout_ms);
-        retval = poll(p.fds, p.max + 1, timeout_ms);
+        size_t ready[p.max + 1];
+        retval = poll_events_wait(&p, timeout_ms, ready);
         time_t now = now_boottime_sec();
 
         if(unlikely(retval == -1)) {
-            error("POLLFD: LISTENER: poll() failed while waiting on %zu sockets.", p.max + 1);
+            error("POLLFD: LISTENER: %s() failed while waiting on %zu sockets.", (p.epoll_fd != -1) ? "epoll_wait" : "poll", p.max + 1);
             break;
         }
         else if(unlikely(!retval)) {
@@ -1799,17 +1991,18 @@ void poll_events(LISTEN_SOCKETS *sockets
         else {
             POLLINFO *pi;
             struct pollfd *pf;
-            size_t idx, processed = 0;
+            size_t idx, processed = 0, ready_max = (size_t)retval;
             short int revents;
 
             // keep fast lookup arrays per function
             // to avoid looping through the entire list every time
-            size_t sends[p.max + 1], sends_max = 0;
-            size_t reads[p.max + 1], reads_max = 0;
-            size_t conns[p.max + 1], conns_max = 0;
-            size_t udprd[p.max + 1], udprd_max = 0;
+            size_t sends[ready_max], sends_max = 0;
+            size_t reads[ready_max], reads_max = 0;
+            size_t conns[ready_max], conns_max = 0;
+            size_t udprd[ready_max], udprd_max = 0;
 
-            for (i = 0; i <= p.max; i++) {
+            for (idx = 0; idx < ready_max; idx++) {
+                i = ready[idx];
                 pi = &p.inf[i];
                 pf = &p.fds[i];
                 revents = pf->revents;
@@ -1890,7 +2083,7 @@ void poll_events(LISTEN_SOCKETS *sockets
                 pi = &p.inf[i];
                 pf = &p.fds[i];
                 pf->revents = 0;
-                processed += poll_process_udp_read(pi, pf, now);
+                processed += poll_process_udp_read(&p, pi, pf, now);
             }
 
             // process TCP reads
@@ -1923,7 +2116,7 @@ void poll_events(LISTEN_SOCKETS *sockets
             for(i = 0; i <= p.max; i++) {
                 POLLINFO *pi = &p.inf[i];
 
-                if(likely(pi->flags & POLLINFO_FLAG_CLIENT_SOCKET)) {
+                if(likely((pi->flags & (POLLINFO_FLAG_CLIENT_SOCKET | POLLINFO_FLAG_NO_TIMEOUT)) == POLLINFO_FLAG_CLIENT_SOCKET)) {
                     if (unlikely(pi->send_count == 0 && p.complete_request_timeout > 0 && (now - pi->connected_t) >= p.complete_request_timeout)) {
                         info("POLLFD: LISTENER: client slot %zu (fd %d) from %s port %s has not sent a complete request in %zu seconds - closing it. "
                               , i
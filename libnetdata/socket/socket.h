@@ -105,10 +105,13 @@ int accept4(int sock, struct sockaddr *addr, socklen_t *addrlen, int flags);
 
 // ----------------------------------------------------------------------------
 // poll() based listener
+// on Linux, epoll() is used instead of poll(), with the same callbacks
 
 #define POLLINFO_FLAG_SERVER_SOCKET 0x00000001
 #define POLLINFO_FLAG_CLIENT_SOCKET 0x00000002
 #define POLLINFO_FLAG_DONT_CLOSE    0x00000004
+#define POLLINFO_FLAG_NOT_POLLABLE  0x00000008 // epoll() does not support this fd (a file) - it is always ready
+#define POLLINFO_FLAG_NO_TIMEOUT    0x00000010 // the socket is not closed when it is idle
 
 typedef struct poll POLLJOB;
 
@@ -132,6 +135,9 @@ typedef struct pollinfo {
 
     uint32_t flags;         // internal flags
 
+    short int epoll_events; // the events registered to epoll() for this socket
+    bool epoll_registered;  // the socket is in the epoll() set
+
     // callbacks for this socket
     void  (*del_callback)(struct pollinfo *pi);
     int   (*rcv_callback)(struct pollinfo *pi, short int *events);
@@ -166,6 +172,10 @@ struct poll {
     struct pollinfo *inf;
     struct pollinfo *first_free;
 
+    int epoll_fd;                       // -1 when poll() is used
+    struct epoll_event *epoll_ready;    // the events returned by epoll_wait(), one per slot
+    size_t not_pollable;                // the number of fds that cannot be added to epoll()
+
     SIMPLE_PATTERN *access_list;
     int allow_dns;
 
@@ -199,6 +209,9 @@ POLLINFO *poll_add_fd(POLLJOB *p
 );
 void poll_close_fd(POLLINFO *pi);
 
+// adds events to wait for on a socket, other than the one a callback is called for
+void poll_fd_add_events(POLLINFO *pi, short int events);
+
 void poll_events(LISTEN_SOCKETS *sockets
         , void *(*add_callback)(POLLINFO *pi, short int *events, void *data)
         , void  (*del_callback)(POLLINFO *pi)
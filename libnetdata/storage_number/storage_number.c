@@ -173,6 +173,456 @@ __attribute__((constructor)) void initialize_lut(void) {
         unpack_storage_number_lut10x[2 * 8 + i] = 1 / pow(100, i);   // exp = 0
         unpack_storage_number_lut10x[3 * 8 + i] = pow(100, i);       // exp = 1
     }
+
+    // pick the fastest bulk packing and unpacking this cpu supports
+    storage_number_array_set_implementation("auto");
+}
+
+// ----------------------------------------------------------------------------
+// bulk packing and unpacking of arrays of storage numbers
+//
+// All implementations give bit-identical results to pack_storage_number()
+// and unpack_storage_number(). The SIMD ones do the same floating point
+// operations, in the same order, for many values at once. Values that need
+// special treatment (NaN, infinite, zero, subnormal, too big) make the
+// whole vector fall back to pack_storage_number().
+
+#define SN_ARRAY_FRACTION_MASK 0x00FFFFFF
+
+static inline size_t storage_number_lut_index(storage_number value) {
+    // the lookup table index is (factor * 16) + (exp * 8) + mul:
+    // bit 27 (factor) goes to bit 5, bits 31 to 28 (exp and mul) go to bits 4 to 1
+    return ((value >> 22) & 0x10) | ((value >> 27) & 0x0F);
+}
+
+static void unpack_storage_number_array_scalar(NETDATA_DOUBLE *dst, const storage_number *src, size_t entries) {
+    for(size_t i = 0; i < entries ;i++) {
+        storage_number value = src[i];
+
+        NETDATA_DOUBLE n = unpack_storage_number_lut10x[storage_number_lut_index(value)] * (NETDATA_DOUBLE)(value & SN_ARRAY_FRACTION_MASK);
+        n = (value & SN_FLAG_NEGATIVE) ? -n : n;
+
+        dst[i] = (value == SN_EMPTY_SLOT) ? NAN : n;
+    }
+}
+
+static void pack_storage_number_array_scalar(storage_number *dst, const NETDATA_DOUBLE *src, size_t entries, SN_FLAGS flags) {
+    for(size_t i = 0; i < entries ;i++)
+        dst[i] = pack_storage_number(src[i], flags);
+}
+
+#if !defined(NETDATA_WITH_LONG_DOUBLE) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SN_ARRAY_HAVE_X86 1
+#include <immintrin.h>
+
+// AVX2 - 4 values per iteration
+
+__attribute__((target("avx2")))
+static inline __m128i sn_avx2_mask_to_epi32(__m256d mask) {
+    // keep the low 32 bits of each 64-bit lane
+    return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(mask), _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+}
+
+__attribute__((target("avx2")))
+static void unpack_storage_number_array_avx2(NETDATA_DOUBLE *dst, const storage_number *src, size_t entries) {
+    const __m128i fraction_mask = _mm_set1_epi32(SN_ARRAY_FRACTION_MASK);
+    const __m128i factor_mask = _mm_set1_epi32(0x10);
+    const __m128i exp_mul_mask = _mm_set1_epi32(0x0F);
+    const __m128i empty_slot = _mm_set1_epi32((int)SN_EMPTY_SLOT);
+    const __m256i sign_mask = _mm256_set1_epi64x((long long)SN_FLAG_NEGATIVE);
+    const __m256d nan = _mm256_set1_pd(NAN);
+
+    size_t i = 0;
+    for(; i + 4 <= entries ; i += 4) {
+        __m128i value = _mm_loadu_si128((const __m128i *)&src[i]);
+
+        __m128i index = _mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(value, 22), factor_mask),
+                _mm_and_si128(_mm_srli_epi32(value, 27), exp_mul_mask));
+
+        __m256d lut = _mm256_i32gather_pd(unpack_storage_number_lut10x, index, sizeof(NETDATA_DOUBLE));
+        __m256d n = _mm256_mul_pd(lut, _mm256_cvtepi32_pd(_mm_and_si128(value, fraction_mask)));
+
+        // move the sign bit of the storage number to the sign bit of the double
+        __m256i sign = _mm256_slli_epi64(_mm256_and_si256(_mm256_cvtepu32_epi64(value), sign_mask), 32);
+        n = _mm256_xor_pd(n, _mm256_castsi256_pd(sign));
+
+        __m256d empty = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm_cmpeq_epi32(value, empty_slot)));
+        _mm256_storeu_pd(&dst[i], _mm256_blendv_pd(n, nan, empty));
+    }
+
+    unpack_storage_number_array_scalar(&dst[i], &src[i], entries - i);
+}
+
+__attribute__((target("avx2")))
+static void pack_storage_number_array_avx2(storage_number *dst, const NETDATA_DOUBLE *src, size_t entries, SN_FLAGS flags) {
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    const __m256d normal_min = _mm256_set1_pd(DBL_MIN);
+    const __m256d infinity = _mm256_set1_pd(INFINITY);
+    const __m256d fraction_max = _mm256_set1_pd((NETDATA_DOUBLE)0x00ffffff);
+    const __m256d multiply_max = _mm256_set1_pd((NETDATA_DOUBLE)0x0019999e);
+    const __m256d mul100_threshold = _mm256_set1_pd(10000000.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d ten = _mm256_set1_pd(10.0);
+    const __m256d hundred = _mm256_set1_pd(100.0);
+    const __m128i base = _mm_set1_epi32((int)(flags & SN_USER_FLAGS));
+
+    size_t i = 0;
+    for(; i + 4 <= entries ; i += 4) {
+        __m256d value = _mm256_loadu_pd(&src[i]);
+        __m256d n = _mm256_and_pd(value, abs_mask);
+
+        __m256d normal = _mm256_and_pd(_mm256_cmp_pd(n, normal_min, _CMP_GE_OQ), _mm256_cmp_pd(n, infinity, _CMP_LT_OQ));
+        if(unlikely(_mm256_movemask_pd(normal) != 0x0F)) {
+            pack_storage_number_array_scalar(&dst[i], &src[i], 4, flags);
+            continue;
+        }
+
+        __m256d negative = _mm256_cmp_pd(value, zero, _CMP_LT_OQ);
+        __m256d mul100 = _mm256_cmp_pd(_mm256_div_pd(n, mul100_threshold), fraction_max, _CMP_GT_OQ);
+        __m256d factor = _mm256_blendv_pd(ten, hundred, mul100);
+        __m256d m = zero;
+
+        for(int k = 0; k < 7 ;k++) {
+            __m256d divide = _mm256_cmp_pd(n, fraction_max, _CMP_GT_OQ);
+            if(!_mm256_movemask_pd(divide)) break;
+
+            n = _mm256_blendv_pd(n, _mm256_div_pd(n, factor), divide);
+            m = _mm256_add_pd(m, _mm256_and_pd(divide, one));
+        }
+
+        __m256d divided = _mm256_cmp_pd(m, zero, _CMP_GT_OQ);
+        if(unlikely(_mm256_movemask_pd(_mm256_and_pd(divided, _mm256_cmp_pd(n, fraction_max, _CMP_GT_OQ))))) {
+            // too big values
+            pack_storage_number_array_scalar(&dst[i], &src[i], 4, flags);
+            continue;
+        }
+
+        __m256d multiplied = _mm256_andnot_pd(divided, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)));
+        for(int k = 0; k < 7 ;k++) {
+            __m256d multiply = _mm256_and_pd(multiplied, _mm256_cmp_pd(n, multiply_max, _CMP_LT_OQ));
+            if(!_mm256_movemask_pd(multiply)) break;
+
+            n = _mm256_blendv_pd(n, _mm256_mul_pd(n, ten), multiply);
+            m = _mm256_add_pd(m, _mm256_and_pd(multiply, one));
+        }
+
+        __m256d overflow = _mm256_and_pd(multiplied, _mm256_cmp_pd(n, fraction_max, _CMP_GT_OQ));
+        n = _mm256_blendv_pd(n, _mm256_div_pd(n, ten), overflow);
+        m = _mm256_sub_pd(m, _mm256_and_pd(overflow, one));
+
+        __m128i r = base;
+        r = _mm_or_si128(r, _mm_and_si128(sn_avx2_mask_to_epi32(negative), _mm_set1_epi32((int)SN_FLAG_NEGATIVE)));
+        r = _mm_or_si128(r, _mm_and_si128(sn_avx2_mask_to_epi32(mul100), _mm_set1_epi32((int)SN_FLAG_NOT_EXISTS_MUL100)));
+        r = _mm_or_si128(r, _mm_and_si128(sn_avx2_mask_to_epi32(divided), _mm_set1_epi32((int)SN_FLAG_MULTIPLY)));
+        r = _mm_add_epi32(r, _mm_slli_epi32(_mm256_cvttpd_epi32(m), 27));
+#ifdef STORAGE_WITH_MATH
+        r = _mm_add_epi32(r, _mm256_cvtpd_epi32(n));
+#else
+        r = _mm_add_epi32(r, _mm256_cvttpd_epi32(n));
+#endif
+        _mm_storeu_si128((__m128i *)&dst[i], r);
+    }
+
+    pack_storage_number_array_scalar(&dst[i], &src[i], entries - i, flags);
+}
+
+// SSE4.1 - 2 values per iteration
+
+__attribute__((target("sse4.1")))
+static inline __m128i sn_sse4_mask_to_epi32(__m128d mask) {
+    // keep the low 32 bits of each 64-bit lane, in the low 64 bits
+    return _mm_shuffle_epi32(_mm_castpd_si128(mask), _MM_SHUFFLE(3, 3, 2, 0));
+}
+
+__attribute__((target("sse4.1")))
+static void unpack_storage_number_array_sse4(NETDATA_DOUBLE *dst, const storage_number *src, size_t entries) {
+    const __m128i fraction_mask = _mm_set1_epi32(SN_ARRAY_FRACTION_MASK);
+    const __m128i empty_slot = _mm_set1_epi32((int)SN_EMPTY_SLOT);
+    const __m128i sign_mask = _mm_set1_epi64x((long long)SN_FLAG_NEGATIVE);
+    const __m128d nan = _mm_set1_pd(NAN);
+
+    size_t i = 0;
+    for(; i + 2 <= entries ; i += 2) {
+        __m128i value = _mm_loadl_epi64((const __m128i *)&src[i]);
+
+        __m128d lut = _mm_setr_pd(unpack_storage_number_lut10x[storage_number_lut_index(src[i])],
+                                  unpack_storage_number_lut10x[storage_number_lut_index(src[i + 1])]);
+
+        __m128d n = _mm_mul_pd(lut, _mm_cvtepi32_pd(_mm_and_si128(value, fraction_mask)));
+
+        __m128i sign = _mm_slli_epi64(_mm_and_si128(_mm_cvtepu32_epi64(value), sign_mask), 32);
+        n = _mm_xor_pd(n, _mm_castsi128_pd(sign));
+
+        __m128d empty = _mm_castsi128_pd(_mm_cvtepi32_epi64(_mm_cmpeq_epi32(value, empty_slot)));
+        _mm_storeu_pd(&dst[i], _mm_blendv_pd(n, nan, empty));
+    }
+
+    unpack_storage_number_array_scalar(&dst[i], &src[i], entries - i);
+}
+
+__attribute__((target("sse4.1")))
+static void pack_storage_number_array_sse4(storage_number *dst, const NETDATA_DOUBLE *src, size_t entries, SN_FLAGS flags) {
+    const __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    const __m128d normal_min = _mm_set1_pd(DBL_MIN);
+    const __m128d infinity = _mm_set1_pd(INFINITY);
+    const __m128d fraction_max = _mm_set1_pd((NETDATA_DOUBLE)0x00ffffff);
+    const __m128d multiply_max = _mm_set1_pd((NETDATA_DOUBLE)0x0019999e);
+    const __m128d mul100_threshold = _mm_set1_pd(10000000.0);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d ten = _mm_set1_pd(10.0);
+    const __m128d hundred = _mm_set1_pd(100.0);
+    const __m128i base = _mm_set1_epi32((int)(flags & SN_USER_FLAGS));
+
+    size_t i = 0;
+    for(; i + 2 <= entries ; i += 2) {
+        __m128d value = _mm_loadu_pd(&src[i]);
+        __m128d n = _mm_and_pd(value, abs_mask);
+
+        __m128d normal = _mm_and_pd(_mm_cmpge_pd(n, normal_min), _mm_cmplt_pd(n, infinity));
+        if(unlikely(_mm_movemask_pd(normal) != 0x03)) {
+            pack_storage_number_array_scalar(&dst[i], &src[i], 2, flags);
+            continue;
+        }
+
+        __m128d negative = _mm_cmplt_pd(value, zero);
+        __m128d mul100 = _mm_cmpgt_pd(_mm_div_pd(n, mul100_threshold), fraction_max);
+        __m128d factor = _mm_blendv_pd(ten, hundred, mul100);
+        __m128d m = zero;
+
+        for(int k = 0; k < 7 ;k++) {
+            __m128d divide = _mm_cmpgt_pd(n, fraction_max);
+            if(!_mm_movemask_pd(divide)) break;
+
+            n = _mm_blendv_pd(n, _mm_div_pd(n, factor), divide);
+            m = _mm_add_pd(m, _mm_and_pd(divide, one));
+        }
+
+        __m128d divided = _mm_cmpgt_pd(m, zero);
+        if(unlikely(_mm_movemask_pd(_mm_and_pd(divided, _mm_cmpgt_pd(n, fraction_max))))) {
+            // too big values
+            pack_storage_number_array_scalar(&dst[i], &src[i], 2, flags);
+            continue;
+        }
+
+        __m128d multiplied = _mm_andnot_pd(divided, _mm_castsi128_pd(_mm_set1_epi64x(-1)));
+        for(int k = 0; k < 7 ;k++) {
+            __m128d multiply = _mm_and_pd(multiplied, _mm_cmplt_pd(n, multiply_max));
+            if(!_mm_movemask_pd(multiply)) break;
+
+            n = _mm_blendv_pd(n, _mm_mul_pd(n, ten), multiply);
+            m = _mm_add_pd(m, _mm_and_pd(multiply, one));
+        }
+
+        __m128d overflow = _mm_and_pd(multiplied, _mm_cmpgt_pd(n, fraction_max));
+        n = _mm_blendv_pd(n, _mm_div_pd(n, ten), overflow);
+        m = _mm_sub_pd(m, _mm_and_pd(overflow, one));
+
+        __m128i r = base;
+        r = _mm_or_si128(r, _mm_and_si128(sn_sse4_mask_to_epi32(negative), _mm_set1_epi32((int)SN_FLAG_NEGATIVE)));
+        r = _mm_or_si128(r, _mm_and_si128(sn_sse4_mask_to_epi32(mul100), _mm_set1_epi32((int)SN_FLAG_NOT_EXISTS_MUL100)));
+        r = _mm_or_si128(r, _mm_and_si128(sn_sse4_mask_to_epi32(divided), _mm_set1_epi32((int)SN_FLAG_MULTIPLY)));
+        r = _mm_add_epi32(r, _mm_slli_epi32(_mm_cvttpd_epi32(m), 27));
+#ifdef STORAGE_WITH_MATH
+        r = _mm_add_epi32(r, _mm_cvtpd_epi32(n));
+#else
+        r = _mm_add_epi32(r, _mm_cvttpd_epi32(n));
+#endif
+        _mm_storel_epi64((__m128i *)&dst[i], r);
+    }
+
+    pack_storage_number_array_scalar(&dst[i], &src[i], entries - i, flags);
+}
+
+#endif // x86_64
+
+#if !defined(NETDATA_WITH_LONG_DOUBLE) && defined(__aarch64__) && defined(__ARM_NEON)
+#define SN_ARRAY_HAVE_NEON 1
+#include <arm_neon.h>
+
+// NEON - 2 values per iteration
+
+static void unpack_storage_number_array_neon(NETDATA_DOUBLE *dst, const storage_number *src, size_t entries) {
+    const uint32x2_t fraction_mask = vdup_n_u32(SN_ARRAY_FRACTION_MASK);
+    const uint32x2_t empty_slot = vdup_n_u32(SN_EMPTY_SLOT);
+    const uint64x2_t sign_mask = vdupq_n_u64(SN_FLAG_NEGATIVE);
+    const float64x2_t nan = vdupq_n_f64(NAN);
+
+    size_t i = 0;
+    for(; i + 2 <= entries ; i += 2) {
+        uint32x2_t value = vld1_u32(&src[i]);
+
+        float64x2_t lut = vsetq_lane_f64(unpack_storage_number_lut10x[storage_number_lut_index(src[i + 1])],
+                                         vdupq_n_f64(unpack_storage_number_lut10x[storage_number_lut_index(src[i])]), 1);
+
+        float64x2_t n = vmulq_f64(lut, vcvtq_f64_u64(vmovl_u32(vand_u32(value, fraction_mask))));
+
+        uint64x2_t sign = vshlq_n_u64(vandq_u64(vmovl_u32(value), sign_mask), 32);
+        n = vreinterpretq_f64_u64(veorq_u64(vreinterpretq_u64_f64(n), sign));
+
+        uint64x2_t empty = vreinterpretq_u64_s64(vmovl_s32(vreinterpret_s32_u32(vceq_u32(value, empty_slot))));
+        vst1q_f64(&dst[i], vbslq_f64(empty, nan, n));
+    }
+
+    unpack_storage_number_array_scalar(&dst[i], &src[i], entries - i);
+}
+
+static void pack_storage_number_array_neon(storage_number *dst, const NETDATA_DOUBLE *src, size_t entries, SN_FLAGS flags) {
+    const float64x2_t normal_min = vdupq_n_f64(DBL_MIN);
+    const float64x2_t infinity = vdupq_n_f64(INFINITY);
+    const float64x2_t fraction_max = vdupq_n_f64((NETDATA_DOUBLE)0x00ffffff);
+    const float64x2_t multiply_max = vdupq_n_f64((NETDATA_DOUBLE)0x0019999e);
+    const float64x2_t mul100_threshold = vdupq_n_f64(10000000.0);
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    const float64x2_t ten = vdupq_n_f64(10.0);
+    const float64x2_t hundred = vdupq_n_f64(100.0);
+    const uint64x2_t one = vdupq_n_u64(1);
+    const uint32x2_t base = vdup_n_u32(flags & SN_USER_FLAGS);
+
+    size_t i = 0;
+    for(; i + 2 <= entries ; i += 2) {
+        float64x2_t value = vld1q_f64(&src[i]);
+        float64x2_t n = vabsq_f64(value);
+
+        uint64x2_t normal = vandq_u64(vcgeq_f64(n, normal_min), vcltq_f64(n, infinity));
+        if(unlikely(vminvq_u32(vreinterpretq_u32_u64(normal)) == 0)) {
+            pack_storage_number_array_scalar(&dst[i], &src[i], 2, flags);
+            continue;
+        }
+
+        uint64x2_t negative = vcltq_f64(value, zero);
+        uint64x2_t mul100 = vcgtq_f64(vdivq_f64(n, mul100_threshold), fraction_max);
+        float64x2_t factor = vbslq_f64(mul100, hundred, ten);
+        uint64x2_t m = vdupq_n_u64(0);
+
+        for(int k = 0; k < 7 ;k++) {
+            uint64x2_t divide = vcgtq_f64(n, fraction_max);
+            if(!vmaxvq_u32(vreinterpretq_u32_u64(divide))) break;
+
+            n = vbslq_f64(divide, vdivq_f64(n, factor), n);
+            m = vaddq_u64(m, vandq_u64(divide, one));
+        }
+
+        uint64x2_t divided = vtstq_u64(m, m);
+        if(unlikely(vmaxvq_u32(vreinterpretq_u32_u64(vandq_u64(divided, vcgtq_f64(n, fraction_max)))))) {
+            // too big values
+            pack_storage_number_array_scalar(&dst[i], &src[i], 2, flags);
+            continue;
+        }
+
+        uint64x2_t multiplied = vreinterpretq_u64_u32(vmvnq_u32(vreinterpretq_u32_u64(divided)));
+        for(int k = 0; k < 7 ;k++) {
+            uint64x2_t multiply = vandq_u64(multiplied, vcltq_f64(n, multiply_max));
+            if(!vmaxvq_u32(vreinterpretq_u32_u64(multiply))) break;
+
+            n = vbslq_f64(multiply, vmulq_f64(n, ten), n);
+            m = vaddq_u64(m, vandq_u64(multiply, one));
+        }
+
+        uint64x2_t overflow = vandq_u64(multiplied, vcgtq_f64(n, fraction_max));
+        n = vbslq_f64(overflow, vdivq_f64(n, ten), n);
+        m = vsubq_u64(m, vandq_u64(overflow, one));
+
+        uint32x2_t r = base;
+        r = vorr_u32(r, vand_u32(vmovn_u64(negative), vdup_n_u32(SN_FLAG_NEGATIVE)));
+        r = vorr_u32(r, vand_u32(vmovn_u64(mul100), vdup_n_u32(SN_FLAG_NOT_EXISTS_MUL100)));
+        r = vorr_u32(r, vand_u32(vmovn_u64(divided), vdup_n_u32(SN_FLAG_MULTIPLY)));
+        r = vadd_u32(r, vshl_n_u32(vmovn_u64(m), 27));
+#ifdef STORAGE_WITH_MATH
+        r = vadd_u32(r, vmovn_u64(vreinterpretq_u64_s64(vcvtnq_s64_f64(n))));
+#else
+        r = vadd_u32(r, vmovn_u64(vreinterpretq_u64_s64(vcvtq_s64_f64(n))));
+#endif
+        vst1_u32(&dst[i], r);
+    }
+
+    pack_storage_number_array_scalar(&dst[i], &src[i], entries - i, flags);
+}
+
+#endif // aarch64
+
+static struct {
+    const char *name;
+    void (*unpack)(NETDATA_DOUBLE *dst, const storage_number *src, size_t entries);
+    void (*pack)(storage_number *dst, const NETDATA_DOUBLE *src, size_t entries, SN_FLAGS flags);
+} storage_number_array_ops = {
+    .name = "scalar",
+    .unpack = unpack_storage_number_array_scalar,
+    .pack = pack_storage_number_array_scalar,
+};
+
+bool storage_number_array_set_implementation(const char *name) {
+    if(!name || strcmp(name, "auto") == 0) {
+#if defined(SN_ARRAY_HAVE_NEON)
+        name = "neon";
+#elif defined(SN_ARRAY_HAVE_X86)
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2"))
+            name = "avx2";
+        else if(__builtin_cpu_supports("sse4.1"))
+            name = "sse4.1";
+        else
+            name = "scalar";
+#else
+        name = "scalar";
+#endif
+    }
+
+    if(strcmp(name, "scalar") == 0) {
+        storage_number_array_ops.name = "scalar";
+        storage_number_array_ops.unpack = unpack_storage_number_array_scalar;
+        storage_number_array_ops.pack = pack_storage_number_array_scalar;
+        return true;
+    }
+
+#if defined(SN_ARRAY_HAVE_X86)
+    if(strcmp(name, "avx2") == 0) {
+        __builtin_cpu_init();
+        if(!__builtin_cpu_supports("avx2"))
+            return false;
+
+        storage_number_array_ops.name = "avx2";
+        storage_number_array_ops.unpack = unpack_storage_number_array_avx2;
+        storage_number_array_ops.pack = pack_storage_number_array_avx2;
+        return true;
+    }
+
+    if(strcmp(name, "sse4.1") == 0) {
+        __builtin_cpu_init();
+        if(!__builtin_cpu_supports("sse4.1"))
+            return false;
+
+        storage_number_array_ops.name = "sse4.1";
+        storage_number_array_ops.unpack = unpack_storage_number_array_sse4;
+        storage_number_array_ops.pack = pack_storage_number_array_sse4;
+        return true;
+    }
+#endif
+
+#if defined(SN_ARRAY_HAVE_NEON)
+    if(strcmp(name, "neon") == 0) {
+        storage_number_array_ops.name = "neon";
+        storage_number_array_ops.unpack = unpack_storage_number_array_neon;
+        storage_number_array_ops.pack = pack_storage_number_array_neon;
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+const char *storage_number_array_implementation(void) {
+    return storage_number_array_ops.name;
+}
+
+void unpack_storage_number_array(NETDATA_DOUBLE *dst, const storage_number *src, size_t entries) {
+    storage_number_array_ops.unpack(dst, src, entries);
+}
+
+void pack_storage_number_array(storage_number *dst, const NETDATA_DOUBLE *src, size_t entries, SN_FLAGS flags) {
+    storage_number_array_ops.pack(dst, src, entries, flags);
 }
 
 /*
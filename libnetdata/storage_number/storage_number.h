@@ -112,6 +112,15 @@ typedef enum {
 storage_number pack_storage_number(NETDATA_DOUBLE value, SN_FLAGS flags) __attribute__((const));
 static inline NETDATA_DOUBLE unpack_storage_number(storage_number value) __attribute__((const));
 
+// the same as calling pack_storage_number() / unpack_storage_number() for each of the values,
+// using the SIMD instructions of the cpu (AVX2, SSE4.1 or NEON) when available
+void pack_storage_number_array(storage_number *dst, const NETDATA_DOUBLE *src, size_t entries, SN_FLAGS flags);
+void unpack_storage_number_array(NETDATA_DOUBLE *dst, const storage_number *src, size_t entries);
+
+// "auto", "scalar", "sse4.1", "avx2" or "neon" - false when the cpu does not support it
+bool storage_number_array_set_implementation(const char *name);
+const char *storage_number_array_implementation(void);
+
 //                                                          sign       div/mul      <--- multiplier / divider --->     10/100       RESET      EXISTS     VALUE
 #define STORAGE_NUMBER_POSITIVE_MAX_RAW (storage_number)( (0 << 31) | (1 << 30) | (1 << 29) | (1 << 28) | (1 << 27) | (1 << 26) | (0 << 25) | (1 << 24) | 0x00ffffff )
 #define STORAGE_NUMBER_POSITIVE_MIN_RAW (storage_number)( (0 << 31) | (0 << 30) | (1 << 29) | (1 << 28) | (1 << 27) | (0 << 26) | (0 << 25) | (1 << 24) | 0x00000001 )
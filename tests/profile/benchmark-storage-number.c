@@ -0,0 +1,115 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * 1. build netdata (as normally)
+ * 2. cd tests/profile/
+ * 3. make benchmark-storage-number
+ * 4. ./benchmark-storage-number [values] [loops]
+ *
+ * Compares the single value pack_storage_number() / unpack_storage_number()
+ * with the bulk ones, for every implementation this cpu supports.
+ * The results of the bulk ones are also checked against the single value ones.
+ */
+
+#include "config.h"
+#include "libnetdata/libnetdata.h"
+
+void netdata_cleanup_and_exit(int ret) { exit(ret); }
+
+static NETDATA_DOUBLE random_value(size_t i) {
+    switch(i % 4) {
+        case 0:
+            // counters
+            return (NETDATA_DOUBLE)i;
+
+        case 1:
+            // percentages
+            return (NETDATA_DOUBLE)(random() % 10000) / 100.0;
+
+        case 2:
+            // big values, like bytes
+            return (NETDATA_DOUBLE)random() * 1024.0;
+
+        default:
+            // small, negative values
+            return -(NETDATA_DOUBLE)(random() % 1000) / 1000.0;
+    }
+}
+
+static void report(const char *name, const char *what, usec_t ut, size_t values) {
+    fprintf(stderr, "%-8s %-6s: %8.2f ms, %6.2f ns per value\n",
+            name, what, (double)ut / USEC_PER_MS, (double)ut * 1000.0 / (double)values);
+}
+
+int main(int argc, char **argv) {
+    size_t entries = (argc > 1) ? str2ul(argv[1]) : 1024 * 1024;
+    size_t loops = (argc > 2) ? str2ul(argv[2]) : 100;
+    if(!entries) entries = 1024 * 1024;
+    if(!loops) loops = 100;
+
+    NETDATA_DOUBLE *values = mallocz(entries * sizeof(NETDATA_DOUBLE));
+    NETDATA_DOUBLE *unpacked = mallocz(entries * sizeof(NETDATA_DOUBLE));
+    storage_number *expected = mallocz(entries * sizeof(storage_number));
+    storage_number *packed = mallocz(entries * sizeof(storage_number));
+    size_t total = entries * loops;
+    int errors = 0;
+
+    for(size_t i = 0; i < entries ;i++) {
+        values[i] = random_value(i);
+        expected[i] = pack_storage_number(values[i], SN_DEFAULT_FLAGS);
+    }
+
+    fprintf(stderr, "%zu values, %zu loops, the default implementation is '%s'\n\n",
+            entries, loops, storage_number_array_implementation());
+
+    // the single value functions
+    {
+        usec_t started_ut = now_monotonic_usec();
+        for(size_t l = 0; l < loops ;l++)
+            for(size_t i = 0; i < entries ;i++)
+                packed[i] = pack_storage_number(values[i], SN_DEFAULT_FLAGS);
+        report("single", "pack", now_monotonic_usec() - started_ut, total);
+
+        started_ut = now_monotonic_usec();
+        for(size_t l = 0; l < loops ;l++)
+            for(size_t i = 0; i < entries ;i++)
+                unpacked[i] = unpack_storage_number(expected[i]);
+        report("single", "unpack", now_monotonic_usec() - started_ut, total);
+    }
+
+    const char *implementations[] = { "scalar", "sse4.1", "avx2", "neon", NULL };
+    for(size_t impl = 0; implementations[impl] ;impl++) {
+        const char *name = implementations[impl];
+        if(!storage_number_array_set_implementation(name))
+            continue;
+
+        usec_t started_ut = now_monotonic_usec();
+        for(size_t l = 0; l < loops ;l++)
+            pack_storage_number_array(packed, values, entries, SN_DEFAULT_FLAGS);
+        report(name, "pack", now_monotonic_usec() - started_ut, total);
+
+        started_ut = now_monotonic_usec();
+        for(size_t l = 0; l < loops ;l++)
+            unpack_storage_number_array(unpacked, expected, entries);
+        report(name, "unpack", now_monotonic_usec() - started_ut, total);
+
+        for(size_t i = 0; i < entries ;i++) {
+            NETDATA_DOUBLE d = unpack_storage_number(expected[i]);
+
+            if(packed[i] != expected[i] || memcmp(&unpacked[i], &d, sizeof(d)) != 0) {
+                fprintf(stderr, "%s: value %zu (" NETDATA_DOUBLE_FORMAT ") does not match the single value functions\n",
+                        name, i, values[i]);
+                errors++;
+                break;
+            }
+        }
+    }
+
+    storage_number_array_set_implementation("auto");
+
+    freez(values);
+    freez(unpacked);
+    freez(expected);
+    freez(packed);
+
+    return errors ? 1 : 0;
+}
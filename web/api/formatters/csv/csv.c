@@ -8,11 +8,19 @@ void rrdr2csv(RRDR *r, BUFFER *wb, uint32_t format, RRDR_OPTIONS options, const
     long c, i;
     const long used = (long)r->d;
 
+    // the header is printed once, by the first slice of the result
+    bool header = !r->stream.slice;
+
     // print the csv header
     for(c = 0, i = 0; c < used ; c++) {
         if(!rrdr_dimension_should_be_exposed(r->od[c], options))
             continue;
 
+        if(!header) {
+            i++;
+            continue;
+        }
+
         if(!i) {
             buffer_strcat(wb, startline);
             if(options & RRDR_OPTION_LABEL_QUOTES) buffer_strcat(wb, "\"");
@@ -25,9 +33,11 @@ void rrdr2csv(RRDR *r, BUFFER *wb, uint32_t format, RRDR_OPTIONS options, const
         if(options & RRDR_OPTION_LABEL_QUOTES) buffer_strcat(wb, "\"");
         i++;
     }
-    buffer_strcat(wb, endline);
 
-    if(format == DATASOURCE_CSV_MARKDOWN) {
+    if(header)
+        buffer_strcat(wb, endline);
+
+    if(header && format == DATASOURCE_CSV_MARKDOWN) {
         // print the --- line after header
         for(c = 0, i = 0; c < used ;c++) {
             if(!rrdr_dimension_should_be_exposed(r->od[c], options))
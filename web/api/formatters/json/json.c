@@ -47,10 +47,12 @@ void rrdr2json(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, int datatable) {
         snprintfz(overflow_annotation, 200, ",{%sv%s:%sRESET OR OVERFLOW%s},{%sv%s:%sThe counters have been wrapped.%s}", kq, kq, sq, sq, kq, kq, sq, sq);
         snprintfz(normal_annotation,   200, ",{%sv%s:null},{%sv%s:null}", kq, kq, kq, kq);
 
-        buffer_sprintf(wb, "{\n %scols%s:\n [\n", kq, kq);
-        buffer_sprintf(wb, "        {%sid%s:%s%s,%slabel%s:%stime%s,%spattern%s:%s%s,%stype%s:%sdatetime%s},\n", kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq);
-        buffer_sprintf(wb, "        {%sid%s:%s%s,%slabel%s:%s%s,%spattern%s:%s%s,%stype%s:%sstring%s,%sp%s:{%srole%s:%sannotation%s}},\n", kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, kq, kq, sq, sq);
-        buffer_sprintf(wb, "        {%sid%s:%s%s,%slabel%s:%s%s,%spattern%s:%s%s,%stype%s:%sstring%s,%sp%s:{%srole%s:%sannotationText%s}}", kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, kq, kq, sq, sq);
+        if(!r->stream.slice) {
+            buffer_sprintf(wb, "{\n %scols%s:\n [\n", kq, kq);
+            buffer_sprintf(wb, "        {%sid%s:%s%s,%slabel%s:%stime%s,%spattern%s:%s%s,%stype%s:%sdatetime%s},\n", kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq);
+            buffer_sprintf(wb, "        {%sid%s:%s%s,%slabel%s:%s%s,%spattern%s:%s%s,%stype%s:%sstring%s,%sp%s:{%srole%s:%sannotation%s}},\n", kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, kq, kq, sq, sq);
+            buffer_sprintf(wb, "        {%sid%s:%s%s,%slabel%s:%s%s,%spattern%s:%s%s,%stype%s:%sstring%s,%sp%s:{%srole%s:%sannotationText%s}}", kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, sq, sq, kq, kq, kq, kq, sq, sq);
+        }
 
         // remove the valueobjects flag
         // google wants its own keys
@@ -82,8 +84,10 @@ void rrdr2json(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, int datatable) {
         snprintfz(data_begin, 100, "],\n        %sdata%s:[\n", kq, kq);
         strcpy(finish,             "\n        ]\n    }");
 
-        buffer_sprintf(wb, "{\n        %slabels%s:[", kq, kq);
-        buffer_sprintf(wb, "%stime%s", sq, sq);
+        if(!r->stream.slice) {
+            buffer_sprintf(wb, "{\n        %slabels%s:[", kq, kq);
+            buffer_sprintf(wb, "%stime%s", sq, sq);
+        }
 
         if( options & RRDR_OPTION_OBJECTSROWS )
             snprintfz(object_rows_time, 100, "%stime%s: ", kq, kq);
@@ -107,18 +111,23 @@ void rrdr2json(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, int datatable) {
     long c, i;
     const long used = (long)r->d;
 
+    // the header is printed once, by the first slice of the result
+    bool header = !r->stream.slice;
+
     // print the header lines
     for(c = 0, i = 0; c < used ; c++) {
         if(!rrdr_dimension_should_be_exposed(r->od[c], options))
             continue;
 
-        buffer_fast_strcat(wb, pre_label, pre_label_len);
-        buffer_strcat(wb, string2str(r->dn[c]));
-        buffer_fast_strcat(wb, post_label, post_label_len);
+        if(header) {
+            buffer_fast_strcat(wb, pre_label, pre_label_len);
+            buffer_strcat(wb, string2str(r->dn[c]));
+            buffer_fast_strcat(wb, post_label, post_label_len);
+        }
         i++;
     }
 
-    if(!i) {
+    if(!i && header) {
         buffer_fast_strcat(wb, pre_label, pre_label_len);
         buffer_fast_strcat(wb, "no data", 7);
         buffer_fast_strcat(wb, post_label, post_label_len);
@@ -126,11 +135,13 @@ void rrdr2json(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, int datatable) {
     size_t total_number_of_dimensions = i;
 
     // print the beginning of row data
-    buffer_strcat(wb, data_begin);
+    if(header)
+        buffer_strcat(wb, data_begin);
 
     // if all dimensions are hidden, print a null
     if(!i) {
-        buffer_strcat(wb, finish);
+        if(header)
+            buffer_strcat(wb, finish);
         return;
     }
 
@@ -162,7 +173,7 @@ void rrdr2json(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, int datatable) {
             struct tm tmbuf, *tm = localtime_r(&now, &tmbuf);
             if(!tm) { error("localtime_r() failed."); continue; }
 
-            if(likely(i != start)) buffer_fast_strcat(wb, ",\n", 2);
+            if(likely(i != start || r->stream.rows)) buffer_fast_strcat(wb, ",\n", 2);
             buffer_fast_strcat(wb, pre_date, pre_date_len);
 
             if( options & RRDR_OPTION_OBJECTSROWS )
@@ -193,7 +204,7 @@ void rrdr2json(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, int datatable) {
         }
         else {
             // print the timestamp of the line
-            if(likely(i != start))
+            if(likely(i != start || r->stream.rows))
                 buffer_fast_strcat(wb, ",\n", 2);
 
             buffer_fast_strcat(wb, pre_date, pre_date_len);
@@ -277,7 +288,8 @@ void rrdr2json(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, int datatable) {
         buffer_fast_strcat(wb, post_line, post_line_len);
     }
 
-    buffer_strcat(wb, finish);
+    if(!r->stream.more)
+        buffer_strcat(wb, finish);
     //info("RRD2JSON(): %s: END", r->st->id);
 }
 
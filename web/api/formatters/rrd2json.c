@@ -164,41 +164,7 @@ static inline void buffer_json_member_add_string_close(BUFFER *wb) {
     buffer_strcat(wb, wb->json.value_quote);
 }
 
-int data_query_execute(ONEWAYALLOC *owa, BUFFER *wb, QUERY_TARGET *qt, time_t *latest_timestamp) {
-    wrapper_begin_t wrapper_begin = rrdr_json_wrapper_begin;
-    wrapper_end_t wrapper_end = rrdr_json_wrapper_end;
-
-    if(qt->request.version == 2) {
-        wrapper_begin = rrdr_json_wrapper_begin2;
-        wrapper_end = rrdr_json_wrapper_end2;
-    }
-
-    RRDR *r = rrd2rrdr(owa, qt);
-    qt->timings.executed_ut = now_monotonic_usec();
-
-    if(!r) {
-        buffer_strcat(wb, "Cannot generate output with these parameters on this chart.");
-        return HTTP_RESP_INTERNAL_SERVER_ERROR;
-    }
-
-    if (r->view.flags & RRDR_RESULT_FLAG_CANCEL) {
-        rrdr_free(owa, r);
-        return HTTP_RESP_BACKEND_FETCH_FAILED;
-    }
-
-    if(r->view.flags & RRDR_RESULT_FLAG_RELATIVE)
-        buffer_no_cacheable(wb);
-    else if(r->view.flags & RRDR_RESULT_FLAG_ABSOLUTE)
-        buffer_cacheable(wb);
-
-    if(latest_timestamp && rrdr_rows(r) > 0)
-        *latest_timestamp = r->view.before;
-
-    DATASOURCE_FORMAT format = qt->request.format;
-    RRDR_OPTIONS options = qt->request.options;
-
-    qt->timings.group_by_ut = now_monotonic_usec();
-
+static void rrdr2format(RRDR *r, BUFFER *wb, DATASOURCE_FORMAT format, RRDR_OPTIONS options, wrapper_begin_t wrapper_begin, wrapper_end_t wrapper_end) {
     switch(format) {
     case DATASOURCE_SSV:
         if(options & RRDR_OPTION_JSON_WRAP) {
@@ -286,9 +252,11 @@ int data_query_execute(ONEWAYALLOC *owa, BUFFER *wb, QUERY_TARGET *qt, time_t *l
         }
         else {
             wb->content_type = CT_APPLICATION_JSON;
-            buffer_strcat(wb, "[\n");
+            if(!r->stream.slice)
+                buffer_strcat(wb, "[\n");
             rrdr2csv(r, wb, format, options + RRDR_OPTION_LABEL_QUOTES, "[", ",", "]", ",\n");
-            buffer_strcat(wb, "\n]");
+            if(!r->stream.more)
+                buffer_strcat(wb, "\n]");
         }
         break;
 
@@ -320,9 +288,11 @@ int data_query_execute(ONEWAYALLOC *owa, BUFFER *wb, QUERY_TARGET *qt, time_t *l
         }
         else {
             wb->content_type = CT_TEXT_HTML;
-            buffer_strcat(wb, "<html>\n<center>\n<table border=\"0\" cellpadding=\"5\" cellspacing=\"5\">\n");
+            if(!r->stream.slice)
+                buffer_strcat(wb, "<html>\n<center>\n<table border=\"0\" cellpadding=\"5\" cellspacing=\"5\">\n");
             rrdr2csv(r, wb, format, options, "<tr><td>", "</td><td>", "</td></tr>\n", "");
-            buffer_strcat(wb, "</table>\n</center>\n</html>\n");
+            if(!r->stream.more)
+                buffer_strcat(wb, "</table>\n</center>\n</html>\n");
         }
         break;
 
@@ -397,7 +367,245 @@ int data_query_execute(ONEWAYALLOC *owa, BUFFER *wb, QUERY_TARGET *qt, time_t *l
         wrapper_end(r, wb);
         break;
     }
+}
+
+// ----------------------------------------------------------------------------
+// sliced execution of large queries
+//
+// Queries that would return more than "query result slice cells" values
+// (points x metrics) and do not need the whole result before their output
+// starts (no JSON wrapper, no 'nonzero' filtering, no smoothing over all their
+// points), are executed in slices of consecutive points. Each slice is queried,
+// formatted and freed before the next one, so the memory of the query is bounded
+// by the size of the slice, not by the points and the dimensions of the result.
+// The slices are queried in the order their rows are printed.
+// The timeout of the request applies to the whole query: each slice is given
+// the time left, and no more slices are queried once it has been exceeded.
+
+#define DATA_QUERY_SLICE_MIN_POINTS 100
+
+size_t data_query_slice_cells = 1000000;
+
+void data_query_init(void) {
+    long long cells = config_get_number(CONFIG_SECTION_WEB, "query result slice cells", (long long)data_query_slice_cells);
+    if(cells < 0) {
+        cells = 0;
+        config_set_number(CONFIG_SECTION_WEB, "query result slice cells", cells);
+    }
+    data_query_slice_cells = (size_t)cells;
+
+    query_cache_init();
+}
+
+// returns the points of each slice, or zero to execute the query at once
+static size_t data_query_slice_points(QUERY_TARGET *qt) {
+    if(!data_query_slice_cells || qt->request.version != 1 || !qt->query.used)
+        return 0;
+
+    if(qt->request.options & (RRDR_OPTION_JSON_WRAP | RRDR_OPTION_NONZERO))
+        return 0;
+
+    switch(qt->window.group_method) {
+        case RRDR_GROUPING_SES:
+        case RRDR_GROUPING_DES:
+            // they smooth each point using all the points before it
+            return 0;
+
+        default:
+            break;
+    }
+
+    if(qt->window.points * qt->query.used <= data_query_slice_cells)
+        return 0;
+
+    size_t points = data_query_slice_cells / qt->query.used;
+    if(points < DATA_QUERY_SLICE_MIN_POINTS)
+        points = DATA_QUERY_SLICE_MIN_POINTS;
+
+    return (points < qt->window.points) ? points : 0;
+}
+
+static void data_query_slice_free(ONEWAYALLOC *owa, RRDR *r) {
+    // the next slices need the query target - the caller of data_query_execute() releases it
+    r->internal.qt = NULL;
+
+    rrdr_free(owa, r);
+    onewayalloc_destroy(owa);
+}
+
+static int data_query_execute_sliced(BUFFER *wb, QUERY_TARGET *qt, time_t *latest_timestamp, size_t slice_points) {
+    time_t after = qt->window.after;
+    time_t before = qt->window.before;
+    size_t points = qt->window.points;
+    time_t granularity = qt->window.query_granularity;
+    time_t point_duration = (time_t)qt->window.group * granularity;
+    size_t slices = (points + slice_points - 1) / slice_points;
+    bool newest_first = !(qt->request.options & RRDR_OPTION_REVERSED);
+    time_t timeout_ms = qt->request.timeout;
+    usec_t started_ut = now_monotonic_usec();
+
+    qt->window.whole.after = after;
+    qt->window.whole.before = before;
+    qt->window.whole.points = points;
+
+    int ret = HTTP_RESP_OK;
+    size_t rows = 0;
+    size_t wb_len = buffer_strlen(wb);
+    bool flushed = false;
+
+    for(size_t s = 0; s < slices ;s++) {
+        // the points of the slice, counting from the oldest point of the query
+        size_t k = newest_first ? slices - 1 - s : s;
+        size_t first_point = k * slice_points;
+        size_t last_point = MIN(points, first_point + slice_points);
+
+        qt->window.before = after - granularity + (time_t)last_point * point_duration;
+        qt->window.after = qt->window.before - (time_t)(last_point - first_point) * point_duration + granularity;
+        qt->window.points = last_point - first_point;
+
+        if(timeout_ms) {
+            // rrd2rrdr() measures the timeout from its own start, so give it the time left
+            time_t elapsed_ms = (time_t)((now_monotonic_usec() - started_ut) / USEC_PER_MS);
+            if(elapsed_ms >= timeout_ms) {
+                log_access("QUERY CANCELED RUNTIME EXCEEDED %lld ms (LIMIT %lld ms), AT SLICE %zu OF %zu",
+                           (long long)elapsed_ms, (long long)timeout_ms, s + 1, slices);
+                ret = HTTP_RESP_BACKEND_FETCH_FAILED;
+                break;
+            }
+
+            qt->request.timeout = timeout_ms - elapsed_ms;
+        }
+
+        ONEWAYALLOC *owa = onewayalloc_create(0);
+        RRDR *r = rrd2rrdr(owa, qt);
+        qt->timings.executed_ut = now_monotonic_usec();
+
+        if(!r) {
+            onewayalloc_destroy(owa);
+            ret = HTTP_RESP_INTERNAL_SERVER_ERROR;
+            break;
+        }
+
+        if (r->view.flags & RRDR_RESULT_FLAG_CANCEL) {
+            data_query_slice_free(owa, r);
+            ret = HTTP_RESP_BACKEND_FETCH_FAILED;
+            break;
+        }
+
+        if(!s) {
+            if(r->view.flags & RRDR_RESULT_FLAG_RELATIVE)
+                buffer_no_cacheable(wb);
+            else if(r->view.flags & RRDR_RESULT_FLAG_ABSOLUTE)
+                buffer_cacheable(wb);
+        }
+
+        if(latest_timestamp && rrdr_rows(r) > 0 && (newest_first ? !s : s + 1 == slices))
+            *latest_timestamp = r->view.before;
+
+        qt->timings.group_by_ut = now_monotonic_usec();
+
+        r->stream.slice = s;
+        r->stream.rows = rows;
+        r->stream.more = (s + 1 < slices);
+        rrdr2format(r, wb, qt->request.format, qt->request.options, rrdr_json_wrapper_begin, rrdr_json_wrapper_end);
+        rows += rrdr_rows(r);
+
+        data_query_slice_free(owa, r);
+
+        // give the output so far to the caller, while the next slices are queried
+        if(s + 1 < slices && qt->request.flush_callback &&
+           qt->request.flush_callback(wb, qt->request.flush_callback_data))
+            flushed = true;
+    }
+
+    qt->window.after = after;
+    qt->window.before = before;
+    qt->window.points = points;
+    qt->request.timeout = timeout_ms;
+    qt->window.whole.after = 0;
+    qt->window.whole.before = 0;
+    qt->window.whole.points = 0;
+
+    if(ret != HTTP_RESP_OK) {
+        if(flushed)
+            // the first slices have been sent already, the caller aborts the response
+            buffer_flush(wb);
+
+        else {
+            // drop the slices already formatted
+            wb->len = wb_len;
+            wb->buffer[wb->len] = '\0';
+
+            if(ret == HTTP_RESP_INTERNAL_SERVER_ERROR)
+                buffer_strcat(wb, "Cannot generate output with these parameters on this chart.");
+        }
+    }
+
+    return ret;
+}
+
+static int data_query_execute_uncached(ONEWAYALLOC *owa, BUFFER *wb, QUERY_TARGET *qt, time_t *latest_timestamp) {
+    size_t slice_points = data_query_slice_points(qt);
+    if(slice_points)
+        return data_query_execute_sliced(wb, qt, latest_timestamp, slice_points);
+
+    wrapper_begin_t wrapper_begin = rrdr_json_wrapper_begin;
+    wrapper_end_t wrapper_end = rrdr_json_wrapper_end;
+
+    if(qt->request.version == 2) {
+        wrapper_begin = rrdr_json_wrapper_begin2;
+        wrapper_end = rrdr_json_wrapper_end2;
+    }
+
+    RRDR *r = rrd2rrdr(owa, qt);
+    qt->timings.executed_ut = now_monotonic_usec();
+
+    if(!r) {
+        buffer_strcat(wb, "Cannot generate output with these parameters on this chart.");
+        return HTTP_RESP_INTERNAL_SERVER_ERROR;
+    }
+
+    if (r->view.flags & RRDR_RESULT_FLAG_CANCEL) {
+        rrdr_free(owa, r);
+        return HTTP_RESP_BACKEND_FETCH_FAILED;
+    }
+
+    if(r->view.flags & RRDR_RESULT_FLAG_RELATIVE)
+        buffer_no_cacheable(wb);
+    else if(r->view.flags & RRDR_RESULT_FLAG_ABSOLUTE)
+        buffer_cacheable(wb);
+
+    if(latest_timestamp && rrdr_rows(r) > 0)
+        *latest_timestamp = r->view.before;
+
+    qt->timings.group_by_ut = now_monotonic_usec();
+
+    rrdr2format(r, wb, qt->request.format, qt->request.options, wrapper_begin, wrapper_end);
 
     rrdr_free(owa, r);
     return HTTP_RESP_OK;
 }
+
+int data_query_execute(ONEWAYALLOC *owa, BUFFER *wb, QUERY_TARGET *qt, time_t *latest_timestamp) {
+    // the output of the queries streamed to the caller is not kept, so they are not cached
+    if(qt->request.flush_callback) {
+        size_t slice_points = data_query_slice_points(qt);
+        if(slice_points)
+            return data_query_execute_sliced(wb, qt, latest_timestamp, slice_points);
+    }
+
+    QUERY_CACHE_KEY qck;
+    if(query_cache_get(&qck, qt, wb, latest_timestamp))
+        return HTTP_RESP_OK;
+
+    size_t wb_start = buffer_strlen(wb);
+    time_t latest = 0;
+
+    int ret = data_query_execute_uncached(owa, wb, qt, &latest);
+    query_cache_put(&qck, qt, wb, wb_start, ret, latest);
+
+    if(latest_timestamp && latest)
+        *latest_timestamp = latest;
+
+    return ret;
+}
@@ -24,6 +24,7 @@ typedef enum {
 
 #include "web/api/exporters/allmetrics.h"
 #include "web/api/queries/rrdr.h"
+#include "web/api/queries/query_cache.h"
 
 #include "web/api/formatters/csv/csv.h"
 #include "web/api/formatters/ssv/ssv.h"
@@ -58,6 +59,8 @@ void rrd_stats_api_v1_chart(RRDSET *st, BUFFER *wb);
 const char *rrdr_format_to_string(DATASOURCE_FORMAT format);
 
 int data_query_execute(ONEWAYALLOC *owa, BUFFER *wb, struct query_target *qt, time_t *latest_timestamp);
+void data_query_init(void);
+extern size_t data_query_slice_cells;
 
 void rrdr_json_group_by_labels(BUFFER *wb, const char *key, RRDR *r, RRDR_OPTIONS options);
 
@@ -6,7 +6,9 @@ void rrdr2ssv(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, const char *prefix, con
     //info("RRD2SSV(): %s: BEGIN", r->st->id);
     long i;
 
-    buffer_strcat(wb, prefix);
+    if(!r->stream.slice)
+        buffer_strcat(wb, prefix);
+
     long start = 0, end = rrdr_rows(r), step = 1;
     if(!(options & RRDR_OPTION_REVERSED)) {
         start = rrdr_rows(r) - 1;
@@ -28,7 +30,7 @@ void rrdr2ssv(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, const char *prefix, con
             r->view.max = v;
         }
 
-        if(likely(i != start))
+        if(likely(i != start || r->stream.rows))
             buffer_strcat(wb, separator);
 
         if(all_values_are_null) {
@@ -40,6 +42,7 @@ void rrdr2ssv(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, const char *prefix, con
         else
             buffer_print_netdata_double(wb, v);
     }
-    buffer_strcat(wb, suffix);
+    if(!r->stream.more)
+        buffer_strcat(wb, suffix);
     //info("RRD2SSV(): %s: END", r->st->id);
 }
@@ -19,6 +19,9 @@
 
 #define POINTS_TO_EXPAND_QUERY 5
 
+// the points read from the storage engines with a single call
+#define QUERY_ENGINE_BATCH_POINTS 32
+
 // ----------------------------------------------------------------------------
 
 static struct {
@@ -1034,9 +1037,17 @@ typedef struct query_engine_ops {
     struct query_metric_tier *tier_ptr;
     struct storage_engine_query_handle *handle;
     STORAGE_POINT (*next_metric)(struct storage_engine_query_handle *handle);
+    size_t (*next_metrics)(struct storage_engine_query_handle *handle, STORAGE_POINT *points, size_t max_points);
     int (*is_finished)(struct storage_engine_query_handle *handle);
     void (*finalize)(struct storage_engine_query_handle *handle);
 
+    // the points read in batches from the current plan, not consumed yet
+    struct {
+        size_t pos;
+        size_t used;
+        STORAGE_POINT points[QUERY_ENGINE_BATCH_POINTS];
+    } batch;
+
     // aggregating points over time
     void (*grouping_add)(struct rrdresult *r, NETDATA_DOUBLE value);
     NETDATA_DOUBLE (*grouping_flush)(struct rrdresult *r, RRDR_VALUE_FLAGS *rrdr_value_options_ptr);
@@ -1055,6 +1066,7 @@ typedef struct query_engine_ops {
         time_t expanded_before;
         struct storage_engine_query_handle handle;
         STORAGE_POINT (*next_metric)(struct storage_engine_query_handle *handle);
+        size_t (*next_metrics)(struct storage_engine_query_handle *handle, STORAGE_POINT *points, size_t max_points);
         int (*is_finished)(struct storage_engine_query_handle *handle);
         void (*finalize)(struct storage_engine_query_handle *handle);
         bool initialized;
@@ -1121,7 +1133,7 @@ static void query_planer_initialize_plans(QUERY_ENGINE_OPS *ops) {
         ops->plans[p].expanded_after = after;
         ops->plans[p].expanded_before = before;
 
-        ops->r->internal.qt->db.tiers[tier].queries++;
+        __atomic_add_fetch(&ops->r->internal.qt->db.tiers[tier].queries, 1, __ATOMIC_RELAXED);
 
         struct query_metric_tier *tier_ptr = &qm->tiers[tier];
         STORAGE_ENGINE *eng = query_metric_storage_engine(ops->r->internal.qt, qm, tier);
@@ -1132,6 +1144,7 @@ static void query_planer_initialize_plans(QUERY_ENGINE_OPS *ops) {
                 ops->r->internal.qt->request.priority);
 
         ops->plans[p].next_metric = eng->api.query_ops.next_metric;
+        ops->plans[p].next_metrics = eng->api.query_ops.next_metrics;
         ops->plans[p].is_finished = eng->api.query_ops.is_finished;
         ops->plans[p].finalize = eng->api.query_ops.finalize;
         ops->plans[p].initialized = true;
@@ -1147,11 +1160,14 @@ static void query_planer_finalize_plan(QUERY_ENGINE_OPS *ops, size_t plan_id) {
         ops->plans[plan_id].initialized = false;
         ops->plans[plan_id].finalized = true;
         ops->plans[plan_id].next_metric = NULL;
+        ops->plans[plan_id].next_metrics = NULL;
         ops->plans[plan_id].is_finished = NULL;
         ops->plans[plan_id].finalize = NULL;
 
         if(ops->current_plan == plan_id) {
             ops->next_metric = NULL;
+            ops->next_metrics = NULL;
+            ops->batch.pos = ops->batch.used = 0;
             ops->is_finished = NULL;
             ops->finalize = NULL;
         }
@@ -1178,10 +1194,14 @@ static void query_planer_activate_plan(QUERY_ENGINE_OPS *ops, size_t plan_id, ti
     ops->tier_ptr = &qm->tiers[ops->tier];
     ops->handle = &ops->plans[plan_id].handle;
     ops->next_metric = ops->plans[plan_id].next_metric;
+    ops->next_metrics = ops->plans[plan_id].next_metrics;
     ops->is_finished = ops->plans[plan_id].is_finished;
     ops->finalize = ops->plans[plan_id].finalize;
     ops->current_plan = plan_id;
 
+    // the points of the previous plan are not needed anymore
+    ops->batch.pos = ops->batch.used = 0;
+
     if(plan_id + 1 < qm->plan.used && qm->plan.array[plan_id + 1].after < qm->plan.array[plan_id].before)
         ops->current_plan_expire_time = qm->plan.array[plan_id + 1].after;
     else
@@ -1222,14 +1242,79 @@ static bool query_planer_next_plan(QUERY_ENGINE_OPS *ops, time_t now, time_t las
     return true;
 }
 
+// ----------------------------------------------------------------------------
+// reading points from the current plan, in batches when the storage engine supports it
+
+static inline bool query_engine_is_finished(QUERY_ENGINE_OPS *ops) {
+    if(likely(ops->batch.pos < ops->batch.used))
+        return false;
+
+    if(likely(ops->next_metrics)) {
+        ops->batch.pos = 0;
+        ops->batch.used = ops->next_metrics(ops->handle, ops->batch.points, QUERY_ENGINE_BATCH_POINTS);
+        return ops->batch.used == 0;
+    }
+
+    return ops->is_finished(ops->handle);
+}
+
+static inline STORAGE_POINT query_engine_next_metric(QUERY_ENGINE_OPS *ops) {
+    if(likely(ops->batch.pos < ops->batch.used))
+        return ops->batch.points[ops->batch.pos++];
+
+    return ops->next_metric(ops->handle);
+}
+
 static int compare_query_plan_entries_on_start_time(const void *a, const void *b) {
     QUERY_PLAN_ENTRY *p1 = (QUERY_PLAN_ENTRY *)a;
     QUERY_PLAN_ENTRY *p2 = (QUERY_PLAN_ENTRY *)b;
     return (p1->after < p2->after)?-1:1;
 }
 
+// limits the plans of a sliced query to the slice being queried
+static void query_plan_clip_to_slice(QUERY_METRIC *qm, time_t after, time_t before) {
+    size_t used = 0, nearest = 0;
+
+    for(size_t p = 0; p < qm->plan.used ; p++) {
+        QUERY_PLAN_ENTRY t = qm->plan.array[p];
+
+        if(t.after <= before)
+            nearest = p;
+
+        if(t.after < after) t.after = after;
+        if(t.before > before) t.before = before;
+
+        if(t.after > t.before)
+            continue;
+
+        qm->plan.array[used++] = t;
+    }
+
+    if(!used) {
+        // there are no data in this slice (so the array is untouched)
+        // query the tier of the nearest plan, to get empty points, as the whole query would
+        QUERY_PLAN_ENTRY t = qm->plan.array[nearest];
+        t.after = after;
+        t.before = before;
+        qm->plan.array[0] = t;
+        used = 1;
+    }
+
+    qm->plan.used = used;
+}
+
 static bool query_plan(QUERY_ENGINE_OPS *ops, time_t after_wanted, time_t before_wanted, size_t points_wanted) {
     QUERY_METRIC *qm = ops->qm;
+    QUERY_TARGET *qt = ops->r->internal.qt;
+
+    // sliced queries are planned for the whole query and the plan is then clipped
+    // to the slice, so that all slices select the same tiers and the same metrics
+    time_t slice_after = after_wanted, slice_before = before_wanted;
+    if(qt->window.whole.points) {
+        after_wanted = qt->window.whole.after;
+        before_wanted = qt->window.whole.before;
+        points_wanted = qt->window.whole.points;
+    }
 
     // put our selected tier as the first plan
     size_t selected_tier;
@@ -1339,6 +1424,12 @@ static bool query_plan(QUERY_ENGINE_OPS *ops, time_t after_wanted, time_t before
     if(!query_metric_is_valid_tier(qm, qm->plan.array[0].tier))
         return false;
 
+    if(qt->window.whole.points) {
+        query_plan_clip_to_slice(qm, slice_after, slice_before);
+        after_wanted = slice_after;
+        before_wanted = slice_before;
+    }
+
 #ifdef NETDATA_INTERNAL_CHECKS
     for(size_t p = 0; p < qm->plan.used ;p++) {
         internal_fatal(qm->plan.array[p].after > qm->plan.array[p].before, "QUERY: flipped after/before");
@@ -1500,7 +1591,7 @@ static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr, QUERY_ENGINE_
                 last1_point = new_point;
             }
 
-            if(unlikely(ops->is_finished(ops->handle))) {
+            if(unlikely(query_engine_is_finished(ops))) {
                 query_is_finished_counter++;
 
                 if(count_same_end_time != 0) {
@@ -1523,7 +1614,7 @@ static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr, QUERY_ENGINE_
                 STORAGE_POINT sp;
                 if(likely(storage_point_is_unset(next1_point))) {
                     db_points_read_since_plan_switch++;
-                    sp = ops->next_metric(ops->handle);
+                    sp = query_engine_next_metric(ops);
                 }
                 else {
                     // ONE POINT READ-AHEAD
@@ -1544,7 +1635,7 @@ static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr, QUERY_ENGINE_
                     // A. the entire point of the previous plan is to the future of point from the next plan
                     // B. part of the point of the previous plan overlaps with the point from the next plan
 
-                    STORAGE_POINT sp2 = ops->next_metric(ops->handle);
+                    STORAGE_POINT sp2 = query_engine_next_metric(ops);
 
                     if(sp.start_time_s > sp2.start_time_s)
                         // the point from the previous plan is useless
@@ -1843,7 +1934,7 @@ static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr, QUERY_ENGINE_
     r->stats.result_points_generated += points_added;
     r->stats.db_points_read += ops->db_total_points_read;
     for(size_t tr = 0; tr < storage_tiers ; tr++)
-        qt->db.tiers[tr].points += ops->db_points_read_per_tier[tr];
+        __atomic_add_fetch(&qt->db.tiers[tr].points, ops->db_points_read_per_tier[tr], __ATOMIC_RELAXED);
 
     internal_error(points_added != points_wanted,
                    "QUERY: '%s', dimension '%s', requested %zu points, but RRDR added %zu (%zu db points read).",
@@ -1855,6 +1946,7 @@ static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr, QUERY_ENGINE_
 // fill the gap of a tier
 
 void store_metric_at_tier(RRDDIM *rd, size_t tier, struct rrddim_tier *t, STORAGE_POINT sp, usec_t now_ut);
+void store_aggregated_metric_at_tier(RRDDIM *rd, size_t tier, struct rrddim_tier *t, STORAGE_POINT sp);
 
 void rrdr_fill_tier_gap_from_smaller_tiers(RRDDIM *rd, size_t tier, time_t now_s) {
     if(unlikely(tier >= storage_tiers)) return;
@@ -1889,14 +1981,63 @@ void rrdr_fill_tier_gap_from_smaller_tiers(RRDDIM *rd, size_t tier, time_t now_s
 
         size_t points_read = 0;
 
-        while(!tmp->query_ops->is_finished(&handle)) {
+        if(tmp->query_ops->next_metrics_aggregated) {
+            // the first point we need is stored as-is, to align the tier point with it
+            while(!tmp->query_ops->is_finished(&handle)) {
+                STORAGE_POINT sp = tmp->query_ops->next_metric(&handle);
+                points_read++;
+
+                if(sp.end_time_s > latest_time_s) {
+                    latest_time_s = sp.end_time_s;
+                    store_metric_at_tier(rd, tier, t, sp, sp.end_time_s * USEC_PER_SEC);
+                    break;
+                }
+            }
+
+            // the rest are aggregated by the storage engine, directly from its pages
+            STORAGE_POINT points[QUERY_ENGINE_BATCH_POINTS];
+            time_t read_granularity = (time_t)tmp->tier_grouping * (time_t)rd->update_every;
+            size_t used;
+
+            while(!tmp->query_ops->is_finished(&handle) &&
+                  (used = tmp->query_ops->next_metrics_aggregated(&handle, granularity, points, QUERY_ENGINE_BATCH_POINTS))) {
+
+                for(size_t i = 0; i < used ;i++) {
+                    points_read += (size_t)((points[i].end_time_s - points[i].start_time_s) / read_granularity);
+
+                    if(points[i].end_time_s > latest_time_s) {
+                        latest_time_s = points[i].end_time_s;
+                        store_aggregated_metric_at_tier(rd, tier, t, points[i]);
+                    }
+                }
+            }
+        }
+        else if(tmp->query_ops->next_metrics) {
+            // read the points of the smaller tier in batches, they are unpacked in bulk
+            STORAGE_POINT points[QUERY_ENGINE_BATCH_POINTS];
+            size_t used;
+
+            while((used = tmp->query_ops->next_metrics(&handle, points, QUERY_ENGINE_BATCH_POINTS))) {
+                points_read += used;
+
+                for(size_t i = 0; i < used ;i++) {
+                    if(points[i].end_time_s > latest_time_s) {
+                        latest_time_s = points[i].end_time_s;
+                        store_metric_at_tier(rd, tier, t, points[i], points[i].end_time_s * USEC_PER_SEC);
+                    }
+                }
+            }
+        }
+        else {
+            while(!tmp->query_ops->is_finished(&handle)) {
 
-            STORAGE_POINT sp = tmp->query_ops->next_metric(&handle);
-            points_read++;
+                STORAGE_POINT sp = tmp->query_ops->next_metric(&handle);
+                points_read++;
 
-            if(sp.end_time_s > latest_time_s) {
-                latest_time_s = sp.end_time_s;
-                store_metric_at_tier(rd, tier, t, sp, sp.end_time_s * USEC_PER_SEC);
+                if(sp.end_time_s > latest_time_s) {
+                    latest_time_s = sp.end_time_s;
+                    store_metric_at_tier(rd, tier, t, sp, sp.end_time_s * USEC_PER_SEC);
+                }
             }
         }
 
@@ -2818,13 +2959,18 @@ static RRDR *rrd2rrdr_group_by_initialize(ONEWAYALLOC *owa, QUERY_TARGET *qt) {
     return r;
 }
 
-static void rrd2rrdr_group_by_add_metric(RRDR *r, size_t query_metric_id) {
+// r_tmp is the RRDR the metric was queried into
+static void rrd2rrdr_group_by_add_metric(RRDR *r, RRDR *r_tmp, size_t query_metric_id) {
     if(!r->group_by.r)
         return;
 
     QUERY_TARGET *qt = r->internal.qt;
     RRDR_OPTIONS options = qt->request.options;
-    RRDR *r_tmp = r->group_by.r;
+
+    // the slices of a sliced query expose the groups of all the metrics queried,
+    // even when they do not have any points in the slice, to have the same columns
+    if(qt->window.whole.points && (r_tmp->od[0] & RRDR_DIMENSION_QUERIED))
+        r->od[query_metric(qt, query_metric_id)->grouped_as.slot] |= RRDR_DIMENSION_QUERIED;
 
     // do the group_by
     for(size_t i = 0; i != rrdr_rows(r_tmp) ; i++) {
@@ -3023,99 +3169,124 @@ static void rrd2rrdr_group_by_finalize(RRDR *r) {
 }
 
 // ----------------------------------------------------------------------------
-// query entry point
+// executing the queries of the metrics
 
-RRDR *rrd2rrdr_legacy(
-        ONEWAYALLOC *owa,
-        RRDSET *st, size_t points, time_t after, time_t before,
-        RRDR_TIME_GROUPING group_method, time_t resampling_time, RRDR_OPTIONS options, const char *dimensions,
-        const char *group_options, time_t timeout, size_t tier, QUERY_SOURCE query_source,
-        STORAGE_PRIORITY priority) {
+struct rrd2rrdr_progress {
+    time_t max_after, min_before;
+    size_t max_rows;
+    long dimensions_used, dimensions_nonzero;
+    struct timeval query_start_time;
+};
 
-    QUERY_TARGET_REQUEST qtr = {
-            .version = 1,
-            .st = st,
-            .points = points,
-            .after = after,
-            .before = before,
-            .time_group_method = group_method,
-            .resampling_time = resampling_time,
-            .options = options,
-            .dimensions = dimensions,
-            .time_group_options = group_options,
-            .timeout = timeout,
-            .tier = tier,
-            .query_source = query_source,
-            .priority = priority,
-    };
+static void rrd2rrdr_query_metric_queried(QUERY_TARGET *qt, size_t d) {
+    QUERY_METRIC *qm = query_metric(qt, d);
+    QUERY_DIMENSION *qd = query_dimension(qt, qm->link.query_dimension_id);
+    QUERY_INSTANCE *qi = query_instance(qt, qm->link.query_instance_id);
+    QUERY_CONTEXT *qc = query_context(qt, qm->link.query_context_id);
+    QUERY_NODE *qn = query_node(qt, qm->link.query_node_id);
 
-    return rrd2rrdr(owa, query_target_create(&qtr));
-}
+    qi->metrics.queried++;
+    qc->metrics.queried++;
+    qn->metrics.queried++;
 
-RRDR *rrd2rrdr(ONEWAYALLOC *owa, QUERY_TARGET *qt) {
-    if(!qt)
-        return NULL;
+    qd->status |= QUERY_STATUS_QUERIED;
+    qm->status |= RRDR_DIMENSION_QUERIED;
 
-    if(!owa) {
-        query_target_release(qt);
-        return NULL;
+    if(qt->request.version >= 2) {
+        query_target_merge_data_statistics(&qi->query_stats, &qm->query_stats);
+        query_target_merge_data_statistics(&qc->query_stats, &qm->query_stats);
+        query_target_merge_data_statistics(&qn->query_stats, &qm->query_stats);
+        query_target_merge_data_statistics(&qt->query_stats, &qm->query_stats);
     }
+}
 
-    // qt.window members are the WANTED ones.
-    // qt.request members are the REQUESTED ones.
+static void rrd2rrdr_query_metric_failed(QUERY_TARGET *qt, size_t d) {
+    QUERY_METRIC *qm = query_metric(qt, d);
+    QUERY_DIMENSION *qd = query_dimension(qt, qm->link.query_dimension_id);
+    QUERY_INSTANCE *qi = query_instance(qt, qm->link.query_instance_id);
+    QUERY_CONTEXT *qc = query_context(qt, qm->link.query_context_id);
+    QUERY_NODE *qn = query_node(qt, qm->link.query_node_id);
 
-    RRDR *r = rrd2rrdr_group_by_initialize(owa, qt);
-    if(!r)
-        return NULL;
+    qi->metrics.failed++;
+    qc->metrics.failed++;
+    qn->metrics.failed++;
 
-    if(qt->window.relative)
-        r->view.flags |= RRDR_RESULT_FLAG_RELATIVE;
-    else
-        r->view.flags |= RRDR_RESULT_FLAG_ABSOLUTE;
+    qd->status |= QUERY_STATUS_FAILED;
+    qm->status |= RRDR_DIMENSION_FAILED;
+}
 
-    // -------------------------------------------------------------------------
-    // initialize RRDR
+// verifies the metric just added to r is aligned with the others
+// returns true when the query has to be canceled
+static bool rrd2rrdr_query_metric_completed(RRDR *r, struct rrd2rrdr_progress *p, size_t d) {
+    QUERY_TARGET *qt = r->internal.qt;
+    QUERY_METRIC *qm = query_metric(qt, d);
+    QUERY_DIMENSION *qd = query_dimension(qt, qm->link.query_dimension_id);
+    QUERY_INSTANCE *qi = query_instance(qt, qm->link.query_instance_id);
+    (void)qd; (void)qi;
 
-    r->view.group = qt->window.group;
-    r->view.update_every = (int) (qt->window.group * qt->window.query_granularity);
-    r->view.before = qt->window.before;
-    r->view.after = qt->window.after;
-    r->view.options = qt->window.options;
-    r->time_grouping.points_wanted = qt->window.points;
-    r->time_grouping.resampling_group = qt->window.resampling_group;
-    r->time_grouping.resampling_divisor = qt->window.resampling_divisor;
+    struct timeval query_current_time;
+    if (qt->request.timeout)
+        now_realtime_timeval(&query_current_time);
 
-    if(r->group_by.r) {
-        r->group_by.r->view = r->view;
-        r->group_by.r->time_grouping = r->time_grouping;
+    if(qm->status & RRDR_DIMENSION_NONZERO)
+        p->dimensions_nonzero++;
+
+    // verify all dimensions are aligned
+    if(unlikely(!p->dimensions_used)) {
+        p->min_before = r->view.before;
+        p->max_after = r->view.after;
+        p->max_rows = r->rows;
     }
+    else {
+        if(r->view.after != p->max_after) {
+            internal_error(true, "QUERY: 'after' mismatch between dimensions for chart '%s': max is %zu, dimension '%s' has %zu",
+                           rrdinstance_acquired_id(qi->ria), (size_t)p->max_after, rrdmetric_acquired_id(qd->rma), (size_t)r->view.after);
 
-    RRDR *r_tmp = r->group_by.r ? r->group_by.r : r;
+            r->view.after = (r->view.after > p->max_after) ? r->view.after : p->max_after;
+        }
 
-    // -------------------------------------------------------------------------
-    // assign the processor functions
-    rrdr_set_grouping_function(r_tmp, qt->window.group_method);
+        if(r->view.before != p->min_before) {
+            internal_error(true, "QUERY: 'before' mismatch between dimensions for chart '%s': max is %zu, dimension '%s' has %zu",
+                           rrdinstance_acquired_id(qi->ria), (size_t)p->min_before, rrdmetric_acquired_id(qd->rma), (size_t)r->view.before);
 
-    // allocate any memory required by the grouping method
-    r_tmp->time_grouping.create(r_tmp, qt->window.group_options);
+            r->view.before = (r->view.before < p->min_before) ? r->view.before : p->min_before;
+        }
 
-    // -------------------------------------------------------------------------
-    // do the work for each dimension
+        if(r->rows != p->max_rows) {
+            internal_error(true, "QUERY: 'rows' mismatch between dimensions for chart '%s': max is %zu, dimension '%s' has %zu",
+                           rrdinstance_acquired_id(qi->ria), (size_t)p->max_rows, rrdmetric_acquired_id(qd->rma), (size_t)r->rows);
 
-    time_t max_after = 0, min_before = 0;
-    size_t max_rows = 0;
+            r->rows = (r->rows > p->max_rows) ? r->rows : p->max_rows;
+        }
+    }
 
-    long dimensions_used = 0, dimensions_nonzero = 0;
-    struct timeval query_start_time;
-    struct timeval query_current_time;
-    if (qt->request.timeout)
-        now_realtime_timeval(&query_start_time);
+    p->dimensions_used++;
+
+    bool cancel = false;
+    if (qt->request.interrupt_callback && qt->request.interrupt_callback(qt->request.interrupt_callback_data)) {
+        cancel = true;
+        log_access("QUERY INTERRUPTED");
+    }
+
+    if (qt->request.timeout && ((NETDATA_DOUBLE)dt_usec(&p->query_start_time, &query_current_time) / 1000.0) > (NETDATA_DOUBLE)qt->request.timeout) {
+        cancel = true;
+        log_access("QUERY CANCELED RUNTIME EXCEEDED %0.2f ms (LIMIT %lld ms)",
+                   (NETDATA_DOUBLE)dt_usec(&p->query_start_time, &query_current_time) / 1000.0, (long long)qt->request.timeout);
+    }
+
+    if(cancel)
+        r->view.flags |= RRDR_RESULT_FLAG_CANCEL;
+
+    return cancel;
+}
+
+static void rrd2rrdr_query_serial(RRDR *r, RRDR *r_tmp, struct rrd2rrdr_progress *p) {
+    QUERY_TARGET *qt = r->internal.qt;
+    ONEWAYALLOC *owa = r->internal.owa;
 
     size_t last_db_points_read = 0;
     size_t last_result_points_generated = 0;
 
-    internal_fatal(released_ops, "QUERY: released_ops should be NULL when the query starts");
-
     QUERY_ENGINE_OPS **ops = NULL;
     if(qt->query.used)
         ops = onewayalloc_callocz(owa, qt->query.used, sizeof(QUERY_ENGINE_OPS *));
@@ -3131,10 +3302,6 @@ RRDR *rrd2rrdr(ONEWAYALLOC *owa, QUERY_TARGET *qt) {
 
     for(size_t d = 0; d < qt->query.used ; d++) {
         QUERY_METRIC *qm = query_metric(qt, d);
-        QUERY_DIMENSION *qd = query_dimension(qt, qm->link.query_dimension_id);
-        QUERY_INSTANCE *qi = query_instance(qt, qm->link.query_instance_id);
-        QUERY_CONTEXT *qc = query_context(qt, qm->link.query_context_id);
-        QUERY_NODE *qn = query_node(qt, qm->link.query_node_id);
 
         if(queries_prepared < qt->query.used) {
             // preload another query
@@ -3167,34 +3334,16 @@ RRDR *rrd2rrdr(ONEWAYALLOC *owa, QUERY_TARGET *qt) {
                 r->view.before = r_tmp->view.before;
                 r->rows = r_tmp->rows;
 
-                rrd2rrdr_group_by_add_metric(r, d);
+                rrd2rrdr_group_by_add_metric(r, r_tmp, d);
             }
 
             rrd2rrdr_query_ops_release(ops[d]); // reuse this ops allocation
             ops[d] = NULL;
 
-            qi->metrics.queried++;
-            qc->metrics.queried++;
-            qn->metrics.queried++;
-
-            qd->status |= QUERY_STATUS_QUERIED;
-            qm->status |= RRDR_DIMENSION_QUERIED;
-
-            if(qt->request.version >= 2) {
-                query_target_merge_data_statistics(&qi->query_stats, &qm->query_stats);
-                query_target_merge_data_statistics(&qc->query_stats, &qm->query_stats);
-                query_target_merge_data_statistics(&qn->query_stats, &qm->query_stats);
-                query_target_merge_data_statistics(&qt->query_stats, &qm->query_stats);
-            }
+            rrd2rrdr_query_metric_queried(qt, d);
         }
         else {
-            qi->metrics.failed++;
-            qc->metrics.failed++;
-            qn->metrics.failed++;
-
-            qd->status |= QUERY_STATUS_FAILED;
-            qm->status |= RRDR_DIMENSION_FAILED;
-
+            rrd2rrdr_query_metric_failed(qt, d);
             continue;
         }
 
@@ -3207,77 +3356,367 @@ RRDR *rrd2rrdr(ONEWAYALLOC *owa, QUERY_TARGET *qt) {
         last_db_points_read = r_tmp->stats.db_points_read;
         last_result_points_generated = r_tmp->stats.result_points_generated;
 
-        if (qt->request.timeout)
-            now_realtime_timeval(&query_current_time);
+        if(rrd2rrdr_query_metric_completed(r, p, d)) {
+            for(size_t i = d + 1; i < queries_prepared ; i++) {
+                if(ops[i]) {
+                    query_planer_finalize_remaining_plans(ops[i]);
+                    rrd2rrdr_query_ops_release(ops[i]);
+                    ops[i] = NULL;
+                }
+            }
+
+            break;
+        }
+    }
+
+    // free the query pipelining ops
+    for(size_t d = 0; d < qt->query.used ; d++) {
+        rrd2rrdr_query_ops_release(ops[d]);
+        ops[d] = NULL;
+    }
 
-        if(qm->status & RRDR_DIMENSION_NONZERO)
-            dimensions_nonzero++;
+    onewayalloc_freez(owa, ops);
+}
 
-        // verify all dimensions are aligned
-        if(unlikely(!dimensions_used)) {
-            min_before = r->view.before;
-            max_after = r->view.after;
-            max_rows = r->rows;
+// ----------------------------------------------------------------------------
+// parallel execution of wide queries
+//
+// The metrics of queries with many metrics are executed by the thread of the
+// query and a few helper threads together. Each thread claims the next metric
+// of the query when it needs one (so threads that get metrics that are fast to
+// query execute more of them), executes it into a private RRDR of one dimension,
+// with its own allocator and time grouping, and then merges it into the result,
+// under a lock, the same way the serial loop does.
+
+size_t rrd2rrdr_parallel_threads = 0;                  // helper threads per query, 0 = disabled
+size_t rrd2rrdr_parallel_min_metrics = 500;            // queries with fewer metrics run serially
+static size_t rrd2rrdr_parallel_threads_max = 0;       // helper threads of all queries
+static size_t rrd2rrdr_parallel_threads_running = 0;
+
+#define RRD2RRDR_PARALLEL_MIN_METRICS_PER_THREAD 100
+#define RRD2RRDR_PARALLEL_MAX_LOOKAHEAD 64
+
+void rrd2rrdr_parallel_init(void) {
+    long cpus = get_system_cpus();
+    if(cpus < 1) cpus = 1;
+
+    long long threads = config_get_number(CONFIG_SECTION_WEB, "query threads for wide queries", MIN(cpus / 2, 8));
+    if(threads < 0 || threads > cpus) {
+        threads = MIN(cpus / 2, 8);
+        config_set_number(CONFIG_SECTION_WEB, "query threads for wide queries", threads);
+    }
+    rrd2rrdr_parallel_threads = (size_t)threads;
+
+    long long min_metrics = config_get_number(CONFIG_SECTION_WEB, "wide query minimum dimensions", (long long)rrd2rrdr_parallel_min_metrics);
+    if(min_metrics < RRD2RRDR_PARALLEL_MIN_METRICS_PER_THREAD * 2) {
+        min_metrics = RRD2RRDR_PARALLEL_MIN_METRICS_PER_THREAD * 2;
+        config_set_number(CONFIG_SECTION_WEB, "wide query minimum dimensions", min_metrics);
+    }
+    rrd2rrdr_parallel_min_metrics = (size_t)min_metrics;
+
+    rrd2rrdr_parallel_threads_max = (size_t)cpus;
+}
+
+// returns the number of helper threads the query can use, 0 to run it serially
+static size_t rrd2rrdr_parallel_helpers_reserve(QUERY_TARGET *qt) {
+    if(!rrd2rrdr_parallel_threads || qt->query.used < rrd2rrdr_parallel_min_metrics)
+        return 0;
+
+    size_t wanted = MIN(rrd2rrdr_parallel_threads, qt->query.used / RRD2RRDR_PARALLEL_MIN_METRICS_PER_THREAD - 1);
+
+    // the helpers of all concurrent queries are limited to the number of cpus
+    size_t running = __atomic_load_n(&rrd2rrdr_parallel_threads_running, __ATOMIC_RELAXED);
+    size_t helpers;
+    do {
+        size_t available = (running < rrd2rrdr_parallel_threads_max) ? rrd2rrdr_parallel_threads_max - running : 0;
+        helpers = MIN(wanted, available);
+        if(!helpers)
+            return 0;
+
+    } while(!__atomic_compare_exchange_n(&rrd2rrdr_parallel_threads_running, &running, running + helpers,
+                                         false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    return helpers;
+}
+
+static void rrd2rrdr_parallel_helpers_release(size_t helpers) {
+    __atomic_sub_fetch(&rrd2rrdr_parallel_threads_running, helpers, __ATOMIC_RELAXED);
+}
+
+struct rrd2rrdr_parallel {
+    RRDR *r;
+    RRDR *r_tmp;                        // the RRDR the serial loop would use (r, or its group by RRDR)
+    struct rrdr_view view;              // the view of the query, before any metric is merged
+    size_t lookahead;                   // the queries each thread prepares ahead
+    size_t next;                        // the next metric to be claimed (atomic)
+    bool cancel;                        // atomic
+
+    netdata_mutex_t mutex;              // protects all below, r and the query target
+    bool have_min_max;
+    struct rrd2rrdr_progress *progress;
+};
+
+static void rrd2rrdr_parallel_merge(struct rrd2rrdr_parallel *pq, RRDR *w, size_t d, size_t db_points_read, size_t result_points_generated) {
+    RRDR *r = pq->r;
+    RRDR *r_tmp = pq->r_tmp;
+    QUERY_TARGET *qt = r->internal.qt;
+    QUERY_METRIC *qm = query_metric(qt, d);
+    size_t rows = rrdr_rows(w);
+
+    netdata_mutex_lock(&pq->mutex);
+
+    memcpy(r_tmp->t, w->t, rows * sizeof(time_t));
+
+    if(r_tmp != r) {
+        // the query updates RRDR_DIMENSION_NONZERO
+        qm->status = w->od[0];
+        r_tmp->rows = w->rows;
+        rrd2rrdr_group_by_add_metric(r, w, d);
+    }
+    else {
+        for(size_t i = 0; i < rows ;i++) {
+            size_t idx = i * r->d + d;
+            r->v[idx] = w->v[i];
+            r->o[idx] = w->o[i];
+            r->ar[idx] = w->ar[i];
         }
-        else {
-            if(r->view.after != max_after) {
-                internal_error(true, "QUERY: 'after' mismatch between dimensions for chart '%s': max is %zu, dimension '%s' has %zu",
-                               rrdinstance_acquired_id(qi->ria), (size_t)max_after, rrdmetric_acquired_id(qd->rma), (size_t)r->view.after);
 
-                r->view.after = (r->view.after > max_after) ? r->view.after : max_after;
-            }
+        r->od[d] = w->od[0];
+        r->internal.queries_count++;
+    }
 
-            if(r->view.before != min_before) {
-                internal_error(true, "QUERY: 'before' mismatch between dimensions for chart '%s': max is %zu, dimension '%s' has %zu",
-                               rrdinstance_acquired_id(qi->ria), (size_t)min_before, rrdmetric_acquired_id(qd->rma), (size_t)r->view.before);
+    // w has the min and max of all the metrics it queried so far
+    if(!pq->have_min_max) {
+        r->view.min = w->view.min;
+        r->view.max = w->view.max;
+        pq->have_min_max = true;
+    }
+    else {
+        if(w->view.min < r->view.min) r->view.min = w->view.min;
+        if(w->view.max > r->view.max) r->view.max = w->view.max;
+    }
 
-                r->view.before = (r->view.before < min_before) ? r->view.before : min_before;
-            }
+    r->view.after = w->view.after;
+    r->view.before = w->view.before;
+    r->rows = w->rows;
 
-            if(r->rows != max_rows) {
-                internal_error(true, "QUERY: 'rows' mismatch between dimensions for chart '%s': max is %zu, dimension '%s' has %zu",
-                               rrdinstance_acquired_id(qi->ria), (size_t)max_rows, rrdmetric_acquired_id(qd->rma), (size_t)r->rows);
+    r_tmp->stats.db_points_read += db_points_read;
+    r_tmp->stats.result_points_generated += result_points_generated;
 
-                r->rows = (r->rows > max_rows) ? r->rows : max_rows;
-            }
+    rrd2rrdr_query_metric_queried(qt, d);
+
+    if(rrd2rrdr_query_metric_completed(r, pq->progress, d))
+        __atomic_store_n(&pq->cancel, true, __ATOMIC_RELAXED);
+
+    netdata_mutex_unlock(&pq->mutex);
+}
+
+static void rrd2rrdr_parallel_worker(struct rrd2rrdr_parallel *pq) {
+    RRDR *r = pq->r;
+    QUERY_TARGET *qt = r->internal.qt;
+
+    ONEWAYALLOC *owa = onewayalloc_create(0);
+    RRDR *w = rrdr_create(owa, qt, 1, qt->window.points);
+    w->view = pq->view;
+    w->time_grouping.points_wanted = r->time_grouping.points_wanted;
+    w->time_grouping.resampling_group = r->time_grouping.resampling_group;
+    w->time_grouping.resampling_divisor = r->time_grouping.resampling_divisor;
+    rrdr_set_grouping_function(w, qt->window.group_method);
+    w->time_grouping.create(w, qt->window.group_options);
+
+    QUERY_ENGINE_OPS *ops[RRD2RRDR_PARALLEL_MAX_LOOKAHEAD];
+    size_t ids[RRD2RRDR_PARALLEL_MAX_LOOKAHEAD];
+    size_t head = 0, prepared = 0;
+
+    while(true) {
+        // keep a few queries prepared, so that their pages are loaded while we work
+        while(prepared < pq->lookahead && !__atomic_load_n(&pq->cancel, __ATOMIC_RELAXED)) {
+            size_t d = __atomic_fetch_add(&pq->next, 1, __ATOMIC_RELAXED);
+            if(d >= qt->query.used)
+                break;
+
+            size_t slot = (head + prepared) % pq->lookahead;
+            ids[slot] = d;
+            ops[slot] = rrd2rrdr_query_ops_prep(w, d);
+            prepared++;
         }
 
-        dimensions_used++;
+        if(!prepared)
+            break;
+
+        size_t d = ids[head];
+        QUERY_ENGINE_OPS *o = ops[head];
+        head = (head + 1) % pq->lookahead;
+        prepared--;
 
-        bool cancel = false;
-        if (qt->request.interrupt_callback && qt->request.interrupt_callback(qt->request.interrupt_callback_data)) {
-            cancel = true;
-            log_access("QUERY INTERRUPTED");
+        if(unlikely(!o)) {
+            netdata_mutex_lock(&pq->mutex);
+            rrd2rrdr_query_metric_failed(qt, d);
+            netdata_mutex_unlock(&pq->mutex);
+            continue;
         }
 
-        if (qt->request.timeout && ((NETDATA_DOUBLE)dt_usec(&query_start_time, &query_current_time) / 1000.0) > (NETDATA_DOUBLE)qt->request.timeout) {
-            cancel = true;
-            log_access("QUERY CANCELED RUNTIME EXCEEDED %0.2f ms (LIMIT %lld ms)",
-                       (NETDATA_DOUBLE)dt_usec(&query_start_time, &query_current_time) / 1000.0, (long long)qt->request.timeout);
+        if(unlikely(__atomic_load_n(&pq->cancel, __ATOMIC_RELAXED))) {
+            query_planer_finalize_remaining_plans(o);
+            rrd2rrdr_query_ops_release(o);
+            continue;
         }
 
-        if(cancel) {
-            r->view.flags |= RRDR_RESULT_FLAG_CANCEL;
+        size_t db_points_read = w->stats.db_points_read;
+        size_t result_points_generated = w->stats.result_points_generated;
 
-            for(size_t i = d + 1; i < queries_prepared ; i++) {
-                if(ops[i]) {
-                    query_planer_finalize_remaining_plans(ops[i]);
-                    rrd2rrdr_query_ops_release(ops[i]);
-                    ops[i] = NULL;
-                }
-            }
+        w->od[0] = query_metric(qt, d)->status;
+        w->time_grouping.reset(w);
+        rrd2rrdr_query_execute(w, 0, o);
+        w->od[0] |= RRDR_DIMENSION_QUERIED;
+        rrd2rrdr_query_ops_release(o);
 
-            break;
-        }
+        db_points_read = w->stats.db_points_read - db_points_read;
+        result_points_generated = w->stats.result_points_generated - result_points_generated;
+        global_statistics_rrdr_query_completed(1, db_points_read, result_points_generated, qt->request.query_source);
+
+        rrd2rrdr_parallel_merge(pq, w, d, db_points_read, result_points_generated);
+    }
+
+    w->time_grouping.free(w);
+    rrd2rrdr_query_ops_freeall(w);
+    onewayalloc_destroy(owa);
+}
+
+static void *rrd2rrdr_parallel_worker_thread(void *ptr) {
+    rrd2rrdr_parallel_worker(ptr);
+    return NULL;
+}
+
+static void rrd2rrdr_query_parallel(RRDR *r, struct rrd2rrdr_progress *p, size_t helpers) {
+    struct rrd2rrdr_parallel pq = {
+            .r = r,
+            .r_tmp = r->group_by.r ? r->group_by.r : r,
+            .view = r->view,
+            .lookahead = MAX(2, MIN(RRD2RRDR_PARALLEL_MAX_LOOKAHEAD, (size_t)libuv_worker_threads * 10 / (helpers + 1))),
+            .next = 0,
+            .cancel = false,
+            .have_min_max = false,
+            .progress = p,
+    };
+    netdata_mutex_init(&pq.mutex);
+
+    netdata_thread_t *workers = callocz(helpers, sizeof(netdata_thread_t));
+    for(size_t t = 0; t < helpers ;t++)
+        netdata_thread_create(&workers[t], "QUERY_PARALLEL", NETDATA_THREAD_OPTION_JOINABLE | NETDATA_THREAD_OPTION_DONT_LOG,
+                              rrd2rrdr_parallel_worker_thread, &pq);
+
+    // this thread works too
+    rrd2rrdr_parallel_worker(&pq);
+
+    for(size_t t = 0; t < helpers ;t++)
+        netdata_thread_join(workers[t], NULL);
+
+    freez(workers);
+    netdata_mutex_destroy(&pq.mutex);
+}
+
+// ----------------------------------------------------------------------------
+// query entry point
+
+RRDR *rrd2rrdr_legacy(
+        ONEWAYALLOC *owa,
+        RRDSET *st, size_t points, time_t after, time_t before,
+        RRDR_TIME_GROUPING group_method, time_t resampling_time, RRDR_OPTIONS options, const char *dimensions,
+        const char *group_options, time_t timeout, size_t tier, QUERY_SOURCE query_source,
+        STORAGE_PRIORITY priority) {
+
+    QUERY_TARGET_REQUEST qtr = {
+            .version = 1,
+            .st = st,
+            .points = points,
+            .after = after,
+            .before = before,
+            .time_group_method = group_method,
+            .resampling_time = resampling_time,
+            .options = options,
+            .dimensions = dimensions,
+            .time_group_options = group_options,
+            .timeout = timeout,
+            .tier = tier,
+            .query_source = query_source,
+            .priority = priority,
+    };
+
+    return rrd2rrdr(owa, query_target_create(&qtr));
+}
+
+RRDR *rrd2rrdr(ONEWAYALLOC *owa, QUERY_TARGET *qt) {
+    if(!qt)
+        return NULL;
+
+    if(!owa) {
+        query_target_release(qt);
+        return NULL;
     }
 
+    // qt.window members are the WANTED ones.
+    // qt.request members are the REQUESTED ones.
+
+    RRDR *r = rrd2rrdr_group_by_initialize(owa, qt);
+    if(!r)
+        return NULL;
+
+    if(qt->window.relative)
+        r->view.flags |= RRDR_RESULT_FLAG_RELATIVE;
+    else
+        r->view.flags |= RRDR_RESULT_FLAG_ABSOLUTE;
+
+    // -------------------------------------------------------------------------
+    // initialize RRDR
+
+    r->view.group = qt->window.group;
+    r->view.update_every = (int) (qt->window.group * qt->window.query_granularity);
+    r->view.before = qt->window.before;
+    r->view.after = qt->window.after;
+    r->view.options = qt->window.options;
+    r->time_grouping.points_wanted = qt->window.points;
+    r->time_grouping.resampling_group = qt->window.resampling_group;
+    r->time_grouping.resampling_divisor = qt->window.resampling_divisor;
+
+    if(r->group_by.r) {
+        r->group_by.r->view = r->view;
+        r->group_by.r->time_grouping = r->time_grouping;
+    }
+
+    RRDR *r_tmp = r->group_by.r ? r->group_by.r : r;
+
+    // -------------------------------------------------------------------------
+    // assign the processor functions
+    rrdr_set_grouping_function(r_tmp, qt->window.group_method);
+
+    // allocate any memory required by the grouping method
+    r_tmp->time_grouping.create(r_tmp, qt->window.group_options);
+
+    // -------------------------------------------------------------------------
+    // do the work for each dimension
+
+    struct rrd2rrdr_progress progress = { 0 };
+    if (qt->request.timeout)
+        now_realtime_timeval(&progress.query_start_time);
+
+    internal_fatal(released_ops, "QUERY: released_ops should be NULL when the query starts");
+
+    size_t helpers = rrd2rrdr_parallel_helpers_reserve(qt);
+    if(helpers) {
+        rrd2rrdr_query_parallel(r, &progress, helpers);
+        rrd2rrdr_parallel_helpers_release(helpers);
+    }
+    else
+        rrd2rrdr_query_serial(r, r_tmp, &progress);
+
     // free all resources used by the grouping method
     r_tmp->time_grouping.free(r_tmp);
 
     rrd2rrdr_group_by_finalize(r);
 
 #ifdef NETDATA_INTERNAL_CHECKS
-    if (dimensions_used && !(r->view.flags & RRDR_RESULT_FLAG_CANCEL)) {
+    if (progress.dimensions_used && !(r->view.flags & RRDR_RESULT_FLAG_CANCEL)) {
         if(r->internal.log)
             rrd2rrdr_log_request_response_metadata(r, qt->window.options, qt->window.group_method, qt->window.aligned, qt->window.group, qt->request.resampling_time, qt->window.resampling_group,
                                                    qt->window.after, qt->request.after, qt->window.before, qt->request.before,
@@ -3322,19 +3761,12 @@ RRDR *rrd2rrdr(ONEWAYALLOC *owa, QUERY_TARGET *qt) {
     }
 #endif
 
-    // free the query pipelining ops
-    for(size_t d = 0; d < qt->query.used ; d++) {
-        rrd2rrdr_query_ops_release(ops[d]);
-        ops[d] = NULL;
-    }
     rrd2rrdr_query_ops_freeall(r);
     internal_fatal(released_ops, "QUERY: released_ops should be NULL when the query ends");
 
-    onewayalloc_freez(owa, ops);
-
-    if(likely(dimensions_used)) {
+    if(likely(progress.dimensions_used)) {
         // when all the dimensions are zero, we should return all of them
-        if (unlikely((qt->window.options & RRDR_OPTION_NONZERO) && !dimensions_nonzero &&
+        if (unlikely((qt->window.options & RRDR_OPTION_NONZERO) && !progress.dimensions_nonzero &&
                      !(r->view.flags & RRDR_RESULT_FLAG_CANCEL))) {
             // all the dimensions are zero
             // mark them as NONZERO to send them all
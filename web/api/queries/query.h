@@ -49,6 +49,7 @@ typedef enum rrdr_time_grouping {
 
 const char *time_grouping_method2string(RRDR_TIME_GROUPING group);
 void time_grouping_init(void);
+void rrd2rrdr_parallel_init(void);
 RRDR_TIME_GROUPING time_grouping_parse(const char *name, RRDR_TIME_GROUPING def);
 const char *time_grouping_tostring(RRDR_TIME_GROUPING group);
 
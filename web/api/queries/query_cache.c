@@ -0,0 +1,454 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "query_cache.h"
+#include "web/api/web_api_v1.h"
+
+#define QUERY_CACHE_BUCKETS 4096                // must be a power of 2
+#define QUERY_CACHE_MAX_ENTRY_SIZE_RATIO 16     // a result cannot use more than 1/16 of the cache
+
+typedef struct query_cache_entry {
+    uint32_t hash;
+    char *key;
+    size_t key_len;
+
+    bool pending;                               // the query is running, there is no result yet
+
+    // the result
+    char *data;
+    size_t len;
+    HTTP_CONTENT_TYPE content_type;
+    BUFFER_OPTIONS options;
+    time_t latest_timestamp;
+
+    // the metrics and the retention the result was made from
+    time_t created_s;
+    time_t db_first_time_s;
+    time_t db_last_time_s;
+    uint32_t metrics;
+    uint64_t contexts_hard_hash;
+    uint64_t backfills;                         // replication may fill gaps without changing the retention
+
+    struct query_cache_entry *prev, *next;      // the LRU list, the most recently used first
+    struct query_cache_entry *bucket_next;      // the next entry of the same bucket
+} QUERY_CACHE_ENTRY;
+
+static struct {
+    size_t max_size;                            // zero disables the cache
+    time_t max_age_s;
+
+    netdata_mutex_t mutex;
+    pthread_cond_t cond;                        // signaled when a pending query is done
+
+    size_t size;                                // the memory used by the entries
+    size_t entries;
+    QUERY_CACHE_ENTRY *lru;
+    QUERY_CACHE_ENTRY *buckets[QUERY_CACHE_BUCKETS];
+} query_cache = {
+        .max_size = 16 * 1024 * 1024,
+        .max_age_s = 60,
+        .mutex = NETDATA_MUTEX_INITIALIZER,
+        .cond = PTHREAD_COND_INITIALIZER,
+        .size = 0,
+        .entries = 0,
+        .lru = NULL,
+        .buckets = { NULL },
+};
+
+void query_cache_init(void) {
+    long long size_mb = config_get_number(CONFIG_SECTION_WEB, "query result cache size MB", (long long)(query_cache.max_size / 1024 / 1024));
+    if(size_mb < 0) {
+        size_mb = 0;
+        config_set_number(CONFIG_SECTION_WEB, "query result cache size MB", size_mb);
+    }
+    query_cache.max_size = (size_t)size_mb * 1024 * 1024;
+
+    long long max_age_s = config_get_number(CONFIG_SECTION_WEB, "query result cache max age", (long long)query_cache.max_age_s);
+    if(max_age_s < 1) {
+        max_age_s = 1;
+        config_set_number(CONFIG_SECTION_WEB, "query result cache max age", max_age_s);
+    }
+    query_cache.max_age_s = (time_t)max_age_s;
+}
+
+// ----------------------------------------------------------------------------
+// the key of a query
+
+static inline const char *query_cache_str(const char *s) {
+    return s ? s : "";
+}
+
+static bool query_cache_key_generate(QUERY_CACHE_KEY *qck, QUERY_TARGET *qt) {
+    QUERY_TARGET_REQUEST *qtr = &qt->request;
+
+    // internal queries are given acquired items, not patterns
+    if(qtr->rca || qtr->ria || qtr->rma || !qt->query.used)
+        return false;
+
+    BUFFER *key = buffer_create(1024, &netdata_buffers_statistics.buffers_api);
+
+    buffer_sprintf(key, "v%zu|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s",
+                   qtr->version,
+                   qtr->host ? qtr->host->machine_guid : "",
+                   qtr->st ? qtr->st->rrdhost->machine_guid : "",
+                   qtr->st ? rrdset_id(qtr->st) : "",
+                   query_cache_str(qtr->scope_nodes),
+                   query_cache_str(qtr->scope_contexts),
+                   query_cache_str(qtr->nodes),
+                   query_cache_str(qtr->contexts),
+                   query_cache_str(qtr->instances),
+                   query_cache_str(qtr->dimensions),
+                   query_cache_str(qtr->chart_label_key),
+                   query_cache_str(qtr->labels),
+                   query_cache_str(qtr->alerts));
+
+    buffer_sprintf(key, "|%ld|%ld|%zu|%u|%llu|%zu|%ld|%u|%s|%u|%s|%u",
+                   (long)qtr->after, (long)qtr->before, qtr->points,
+                   qtr->format, (unsigned long long)qtr->options, qtr->tier, (long)qtr->resampling_time,
+                   (unsigned)qtr->time_group_method, query_cache_str(qtr->time_group_options),
+                   (unsigned)qtr->group_by, query_cache_str(qtr->group_by_label), (unsigned)qtr->group_by_aggregate_function);
+
+    // the absolute window the request has been resolved to
+    buffer_sprintf(key, "|%ld|%ld|%zu",
+                   (long)qt->window.after, (long)qt->window.before, qt->window.points);
+
+    qck->key = key;
+    qck->hash = simple_hash(buffer_tostring(key));
+    qck->owner = false;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// the entries - all these are called with the mutex locked
+
+static QUERY_CACHE_ENTRY *query_cache_find(QUERY_CACHE_KEY *qck) {
+    QUERY_CACHE_ENTRY *e;
+    for(e = query_cache.buckets[qck->hash & (QUERY_CACHE_BUCKETS - 1)]; e ; e = e->bucket_next) {
+        if(e->hash == qck->hash && e->key_len == buffer_strlen(qck->key) && !strcmp(e->key, buffer_tostring(qck->key)))
+            return e;
+    }
+
+    return NULL;
+}
+
+static inline size_t query_cache_entry_size(QUERY_CACHE_ENTRY *e) {
+    return sizeof(QUERY_CACHE_ENTRY) + e->key_len + 1 + e->len;
+}
+
+static QUERY_CACHE_ENTRY *query_cache_add_pending(QUERY_CACHE_KEY *qck) {
+    QUERY_CACHE_ENTRY *e = callocz(1, sizeof(QUERY_CACHE_ENTRY));
+    e->hash = qck->hash;
+    e->key = strdupz(buffer_tostring(qck->key));
+    e->key_len = buffer_strlen(qck->key);
+    e->pending = true;
+
+    QUERY_CACHE_ENTRY **bucket = &query_cache.buckets[e->hash & (QUERY_CACHE_BUCKETS - 1)];
+    e->bucket_next = *bucket;
+    *bucket = e;
+
+    DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(query_cache.lru, e, prev, next);
+    query_cache.entries++;
+    query_cache.size += query_cache_entry_size(e);
+
+    return e;
+}
+
+static void query_cache_entry_data_free(QUERY_CACHE_ENTRY *e) {
+    query_cache.size -= e->len;
+    freez(e->data);
+    e->data = NULL;
+    e->len = 0;
+}
+
+static void query_cache_del(QUERY_CACHE_ENTRY *e) {
+    QUERY_CACHE_ENTRY **ptr = &query_cache.buckets[e->hash & (QUERY_CACHE_BUCKETS - 1)];
+    while(*ptr != e)
+        ptr = &(*ptr)->bucket_next;
+    *ptr = e->bucket_next;
+
+    DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(query_cache.lru, e, prev, next);
+    query_cache.entries--;
+
+    query_cache_entry_data_free(e);
+    query_cache.size -= query_cache_entry_size(e);
+
+    freez(e->key);
+    freez(e);
+}
+
+static void query_cache_evict(void) {
+    // the least recently used are evicted first - the pending ones are needed by their queries
+    QUERY_CACHE_ENTRY *e = query_cache.lru ? query_cache.lru->prev : NULL;
+    while(e && query_cache.size > query_cache.max_size) {
+        QUERY_CACHE_ENTRY *prev = (e == query_cache.lru) ? NULL : e->prev;
+
+        if(!e->pending)
+            query_cache_del(e);
+
+        e = prev;
+    }
+}
+
+// can the cached result be used for the query?
+static bool query_cache_entry_is_valid(QUERY_CACHE_ENTRY *e, QUERY_TARGET *qt) {
+    if(e->metrics != qt->query.used || e->contexts_hard_hash != qt->versions.contexts_hard_hash ||
+       e->backfills != qt->versions.backfills)
+        return false;
+
+    if(now_realtime_sec() - e->created_s >= query_cache.max_age_s)
+        return false;
+
+    if(e->db_first_time_s == qt->db.first_time_s && e->db_last_time_s == qt->db.last_time_s)
+        return true;
+
+    // the JSON wrapper includes the retention of the metrics
+    if(qt->request.options & RRDR_OPTION_JSON_WRAP)
+        return false;
+
+    // retention changes outside the window of the query do not change its result
+    if(e->db_first_time_s != qt->db.first_time_s && qt->window.after <= MAX(e->db_first_time_s, qt->db.first_time_s))
+        return false;
+
+    if(e->db_last_time_s != qt->db.last_time_s && qt->window.before >= MIN(e->db_last_time_s, qt->db.last_time_s))
+        return false;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// the API
+
+bool query_cache_get(QUERY_CACHE_KEY *qck, QUERY_TARGET *qt, BUFFER *wb, time_t *latest_timestamp) {
+    qck->key = NULL;
+    qck->owner = false;
+
+    if(!query_cache.max_size || !query_cache_key_generate(qck, qt))
+        return false;
+
+    usec_t wait_until_ut = qt->request.timeout ? now_monotonic_usec() + qt->request.timeout * USEC_PER_MS : 0;
+    bool found = false;
+
+    netdata_mutex_lock(&query_cache.mutex);
+
+    while(true) {
+        QUERY_CACHE_ENTRY *e = query_cache_find(qck);
+
+        if(!e) {
+            // we will execute the query - the same queries will wait for us
+            query_cache_add_pending(qck);
+            qck->owner = true;
+            break;
+        }
+
+        if(e->pending) {
+            if(wait_until_ut && now_monotonic_usec() >= wait_until_ut)
+                // we cannot wait more - execute the query without caching it
+                break;
+
+            struct timespec tp;
+            clock_gettime(CLOCK_REALTIME, &tp);
+            tp.tv_sec += 1;
+
+            // the mutex is unlocked within pthread_cond_timedwait()
+            pthread_cond_timedwait(&query_cache.cond, &query_cache.mutex, &tp);
+            continue;
+        }
+
+        if(!query_cache_entry_is_valid(e, qt)) {
+            // we will execute the query again
+            query_cache_entry_data_free(e);
+            e->pending = true;
+            qck->owner = true;
+            break;
+        }
+
+        buffer_fast_strcat(wb, e->data, e->len);
+        wb->content_type = e->content_type;
+        if(e->options & WB_CONTENT_CACHEABLE)
+            buffer_cacheable(wb);
+        else if(e->options & WB_CONTENT_NO_CACHEABLE)
+            buffer_no_cacheable(wb);
+
+        if(latest_timestamp && e->latest_timestamp)
+            *latest_timestamp = e->latest_timestamp;
+
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(query_cache.lru, e, prev, next);
+        DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(query_cache.lru, e, prev, next);
+
+        found = true;
+        break;
+    }
+
+    netdata_mutex_unlock(&query_cache.mutex);
+
+    if(found || !qck->owner) {
+        buffer_free(qck->key);
+        qck->key = NULL;
+    }
+
+    return found;
+}
+
+void query_cache_put(QUERY_CACHE_KEY *qck, QUERY_TARGET *qt, BUFFER *wb, size_t wb_start, int ret, time_t latest_timestamp) {
+    if(!qck->key)
+        return;
+
+    size_t len = (buffer_strlen(wb) > wb_start) ? buffer_strlen(wb) - wb_start : 0;
+
+    netdata_mutex_lock(&query_cache.mutex);
+
+    QUERY_CACHE_ENTRY *e = query_cache_find(qck);
+    if(e && e->pending && qck->owner) {
+        if(ret == HTTP_RESP_OK && len && len <= query_cache.max_size / QUERY_CACHE_MAX_ENTRY_SIZE_RATIO) {
+            e->data = mallocz(len);
+            memcpy(e->data, &wb->buffer[wb_start], len);
+            e->len = len;
+            e->content_type = wb->content_type;
+            e->options = wb->options;
+            e->latest_timestamp = latest_timestamp;
+
+            e->created_s = now_realtime_sec();
+            e->db_first_time_s = qt->db.first_time_s;
+            e->db_last_time_s = qt->db.last_time_s;
+            e->metrics = qt->query.used;
+            e->contexts_hard_hash = qt->versions.contexts_hard_hash;
+            e->backfills = qt->versions.backfills;
+
+            e->pending = false;
+            query_cache.size += len;
+            query_cache_evict();
+        }
+        else
+            query_cache_del(e);
+
+        pthread_cond_broadcast(&query_cache.cond);
+    }
+
+    netdata_mutex_unlock(&query_cache.mutex);
+
+    buffer_free(qck->key);
+    qck->key = NULL;
+    qck->owner = false;
+}
+
+// ----------------------------------------------------------------------------
+// unittest
+
+static void query_cache_cleanup(void) {
+    netdata_mutex_lock(&query_cache.mutex);
+    while(query_cache.lru)
+        query_cache_del(query_cache.lru);
+    netdata_mutex_unlock(&query_cache.mutex);
+}
+
+static int query_cache_unittest_query(const char *name, QUERY_TARGET *qt, const char *result, int ret, bool expect_cached) {
+    BUFFER *wb = buffer_create(0, NULL);
+    QUERY_CACHE_KEY qck;
+    time_t latest_timestamp = 0;
+    int errors = 0;
+
+    buffer_strcat(wb, "prefix:");
+    size_t wb_start = buffer_strlen(wb);
+
+    bool cached = query_cache_get(&qck, qt, wb, &latest_timestamp);
+    if(cached != expect_cached) {
+        fprintf(stderr, "QUERY CACHE: %s: expected the result to %sbe cached\n", name, expect_cached ? "" : "not ");
+        errors++;
+    }
+
+    if(!cached) {
+        buffer_strcat(wb, result);
+        query_cache_put(&qck, qt, wb, wb_start, ret, qt->window.before);
+    }
+    else if(strcmp(&wb->buffer[wb_start], result) != 0 || latest_timestamp != qt->window.before) {
+        fprintf(stderr, "QUERY CACHE: %s: the cached result is '%s', expected '%s'\n", name, &wb->buffer[wb_start], result);
+        errors++;
+    }
+
+    fprintf(stderr, "QUERY CACHE: %s - %s\n", name, errors ? "FAILED" : "OK");
+
+    buffer_free(wb);
+    return errors;
+}
+
+int query_cache_unittest(void) {
+    size_t max_size = query_cache.max_size;
+    query_cache.max_size = 1024 * 1024;
+    int errors = 0;
+
+    QUERY_TARGET *qt = callocz(1, sizeof(QUERY_TARGET));
+    qt->request.version = 1;
+    qt->request.contexts = "system.cpu";
+    qt->request.after = -600;
+    qt->request.points = 600;
+    qt->query.used = 10;
+    qt->db.first_time_s = 1000;
+    qt->db.last_time_s = 5000;
+    qt->window.after = 4400;
+    qt->window.before = 5000;
+    qt->window.points = 600;
+
+    errors += query_cache_unittest_query("first query", qt, "result1", HTTP_RESP_OK, false);
+    errors += query_cache_unittest_query("same query", qt, "result1", HTTP_RESP_OK, true);
+
+    qt->db.last_time_s = 5001;
+    errors += query_cache_unittest_query("new points in the window", qt, "result2", HTTP_RESP_OK, false);
+    errors += query_cache_unittest_query("same query after new points", qt, "result2", HTTP_RESP_OK, true);
+
+    qt->db.first_time_s = 2000;
+    errors += query_cache_unittest_query("retention changed outside the window", qt, "result2", HTTP_RESP_OK, true);
+
+    qt->query.used = 11;
+    errors += query_cache_unittest_query("metrics changed", qt, "result3", HTTP_RESP_OK, false);
+
+    qt->window.before = 4000;
+    qt->window.after = 3000;
+    errors += query_cache_unittest_query("historical window", qt, "result4", HTTP_RESP_OK, false);
+    qt->db.last_time_s = 6000;
+    errors += query_cache_unittest_query("historical window after new points", qt, "result4", HTTP_RESP_OK, true);
+    qt->db.first_time_s = 3500;
+    errors += query_cache_unittest_query("historical window after retention changed", qt, "result5", HTTP_RESP_OK, false);
+    qt->versions.backfills++;
+    errors += query_cache_unittest_query("historical window after replication", qt, "result5b", HTTP_RESP_OK, false);
+    errors += query_cache_unittest_query("historical window again", qt, "result5b", HTTP_RESP_OK, true);
+
+    qt->request.options |= RRDR_OPTION_JSON_WRAP;
+    errors += query_cache_unittest_query("failed query", qt, "error", HTTP_RESP_INTERNAL_SERVER_ERROR, false);
+    errors += query_cache_unittest_query("failed query again", qt, "result6", HTTP_RESP_OK, false);
+    qt->db.last_time_s = 6001;
+    errors += query_cache_unittest_query("json wrapped after new points", qt, "result7", HTTP_RESP_OK, false);
+
+    // fill the cache
+    char result[4096];
+    memset(result, 'x', sizeof(result) - 1);
+    result[sizeof(result) - 1] = '\0';
+    for(size_t i = 0; i < 1000 ; i++) {
+        qt->window.points = 1000 + i;
+
+        BUFFER *wb = buffer_create(0, NULL);
+        QUERY_CACHE_KEY qck;
+        if(!query_cache_get(&qck, qt, wb, NULL)) {
+            buffer_strcat(wb, result);
+            query_cache_put(&qck, qt, wb, 0, HTTP_RESP_OK, 0);
+        }
+        buffer_free(wb);
+    }
+
+    if(query_cache.size > query_cache.max_size) {
+        fprintf(stderr, "QUERY CACHE: the cache uses %zu bytes, more than its size %zu\n", query_cache.size, query_cache.max_size);
+        errors++;
+    }
+    else
+        fprintf(stderr, "QUERY CACHE: %zu results cached in %zu bytes - OK\n", query_cache.entries, query_cache.size);
+
+    query_cache_cleanup();
+    if(query_cache.size || query_cache.entries) {
+        fprintf(stderr, "QUERY CACHE: %zu bytes and %zu entries are left after cleanup\n", query_cache.size, query_cache.entries);
+        errors++;
+    }
+
+    freez(qt);
+    query_cache.max_size = max_size;
+
+    fprintf(stderr, "QUERY CACHE: %d errors\n", errors);
+    return errors;
+}
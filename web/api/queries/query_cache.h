@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_API_QUERY_CACHE_H
+#define NETDATA_API_QUERY_CACHE_H 1
+
+#include "libnetdata/libnetdata.h"
+
+// ----------------------------------------------------------------------------
+// Cache of data query results
+//
+// The output of data queries is cached, keyed on their normalized request (the
+// metrics selected, the grouping, the options, the format and the absolute window
+// they have been resolved to). A cached result is used only while the metrics it
+// was made from and their retention are the same, so queries including the latest
+// points use it until new points are collected, and queries of older timeframes
+// use it until the data of their window are rotated out of the database, or
+// replication stores points to their metrics (filling gaps within their retention).
+//
+// When the same query is already running, the other requests for it wait for its
+// result, instead of executing it again.
+
+struct query_target;
+
+typedef struct query_cache_key {
+    BUFFER *key;                        // NULL when the result of the query will not be cached
+    uint32_t hash;
+    bool owner;                         // true when this query will give its result to the others
+} QUERY_CACHE_KEY;
+
+void query_cache_init(void);
+
+// returns true when the result has been appended to wb from the cache
+// otherwise the caller executes the query and gives its result to query_cache_put()
+bool query_cache_get(QUERY_CACHE_KEY *qck, struct query_target *qt, BUFFER *wb, time_t *latest_timestamp);
+
+// caches the result of the query appended to wb after wb_start (only when ret is HTTP_RESP_OK)
+void query_cache_put(QUERY_CACHE_KEY *qck, struct query_target *qt, BUFFER *wb, size_t wb_start, int ret, time_t latest_timestamp);
+
+int query_cache_unittest(void);
+
+#endif //NETDATA_API_QUERY_CACHE_H
@@ -115,7 +115,7 @@ typedef struct rrdresult {
     NETDATA_DOUBLE *ar;       // array n x d of anomaly rates (0 - 100)
     uint32_t *gbc;            // array n x d of group by count - NOT ALLOCATED when RRDR is created
 
-    struct {
+    struct rrdr_view {
         size_t group;         // how many collected values were grouped for each row - NEEDED BY GROUPING FUNCTIONS
         time_t after;
         time_t before;
@@ -131,6 +131,12 @@ typedef struct rrdresult {
         size_t result_points_generated;
     } stats;
 
+    struct {
+        size_t slice;                       // the slice of the result in this RRDR, 0 for the first (or the only one)
+        size_t rows;                        // the rows of the result generated by the previous slices
+        bool more;                          // more slices of the result will follow this one
+    } stream;
+
     struct {
         void *data;                         // the internal data of the grouping function
 
@@ -187,6 +193,7 @@ RRDR *rrd2rrdr_legacy(
         STORAGE_PRIORITY priority);
 
 RRDR *rrd2rrdr(ONEWAYALLOC *owa, struct query_target *qt);
+extern size_t rrd2rrdr_parallel_threads;
 bool query_target_calculate_window(struct query_target *qt);
 
 bool rrdr_relative_window_to_absolute(time_t *after, time_t *before, time_t *now_ptr);
@@ -100,6 +100,8 @@ void web_client_api_v1_init(void) {
         api_v1_data_google_formats[i].hash = simple_hash(api_v1_data_google_formats[i].name);
 
     time_grouping_init();
+    rrd2rrdr_parallel_init();
+    data_query_init();
 
 	uuid_t uuid;
 
@@ -712,6 +714,12 @@ static inline int web_client_api_request_v1_data(RRDHOST *host, struct web_clien
             .labels = chart_labels_filter,
             .query_source = QUERY_SOURCE_API_DATA,
             .priority = STORAGE_PRIORITY_NORMAL,
+            .interrupt_callback = web_client_interrupt_callback,
+            .interrupt_callback_data = w,
+
+            // google responses may be replaced after the query, so they are not streamed
+            .flush_callback = (format == DATASOURCE_DATATABLE_JSONP) ? NULL : web_client_flush_callback,
+            .flush_callback_data = w,
     };
     qt = query_target_create(&qtr);
 
@@ -16,9 +16,12 @@ long web_client_streaming_rate_t = 0L;
 #define WORKER_JOB_RCV_DATA       6
 #define WORKER_JOB_SND_DATA       7
 #define WORKER_JOB_PROCESS        8
+#define WORKER_JOB_QUERIES_DONE   9
+#define WORKER_JOB_QUERY_HIGH    10
+#define WORKER_JOB_QUERY_LOW     11
 
-#if (WORKER_UTILIZATION_MAX_JOB_TYPES < 9)
-#error Please increase WORKER_UTILIZATION_MAX_JOB_TYPES to at least 8
+#if (WORKER_UTILIZATION_MAX_JOB_TYPES < 12)
+#error Please increase WORKER_UTILIZATION_MAX_JOB_TYPES to at least 12
 #endif
 
 /*
@@ -63,6 +66,13 @@ struct web_server_static_threaded_worker {
 
     volatile size_t files_read;
     volatile size_t file_reads;
+
+    // the queries of the clients of this worker, executed by the query threads
+    size_t queries_running;                 // queries given to the query threads, not sent yet
+    netdata_mutex_t queries_mutex;          // protects queries_done and queries_pipe
+    struct web_server_query *queries_done;  // queries executed, waiting to be sent by this worker
+    int queries_pipe[2];                    // the query threads wake up this worker via this pipe
+    size_t queries_pipe_slot;               // the POLLINFO slot of the pipe, 0 when not polled
 };
 
 static long long static_threaded_workers_count = 1;
@@ -143,7 +153,7 @@ static int web_server_file_read_callback(POLLINFO *pi, short int *events) {
         POLLINFO *wpi = pollinfo_from_slot(p, w->pollinfo_slot);  // POLLINFO of the client socket
 
         debug(D_WEB_CLIENT, "%llu: SIGNALING W TO SEND (iFD %d, oFD %d)", w->id, pi->fd, wpi->fd);
-        p->fds[wpi->slot].events |= POLLOUT;
+        poll_fd_add_events(wpi, POLLOUT);
     }
 
     if(unlikely(ret <= 0 || w->ifd == w->ofd)) {
@@ -171,6 +181,347 @@ static int web_server_file_write_callback(POLLINFO *pi, short int *events) {
     return -1;
 }
 
+// ----------------------------------------------------------------------------
+// web server queries
+//
+// The queries (chart data, badges, weights, etc) are executed by a pool of query
+// threads, so that a slow query does not stall the other connections of the web
+// server thread that received it. The web server threads parse the requests and
+// process everything else themselves. High priority queries are executed before
+// the low priority ones. When a query is done, the query thread gives the client
+// back to its web server thread (which polls a pipe for this), to send the response.
+
+typedef struct web_server_query {
+    struct web_client *w;
+    struct web_server_static_threaded_worker *worker;   // the web server thread of the client
+    struct web_server_query *prev, *next;
+} WEB_SERVER_QUERY;
+
+static struct {
+    int threads;
+    netdata_thread_t *thread;
+
+    netdata_mutex_t mutex;
+    pthread_cond_t cond;
+    WEB_SERVER_QUERY *queue[WEB_CLIENT_QUERY_PRIORITIES];   // the queries waiting for a query thread
+} web_server_queries = {
+        .threads = 0,
+        .thread = NULL,
+        .mutex = NETDATA_MUTEX_INITIALIZER,
+        .cond = PTHREAD_COND_INITIALIZER,
+        .queue = { NULL },
+};
+
+static bool web_server_should_stop(void);
+
+// releases a client that disconnected while its query was queued or running
+// its socket is closed here, because the query may have been sending the response to it
+static void web_server_query_client_release(struct web_client *w) {
+    w->running = 0;
+    worker_private->queries_running--;
+
+    if(w->ofd != -1 && !web_client_flag_check(w, WEB_CLIENT_FLAG_DONT_CLOSE_SOCKET))
+        close(w->ofd);
+
+    w->ifd = w->ofd = -1;
+    web_client_release(w);
+}
+
+static void web_server_query_send(POLLJOB *p, struct web_client *w) {
+    if(unlikely(!w->pollinfo_slot)) {
+        debug(D_WEB_CLIENT, "%llu: CLIENT DISCONNECTED WHILE ITS QUERY WAS RUNNING", w->id);
+        web_server_query_client_release(w);
+        return;
+    }
+
+    w->running = 0;
+    worker_private->queries_running--;
+
+    POLLINFO *wpi = pollinfo_from_slot(p, w->pollinfo_slot);
+
+    debug(D_WEB_CLIENT, "%llu: QUERY DONE ON FD %d", w->id, wpi->fd);
+    web_client_finish_deferred_query(w);
+
+    short int events = 0;
+    if(unlikely(web_client_has_wait_receive(w)))
+        events |= POLLIN;
+
+    if(likely(web_client_has_wait_send(w)))
+        events |= POLLOUT;
+    else
+        // the send callback enables the timeouts again, when there is something to send
+        wpi->flags &= ~POLLINFO_FLAG_NO_TIMEOUT;
+
+    if(unlikely(web_server_check_client_status(w) == -1))
+        poll_close_fd(wpi);
+    else
+        poll_fd_add_events(wpi, events);
+}
+
+static int web_server_queries_rcv_callback(POLLINFO *pi, short int *events) {
+    worker_is_busy(WORKER_JOB_QUERIES_DONE);
+
+    POLLJOB *p = pi->p;
+
+    char buffer[256];
+    while(read(pi->fd, buffer, sizeof(buffer)) > 0) ;
+
+    netdata_mutex_lock(&worker_private->queries_mutex);
+    WEB_SERVER_QUERY *done = worker_private->queries_done;
+    worker_private->queries_done = NULL;
+    netdata_mutex_unlock(&worker_private->queries_mutex);
+
+    while(done) {
+        WEB_SERVER_QUERY *q = done;
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(done, q, prev, next);
+        web_server_query_send(p, q->w);
+        freez(q);
+    }
+
+    *events = POLLIN;
+
+    worker_is_idle();
+    return 0;
+}
+
+static int web_server_queries_snd_callback(POLLINFO *pi, short int *events) {
+    (void)pi;
+    (void)events;
+
+    error("Writing to the web server queries pipe is not supported!");
+    return -1;
+}
+
+static void *web_server_queries_add_callback(POLLINFO *pi, short int *events, void *data) {
+    (void)pi;
+
+    *events = POLLIN;
+    return data;
+}
+
+static void web_server_queries_del_callback(POLLINFO *pi) {
+    (void)pi;
+
+    // the pipe is closed when the worker stops - it is added again if needed
+    worker_private->queries_pipe_slot = 0;
+}
+
+static bool web_server_queries_pipe_add(POLLJOB *p) {
+    if(likely(worker_private->queries_pipe_slot))
+        return true;
+
+    if(worker_private->queries_pipe[PIPE_READ] == -1) {
+        int pipe_fds[2];
+        if(pipe(pipe_fds) != 0) {
+            error("WEB SERVER: cannot create the pipe of the query threads - queries will be executed by the web server threads.");
+            return false;
+        }
+
+        sock_setnonblock(pipe_fds[PIPE_READ]);
+        sock_setnonblock(pipe_fds[PIPE_WRITE]);
+
+        netdata_mutex_lock(&worker_private->queries_mutex);
+        worker_private->queries_pipe[PIPE_READ] = pipe_fds[PIPE_READ];
+        worker_private->queries_pipe[PIPE_WRITE] = pipe_fds[PIPE_WRITE];
+        netdata_mutex_unlock(&worker_private->queries_mutex);
+    }
+
+    POLLINFO *qpi = poll_add_fd(p
+                                , worker_private->queries_pipe[PIPE_READ]
+                                , 0
+                                , 0
+                                , POLLINFO_FLAG_CLIENT_SOCKET | POLLINFO_FLAG_NO_TIMEOUT | POLLINFO_FLAG_DONT_CLOSE
+                                , "QUERIES"
+                                , ""
+                                , ""
+                                , web_server_queries_add_callback
+                                , web_server_queries_del_callback
+                                , web_server_queries_rcv_callback
+                                , web_server_queries_snd_callback
+                                , NULL
+                                );
+
+    if(unlikely(!qpi))
+        return false;
+
+    worker_private->queries_pipe_slot = qpi->slot;
+    return true;
+}
+
+// gives the query of the client to the query threads
+// the POLLINFO of the client (and the events given to the callback) may be invalid after this call
+static bool web_server_query_enqueue(POLLJOB *p, struct web_client *w) {
+    if(unlikely(!web_server_queries.threads || web_server_should_stop() || !web_server_queries_pipe_add(p)))
+        return false;
+
+    // the client is not closed for being idle while its query runs
+    POLLINFO *wpi = pollinfo_from_slot(p, w->pollinfo_slot);
+    wpi->flags |= POLLINFO_FLAG_NO_TIMEOUT;
+
+    WEB_SERVER_QUERY *q = callocz(1, sizeof(WEB_SERVER_QUERY));
+    q->w = w;
+    q->worker = worker_private;
+
+    w->running = 1;
+    worker_private->queries_running++;
+
+    netdata_mutex_lock(&web_server_queries.mutex);
+    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(web_server_queries.queue[w->query_priority], q, prev, next);
+    pthread_cond_signal(&web_server_queries.cond);
+    netdata_mutex_unlock(&web_server_queries.mutex);
+
+    return true;
+}
+
+static void web_server_query_done(WEB_SERVER_QUERY *q) {
+    struct web_server_static_threaded_worker *worker = q->worker;
+
+    netdata_mutex_lock(&worker->queries_mutex);
+    DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(worker->queries_done, q, prev, next);
+
+    // when the pipe is full, the worker has not read it yet, so it will get this query too
+    if(worker->queries_pipe[PIPE_WRITE] != -1 &&
+       write(worker->queries_pipe[PIPE_WRITE], "", 1) == -1 && errno != EAGAIN && errno != EWOULDBLOCK)
+        error("WEB SERVER: cannot wake up web server thread %d for its queries", worker->id + 1);
+
+    netdata_mutex_unlock(&worker->queries_mutex);
+}
+
+static void *web_server_query_thread(void *ptr __maybe_unused) {
+    worker_register("WEBQUERY");
+    worker_register_job_name(WORKER_JOB_QUERY_HIGH, "high priority query");
+    worker_register_job_name(WORKER_JOB_QUERY_LOW, "low priority query");
+
+    netdata_mutex_lock(&web_server_queries.mutex);
+
+    while(true) {
+        WEB_SERVER_QUERY *q = NULL;
+        WEB_CLIENT_QUERY_PRIORITY priority;
+        for(priority = WEB_CLIENT_QUERY_HIGH; priority < WEB_CLIENT_QUERY_PRIORITIES && !q ; priority++)
+            q = web_server_queries.queue[priority];
+
+        if(!q) {
+            // the queries still queued are executed, so that their web server threads can stop
+            if(web_server_should_stop())
+                break;
+
+            struct timespec tp;
+            clock_gettime(CLOCK_REALTIME, &tp);
+            tp.tv_sec += 1;
+
+            // the mutex is unlocked within pthread_cond_timedwait()
+            pthread_cond_timedwait(&web_server_queries.cond, &web_server_queries.mutex, &tp);
+            continue;
+        }
+
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(web_server_queries.queue[q->w->query_priority], q, prev, next);
+        netdata_mutex_unlock(&web_server_queries.mutex);
+
+        worker_is_busy(q->w->query_priority == WEB_CLIENT_QUERY_HIGH ? WORKER_JOB_QUERY_HIGH : WORKER_JOB_QUERY_LOW);
+        web_client_execute_deferred_query(q->w);
+        web_server_query_done(q);
+        worker_is_idle();
+
+        netdata_mutex_lock(&web_server_queries.mutex);
+    }
+
+    netdata_mutex_unlock(&web_server_queries.mutex);
+
+    worker_unregister();
+    return NULL;
+}
+
+static void web_server_queries_start(void) {
+    web_server_queries.threads = (int)config_get_number(CONFIG_SECTION_WEB, "web server query threads", static_threaded_workers_count);
+    if(web_server_queries.threads < 0)
+        web_server_queries.threads = 0;
+
+    if(!web_server_queries.threads) {
+        info("Web server queries will be executed by the web server threads.");
+        return;
+    }
+
+    web_server_queries.thread = callocz((size_t)web_server_queries.threads, sizeof(netdata_thread_t));
+
+    int i;
+    for(i = 0; i < web_server_queries.threads ; i++) {
+        char tag[50 + 1];
+        snprintfz(tag, 50, "WEBQUERY[%d]", i + 1);
+
+        netdata_thread_create(&web_server_queries.thread[i], tag, NETDATA_THREAD_OPTION_JOINABLE,
+                              web_server_query_thread, NULL);
+    }
+}
+
+// called by the listener when it stops - the query threads exit when the web server
+// is stopping and the queries still queued have been executed
+static void web_server_queries_stop(void) {
+    if(!web_server_queries.thread)
+        return;
+
+    info("waiting for %d web server query threads to finish...", web_server_queries.threads);
+
+    int i;
+    for(i = 0; i < web_server_queries.threads ; i++)
+        netdata_thread_join(web_server_queries.thread[i], NULL);
+
+    freez(web_server_queries.thread);
+    web_server_queries.thread = NULL;
+    web_server_queries.threads = 0;
+}
+
+// called by a worker when it stops, after all its sockets have been closed
+static void web_server_queries_cleanup(void) {
+    // the queries still queued are not executed
+    netdata_mutex_lock(&web_server_queries.mutex);
+    WEB_CLIENT_QUERY_PRIORITY priority;
+    for(priority = WEB_CLIENT_QUERY_HIGH; priority < WEB_CLIENT_QUERY_PRIORITIES ; priority++) {
+        WEB_SERVER_QUERY *q = web_server_queries.queue[priority];
+        while(q) {
+            WEB_SERVER_QUERY *next = q->next;
+
+            if(q->worker == worker_private) {
+                DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(web_server_queries.queue[priority], q, prev, next);
+                web_server_query_client_release(q->w);
+                freez(q);
+            }
+
+            q = next;
+        }
+    }
+    netdata_mutex_unlock(&web_server_queries.mutex);
+
+    // wait for the queries that are running
+    while(true) {
+        netdata_mutex_lock(&worker_private->queries_mutex);
+        WEB_SERVER_QUERY *done = worker_private->queries_done;
+        worker_private->queries_done = NULL;
+        netdata_mutex_unlock(&worker_private->queries_mutex);
+
+        while(done) {
+            WEB_SERVER_QUERY *q = done;
+            DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(done, q, prev, next);
+            web_server_query_client_release(q->w);
+            freez(q);
+        }
+
+        if(!worker_private->queries_running)
+            break;
+
+        sleep_usec(10 * USEC_PER_MS);
+    }
+
+    netdata_mutex_lock(&worker_private->queries_mutex);
+    if(worker_private->queries_pipe[PIPE_READ] != -1)
+        close(worker_private->queries_pipe[PIPE_READ]);
+
+    if(worker_private->queries_pipe[PIPE_WRITE] != -1)
+        close(worker_private->queries_pipe[PIPE_WRITE]);
+
+    worker_private->queries_pipe[PIPE_READ] = worker_private->queries_pipe[PIPE_WRITE] = -1;
+    netdata_mutex_unlock(&worker_private->queries_mutex);
+}
+
 // ----------------------------------------------------------------------------
 // web server clients
 
@@ -189,6 +540,9 @@ static void *web_server_add_callback(POLLINFO *pi, short int *events, void *data
     debug(D_WEB_CLIENT_ACCESS, "LISTENER on %d: new connection.", pi->fd);
     struct web_client *w = web_client_create_on_fd(pi);
 
+    if(web_server_queries.threads)
+        web_client_flag_set(w, WEB_CLIENT_FLAG_QUERIES_CAN_BE_DEFERRED);
+
     if (!strncmp(pi->client_port, "UNIX", 4)) {
         web_client_set_unix(w);
     } else {
@@ -267,7 +621,13 @@ static void web_server_del_callback(POLLINFO *pi) {
     struct web_client *w = (struct web_client *)pi->data;
 
     w->pollinfo_slot = 0;
-    if(unlikely(w->pollinfo_filecopy_slot)) {
+    if(unlikely(w->running)) {
+        // the query may send its response while it runs, so the socket is not
+        // closed (and its fd is not reused) before the query is done
+        pi->flags |= POLLINFO_FLAG_DONT_CLOSE;
+        debug(D_WEB_CLIENT, "%llu: THE CLIENT WILL BE FREED WHEN ITS QUERY IS DONE ON FD %d", w->id, pi->fd);
+    }
+    else if(unlikely(w->pollinfo_filecopy_slot)) {
         POLLINFO *fpi = pollinfo_from_slot(pi->p, w->pollinfo_filecopy_slot);  // POLLINFO of the client socket
         (void)fpi;
 
@@ -284,6 +644,79 @@ static void web_server_del_callback(POLLINFO *pi) {
     worker_is_idle();
 }
 
+// processes the request received by the client and enables the events it waits for
+// it returns what the poll callbacks return (-1 closes the client)
+// the POLLINFO of the client may be reallocated by this call, so it is given by its slot
+static int web_server_process_request(POLLJOB *p, size_t slot, struct web_client *w) {
+    int fd = pollinfo_from_slot(p, slot)->fd;
+    short int *events = &p->fds[slot].events;
+
+    web_client_process_request(w);
+
+    if(unlikely(web_client_flag_check(w, WEB_CLIENT_FLAG_QUERY_DEFERRED))) {
+        if(likely(web_server_query_enqueue(p, w))) {
+            // no events for the client, until its query is done
+            // (the events have been zeroed before calling the callbacks)
+            debug(D_WEB_CLIENT, "%llu: QUERY DEFERRED ON FD %d", w->id, fd);
+            return 0;
+        }
+
+        web_client_execute_deferred_query(w);
+        web_client_finish_deferred_query(w);
+    }
+
+    if (unlikely(w->mode == WEB_CLIENT_MODE_STREAM)) {
+        web_client_send(w);
+    }
+
+    else if(unlikely(w->mode == WEB_CLIENT_MODE_FILECOPY)) {
+        if(w->pollinfo_filecopy_slot == 0) {
+            debug(D_WEB_CLIENT, "%llu: FILECOPY DETECTED ON FD %d", w->id, fd);
+
+            if (unlikely(w->ifd != -1 && w->ifd != w->ofd && w->ifd != fd && !web_client_flag_check(w, WEB_CLIENT_FLAG_SENDFILE))) {
+                // add a new socket to poll_events, with the same
+                debug(D_WEB_CLIENT, "%llu: CREATING FILECOPY SLOT ON FD %d", w->id, fd);
+
+                POLLINFO *fpi = poll_add_fd(
+                                            p
+                                            , w->ifd
+                                            , pollinfo_from_slot(p, slot)->port_acl
+                                            , 0
+                                            , POLLINFO_FLAG_CLIENT_SOCKET
+                                            , "FILENAME"
+                                            , ""
+                                            , ""
+                                            , web_server_file_add_callback
+                                            , web_server_file_del_callback
+                                            , web_server_file_read_callback
+                                            , web_server_file_write_callback
+                                            , (void *) w
+                                            );
+
+                if(fpi) {
+                    w->pollinfo_filecopy_slot = fpi->slot;
+
+                    // the poll arrays may have been reallocated
+                    events = &p->fds[slot].events;
+                }
+                else {
+                    error("Failed to add filecopy fd. Closing client.");
+                    return -1;
+                }
+            }
+        }
+    }
+    else {
+        if(unlikely(w->ifd == fd && web_client_has_wait_receive(w)))
+            *events |= POLLIN;
+    }
+
+    if(unlikely(w->ofd == fd && web_client_has_wait_send(w)))
+        *events |= POLLOUT;
+
+    return web_server_check_client_status(w);
+}
+
 static int web_server_rcv_callback(POLLINFO *pi, short int *events) {
     int ret = -1;
     worker_is_busy(WORKER_JOB_RCV_DATA);
@@ -300,53 +733,8 @@ static int web_server_rcv_callback(POLLINFO *pi, short int *events) {
         debug(D_WEB_CLIENT, "%llu: processing received data on fd %d.", w->id, fd);
         worker_is_idle();
         worker_is_busy(WORKER_JOB_PROCESS);
-        web_client_process_request(w);
-
-        if (unlikely(w->mode == WEB_CLIENT_MODE_STREAM)) {
-            web_client_send(w);
-        }
-
-        else if(unlikely(w->mode == WEB_CLIENT_MODE_FILECOPY)) {
-            if(w->pollinfo_filecopy_slot == 0) {
-                debug(D_WEB_CLIENT, "%llu: FILECOPY DETECTED ON FD %d", w->id, pi->fd);
-
-                if (unlikely(w->ifd != -1 && w->ifd != w->ofd && w->ifd != fd)) {
-                    // add a new socket to poll_events, with the same
-                    debug(D_WEB_CLIENT, "%llu: CREATING FILECOPY SLOT ON FD %d", w->id, pi->fd);
-
-                    POLLINFO *fpi = poll_add_fd(
-                                                pi->p
-                                                , w->ifd
-                                                , pi->port_acl
-                                                , 0
-                                                , POLLINFO_FLAG_CLIENT_SOCKET
-                                                , "FILENAME"
-                                                , ""
-                                                , ""
-                                                , web_server_file_add_callback
-                                                , web_server_file_del_callback
-                                                , web_server_file_read_callback
-                                                , web_server_file_write_callback
-                                                , (void *) w
-                                                );
-
-                    if(fpi)
-                        w->pollinfo_filecopy_slot = fpi->slot;
-                    else {
-                        error("Failed to add filecopy fd. Closing client.");
-                        ret = -1;
-                        goto cleanup;
-                    }
-                }
-            }
-        }
-        else {
-            if(unlikely(w->ifd == fd && web_client_has_wait_receive(w)))
-                *events |= POLLIN;
-        }
-
-        if(unlikely(w->ofd == fd && web_client_has_wait_send(w)))
-            *events |= POLLOUT;
+        ret = web_server_process_request(pi->p, pi->slot, w);
+        goto cleanup;
     } else if(unlikely(bytes < 0)) {
         ret = -1;
         goto cleanup;
@@ -374,6 +762,9 @@ static int web_server_snd_callback(POLLINFO *pi, short int *events) {
     struct web_client *w = (struct web_client *)pi->data;
     int fd = pi->fd;
 
+    // the timeouts may have been disabled while the query of the client was running
+    pi->flags &= ~POLLINFO_FLAG_NO_TIMEOUT;
+
     debug(D_WEB_CLIENT, "%llu: sending data on fd %d.", w->id, fd);
 
     int ret = web_client_send(w);
@@ -383,6 +774,15 @@ static int web_server_snd_callback(POLLINFO *pi, short int *events) {
         goto cleanup;
     }
 
+    // the response has been sent, and the next request of the client has been received already
+    if(unlikely(web_client_flag_check(w, WEB_CLIENT_FLAG_PIPELINED_REQUEST))) {
+        debug(D_WEB_CLIENT, "%llu: processing pipelined request on fd %d.", w->id, fd);
+        worker_is_idle();
+        worker_is_busy(WORKER_JOB_PROCESS);
+        retval = web_server_process_request(pi->p, pi->slot, w);
+        goto cleanup;
+    }
+
     if(unlikely(w->ifd == fd && web_client_has_wait_receive(w)))
         *events |= POLLIN;
 
@@ -402,6 +802,8 @@ static int web_server_snd_callback(POLLINFO *pi, short int *events) {
 static void socket_listen_main_static_threaded_worker_cleanup(void *ptr) {
     worker_private = (struct web_server_static_threaded_worker *)ptr;
 
+    web_server_queries_cleanup();
+
     info("freeing local web clients cache...");
     web_client_cache_destroy();
 
@@ -434,6 +836,10 @@ void *socket_listen_main_static_threaded_worker(void *ptr) {
     worker_register_job_name(WORKER_JOB_RCV_DATA, "receive");
     worker_register_job_name(WORKER_JOB_SND_DATA, "send");
     worker_register_job_name(WORKER_JOB_PROCESS, "process");
+    worker_register_job_name(WORKER_JOB_QUERIES_DONE, "queries done");
+
+    netdata_mutex_init(&worker_private->queries_mutex);
+    worker_private->queries_pipe[PIPE_READ] = worker_private->queries_pipe[PIPE_WRITE] = -1;
 
     netdata_thread_cleanup_push(socket_listen_main_static_threaded_worker_cleanup, ptr);
 
@@ -499,6 +905,8 @@ static void socket_listen_main_static_threaded_cleanup(void *ptr) {
     info("closing all web server sockets...");
     listen_sockets_close(&api_sockets);
 
+    web_server_queries_stop();
+
     info("all static web threads stopped.");
     static_thread->enabled = NETDATA_MAIN_THREAD_EXITED;
 }
@@ -542,6 +950,8 @@ void *socket_listen_main_static_threaded(void *ptr) {
 
     web_server_is_multithreaded = (static_threaded_workers_count > 1);
 
+    web_server_queries_start();
+
     int i;
     for (i = 1; i < static_threaded_workers_count; i++) {
         static_workers_private_data[i].id = i;
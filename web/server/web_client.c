@@ -1,6 +1,11 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "web_client.h"
+#include "web_client_cache.h"
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 
 // this is an async I/O implementation of the web server request parser
 // it is used by all netdata web servers
@@ -52,6 +57,21 @@ static inline void web_client_enable_wait_from_ssl(struct web_client *w, int byt
 }
 #endif
 
+static inline bool web_client_uses_ssl(struct web_client *w) {
+#ifdef ENABLE_HTTPS
+    return !web_client_check_unix(w) && netdata_ssl_srv_ctx && w->ssl.conn && !w->ssl.flags;
+#else
+    (void)w;
+    return false;
+#endif
+}
+
+// the response will be sent as it is (it is already compressed, or it is not compressible)
+static inline void web_client_disable_deflate(struct web_client *w) {
+    w->response.zoutput = 0;
+    web_client_flag_clear(w, WEB_CLIENT_CHUNKED_TRANSFER);
+}
+
 static inline int web_client_uncrock_socket(struct web_client *w) {
 #ifdef TCP_CORK
     if(likely(w->tcp_cork && w->ofd != -1)) {
@@ -90,7 +110,7 @@ void web_client_request_done(struct web_client *w) {
         struct timeval tv;
         now_realtime_timeval(&tv);
 
-        size_t size = (w->mode == WEB_CLIENT_MODE_FILECOPY)?w->response.rlen:w->response.data->len;
+        size_t size = (w->mode == WEB_CLIENT_MODE_FILECOPY)?w->response.rlen:w->response.data->len + w->response.streamed;
         size_t sent = size;
 #ifdef NETDATA_WITH_ZLIB
         if(likely(w->response.zoutput)) sent = (size_t)w->response.zstream.total_out;
@@ -156,7 +176,8 @@ void web_client_request_done(struct web_client *w) {
         if(w->ifd != w->ofd) {
             debug(D_WEB_CLIENT, "%llu: Closing filecopy input file descriptor %d.", w->id, w->ifd);
 
-            if(web_server_mode != WEB_SERVER_MODE_STATIC_THREADED) {
+            // the static-threaded web server closes the files it reads, but not the ones sent with sendfile()
+            if(web_server_mode != WEB_SERVER_MODE_STATIC_THREADED || web_client_flag_check(w, WEB_CLIENT_FLAG_SENDFILE)) {
                 if (w->ifd != -1){
                     close(w->ifd);
                 }
@@ -164,6 +185,10 @@ void web_client_request_done(struct web_client *w) {
 
             w->ifd = w->ofd;
         }
+
+        web_static_file_release(w->response.static_file);
+        w->response.static_file = NULL;
+        w->response.static_data = NULL;
     }
 
     w->last_url[0] = '\0';
@@ -173,6 +198,7 @@ void web_client_request_done(struct web_client *w) {
     w->origin[1] = '\0';
 
     freez(w->user_agent); w->user_agent = NULL;
+    freez(w->if_none_match); w->if_none_match = NULL;
     if (w->auth_bearer_token) {
         freez(w->auth_bearer_token);
         w->auth_bearer_token = NULL;
@@ -184,6 +210,7 @@ void web_client_request_done(struct web_client *w) {
     web_client_disable_donottrack(w);
     web_client_disable_tracking_required(w);
     web_client_disable_keepalive(w);
+    web_client_flag_clear(w, WEB_CLIENT_FLAG_SENDFILE | WEB_CLIENT_FLAG_ACCEPT_BROTLI);
     w->decoded_url[0] = '\0';
 
     buffer_reset(w->response.header_output);
@@ -199,6 +226,15 @@ void web_client_request_done(struct web_client *w) {
     web_client_enable_wait_receive(w);
     web_client_disable_wait_send(w);
 
+    if(unlikely(web_client_flag_check(w, WEB_CLIENT_FLAG_STREAMING))) {
+        // streamed responses are big, so their buffer is not kept for the next request
+        buffer_free(w->response.stream);
+        w->response.stream = NULL;
+        w->response.stream_sent = 0;
+        w->response.streamed = 0;
+        web_client_flag_clear(w, WEB_CLIENT_FLAG_STREAMING | WEB_CLIENT_CHUNKED_TRANSFER);
+    }
+
     w->response.zoutput = 0;
 
     // if we had enabled compression, release it
@@ -216,6 +252,13 @@ void web_client_request_done(struct web_client *w) {
         w->flags &= ~WEB_CLIENT_CHUNKED_TRANSFER;
     }
 #endif // NETDATA_WITH_ZLIB
+
+    // the next request of the client has already been received
+    if(unlikely(w->pipeline && buffer_strlen(w->pipeline))) {
+        buffer_fast_strcat(w->response.data, buffer_tostring(w->pipeline), buffer_strlen(w->pipeline));
+        buffer_flush(w->pipeline);
+        web_client_flag_set(w, WEB_CLIENT_FLAG_PIPELINED_REQUEST);
+    }
 }
 
 static struct {
@@ -286,6 +329,28 @@ static inline uint8_t contenttype_for_filename(const char *filename) {
     return CT_APPLICATION_OCTET_STREAM;
 }
 
+static inline bool contenttype_is_compressible(HTTP_CONTENT_TYPE content_type) {
+    switch(content_type) {
+        case CT_TEXT_HTML:
+        case CT_APPLICATION_X_JAVASCRIPT:
+        case CT_TEXT_CSS:
+        case CT_TEXT_XML:
+        case CT_TEXT_XSL:
+        case CT_TEXT_PLAIN:
+        case CT_APPLICATION_JSON:
+        case CT_IMAGE_SVG_XML:
+        case CT_APPLICATION_X_FONT_TRUETYPE:
+        case CT_APPLICATION_X_FONT_OPENTYPE:
+        case CT_APPLICATION_VND_MS_FONTOBJ:
+        case CT_IMAGE_BMP:
+            return true;
+
+        default:
+            // images and woff fonts are already compressed
+            return false;
+    }
+}
+
 static inline int access_to_file_is_not_permitted(struct web_client *w, const char *filename) {
     w->response.data->content_type = CT_TEXT_HTML;
     buffer_strcat(w->response.data, "Access to file is not permitted: ");
@@ -354,6 +419,63 @@ int mysendfile(struct web_client *w, char *filename) {
         done = 1;
     }
 
+    w->response.data->content_type = contenttype_for_filename(webfilename);
+#ifdef __APPLE__
+    w->response.data->date = statbuf.st_mtimespec.tv_sec;
+#else
+    w->response.data->date = statbuf.st_mtim.tv_sec;
+#endif
+    buffer_cacheable(w->response.data);
+
+    char etag[WEB_STATIC_FILE_ETAG_SIZE];
+    web_static_file_etag(&statbuf, etag, sizeof(etag));
+
+    // the browser has this file already
+    if(w->if_none_match && web_static_file_etag_matches(w->if_none_match, etag)) {
+        debug(D_WEB_CLIENT_ACCESS, "%llu: File '%s' is not modified.", w->id, webfilename);
+        buffer_sprintf(w->response.header, "ETag: %s\r\n", etag);
+        web_client_disable_deflate(w);
+        buffer_flush(w->response.data);
+        return HTTP_RESP_NOT_MODIFIED;
+    }
+
+    bool compressible = contenttype_is_compressible(w->response.data->content_type);
+
+    // send it from memory, as it is cached (possibly pre-compressed)
+#ifdef NETDATA_WITH_ZLIB
+    WEB_STATIC_FILE *sf = web_static_file_acquire(webfilename, &statbuf, compressible && web_enable_gzip);
+#else
+    WEB_STATIC_FILE *sf = web_static_file_acquire(webfilename, &statbuf, false);
+#endif
+    if(sf) {
+        uint32_t accepted = 0;
+        if(w->response.zoutput)
+            accepted |= WEB_STATIC_FILE_ACCEPT(WEB_STATIC_FILE_GZIP);
+        if(web_client_flag_check(w, WEB_CLIENT_FLAG_ACCEPT_BROTLI))
+            accepted |= WEB_STATIC_FILE_ACCEPT(WEB_STATIC_FILE_BROTLI);
+
+        WEB_STATIC_FILE_ENCODING encoding;
+        size_t len;
+        w->response.static_file = sf;
+        w->response.static_data = web_static_file_data(sf, accepted, &encoding, &len);
+
+        web_client_disable_deflate(w);
+        buffer_sprintf(w->response.header, "ETag: %s\r\n", etag);
+        if(encoding != WEB_STATIC_FILE_IDENTITY)
+            buffer_sprintf(w->response.header, "Content-Encoding: %s\r\n", web_static_file_encoding_name(encoding));
+        if(compressible)
+            buffer_strcat(w->response.header, "Vary: Accept-Encoding\r\n");
+
+        debug(D_WEB_CLIENT_ACCESS, "%llu: Sending cached file '%s' (%zu bytes, %s).", w->id, webfilename, len, web_static_file_encoding_name(encoding));
+
+        w->mode = WEB_CLIENT_MODE_FILECOPY;
+        web_client_disable_wait_receive(w);
+        web_client_disable_wait_send(w);
+        buffer_flush(w->response.data);
+        w->response.rlen = len;
+        return HTTP_RESP_OK;
+    }
+
     // open the file
     w->ifd = open(webfilename, O_NONBLOCK, O_RDONLY);
     if(w->ifd == -1) {
@@ -376,23 +498,29 @@ int mysendfile(struct web_client *w, char *filename) {
         }
     }
 
-    sock_setnonblock(w->ifd);
-
-    w->response.data->content_type = contenttype_for_filename(webfilename);
     debug(D_WEB_CLIENT_ACCESS, "%llu: Sending file '%s' (%"PRId64" bytes, ifd %d, ofd %d).", w->id, webfilename, (int64_t)statbuf.st_size, w->ifd, w->ofd);
 
+    buffer_sprintf(w->response.header, "ETag: %s\r\n", etag);
+
     w->mode = WEB_CLIENT_MODE_FILECOPY;
+    buffer_flush(w->response.data);
+    w->response.rlen = (size_t)statbuf.st_size;
+
+#ifdef __linux__
+    // files that are not going to be compressed or encrypted, are copied to the socket by the kernel
+    if(!web_client_uses_ssl(w) && (!w->response.zoutput || !compressible)) {
+        web_client_disable_deflate(w);
+        web_client_flag_set(w, WEB_CLIENT_FLAG_SENDFILE);
+        web_client_disable_wait_receive(w);
+        web_client_disable_wait_send(w);
+        return HTTP_RESP_OK;
+    }
+#endif
+
+    sock_setnonblock(w->ifd);
     web_client_enable_wait_receive(w);
     web_client_disable_wait_send(w);
-    buffer_flush(w->response.data);
     buffer_need_bytes(w->response.data, (size_t)statbuf.st_size);
-    w->response.rlen = (size_t)statbuf.st_size;
-#ifdef __APPLE__
-    w->response.data->date = statbuf.st_mtimespec.tv_sec;
-#else
-    w->response.data->date = statbuf.st_mtim.tv_sec;
-#endif 
-    buffer_cacheable(w->response.data);
 
     return HTTP_RESP_OK;
 }
@@ -646,6 +774,9 @@ const char *web_response_code_to_string(int code) {
         case HTTP_RESP_MOVED_PERM:
             return "Moved Permanently";
 
+        case HTTP_RESP_NOT_MODIFIED:
+            return "Not Modified";
+
         case HTTP_RESP_REDIR_TEMP:
             return "Temporary Redirect";
 
@@ -681,19 +812,55 @@ const char *web_response_code_to_string(int code) {
     }
 }
 
+// Is the content coding accepted by the Accept-Encoding header value v?
+// The codings are separated by commas and may have a q value, where q=0 means
+// "not acceptable". A "*" applies to the codings not listed.
+static bool http_header_accepts_encoding(const char *v, const char *encoding) {
+    size_t len = strlen(encoding);
+    NETDATA_DOUBLE q_any = 0.0;
+
+    while(*v) {
+        while(*v == ' ' || *v == '\t' || *v == ',') v++;
+        if(!*v) break;
+
+        const char *name = v;
+        while(*v && *v != ',' && *v != ';' && *v != ' ' && *v != '\t') v++;
+        size_t name_len = (size_t)(v - name);
+
+        // the parameters of this coding
+        NETDATA_DOUBLE q = 1.0;
+        while(*v && *v != ',') {
+            if(*v++ != ';')
+                continue;
+
+            while(*v == ' ' || *v == '\t') v++;
+            if((*v == 'q' || *v == 'Q') && v[1] == '=') {
+                char *end;
+                q = str2ndd(&v[2], &end);
+                v = end;
+            }
+        }
+
+        if(name_len == len && !strncasecmp(name, encoding, len))
+            return q > 0.0;
+
+        if(name_len == 1 && *name == '*')
+            q_any = q;
+    }
+
+    return q_any > 0.0;
+}
+
 static inline char *http_header_parse(struct web_client *w, char *s, int parse_useragent) {
     static uint32_t hash_origin = 0, hash_connection = 0, hash_donottrack = 0, hash_useragent = 0,
-                    hash_authorization = 0, hash_host = 0, hash_forwarded_proto = 0, hash_forwarded_host = 0;
-#ifdef NETDATA_WITH_ZLIB
-    static uint32_t hash_accept_encoding = 0;
-#endif
+                    hash_authorization = 0, hash_host = 0, hash_forwarded_proto = 0, hash_forwarded_host = 0,
+                    hash_accept_encoding = 0, hash_if_none_match = 0;
 
     if(unlikely(!hash_origin)) {
         hash_origin = simple_uhash("Origin");
         hash_connection = simple_uhash("Connection");
-#ifdef NETDATA_WITH_ZLIB
         hash_accept_encoding = simple_uhash("Accept-Encoding");
-#endif
+        hash_if_none_match = simple_uhash("If-None-Match");
         hash_donottrack = simple_uhash("DNT");
         hash_useragent = simple_uhash("User-Agent");
         hash_authorization = simple_uhash("X-Auth-Token");
@@ -749,18 +916,26 @@ static inline char *http_header_parse(struct web_client *w, char *s, int parse_u
     else if(hash == hash_host && !strcasecmp(s, "Host")){
         strncpyz(w->server_host, v, ((size_t)(ve - v) < sizeof(w->server_host)-1 ? (size_t)(ve - v) : sizeof(w->server_host)-1));
     }
-#ifdef NETDATA_WITH_ZLIB
     else if(hash == hash_accept_encoding && !strcasecmp(s, "Accept-Encoding")) {
+        // brotli is used only for pre-compressed static files
+        if(http_header_accepts_encoding(v, "br"))
+            web_client_flag_set(w, WEB_CLIENT_FLAG_ACCEPT_BROTLI);
+
+#ifdef NETDATA_WITH_ZLIB
         if(web_enable_gzip) {
-            if(strcasestr(v, "gzip"))
+            if(http_header_accepts_encoding(v, "gzip"))
                 web_client_enable_deflate(w, 1);
             //
             // does not seem to work
-            // else if(strcasestr(v, "deflate"))
+            // else if(http_header_accepts_encoding(v, "deflate"))
             //  web_client_enable_deflate(w, 0);
         }
-    }
 #endif /* NETDATA_WITH_ZLIB */
+    }
+    else if(hash == hash_if_none_match && !strcasecmp(s, "If-None-Match")) {
+        freez(w->if_none_match);
+        w->if_none_match = strdupz(v);
+    }
 #ifdef ENABLE_HTTPS
     else if(hash == hash_forwarded_proto && !strcasecmp(s, "X-Forwarded-Proto")) {
         if(strcasestr(v, "https"))
@@ -895,6 +1070,36 @@ void web_client_split_path_query(struct web_client *w, char *s) {
     w->url_path_length = strlen(s);
 }
 
+// HTTP/1.1 pipelining: clients may send their next requests before they get the response
+// of the first one - the requests following the first are kept until its response is sent
+// returns false when too many requests are waiting
+static inline bool web_client_pipeline_requests(struct web_client *w) {
+    char *s = w->response.data->buffer;
+
+    // only requests without a body can be pipelined
+    if(strncmp(s, "GET ", 4) != 0 && strncmp(s, "OPTIONS ", 8) != 0)
+        return true;
+
+    char *e = strstr(s, "\r\n\r\n");
+    if(!e || !e[4])
+        return true;
+
+    e += 4;
+    size_t len = w->response.data->len - (size_t)(e - s);
+
+    if(!w->pipeline)
+        w->pipeline = buffer_create(len + 1, &netdata_buffers_statistics.buffers_web);
+
+    if(buffer_strlen(w->pipeline) + len > NETDATA_WEB_REQUEST_MAX_SIZE)
+        return false;
+
+    buffer_fast_strcat(w->pipeline, e, len);
+
+    *e = '\0';
+    w->response.data->len = (size_t)(e - s);
+    return true;
+}
+
 /**
  * Request validate
  *
@@ -904,6 +1109,13 @@ void web_client_split_path_query(struct web_client *w, char *s) {
  *          in the enum HTTP_VALIDATION otherwise.
  */
 static inline HTTP_VALIDATION http_request_validate(struct web_client *w) {
+    if(unlikely(!web_client_pipeline_requests(w))) {
+        w->header_parse_tries = 0;
+        w->header_parse_last_size = 0;
+        web_client_disable_wait_receive(w);
+        return HTTP_VALIDATION_EXCESS_REQUEST_DATA;
+    }
+
     char *s = (char *)buffer_tostring(w->response.data), *encoded_url = NULL;
 
     size_t last_pos = w->header_parse_last_size;
@@ -1086,7 +1298,7 @@ static inline ssize_t web_client_send_data(struct web_client *w,const void *buf,
 }
 
 void web_client_build_http_header(struct web_client *w) {
-    if(unlikely(w->response.code != HTTP_RESP_OK))
+    if(unlikely(w->response.code != HTTP_RESP_OK && w->response.code != HTTP_RESP_NOT_MODIFIED))
         buffer_no_cacheable(w->response.data);
 
     // set a proper expiration date, if not already set
@@ -1196,6 +1408,10 @@ void web_client_build_http_header(struct web_client *w) {
 
     if(likely(w->flags & WEB_CLIENT_CHUNKED_TRANSFER))
         buffer_strcat(w->response.header_output, "Transfer-Encoding: chunked\r\n");
+    else if(unlikely(w->response.code == HTTP_RESP_NOT_MODIFIED)) {
+        // there is no content
+        ;
+    }
     else {
         if(likely((w->response.data->len || w->response.rlen))) {
             // we know the content length, put it
@@ -1462,10 +1678,64 @@ static inline int web_client_process_url(RRDHOST *host, struct web_client *w, ch
     return mysendfile(w, (tok && *tok)?tok:"/");
 }
 
+// the queries that are executed outside the web server threads, when the web server can do so
+// all the other requests are fast enough to be processed by the web server threads directly
+WEB_CLIENT_QUERY_PRIORITY web_client_query_priority(const char *url) {
+    static const struct {
+        const char *api;
+        const char *command;
+        WEB_CLIENT_QUERY_PRIORITY priority;
+    } queries[] = {
+            { "/api/v1/", "data",                WEB_CLIENT_QUERY_HIGH },
+            { "/api/v1/", "badge.svg",           WEB_CLIENT_QUERY_HIGH },
+            { "/api/v2/", "data",                WEB_CLIENT_QUERY_HIGH },
+            { "/api/v1/", "weights",             WEB_CLIENT_QUERY_LOW  },
+            { "/api/v1/", "metric_correlations", WEB_CLIENT_QUERY_LOW  },
+            { "/api/v1/", "allmetrics",          WEB_CLIENT_QUERY_LOW  },
+            { "/api/v1/", "function",            WEB_CLIENT_QUERY_LOW  },
+            { "/api/v2/", "q",                   WEB_CLIENT_QUERY_LOW  },
+
+            // terminator
+            { NULL, NULL, WEB_CLIENT_QUERY_INLINE },
+    };
+
+    // the API may be prefixed by /host/HOSTNAME
+    const char *api = strstr(url, "/api/v");
+    if(!api)
+        return WEB_CLIENT_QUERY_INLINE;
+
+    const char *command = &api[sizeof("/api/v1/") - 1];
+    size_t command_len = strcspn(command, "/?");
+
+    for(size_t i = 0; queries[i].api ; i++) {
+        if(strncmp(api, queries[i].api, sizeof("/api/v1/") - 1) == 0 &&
+           strlen(queries[i].command) == command_len &&
+           strncmp(command, queries[i].command, command_len) == 0)
+            return queries[i].priority;
+    }
+
+    return WEB_CLIENT_QUERY_INLINE;
+}
+
+static void web_client_process_request_finish(struct web_client *w);
+
+// executes a query deferred by web_client_process_request()
+// it does not access the socket of the client, so it can run in any thread
+void web_client_execute_deferred_query(struct web_client *w) {
+    web_client_flag_clear(w, WEB_CLIENT_FLAG_QUERY_DEFERRED);
+    w->response.code = web_client_process_url(localhost, w, w->decoded_url);
+}
+
+// sends the response headers of a deferred query, in the web server thread of the client
+void web_client_finish_deferred_query(struct web_client *w) {
+    web_client_process_request_finish(w);
+}
+
 void web_client_process_request(struct web_client *w) {
 
     // start timing us
     now_realtime_timeval(&w->tv_in);
+    web_client_flag_clear(w, WEB_CLIENT_FLAG_PIPELINED_REQUEST);
 
     switch(http_request_validate(w)) {
         case HTTP_VALIDATION_OK:
@@ -1510,6 +1780,14 @@ void web_client_process_request(struct web_client *w) {
                         break;
                     }
 
+                    if(web_client_flag_check(w, WEB_CLIENT_FLAG_QUERIES_CAN_BE_DEFERRED) &&
+                       (w->query_priority = web_client_query_priority(w->decoded_url)) != WEB_CLIENT_QUERY_INLINE) {
+                        // the web server will execute the query in another thread
+                        // and call web_client_finish_deferred_query() when it is done
+                        web_client_flag_set(w, WEB_CLIENT_FLAG_QUERY_DEFERRED);
+                        return;
+                    }
+
                     w->response.code = web_client_process_url(localhost, w, w->decoded_url);
                     break;
             }
@@ -1582,6 +1860,207 @@ void web_client_process_request(struct web_client *w) {
             break;
     }
 
+    web_client_process_request_finish(w);
+}
+
+// ----------------------------------------------------------------------------
+// streaming of responses
+//
+// Large query results are sent while the query runs: the query gives its output
+// to web_client_flush_callback() between its slices, which sends the response
+// header and then the output as chunks (chunked transfer encoding), compressed
+// incrementally when the client accepts gzip. So the response data buffer keeps
+// only a slice of the result, and the client gets the first bytes early.
+// When the client is slower than the query, the query waits for it, so that the
+// part of the response not sent yet stays below NETDATA_WEB_RESPONSE_STREAM_MAX_PENDING.
+
+static void web_client_stream_chunk(struct web_client *w, const char *data, size_t len) {
+    if(unlikely(!len)) return;
+
+    BUFFER *b = w->response.stream;
+    buffer_sprintf(b, "%zX\r\n", len);
+
+    // compressed data may include zeros, so they are copied with memcpy()
+    buffer_need_bytes(b, len + 2);
+    memcpy(&b->buffer[b->len], data, len);
+    b->len += len;
+    buffer_strcat(b, "\r\n");
+}
+
+// moves the data of wb to the stream buffer, as chunks
+// when finish is true, the stream is terminated
+static bool web_client_stream_encode(struct web_client *w, BUFFER *wb, bool finish) {
+#ifdef NETDATA_WITH_ZLIB
+    if(w->response.zoutput) {
+        w->response.zstream.next_in = (Bytef *)wb->buffer;
+        w->response.zstream.avail_in = (uInt)wb->len;
+
+        // the output is flushed, so that the client can decompress everything given so far
+        do {
+            w->response.zstream.next_out = w->response.zbuffer;
+            w->response.zstream.avail_out = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE;
+
+            if(deflate(&w->response.zstream, finish ? Z_FINISH : Z_SYNC_FLUSH) == Z_STREAM_ERROR) {
+                error("%llu: Compression of streamed response failed.", w->id);
+                return false;
+            }
+
+            web_client_stream_chunk(w, (const char *)w->response.zbuffer, NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE - w->response.zstream.avail_out);
+        } while(w->response.zstream.avail_out == 0);
+    }
+    else
+#endif // NETDATA_WITH_ZLIB
+        web_client_stream_chunk(w, wb->buffer, wb->len);
+
+    if(finish)
+        buffer_strcat(w->response.stream, "0\r\n\r\n");
+
+    w->response.streamed += wb->len;
+    buffer_flush(wb);
+    return true;
+}
+
+// sends as much of the stream buffer as the socket accepts, without blocking
+static ssize_t web_client_stream_send(struct web_client *w) {
+    BUFFER *b = w->response.stream;
+    size_t left = b->len - w->response.stream_sent;
+    if(unlikely(!left))
+        return 0;
+
+    ssize_t bytes = web_client_send_data(w, &b->buffer[w->response.stream_sent], left, MSG_DONTWAIT);
+    if(likely(bytes > 0)) {
+        w->stats_sent_bytes += bytes;
+        w->response.stream_sent += bytes;
+        debug(D_WEB_CLIENT, "%llu: Sent %zd bytes of streamed response.", w->id, bytes);
+
+        if(w->response.stream_sent == b->len) {
+            buffer_flush(b);
+            w->response.stream_sent = 0;
+        }
+        else if(w->response.stream_sent > b->len / 2) {
+            // reuse the space of the part sent, instead of growing the buffer
+            b->len -= w->response.stream_sent;
+            memmove(b->buffer, &b->buffer[w->response.stream_sent], b->len);
+            b->buffer[b->len] = '\0';
+            w->response.stream_sent = 0;
+        }
+    }
+    else if(bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        bytes = 0;
+
+    return bytes;
+}
+
+static inline size_t web_client_stream_pending(struct web_client *w) {
+    return w->response.stream->len - w->response.stream_sent;
+}
+
+// blocks until the part of the stream not sent yet is below the limit
+// returns false when the client is gone, or does not read for web_client_timeout seconds
+static bool web_client_stream_drain(struct web_client *w) {
+    usec_t timeout_ut = 0;
+
+    while(web_client_stream_pending(w) > NETDATA_WEB_RESPONSE_STREAM_MAX_PENDING) {
+        ssize_t bytes = web_client_stream_send(w);
+        if(unlikely(bytes < 0))
+            return false;
+
+        if(bytes > 0) {
+            timeout_ut = 0;
+            continue;
+        }
+
+        if(unlikely(web_client_interrupt_callback(w)))
+            return false;
+
+        usec_t now_ut = now_monotonic_usec();
+        if(!timeout_ut)
+            timeout_ut = now_ut + (usec_t)web_client_timeout * USEC_PER_SEC;
+        else if(now_ut >= timeout_ut) {
+            info("%llu: The client did not read the streamed response for %d seconds.", w->id, web_client_timeout);
+            return false;
+        }
+
+        struct pollfd pfd = {
+                .fd = w->ofd,
+                .events = POLLOUT,
+                .revents = 0,
+        };
+
+        if(poll(&pfd, 1, NETDATA_WEB_RESPONSE_STREAM_POLL_MS) == -1 && errno != EINTR)
+            return false;
+    }
+
+    return true;
+}
+
+// called by the queries, between the slices of their output
+// returns true when the output in wb has been taken (and wb has been flushed)
+bool web_client_flush_callback(BUFFER *wb, void *data) {
+    struct web_client *w = data;
+
+    // the SSL connections are not shared with the query threads
+    // and queries running inline on a web server thread (no query threads, or a full queue)
+    // are not streamed, because waiting for a slow client would block all its other clients
+    if(unlikely(wb != w->response.data || w->mode != WEB_CLIENT_MODE_NORMAL || web_client_uses_ssl(w) || !w->running))
+        return false;
+
+    if(unlikely(web_client_check_dead(w))) {
+        // the client cannot get it, but the output is dropped to keep the memory low
+        buffer_flush(wb);
+        return true;
+    }
+
+    if(!web_client_flag_check(w, WEB_CLIENT_FLAG_STREAMING)) {
+        // the response header is sent with the first part of the response
+        now_realtime_timeval(&w->tv_ready);
+
+        if(unlikely(!wb->date))
+            wb->date = w->tv_ready.tv_sec;
+
+        w->response.code = HTTP_RESP_OK;
+        web_client_flag_set(w, WEB_CLIENT_FLAG_STREAMING | WEB_CLIENT_CHUNKED_TRANSFER);
+        web_client_build_http_header(w);
+
+        if(!w->response.stream)
+            w->response.stream = buffer_create(NETDATA_WEB_RESPONSE_INITIAL_SIZE, &netdata_buffers_statistics.buffers_web);
+
+        buffer_fast_strcat(w->response.stream, buffer_tostring(w->response.header_output), buffer_strlen(w->response.header_output));
+    }
+
+    if(unlikely(!web_client_stream_encode(w, wb, false) || web_client_stream_send(w) < 0 || !web_client_stream_drain(w))) {
+        debug(D_WEB_CLIENT, "%llu: Failed to stream the response to the client.", w->id);
+        WEB_CLIENT_IS_DEAD(w);
+        buffer_flush(wb);
+    }
+
+    return true;
+}
+
+// the query of a streamed response is done - what is left is sent by web_client_send()
+static void web_client_finish_stream(struct web_client *w) {
+    if(likely(w->response.code == HTTP_RESP_OK)) {
+        if(unlikely(!web_client_stream_encode(w, w->response.data, true)))
+            WEB_CLIENT_IS_DEAD(w);
+    }
+    else {
+        // the header has been sent already, so the response is left unterminated and the
+        // connection is closed, for the client to know it is incomplete
+        info("%llu: Streamed response failed with code %d. Closing the connection.", w->id, w->response.code);
+        buffer_flush(w->response.data);
+        web_client_disable_keepalive(w);
+    }
+
+    w->response.sent = 0;
+    web_client_enable_wait_send(w);
+}
+
+static void web_client_process_request_finish(struct web_client *w) {
+    if(unlikely(web_client_flag_check(w, WEB_CLIENT_FLAG_STREAMING))) {
+        web_client_finish_stream(w);
+        return;
+    }
+
     // keep track of the processing time
     now_realtime_timeval(&w->tv_ready);
 
@@ -1613,20 +2092,12 @@ void web_client_process_request(struct web_client *w) {
         case WEB_CLIENT_MODE_FILECOPY:
             if(w->response.rlen) {
                 debug(D_WEB_CLIENT, "%llu: Done preparing the response. Will be sending data file of %zu bytes to client.", w->id, w->response.rlen);
-                web_client_enable_wait_receive(w);
-
-                /*
-                // utilize the kernel sendfile() for copying the file to the socket.
-                // this block of code can be commented, without anything missing.
-                // when it is commented, the program will copy the data using async I/O.
-                {
-                    long len = sendfile(w->ofd, w->ifd, NULL, w->response.data->rbytes);
-                    if(len != w->response.data->rbytes)
-                        error("%llu: sendfile() should copy %ld bytes, but copied %ld. Falling back to manual copy.", w->id, w->response.data->rbytes, len);
-                    else
-                        web_client_request_done(w);
-                }
-                */
+
+                // cached files and files sent with sendfile() are not read before sending them
+                if(w->response.static_file || web_client_flag_check(w, WEB_CLIENT_FLAG_SENDFILE))
+                    web_client_enable_wait_send(w);
+                else
+                    web_client_enable_wait_receive(w);
             }
             else
                 debug(D_WEB_CLIENT, "%llu: Done preparing the response. Will be sending an unknown amount of bytes to client.", w->id);
@@ -1824,11 +2295,88 @@ ssize_t web_client_send_deflate(struct web_client *w)
 }
 #endif // NETDATA_WITH_ZLIB
 
+static inline ssize_t web_client_send_done(struct web_client *w) {
+    if(unlikely(!web_client_has_keepalive(w))) {
+        debug(D_WEB_CLIENT, "%llu: Closing (keep-alive is not enabled). %zu bytes sent.", w->id, w->response.sent);
+        WEB_CLIENT_IS_DEAD(w);
+        return 0;
+    }
+
+    web_client_request_done(w);
+    debug(D_WEB_CLIENT, "%llu: Done sending all data on socket. Waiting for next request on the same socket.", w->id);
+    return 0;
+}
+
+// sends a file cached in memory, or a file with sendfile()
+static ssize_t web_client_send_file(struct web_client *w) {
+    if(unlikely(w->response.sent >= w->response.rlen)) {
+        debug(D_WEB_CLIENT, "%llu: Out of file data.", w->id);
+        return web_client_send_done(w);
+    }
+
+    ssize_t bytes;
+    size_t left = w->response.rlen - w->response.sent;
+
+    if(w->response.static_file)
+        bytes = web_client_send_data(w, &w->response.static_data[w->response.sent], left, MSG_DONTWAIT);
+    else {
+#ifdef __linux__
+        off_t offset = (off_t)w->response.sent;
+        bytes = sendfile(w->ofd, w->ifd, &offset, left);
+
+        if(unlikely(bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)))
+            bytes = 0;
+        else if(unlikely(bytes == 0)) {
+            error("%llu: file has been truncated while sending it, %zu bytes are missing.", w->id, left);
+            bytes = -1;
+        }
+#else
+        bytes = -1;
+#endif
+    }
+
+    if(likely(bytes > 0)) {
+        w->stats_sent_bytes += bytes;
+        w->response.sent += bytes;
+        debug(D_WEB_CLIENT, "%llu: Sent %zd bytes of file.", w->id, bytes);
+    }
+    else if(likely(bytes == 0)) {
+        debug(D_WEB_CLIENT, "%llu: Did not send any bytes to the client.", w->id);
+    }
+    else {
+        debug(D_WEB_CLIENT, "%llu: Failed to send file to client.", w->id);
+        WEB_CLIENT_IS_DEAD(w);
+    }
+
+    return(bytes);
+}
+
+static ssize_t web_client_send_stream(struct web_client *w) {
+    if(unlikely(w->response.stream_sent == buffer_strlen(w->response.stream))) {
+        debug(D_WEB_CLIENT, "%llu: Out of streamed data.", w->id);
+        return web_client_send_done(w);
+    }
+
+    ssize_t bytes = web_client_stream_send(w);
+    if(unlikely(bytes < 0)) {
+        debug(D_WEB_CLIENT, "%llu: Failed to send streamed data to client.", w->id);
+        WEB_CLIENT_IS_DEAD(w);
+    }
+
+    return bytes;
+}
+
 ssize_t web_client_send(struct web_client *w) {
+    if(unlikely(web_client_flag_check(w, WEB_CLIENT_FLAG_STREAMING)))
+        return web_client_send_stream(w);
+
 #ifdef NETDATA_WITH_ZLIB
     if(likely(w->response.zoutput)) return web_client_send_deflate(w);
 #endif // NETDATA_WITH_ZLIB
 
+    if(unlikely(w->response.static_file || web_client_flag_check(w, WEB_CLIENT_FLAG_SENDFILE)))
+        return web_client_send_file(w);
+
     ssize_t bytes;
 
     if(unlikely(w->response.data->len - w->response.sent == 0)) {
@@ -1847,15 +2395,7 @@ ssize_t web_client_send(struct web_client *w) {
             return 0;
         }
 
-        if(unlikely(!web_client_has_keepalive(w))) {
-            debug(D_WEB_CLIENT, "%llu: Closing (keep-alive is not enabled). %zu bytes sent.", w->id, w->response.sent);
-            WEB_CLIENT_IS_DEAD(w);
-            return 0;
-        }
-
-        web_client_request_done(w);
-        debug(D_WEB_CLIENT, "%llu: Done sending all data on socket. Waiting for next request on the same socket.", w->id);
-        return 0;
+        return web_client_send_done(w);
     }
 
     bytes = web_client_send_data(w,&w->response.data->buffer[w->response.sent], w->response.data->len - w->response.sent, MSG_DONTWAIT);
@@ -1995,3 +2535,263 @@ int web_client_socket_is_now_used_for_streaming(struct web_client *w) {
 
     return HTTP_RESP_OK;
 }
+
+// ----------------------------------------------------------------------------
+// unittest
+
+static int web_client_unittest_accept_encoding(void) {
+    struct {
+        const char *header;
+        const char *encoding;
+        bool accepted;
+    } tests[] = {
+            { "gzip, deflate, br",          "br",   true  },
+            { "gzip, deflate, br",          "gzip", true  },
+            { "gzip;q=1.0, br;q=0",         "br",   false },
+            { "gzip;q=1.0, br;q=0",         "gzip", true  },
+            { "br ; q=0.000",               "br",   false },
+            { "br;q=0.5",                   "br",   true  },
+            { "gzip;q=0, br",               "gzip", false },
+            { "x-brotli, abr",              "br",   false },
+            { "x-gzip",                     "gzip", false },
+            { "*",                          "br",   true  },
+            { "gzip, *;q=0",                "br",   false },
+            { "BR",                         "br",   true  },
+            { "",                           "gzip", false },
+    };
+
+    int errors = 0;
+    for(size_t i = 0; i < sizeof(tests) / sizeof(tests[0]) ; i++) {
+        bool accepted = http_header_accepts_encoding(tests[i].header, tests[i].encoding);
+        if(accepted != tests[i].accepted) {
+            fprintf(stderr, "WEB CLIENT: Accept-Encoding '%s' should %saccept '%s' - FAILED\n",
+                    tests[i].header, tests[i].accepted ? "" : "not ", tests[i].encoding);
+            errors++;
+        }
+    }
+
+    fprintf(stderr, "WEB CLIENT: Accept-Encoding parsing - %s\n", errors ? "FAILED" : "OK");
+    return errors;
+}
+
+struct web_client_unittest_slow_reader {
+    int fd;
+    size_t received;
+};
+
+static void *web_client_unittest_slow_reader_thread(void *ptr) {
+    struct web_client_unittest_slow_reader *r = ptr;
+    char buf[4096];
+
+    while(true) {
+        ssize_t bytes = read(r->fd, buf, sizeof(buf));
+        if(bytes <= 0) {
+            if(bytes == -1 && errno == EINTR)
+                continue;
+            break;
+        }
+
+        r->received += bytes;
+        sleep_usec(200);
+    }
+
+    return ptr;
+}
+
+// a query streams its output to a client that reads slower than the query produces it
+static int web_client_unittest_slow_reader(void) {
+    int sv[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1) {
+        error("WEB CLIENT: cannot create a socket pair");
+        return 1;
+    }
+
+    struct web_client_unittest_slow_reader r = {
+            .fd = sv[1],
+            .received = 0,
+    };
+
+    netdata_thread_t thread;
+    netdata_thread_create(&thread, "WEBSLOWREADER", NETDATA_THREAD_OPTION_JOINABLE | NETDATA_THREAD_OPTION_DONT_LOG,
+                          web_client_unittest_slow_reader_thread, &r);
+
+    struct web_client *w = web_client_get_from_cache_or_allocate();
+    w->ifd = w->ofd = sv[0];
+    w->running = 1; // as if the query runs on a query thread
+    w->response.data->content_type = CT_TEXT_PLAIN;
+    w->response.data->expires = now_realtime_sec() + 1;
+
+    int errors = 0;
+    size_t slices = 256, max_pending = 0;
+    char slice[NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE];
+    memset(slice, 'x', sizeof(slice));
+
+    for(size_t i = 0; i < slices && !errors ; i++) {
+        buffer_fast_strcat(w->response.data, slice, sizeof(slice));
+
+        if(!web_client_flush_callback(w->response.data, w) || web_client_check_dead(w) || buffer_strlen(w->response.data)) {
+            fprintf(stderr, "WEB CLIENT: slice %zu of the streamed response was not sent\n", i);
+            errors++;
+            break;
+        }
+
+        size_t pending = web_client_stream_pending(w);
+        if(pending > max_pending)
+            max_pending = pending;
+
+        if(pending > NETDATA_WEB_RESPONSE_STREAM_MAX_PENDING) {
+            fprintf(stderr, "WEB CLIENT: %zu bytes of the streamed response are waiting, more than %d\n",
+                    pending, NETDATA_WEB_RESPONSE_STREAM_MAX_PENDING);
+            errors++;
+        }
+    }
+
+    // send the rest and let the reader finish
+    web_client_stream_encode(w, w->response.data, true);
+    while(!errors && web_client_stream_pending(w)) {
+        if(web_client_stream_send(w) < 0) {
+            fprintf(stderr, "WEB CLIENT: cannot send the end of the streamed response\n");
+            errors++;
+        }
+        else
+            sleep_usec(1000);
+    }
+
+    shutdown(sv[0], SHUT_WR);
+    netdata_thread_join(thread, NULL);
+
+    if(!errors && (r.received != w->stats_sent_bytes || w->response.streamed != slices * sizeof(slice))) {
+        fprintf(stderr, "WEB CLIENT: the reader got %zu bytes of the %zu sent, for %zu bytes of output\n",
+                r.received, w->stats_sent_bytes, w->response.streamed);
+        errors++;
+    }
+
+    fprintf(stderr, "WEB CLIENT: streamed %zu bytes to a slow reader, with up to %zu bytes waiting - %s\n",
+            w->response.streamed, max_pending, errors ? "FAILED" : "OK");
+
+    close(sv[0]);
+    close(sv[1]);
+    w->ifd = w->ofd = -1;
+    w->running = 0;
+    web_client_cache_destroy();
+
+    return errors;
+}
+
+// queries running inline on a web server thread are never streamed
+static int web_client_unittest_inline_query(void) {
+    struct web_client *w = web_client_get_from_cache_or_allocate();
+    buffer_strcat(w->response.data, "not streamed");
+
+    int errors = 0;
+    if(web_client_flush_callback(w->response.data, w) || strcmp(buffer_tostring(w->response.data), "not streamed") != 0) {
+        fprintf(stderr, "WEB CLIENT: the response of a query not running on a query thread has been streamed\n");
+        errors++;
+    }
+
+    fprintf(stderr, "WEB CLIENT: inline queries are not streamed - %s\n", errors ? "FAILED" : "OK");
+    web_client_cache_destroy();
+    return errors;
+}
+
+// HTTP/1.1 pipelining: the requests following the first are kept until its response is sent
+static int web_client_unittest_pipelining(void) {
+    struct {
+        const char *name;
+        const char *received;
+        HTTP_VALIDATION validation;
+        const char *url;
+        const char *pipelined;
+    } tests[] = {
+            {
+                    .name = "two requests in one read",
+                    .received = "GET /api/v1/info HTTP/1.1\r\nHost: localhost\r\n\r\nGET /api/v1/charts HTTP/1.1\r\nHost: localhost\r\n\r\n",
+                    .validation = HTTP_VALIDATION_OK,
+                    .url = "/api/v1/info",
+                    .pipelined = "GET /api/v1/charts HTTP/1.1\r\nHost: localhost\r\n\r\n",
+            },
+            {
+                    .name = "a partial second request",
+                    .received = "GET /api/v1/info HTTP/1.1\r\n\r\nGET /api/v1/cha",
+                    .validation = HTTP_VALIDATION_OK,
+                    .url = "/api/v1/info",
+                    .pipelined = "GET /api/v1/cha",
+            },
+            {
+                    .name = "a single request",
+                    .received = "GET /api/v1/info HTTP/1.1\r\n\r\n",
+                    .validation = HTTP_VALIDATION_OK,
+                    .url = "/api/v1/info",
+                    .pipelined = "",
+            },
+    };
+
+    int errors = 0;
+    for(size_t i = 0; i < sizeof(tests) / sizeof(tests[0]) ; i++) {
+        struct web_client *w = web_client_get_from_cache_or_allocate();
+        buffer_strcat(w->response.data, tests[i].received);
+
+        HTTP_VALIDATION validation = http_request_validate(w);
+        const char *pipelined = w->pipeline ? buffer_tostring(w->pipeline) : "";
+
+        if(validation != tests[i].validation || strcmp(w->decoded_url, tests[i].url) != 0 || strcmp(pipelined, tests[i].pipelined) != 0) {
+            fprintf(stderr, "WEB CLIENT: pipelining '%s' gave validation %d for url '%s', keeping '%s' - FAILED\n",
+                    tests[i].name, (int)validation, w->decoded_url, pipelined);
+            errors++;
+        }
+        else if(*tests[i].pipelined) {
+            // the kept request becomes the next request of the client
+            web_client_request_done(w);
+
+            if(!web_client_flag_check(w, WEB_CLIENT_FLAG_PIPELINED_REQUEST) ||
+               strcmp(buffer_tostring(w->response.data), tests[i].pipelined) != 0 ||
+               buffer_strlen(w->pipeline)) {
+                fprintf(stderr, "WEB CLIENT: pipelining '%s' did not move the next request back - FAILED\n", tests[i].name);
+                errors++;
+            }
+        }
+
+        web_client_cache_destroy();
+    }
+
+    // the requests waiting are limited to NETDATA_WEB_REQUEST_MAX_SIZE
+    {
+        struct web_client *w = web_client_get_from_cache_or_allocate();
+        const char *request = "GET /api/v1/info HTTP/1.1\r\n\r\n";
+        size_t len = strlen(request), pipelined = 0;
+        HTTP_VALIDATION validation = HTTP_VALIDATION_OK;
+
+        while(validation == HTTP_VALIDATION_OK && pipelined <= NETDATA_WEB_REQUEST_MAX_SIZE) {
+            buffer_flush(w->response.data);
+            buffer_strcat(w->response.data, request);
+            buffer_strcat(w->response.data, request);
+
+            validation = http_request_validate(w);
+            if(validation == HTTP_VALIDATION_OK)
+                pipelined += len;
+        }
+
+        if(validation != HTTP_VALIDATION_EXCESS_REQUEST_DATA || buffer_strlen(w->pipeline) > NETDATA_WEB_REQUEST_MAX_SIZE) {
+            fprintf(stderr, "WEB CLIENT: pipelining more than %d bytes gave validation %d, keeping %zu bytes - FAILED\n",
+                    NETDATA_WEB_REQUEST_MAX_SIZE, (int)validation, buffer_strlen(w->pipeline));
+            errors++;
+        }
+
+        web_client_cache_destroy();
+    }
+
+    fprintf(stderr, "WEB CLIENT: pipelining - %s\n", errors ? "FAILED" : "OK");
+    return errors;
+}
+
+int web_client_unittest(void) {
+    int errors = 0;
+
+    errors += web_client_unittest_accept_encoding();
+    errors += web_client_unittest_slow_reader();
+    errors += web_client_unittest_inline_query();
+    errors += web_client_unittest_pipelining();
+
+    fprintf(stderr, "WEB CLIENT: %d errors\n", errors);
+    return errors;
+}
@@ -4,6 +4,7 @@
 #define NETDATA_WEB_CLIENT_H 1
 
 #include "libnetdata/libnetdata.h"
+#include "web_static_files.h"
 
 #ifdef NETDATA_WITH_ZLIB
 extern int web_enable_gzip, web_gzip_level, web_gzip_strategy;
@@ -14,6 +15,7 @@ extern int web_enable_gzip, web_gzip_level, web_gzip_strategy;
 
 // HTTP_CODES 3XX Redirections
 #define HTTP_RESP_MOVED_PERM 301
+#define HTTP_RESP_NOT_MODIFIED 304
 #define HTTP_RESP_REDIR_TEMP 307
 #define HTTP_RESP_REDIR_PERM 308
 
@@ -76,11 +78,30 @@ typedef enum web_client_flags {
 
     WEB_CLIENT_FLAG_SSL_WAIT_RECEIVE = 1 << 11, // if set, we are waiting more input data from an ssl conn
     WEB_CLIENT_FLAG_SSL_WAIT_SEND = 1 << 12,    // if set, we have data to send to the client from an ssl conn
+
+    WEB_CLIENT_FLAG_QUERIES_CAN_BE_DEFERRED = 1 << 13, // if set, the web server can execute the queries of the client in other threads
+    WEB_CLIENT_FLAG_QUERY_DEFERRED = 1 << 14,          // if set, the request is a query, waiting to be executed
+
+    WEB_CLIENT_FLAG_SENDFILE = 1 << 15,       // if set, the file in ifd is sent with sendfile()
+    WEB_CLIENT_FLAG_ACCEPT_BROTLI = 1 << 16,  // if set, the client accepts brotli compressed responses
+
+    WEB_CLIENT_FLAG_STREAMING = 1 << 17,         // if set, the response is sent while it is generated (chunked)
+    WEB_CLIENT_FLAG_PIPELINED_REQUEST = 1 << 18, // if set, the next request has been received with the previous one
 } WEB_CLIENT_FLAGS;
 
+// the priority of the requests that can be executed outside the web server threads
+typedef enum web_client_query_priority {
+    WEB_CLIENT_QUERY_INLINE = 0,    // not a query, the web server threads process it
+    WEB_CLIENT_QUERY_HIGH,          // interactive queries (chart data, badges)
+    WEB_CLIENT_QUERY_LOW,           // bulk queries (weights, metric correlations, allmetrics, functions)
+
+    // terminator
+    WEB_CLIENT_QUERY_PRIORITIES,
+} WEB_CLIENT_QUERY_PRIORITY;
+
 #define web_client_flag_check(w, flag) ((w)->flags & (flag))
-#define web_client_flag_set(w, flag) (w)->flags |= flag
-#define web_client_flag_clear(w, flag) (w)->flags &= ~flag
+#define web_client_flag_set(w, flag) (w)->flags |= (flag)
+#define web_client_flag_clear(w, flag) (w)->flags &= ~(flag)
 
 #define WEB_CLIENT_IS_DEAD(w) web_client_flag_set(w, WEB_CLIENT_FLAG_DEAD)
 #define web_client_check_dead(w) web_client_flag_check(w, WEB_CLIENT_FLAG_DEAD)
@@ -131,6 +152,10 @@ typedef enum web_client_flags {
 #define NETDATA_WEB_REQUEST_INITIAL_SIZE 8192
 #define NETDATA_WEB_REQUEST_MAX_SIZE 65536
 
+// when more of a streamed response is waiting to be sent, the query waits for the client
+#define NETDATA_WEB_RESPONSE_STREAM_MAX_PENDING (4 * NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE)
+#define NETDATA_WEB_RESPONSE_STREAM_POLL_MS 100
+
 struct response {
     BUFFER *header;        // our response header
     BUFFER *header_output; // internal use
@@ -149,6 +174,13 @@ struct response {
     size_t zhave;                                        // the compressed bytes that we have received from zlib
     unsigned int zinitialized : 1;
 #endif /* NETDATA_WITH_ZLIB */
+
+    WEB_STATIC_FILE *static_file; // if set, the response is this cached file
+    const char *static_data;      // the variant of the cached file sent (rlen bytes)
+
+    BUFFER *stream;     // the chunks of a streamed response, not sent yet
+    size_t stream_sent; // the bytes of the stream buffer sent
+    size_t streamed;    // the bytes of the response data streamed so far
 };
 
 struct web_client {
@@ -186,6 +218,9 @@ struct web_client {
     char cookie2[NETDATA_WEB_REQUEST_COOKIE_SIZE + 1];
     char origin[NETDATA_WEB_REQUEST_ORIGIN_HEADER_SIZE + 1];
     char *user_agent;
+    char *if_none_match; // the ETags of the If-None-Match header (if sent)
+
+    BUFFER *pipeline;    // the requests received after the one being processed (HTTP/1.1 pipelining)
 
     struct response response;
 
@@ -203,6 +238,7 @@ struct web_client {
     // STATIC-THREADED WEB SERVER MEMBERS
     size_t pollinfo_slot;          // POLLINFO slot of the web client
     size_t pollinfo_filecopy_slot; // POLLINFO slot of the file read
+    WEB_CLIENT_QUERY_PRIORITY query_priority; // the priority of the deferred query
 #ifdef ENABLE_HTTPS
     struct netdata_ssl ssl;
 #endif
@@ -215,8 +251,14 @@ ssize_t web_client_receive(struct web_client *w);
 ssize_t web_client_read_file(struct web_client *w);
 
 void web_client_process_request(struct web_client *w);
+
+WEB_CLIENT_QUERY_PRIORITY web_client_query_priority(const char *url);
+void web_client_execute_deferred_query(struct web_client *w);
+void web_client_finish_deferred_query(struct web_client *w);
 void web_client_request_done(struct web_client *w);
 
+bool web_client_flush_callback(BUFFER *wb, void *data);
+
 void buffer_data_options2string(BUFFER *wb, uint32_t options);
 
 int mysendfile(struct web_client *w, char *filename);
@@ -226,6 +268,8 @@ char *strip_control_characters(char *url);
 
 int web_client_socket_is_now_used_for_streaming(struct web_client *w);
 
+int web_client_unittest(void);
+
 #include "web/api/web_api_v1.h"
 #include "web/api/web_api_v2.h"
 #include "daemon/common.h"
@@ -41,6 +41,11 @@ static void web_client_zero(struct web_client *w) {
     buffer_flush(b3);
 
     freez(w->user_agent);
+    freez(w->if_none_match);
+
+    // the buffers of pipelining and streaming are allocated when needed
+    buffer_free(w->pipeline);
+    buffer_free(w->response.stream);
 
     // zero everything
     memset(w, 0, sizeof(struct web_client));
@@ -55,7 +60,10 @@ static void web_client_free(struct web_client *w) {
     buffer_free(w->response.header_output);
     buffer_free(w->response.header);
     buffer_free(w->response.data);
+    buffer_free(w->pipeline);
+    buffer_free(w->response.stream);
     freez(w->user_agent);
+    freez(w->if_none_match);
 #ifdef ENABLE_HTTPS
     if ((!web_client_check_unix(w)) && (netdata_ssl_srv_ctx)) {
         if (w->ssl.conn) {
@@ -0,0 +1,585 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "web_static_files.h"
+#include "web_server.h"
+
+#define WEB_STATIC_FILES_BUCKETS 256                // must be a power of 2
+#define WEB_STATIC_FILES_MAX_FILE_SIZE_RATIO 4      // a file cannot use more than 1/4 of the cache
+
+struct web_static_file {
+    uint32_t hash;
+    char *filename;
+
+    // the file on disk, when it was cached
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    uint64_t mtime_ns;
+
+    bool loading;                                   // the file is being read, there is no content yet
+    bool obsolete;                                  // not in the cache any more, freed when released
+    int32_t refcount;
+
+    struct {
+        char *data;
+        size_t len;
+    } encodings[WEB_STATIC_FILE_ENCODINGS];
+
+    size_t memory;
+
+    struct web_static_file *prev, *next;            // the LRU list, the most recently used first
+    struct web_static_file *bucket_next;            // the next file of the same bucket
+};
+
+static struct {
+    size_t max_size;                                // zero disables the cache
+
+    netdata_mutex_t mutex;
+    pthread_cond_t cond;                            // signaled when a file has been loaded
+
+    size_t size;                                    // the memory used by the cached files
+    size_t files;
+    WEB_STATIC_FILE *lru;
+    WEB_STATIC_FILE *buckets[WEB_STATIC_FILES_BUCKETS];
+} web_static_files = {
+        .max_size = 32 * 1024 * 1024,
+        .mutex = NETDATA_MUTEX_INITIALIZER,
+        .cond = PTHREAD_COND_INITIALIZER,
+        .size = 0,
+        .files = 0,
+        .lru = NULL,
+        .buckets = { NULL },
+};
+
+void web_static_files_init(void) {
+    long long size_mb = config_get_number(CONFIG_SECTION_WEB, "static files cache size MB", (long long)(web_static_files.max_size / 1024 / 1024));
+    if(size_mb < 0) {
+        size_mb = 0;
+        config_set_number(CONFIG_SECTION_WEB, "static files cache size MB", size_mb);
+    }
+    web_static_files.max_size = (size_t)size_mb * 1024 * 1024;
+}
+
+static inline uint64_t web_static_file_mtime_ns(struct stat *st) {
+#ifdef __APPLE__
+    return (uint64_t)st->st_mtimespec.tv_sec * NSEC_PER_SEC + (uint64_t)st->st_mtimespec.tv_nsec;
+#else
+    return (uint64_t)st->st_mtim.tv_sec * NSEC_PER_SEC + (uint64_t)st->st_mtim.tv_nsec;
+#endif
+}
+
+static inline bool web_static_file_is_same(WEB_STATIC_FILE *sf, struct stat *st) {
+    return sf->dev == st->st_dev && sf->ino == st->st_ino && sf->size == st->st_size && sf->mtime_ns == web_static_file_mtime_ns(st);
+}
+
+// ----------------------------------------------------------------------------
+// ETags
+
+void web_static_file_etag(struct stat *st, char *dst, size_t dst_size) {
+    snprintfz(dst, dst_size - 1, "W/\"%llx-%llx-%llx\"",
+              (unsigned long long)st->st_ino, (unsigned long long)st->st_size, (unsigned long long)web_static_file_mtime_ns(st));
+}
+
+static inline const char *web_static_file_etag_opaque(const char *etag, size_t *len) {
+    // weak comparison: the W/ prefix is ignored
+    if(etag[0] == 'W' && etag[1] == '/')
+        etag += 2;
+
+    *len = strlen(etag);
+    return etag;
+}
+
+bool web_static_file_etag_matches(const char *if_none_match, const char *etag) {
+    if(!if_none_match || !etag)
+        return false;
+
+    size_t etag_len;
+    etag = web_static_file_etag_opaque(etag, &etag_len);
+
+    const char *s = if_none_match;
+    while(*s) {
+        while(*s == ' ' || *s == '\t' || *s == ',') s++;
+        if(!*s) break;
+
+        if(*s == '*')
+            return true;
+
+        if(s[0] == 'W' && s[1] == '/')
+            s += 2;
+
+        const char *e = s;
+        if(*e == '"') {
+            e++;
+            while(*e && *e != '"') e++;
+            if(*e == '"') e++;
+        }
+        else {
+            while(*e && *e != ',' && *e != ' ' && *e != '\t') e++;
+        }
+
+        if((size_t)(e - s) == etag_len && !strncmp(s, etag, etag_len))
+            return true;
+
+        s = e;
+    }
+
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// loading files
+
+static char *web_static_file_read(const char *filename, struct stat *st, size_t *len) {
+    int fd = open(filename, O_RDONLY);
+    if(fd == -1)
+        return NULL;
+
+    // make sure we read the file we have been given
+    struct stat fst;
+    if(fstat(fd, &fst) != 0 || fst.st_dev != st->st_dev || fst.st_ino != st->st_ino ||
+       fst.st_size != st->st_size || web_static_file_mtime_ns(&fst) != web_static_file_mtime_ns(st)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st->st_size;
+    char *data = mallocz(size + 1);
+    size_t got = 0;
+    while(got < size) {
+        ssize_t bytes = read(fd, &data[got], size - got);
+        if(bytes < 0 && errno == EINTR)
+            continue;
+
+        if(bytes <= 0)
+            break;
+
+        got += (size_t)bytes;
+    }
+    close(fd);
+
+    if(got != size) {
+        freez(data);
+        return NULL;
+    }
+
+    data[size] = '\0';
+    *len = size;
+    return data;
+}
+
+#ifdef NETDATA_WITH_ZLIB
+static char *web_static_file_gzip(const char *data, size_t len, size_t *compressed_len) {
+    z_stream zs = {
+            .zalloc = Z_NULL,
+            .zfree = Z_NULL,
+            .opaque = Z_NULL,
+    };
+
+    // the file is compressed once, so use the best compression
+    if(deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+        return NULL;
+
+    size_t size = deflateBound(&zs, (uLong)len);
+    char *compressed = mallocz(size);
+
+    zs.next_in = (Bytef *)data;
+    zs.avail_in = (uInt)len;
+    zs.next_out = (Bytef *)compressed;
+    zs.avail_out = (uInt)size;
+
+    int rc = deflate(&zs, Z_FINISH);
+    *compressed_len = zs.total_out;
+    deflateEnd(&zs);
+
+    // keep it only when it saves something
+    if(rc != Z_STREAM_END || *compressed_len >= len) {
+        freez(compressed);
+        return NULL;
+    }
+
+    return compressed;
+}
+#endif // NETDATA_WITH_ZLIB
+
+static void web_static_file_load(WEB_STATIC_FILE *sf, struct stat *st, bool compress) {
+    size_t len = 0;
+    char *data = web_static_file_read(sf->filename, st, &len);
+    if(!data)
+        return;
+
+    sf->encodings[WEB_STATIC_FILE_IDENTITY].data = data;
+    sf->encodings[WEB_STATIC_FILE_IDENTITY].len = len;
+
+#ifdef NETDATA_WITH_ZLIB
+    if(compress)
+        sf->encodings[WEB_STATIC_FILE_GZIP].data = web_static_file_gzip(data, len, &sf->encodings[WEB_STATIC_FILE_GZIP].len);
+#else
+    (void)compress;
+#endif
+
+    // a pre-compressed brotli variant, not older than the file
+    char filename[FILENAME_MAX + 1];
+    snprintfz(filename, FILENAME_MAX, "%s.br", sf->filename);
+
+    struct stat br_st;
+    if(stat(filename, &br_st) == 0 && (br_st.st_mode & S_IFMT) == S_IFREG &&
+       br_st.st_size > 0 && br_st.st_size < st->st_size &&
+       web_static_file_mtime_ns(&br_st) >= web_static_file_mtime_ns(st))
+        sf->encodings[WEB_STATIC_FILE_BROTLI].data = web_static_file_read(filename, &br_st, &sf->encodings[WEB_STATIC_FILE_BROTLI].len);
+
+    sf->memory = sizeof(WEB_STATIC_FILE) + strlen(sf->filename) + 1;
+    for(size_t i = 0; i < WEB_STATIC_FILE_ENCODINGS ;i++) {
+        if(!sf->encodings[i].data)
+            sf->encodings[i].len = 0;
+
+        sf->memory += sf->encodings[i].len;
+    }
+}
+
+static void web_static_file_free(WEB_STATIC_FILE *sf) {
+    for(size_t i = 0; i < WEB_STATIC_FILE_ENCODINGS ;i++)
+        freez(sf->encodings[i].data);
+
+    freez(sf->filename);
+    freez(sf);
+}
+
+// ----------------------------------------------------------------------------
+// the cache - all these are called with the mutex locked
+
+static WEB_STATIC_FILE *web_static_file_find(const char *filename, uint32_t hash) {
+    WEB_STATIC_FILE *sf;
+    for(sf = web_static_files.buckets[hash & (WEB_STATIC_FILES_BUCKETS - 1)]; sf ; sf = sf->bucket_next) {
+        if(sf->hash == hash && !strcmp(sf->filename, filename))
+            return sf;
+    }
+
+    return NULL;
+}
+
+static void web_static_file_del(WEB_STATIC_FILE *sf) {
+    WEB_STATIC_FILE **p = &web_static_files.buckets[sf->hash & (WEB_STATIC_FILES_BUCKETS - 1)];
+    while(*p && *p != sf)
+        p = &(*p)->bucket_next;
+
+    if(*p)
+        *p = sf->bucket_next;
+
+    DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(web_static_files.lru, sf, prev, next);
+
+    web_static_files.size -= sf->memory;
+    web_static_files.files--;
+
+    // the files sent to clients are freed when the last of them is done
+    sf->obsolete = true;
+    if(!sf->refcount)
+        web_static_file_free(sf);
+}
+
+static void web_static_files_evict(void) {
+    // the least recently used are at the end of the list
+    WEB_STATIC_FILE *sf = web_static_files.lru ? web_static_files.lru->prev : NULL;
+    while(sf && web_static_files.size > web_static_files.max_size) {
+        WEB_STATIC_FILE *prev = (sf == web_static_files.lru) ? NULL : sf->prev;
+
+        if(!sf->loading)
+            web_static_file_del(sf);
+
+        sf = prev;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// the API
+
+WEB_STATIC_FILE *web_static_file_acquire(const char *filename, struct stat *st, bool compress) {
+    if(!web_static_files.max_size || (size_t)st->st_size > web_static_files.max_size / WEB_STATIC_FILES_MAX_FILE_SIZE_RATIO)
+        return NULL;
+
+    uint32_t hash = simple_hash(filename);
+    WEB_STATIC_FILE *sf;
+
+    netdata_mutex_lock(&web_static_files.mutex);
+
+    while((sf = web_static_file_find(filename, hash)) && sf->loading)
+        pthread_cond_wait(&web_static_files.cond, &web_static_files.mutex);
+
+    if(sf && web_static_file_is_same(sf, st)) {
+        sf->refcount++;
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(web_static_files.lru, sf, prev, next);
+        DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(web_static_files.lru, sf, prev, next);
+        netdata_mutex_unlock(&web_static_files.mutex);
+        return sf;
+    }
+
+    // the file has changed on disk
+    if(sf)
+        web_static_file_del(sf);
+
+    // add it loading, so that the other threads wait for it, instead of loading it too
+    sf = callocz(1, sizeof(WEB_STATIC_FILE));
+    sf->hash = hash;
+    sf->filename = strdupz(filename);
+    sf->dev = st->st_dev;
+    sf->ino = st->st_ino;
+    sf->size = st->st_size;
+    sf->mtime_ns = web_static_file_mtime_ns(st);
+    sf->loading = true;
+    sf->refcount = 1;
+    sf->memory = sizeof(WEB_STATIC_FILE) + strlen(filename) + 1;
+
+    WEB_STATIC_FILE **bucket = &web_static_files.buckets[hash & (WEB_STATIC_FILES_BUCKETS - 1)];
+    sf->bucket_next = *bucket;
+    *bucket = sf;
+    DOUBLE_LINKED_LIST_PREPEND_ITEM_UNSAFE(web_static_files.lru, sf, prev, next);
+    web_static_files.size += sf->memory;
+    web_static_files.files++;
+
+    netdata_mutex_unlock(&web_static_files.mutex);
+
+    size_t memory = sf->memory;
+    web_static_file_load(sf, st, compress);
+
+    netdata_mutex_lock(&web_static_files.mutex);
+
+    sf->loading = false;
+    web_static_files.size += sf->memory - memory;
+
+    if(!sf->encodings[WEB_STATIC_FILE_IDENTITY].data) {
+        sf->refcount--;
+        web_static_file_del(sf);
+        sf = NULL;
+    }
+
+    web_static_files_evict();
+
+    pthread_cond_broadcast(&web_static_files.cond);
+    netdata_mutex_unlock(&web_static_files.mutex);
+
+    return sf;
+}
+
+void web_static_file_release(WEB_STATIC_FILE *sf) {
+    if(!sf)
+        return;
+
+    netdata_mutex_lock(&web_static_files.mutex);
+
+    sf->refcount--;
+    if(!sf->refcount && sf->obsolete)
+        web_static_file_free(sf);
+
+    netdata_mutex_unlock(&web_static_files.mutex);
+}
+
+const char *web_static_file_data(WEB_STATIC_FILE *sf, uint32_t accepted, WEB_STATIC_FILE_ENCODING *encoding, size_t *len) {
+    // the smallest variant the client accepts
+    WEB_STATIC_FILE_ENCODING best = WEB_STATIC_FILE_IDENTITY;
+    for(WEB_STATIC_FILE_ENCODING e = WEB_STATIC_FILE_IDENTITY + 1; e < WEB_STATIC_FILE_ENCODINGS ;e++) {
+        if((accepted & WEB_STATIC_FILE_ACCEPT(e)) && sf->encodings[e].data && sf->encodings[e].len < sf->encodings[best].len)
+            best = e;
+    }
+
+    *encoding = best;
+    *len = sf->encodings[best].len;
+    return sf->encodings[best].data;
+}
+
+const char *web_static_file_encoding_name(WEB_STATIC_FILE_ENCODING encoding) {
+    switch(encoding) {
+        case WEB_STATIC_FILE_GZIP:
+            return "gzip";
+
+        case WEB_STATIC_FILE_BROTLI:
+            return "br";
+
+        default:
+            return "identity";
+    }
+}
+
+// ----------------------------------------------------------------------------
+// unittest
+
+static bool web_static_files_unittest_write(const char *filename, const char *content, size_t len) {
+    FILE *fp = fopen(filename, "w");
+    if(!fp)
+        return false;
+
+    bool ok = fwrite(content, 1, len, fp) == len;
+    return fclose(fp) == 0 && ok;
+}
+
+static int web_static_files_unittest_check(const char *name, WEB_STATIC_FILE *sf, uint32_t accepted, WEB_STATIC_FILE_ENCODING expected_encoding, const char *expected, size_t expected_len) {
+    if(!sf) {
+        fprintf(stderr, "STATIC FILES: %s: the file is not cached - FAILED\n", name);
+        return 1;
+    }
+
+    WEB_STATIC_FILE_ENCODING encoding;
+    size_t len;
+    const char *data = web_static_file_data(sf, accepted, &encoding, &len);
+
+    if(encoding != expected_encoding) {
+        fprintf(stderr, "STATIC FILES: %s: expected encoding '%s', got '%s' - FAILED\n",
+                name, web_static_file_encoding_name(expected_encoding), web_static_file_encoding_name(encoding));
+        return 1;
+    }
+
+    if(expected && (len != expected_len || memcmp(data, expected, len) != 0)) {
+        fprintf(stderr, "STATIC FILES: %s: the content is not the expected - FAILED\n", name);
+        return 1;
+    }
+
+#ifdef NETDATA_WITH_ZLIB
+    if(encoding == WEB_STATIC_FILE_GZIP) {
+        WEB_STATIC_FILE_ENCODING identity_encoding;
+        size_t identity_len;
+        const char *identity = web_static_file_data(sf, 0, &identity_encoding, &identity_len);
+
+        char *uncompressed = mallocz(identity_len + 1);
+        z_stream zs = {
+                .zalloc = Z_NULL,
+                .zfree = Z_NULL,
+                .opaque = Z_NULL,
+                .next_in = (Bytef *)data,
+                .avail_in = (uInt)len,
+                .next_out = (Bytef *)uncompressed,
+                .avail_out = (uInt)(identity_len + 1),
+        };
+
+        bool ok = inflateInit2(&zs, 15 + 16) == Z_OK;
+        ok = ok && inflate(&zs, Z_FINISH) == Z_STREAM_END && zs.total_out == identity_len && !memcmp(uncompressed, identity, identity_len);
+        inflateEnd(&zs);
+        freez(uncompressed);
+
+        if(!ok) {
+            fprintf(stderr, "STATIC FILES: %s: the gzip variant does not decompress to the file - FAILED\n", name);
+            return 1;
+        }
+    }
+#endif
+
+    fprintf(stderr, "STATIC FILES: %s: %zu bytes, '%s' - OK\n", name, len, web_static_file_encoding_name(encoding));
+    return 0;
+}
+
+int web_static_files_unittest(void) {
+    int errors = 0;
+
+    char dir[] = "/tmp/netdata-static-files-XXXXXX";
+    if(!mkdtemp(dir)) {
+        fprintf(stderr, "STATIC FILES: cannot create a temporary directory\n");
+        return 1;
+    }
+
+    char filename[FILENAME_MAX + 1], br_filename[FILENAME_MAX + 1], big_filename[FILENAME_MAX + 1];
+    snprintfz(filename, FILENAME_MAX, "%s/index.html", dir);
+    snprintfz(br_filename, FILENAME_MAX, "%s/index.html.br", dir);
+    snprintfz(big_filename, FILENAME_MAX, "%s/big.js", dir);
+
+    size_t saved_max_size = web_static_files.max_size;
+    web_static_files.max_size = 1024 * 1024;
+
+    BUFFER *wb = buffer_create(0, NULL);
+    for(size_t i = 0; i < 1000 ;i++)
+        buffer_sprintf(wb, "<p>line %zu of a compressible file</p>\n", i);
+
+    const char *content = buffer_tostring(wb);
+    size_t content_len = buffer_strlen(wb);
+    uint32_t all = WEB_STATIC_FILE_ACCEPT(WEB_STATIC_FILE_GZIP) | WEB_STATIC_FILE_ACCEPT(WEB_STATIC_FILE_BROTLI);
+    struct stat st;
+
+    if(!web_static_files_unittest_write(filename, content, content_len) || stat(filename, &st) != 0) {
+        fprintf(stderr, "STATIC FILES: cannot write file '%s'\n", filename);
+        errors++;
+        goto cleanup;
+    }
+
+    // the file, its gzip variant and a cache hit
+    WEB_STATIC_FILE *sf1 = web_static_file_acquire(filename, &st, true);
+    errors += web_static_files_unittest_check("identity", sf1, 0, WEB_STATIC_FILE_IDENTITY, content, content_len);
+#ifdef NETDATA_WITH_ZLIB
+    errors += web_static_files_unittest_check("gzip", sf1, all, WEB_STATIC_FILE_GZIP, NULL, 0);
+#endif
+
+    WEB_STATIC_FILE *sf2 = web_static_file_acquire(filename, &st, true);
+    if(sf2 != sf1) {
+        fprintf(stderr, "STATIC FILES: the same file has been loaded twice - FAILED\n");
+        errors++;
+    }
+    web_static_file_release(sf2);
+
+    // a changed file is loaded again, while the old one is still valid for its clients
+    const char *br = "brotli";
+    if(!web_static_files_unittest_write(filename, "changed", 7) || stat(filename, &st) != 0 ||
+       !web_static_files_unittest_write(br_filename, br, strlen(br))) {
+        fprintf(stderr, "STATIC FILES: cannot write file '%s'\n", filename);
+        errors++;
+        web_static_file_release(sf1);
+        goto cleanup;
+    }
+
+    sf2 = web_static_file_acquire(filename, &st, true);
+    errors += web_static_files_unittest_check("changed", sf2, 0, WEB_STATIC_FILE_IDENTITY, "changed", 7);
+    errors += web_static_files_unittest_check("old", sf1, 0, WEB_STATIC_FILE_IDENTITY, content, content_len);
+    web_static_file_release(sf1);
+    web_static_file_release(sf2);
+
+    // a pre-compressed brotli variant is used only when it is smaller than the file
+    buffer_flush(wb);
+    for(size_t i = 0; i < 100 ;i++)
+        buffer_sprintf(wb, "<p>line %zu</p>\n", i);
+
+    if(!web_static_files_unittest_write(filename, buffer_tostring(wb), buffer_strlen(wb)) ||
+       !web_static_files_unittest_write(br_filename, br, strlen(br)) || stat(filename, &st) != 0) {
+        fprintf(stderr, "STATIC FILES: cannot write file '%s'\n", filename);
+        errors++;
+        goto cleanup;
+    }
+
+    sf1 = web_static_file_acquire(filename, &st, true);
+    errors += web_static_files_unittest_check("brotli", sf1, all, WEB_STATIC_FILE_BROTLI, br, strlen(br));
+    web_static_file_release(sf1);
+
+    // big files are not cached
+    BUFFER *big = buffer_create(web_static_files.max_size, NULL);
+    while(buffer_strlen(big) <= web_static_files.max_size / WEB_STATIC_FILES_MAX_FILE_SIZE_RATIO)
+        buffer_strcat(big, "var x = 0;\n");
+
+    if(!web_static_files_unittest_write(big_filename, buffer_tostring(big), buffer_strlen(big)) || stat(big_filename, &st) != 0) {
+        fprintf(stderr, "STATIC FILES: cannot write file '%s'\n", big_filename);
+        errors++;
+    }
+    else if(web_static_file_acquire(big_filename, &st, true)) {
+        fprintf(stderr, "STATIC FILES: a file bigger than the cache allows has been cached - FAILED\n");
+        errors++;
+    }
+    buffer_free(big);
+
+    // ETags
+    char etag[WEB_STATIC_FILE_ETAG_SIZE], if_none_match[WEB_STATIC_FILE_ETAG_SIZE * 3];
+    web_static_file_etag(&st, etag, sizeof(etag));
+    snprintfz(if_none_match, sizeof(if_none_match) - 1, "\"x\", %s", &etag[2]);
+    if(!web_static_file_etag_matches(if_none_match, etag) || !web_static_file_etag_matches("*", etag) ||
+       web_static_file_etag_matches("W/\"x\", \"y\"", etag)) {
+        fprintf(stderr, "STATIC FILES: ETag '%s' is not matched properly - FAILED\n", etag);
+        errors++;
+    }
+
+cleanup:
+    netdata_mutex_lock(&web_static_files.mutex);
+    while(web_static_files.lru)
+        web_static_file_del(web_static_files.lru);
+    netdata_mutex_unlock(&web_static_files.mutex);
+    web_static_files.max_size = saved_max_size;
+
+    buffer_free(wb);
+    unlink(filename);
+    unlink(br_filename);
+    unlink(big_filename);
+    rmdir(dir);
+
+    fprintf(stderr, "STATIC FILES: %s\n", errors ? "FAILED" : "OK");
+    return errors;
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_WEB_STATIC_FILES_H
+#define NETDATA_WEB_STATIC_FILES_H 1
+
+#include "libnetdata/libnetdata.h"
+
+// ----------------------------------------------------------------------------
+// Cache of static files
+//
+// The files of the dashboards are kept in memory, together with their compressed
+// variants, so that serving them does not read or compress anything. The gzip
+// variant is compressed once, when the file is cached. The brotli variant is used
+// only when it is given pre-compressed next to the file (filename.br).
+//
+// A cached file is used while the file on disk has the same inode, size and
+// modification time. Files that are too big for the cache are sent with sendfile().
+
+typedef enum web_static_file_encoding {
+    WEB_STATIC_FILE_IDENTITY = 0,
+    WEB_STATIC_FILE_GZIP,
+    WEB_STATIC_FILE_BROTLI,
+
+    // terminator
+    WEB_STATIC_FILE_ENCODINGS,
+} WEB_STATIC_FILE_ENCODING;
+
+#define WEB_STATIC_FILE_ACCEPT(encoding) (1 << (encoding))
+
+#define WEB_STATIC_FILE_ETAG_SIZE 64
+
+typedef struct web_static_file WEB_STATIC_FILE;
+
+void web_static_files_init(void);
+
+// returns the file cached and acquired, or NULL when it cannot be cached
+// when compress is true, a gzip variant of the file is cached too
+WEB_STATIC_FILE *web_static_file_acquire(const char *filename, struct stat *st, bool compress);
+void web_static_file_release(WEB_STATIC_FILE *sf);
+
+// returns the best variant of the file, among the encodings accepted (a bitmap of WEB_STATIC_FILE_ACCEPT())
+const char *web_static_file_data(WEB_STATIC_FILE *sf, uint32_t accepted, WEB_STATIC_FILE_ENCODING *encoding, size_t *len);
+
+const char *web_static_file_encoding_name(WEB_STATIC_FILE_ENCODING encoding);
+
+// the (weak) ETag of a file, based on its inode, size and modification time
+void web_static_file_etag(struct stat *st, char *dst, size_t dst_size);
+
+// returns true when the value of an If-None-Match header matches the ETag
+bool web_static_file_etag_matches(const char *if_none_match, const char *etag);
+
+int web_static_files_unittest(void);
+
+#endif //NETDATA_WEB_STATIC_FILES_H